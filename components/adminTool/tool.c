@@ -27,6 +27,10 @@ static enum
     ACTION_POLL,
     ACTION_READ,
     ACTION_WATCH,
+    ACTION_CONFIG_ESTIMATE,
+    ACTION_STATS,
+    ACTION_SLOW_OPS,
+    ACTION_CPU_TOP,
 }
 Action = ACTION_UNSPECIFIED;
 
@@ -71,6 +75,44 @@ static bool UseJsonFormat = false;
 //--------------------------------------------------------------------------------------------------
 static bool ReadFromFile = false;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag indicating whether or not the push statistics should be cleared after they are printed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ResetStats = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flags indicating whether the timing of the stages of the push path should be turned on or off.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool StageTimingOn = false;
+static bool StageTimingOff = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag indicating whether or not the slow operations should be forgotten after they are printed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ClearSlowOps = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flags indicating whether the heaviest resources should be printed only once, and whether CPU
+ * profiling should be turned off instead.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CpuTopOnce = false;
+static bool CpuProfilingOff = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag indicating whether an administrative update started by this tool is still open.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsUpdating = false;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print help text to stdout and exit with EXIT_SUCCESS.
@@ -105,6 +147,10 @@ static void HandleHelpRequest
         "    dhub watch [--json] PATH\n"
         "    dhub get OBJECT PATH [START]\n"
         "    dhub read PATH [START]\n"
+        "    dhub config estimate FILE [ENCODING]\n"
+        "    dhub stats [--reset] [--time|--no-time] [PATH]\n"
+        "    dhub slow [--clear] [THRESHOLD]\n"
+        "    dhub top [--once] [--off]\n"
         "    dhub help\n"
         "    dhub -h\n"
         "    dhub --help\n"
@@ -263,6 +309,44 @@ static void HandleHelpRequest
         "            than 2 minutes old.  If START is not specified, the entire buffer\n"
         "            will be read.\n"
         "\n"
+        "    dhub config estimate FILE [ENCODING]\n"
+        "            Validates the configuration file FILE, without loading it, and\n"
+        "            prints what loading it would take: the number of Observations\n"
+        "            and state values, the buffer entries, data samples and string\n"
+        "            blocks needed once the Observation buffers are full, and the\n"
+        "            bytes per second written by buffer backups.  ENCODING is 'json'\n"
+        "            (the default) or 'cbor'.\n"
+        "\n"
+        "    dhub stats [--reset] [--time|--no-time] [PATH]\n"
+        "            Prints the push statistics of the resource at PATH: the number\n"
+        "            of samples pushed to it, accepted, filtered out by each of the\n"
+        "            limit, changeBy and minPeriod filters, rejected for any other\n"
+        "            reason, and dropped for lack of memory.  Without PATH, prints\n"
+        "            the latency (microseconds) of each stage of the push path, for\n"
+        "            all resources together.  Stages are only timed once --time\n"
+        "            (-t) has been given, until --no-time is.  With --reset (-r),\n"
+        "            the statistics of all resources are then cleared.\n"
+        "\n"
+        "    dhub slow [--clear] [THRESHOLD]\n"
+        "            Prints the most recent operations that held up the Data Hub's\n"
+        "            event loop for at least the slow operation threshold, newest\n"
+        "            first: when each one started, how long it took (milliseconds),\n"
+        "            its name and the path it was on.  With THRESHOLD (seconds), the\n"
+        "            threshold is set first.  With --clear (-c), the operations are\n"
+        "            then forgotten.\n"
+        "\n"
+        "    dhub top [--once] [--off]\n"
+        "            Turns CPU profiling on, then prints the resources whose pushes\n"
+        "            took the most CPU time in the last 10 seconds, heaviest first,\n"
+        "            refreshed every second: the percentage of the CPU each push\n"
+        "            took (leaving out the pushes it led to), the part of it spent\n"
+        "            in JSON extraction, transform and push handlers, and the path.\n"
+        "            With --once (-o), prints them once and exits.  Profiling stays\n"
+        "            on until 'dhub top --off' is run.  On targets other than x86\n"
+        "            and 64-bit ARM, such as 32-bit ARM, the times are read from the\n"
+        "            monotonic clock rather than a cycle counter, so profiling costs\n"
+        "            more there and the shortest pushes are measured less precisely.\n"
+        "\n"
         "    dhub help\n"
         "    dhub -h\n"
         "    dhub --help\n"
@@ -308,6 +392,14 @@ static const char* ValueArg = NULL;
 static double StartArg = NAN;  // Not-a-number by default
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Threshold argument for the 'slow' command.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ThresholdArg = NAN;  // Not-a-number by default
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handles a failure to connect an IPC session with the Data Hub by reporting an error to stderr
@@ -379,6 +471,12 @@ static void ConnectToDataHub
     {
         HandleConnectionError("Data Hub I/O", result);
     }
+
+    result = config_TryConnectService();
+    if (result != LE_OK)
+    {
+        HandleConnectionError("Data Hub Config", result);
+    }
 }
 
 
@@ -479,44 +577,6 @@ static void Indent
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Print the current value of a given resource.
- */
-//--------------------------------------------------------------------------------------------------
-static void PrintCurrentValue
-(
-    const char* path
-)
-//--------------------------------------------------------------------------------------------------
-{
-    double timestamp;
-    char value[IO_MAX_STRING_VALUE_LEN + 1];
-
-    le_result_t result = query_GetJson(path, &timestamp, value, sizeof(value));
-
-    if (result == LE_OK)
-    {
-        printf("%s (ts: %lf)\n", value, timestamp);
-    }
-    else if (result == LE_UNAVAILABLE)
-    {
-        if (admin_IsMandatory(path))
-        {
-            printf(" <-- WARNING: unsatisfied mandatory output\n");
-        }
-        else
-        {
-            putchar('\n');
-        }
-    }
-    else
-    {
-        fprintf(stderr, "** ERROR: %s\n", LE_RESULT_TXT(result));
-    }
-}
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Print the default value associated with a given resource.
@@ -728,239 +788,311 @@ static void PrintTransformSetting
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print the data type of a resource at a given path.
+ * Buffer for the largest field of a listing record (a string value, in quotes).
+ */
+//--------------------------------------------------------------------------------------------------
+static char FieldBuffer[IO_MAX_STRING_VALUE_LEN + 3];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the next field of a listing record from a stream (see admin_ListSubtree()).  The field's
+ * length prefix is preceded by the newline ending the previous record, if any.
+ *
+ * @return Pointer to the null-terminated field (in buffPtr).  Exits on error.
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintDataType
+static const char* ReadField
 (
-    const char* path,
-    size_t depth
+    FILE* streamPtr,
+    char* buffPtr,
+    size_t buffSize
 )
 //--------------------------------------------------------------------------------------------------
 {
-    io_DataType_t dataType;
-
-    le_result_t result = query_GetDataType(path, &dataType);
+    size_t len;
 
-    if (result == LE_OK)
+    if (   (fscanf(streamPtr, "%zu:", &len) != 1)
+        || (len >= buffSize)
+        || (fread(buffPtr, 1, len, streamPtr) != len))
     {
-        Indent(depth);
+        fprintf(stderr, "** ERROR: Malformed listing from the Data Hub.\n");
+        exit(EXIT_FAILURE);
+    }
 
-        char example[IO_MAX_STRING_VALUE_LEN];
+    buffPtr[len] = '\0';
 
-        if (query_GetJsonExample(path, example, sizeof(example)) == LE_OK)
-        {
-            printf("data type = %s (e.g., '%s')\n", DataTypeStr(dataType), example);
-        }
-        else
-        {
-            printf("data type = %s\n", DataTypeStr(dataType));
-        }
-    }
-    else
-    {
-        fprintf(stderr, "** Error getting data type: %d (%s).\n", result, LE_RESULT_TXT(result));
-    }
+    return buffPtr;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print the units of a resource at a given path (if any specified).
+ * Read a number field of a listing record from a stream.
+ *
+ * @return The number, or NAN if the field is empty (not set).
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintUnits
+static double ReadNumberField
 (
-    const char* path,
-    size_t depth
+    FILE* streamPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char units[IO_MAX_UNITS_NAME_LEN + 1];
-
-    le_result_t result = query_GetUnits(path, units, sizeof(units));
+    char number[64];
 
-    if (result == LE_OK)
+    if (ReadField(streamPtr, number, sizeof(number))[0] == '\0')
     {
-        if (units[0] != '\0')
-        {
-            Indent(depth);
-            printf("units = '%s'\n", units);
-        }
-    }
-    else
-    {
-        fprintf(stderr, "** Error getting units: %d (%s).\n", result, LE_RESULT_TXT(result));
+        return NAN;
     }
+
+    return strtod(number, NULL);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print a JSON extraction specification setting.
+ * Print a default or override value, given in JSON, as PrintDefault() and PrintOverride() do.
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintJsonExtractionSetting
+static void PrintJsonValue
 (
-    size_t depth,    ///< Indent this far.
-    const char* path
+    io_DataType_t dataType,
+    const char* value
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char spec[ADMIN_MAX_JSON_EXTRACTOR_LEN];
-
-    le_result_t result = admin_GetJsonExtraction(path, spec, sizeof(spec));
-
-    if (result == LE_OK)
+    if (dataType == IO_DATA_TYPE_JSON)
     {
-        Indent(depth);
-        printf("JSON extraction: %s\n", spec);
+        printf("JSON: %s", value);
     }
-    else if (result != LE_NOT_FOUND)
+    else
     {
-        fprintf(stderr,
-                "**ERROR: Failed (%s) to get JSON extraction specification for '%s'.\n",
-                LE_RESULT_TXT(result),
-                path);
-        exit(EXIT_FAILURE);
+        // Boolean, numeric and string values look the same in JSON.
+        printf("%s", value);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print the details of an entry in the resource tree at a given path.
+ * Print the details of an entry in the resource tree, from its listing record.
+ *
+ * @return false if there are no more records in the stream.
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintEntry
+static bool PrintRecord
 (
-    const char* path,
-    size_t depth    ///< Indentation depth
+    FILE* streamPtr,
+    const char* rootPath    ///< Path of the listed branch (names the entry at depth 0).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_result_t result;
+    char name[IO_MAX_RESOURCE_PATH_LEN + 1];
+    char units[IO_MAX_UNITS_NAME_LEN + 1];
+    char srcPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+    char number[16];
+    int c;
 
-    const char* name = GetEntryName(path);
+    // Skip the newline ending the previous record, and stop at the end of the stream.
+    while (isspace(c = fgetc(streamPtr)))
+    {
+    }
+    if (c == EOF)
+    {
+        return false;
+    }
+    ungetc(c, streamPtr);
+
+    size_t depth = (size_t)ReadNumberField(streamPtr);
+    admin_EntryType_t entryType = (admin_EntryType_t)ReadNumberField(streamPtr);
+    ReadField(streamPtr, name, sizeof(name));
 
-    admin_EntryType_t entryType = admin_GetEntryType(path);
+    Indent(depth);
 
-    if (entryType == ADMIN_ENTRY_TYPE_NONE)
+    if (entryType == ADMIN_ENTRY_TYPE_NAMESPACE)
     {
-        fprintf(stderr, "No resource at path '%s'.\n", path);
-        exit(EXIT_FAILURE);
+        // There's not much to print for a Namespace.
+        printf("%s\n", (depth == 0) ? GetEntryName(rootPath) : name);
+        return true;
     }
-    else if (entryType == ADMIN_ENTRY_TYPE_NAMESPACE)
+
+    printf("%s <%s> = ", (depth == 0) ? GetEntryName(rootPath) : name, EntryTypeStr(entryType));
+
+    io_DataType_t dataType = (io_DataType_t)ReadNumberField(streamPtr);
+    ReadField(streamPtr, units, sizeof(units));
+    bool isMandatory = (ReadNumberField(streamPtr) != 0);
+    double timestamp = ReadNumberField(streamPtr);
+
+    if (ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer))[0] != '\0')
     {
-        // There's not much to print for a Namespace.
-        Indent(depth);
-        printf("%s\n", name);
+        printf("%s (ts: %lf)\n", FieldBuffer, timestamp);
     }
-    else // Resource
+    else if (isMandatory)
     {
-        Indent(depth);
-        printf("%s <%s> = ", name, EntryTypeStr(entryType));
-        PrintCurrentValue(path);
+        printf(" <-- WARNING: unsatisfied mandatory output\n");
+    }
+    else
+    {
+        putchar('\n');
+    }
+
+    depth += 2;
 
-        depth += 2;
+    Indent(depth);
+    if (ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer))[0] != '\0')
+    {
+        printf("data type = %s (e.g., '%s')\n", DataTypeStr(dataType), FieldBuffer);
+    }
+    else
+    {
+        printf("data type = %s\n", DataTypeStr(dataType));
+    }
 
-        PrintDataType(path, depth);
+    if (units[0] != '\0')
+    {
+        Indent(depth);
+        printf("units = '%s'\n", units);
+    }
 
-        PrintUnits(path, depth);
+    ReadField(streamPtr, srcPath, sizeof(srcPath));
 
-        if (admin_HasOverride(path))
-        {
-            Indent(depth);
-            printf("** override = ");
-            PrintOverride(path);
-            putchar('\n');
-        }
+    if (ReadField(streamPtr, number, sizeof(number))[0] != '\0')
+    {
+        io_DataType_t overrideType = (io_DataType_t)atoi(number);
 
-        if (admin_HasDefault(path))
+        Indent(depth);
+        printf("** override = ");
+        PrintJsonValue(overrideType, ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer)));
+        if (dataType != overrideType)
         {
-            Indent(depth);
-            printf("default = ");
-            PrintDefault(path);
-            putchar('\n');
+            printf("  <-- WARNING: Override has different data type than resource.");
         }
+        putchar('\n');
+    }
+    else
+    {
+        ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer));
+    }
 
-        char srcPath[IO_MAX_RESOURCE_PATH_LEN + 1];
-        result = admin_GetSource(path, srcPath, sizeof(srcPath));
-        if (result == LE_OK)
-        {
-            Indent(depth);
-            printf("receiving data from '%s'", srcPath);
+    if (ReadField(streamPtr, number, sizeof(number))[0] != '\0')
+    {
+        Indent(depth);
+        printf("default = ");
+        PrintJsonValue((io_DataType_t)atoi(number),
+                       ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer)));
+        putchar('\n');
+    }
+    else
+    {
+        ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer));
+    }
 
-            if (entryType == ADMIN_ENTRY_TYPE_INPUT)
-            {
-                Indent(depth);
-                printf(" (which will be ignored because this is an input)");
-            }
+    if (srcPath[0] != '\0')
+    {
+        Indent(depth);
+        printf("receiving data from '%s'", srcPath);
 
-            putchar('\n');
-        }
-        else if (result != LE_NOT_FOUND)
+        if (entryType == ADMIN_ENTRY_TYPE_INPUT)
         {
-            LE_FATAL("Bug: Unexpected result from admin_GetSource(): %d (%s).",
-                     result,
-                     LE_RESULT_TXT(result));
+            Indent(depth);
+            printf(" (which will be ignored because this is an input)");
         }
 
+        putchar('\n');
     }
 
     // Observation
     if (entryType == ADMIN_ENTRY_TYPE_OBSERVATION)
     {
-        PrintJsonExtractionSetting(depth, path);
+        if (ReadField(streamPtr, FieldBuffer, sizeof(FieldBuffer))[0] != '\0')
+        {
+            Indent(depth);
+            printf("JSON extraction: %s\n", FieldBuffer);
+        }
         Indent(depth);
-        PrintDoubleSetting("minPeriod", admin_GetMinPeriod(path));
+        PrintDoubleSetting("minPeriod", ReadNumberField(streamPtr));
         Indent(depth);
-        PrintDoubleSetting("lowLimit", admin_GetLowLimit(path));
+        PrintDoubleSetting("lowLimit", ReadNumberField(streamPtr));
         Indent(depth);
-        PrintDoubleSetting("highLimit", admin_GetHighLimit(path));
+        PrintDoubleSetting("highLimit", ReadNumberField(streamPtr));
         Indent(depth);
-        PrintDoubleSetting("changeBy", admin_GetChangeBy(path));
+        PrintDoubleSetting("changeBy", ReadNumberField(streamPtr));
         Indent(depth);
-        PrintTransformSetting("transform", admin_GetTransform(path));
+        PrintTransformSetting("transform", (int)ReadNumberField(streamPtr));
         Indent(depth);
-        printf("bufferSize: %u entries\n", admin_GetBufferMaxCount(path));
+        printf("bufferSize: %u entries\n", (unsigned int)ReadNumberField(streamPtr));
         Indent(depth);
-        uint32_t backupPeriod = admin_GetBufferBackupPeriod(path);
+        uint32_t backupPeriod = (uint32_t)ReadNumberField(streamPtr);
         printf("backupPeriod: %u seconds (= %lf minutes) (= %lf hours)\n",
                backupPeriod,
                ((double)backupPeriod) / 60,
                ((double)backupPeriod) / 3600);
     }
+
+    return true;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Print the details of a branch of the resource tree, starting from a given path.
+ * List completion callback function.  This gets called when the Data Hub has finished listing
+ * a branch of the resource tree.
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintBranch
+static void ListComplete
 (
-    const char* path,
-    size_t depth    ///< Indentation depth
+    le_result_t result,
+    void* contextPtr ///< Not used.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    PrintEntry(path, depth);
+    if (result != LE_OK)
+    {
+        fprintf(stderr, "List operation failed (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
 
-    char childPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the details of a branch of the resource tree, starting from a given path.  The Data Hub
+ * lists the whole branch in one pass, through a pipe, and ListComplete() is called once it is
+ * done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintBranch
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fds[2];
 
-    le_result_t result = admin_GetFirstChild(path, childPath, sizeof(childPath));
-    LE_ASSERT(result != LE_OVERFLOW);
+    if (pipe(fds) != 0)
+    {
+        fprintf(stderr, "** ERROR: Failed to create a pipe (%m).\n");
+        exit(EXIT_FAILURE);
+    }
 
-    while (result == LE_OK)
+    // The write end is closed once it has been sent to the Data Hub.
+    if (admin_ListSubtree(path, fds[1], ListComplete, NULL) != LE_OK)
     {
-        PrintBranch(childPath, depth + 1);
+        fprintf(stderr, "No resource at path '%s'.\n", path);
+        exit(EXIT_FAILURE);
+    }
 
-        result = admin_GetNextSibling(childPath, childPath, sizeof(childPath));
+    FILE* streamPtr = fdopen(fds[0], "r");
+    LE_ASSERT(streamPtr != NULL);
 
-        LE_ASSERT(result != LE_OVERFLOW);
+    while (PrintRecord(streamPtr, path))
+    {
     }
+
+    fclose(streamPtr);
 }
 
 
@@ -1662,7 +1794,7 @@ static void PathArgHandler
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (Action == ACTION_WATCH)
+    if ((Action == ACTION_WATCH) || (Action == ACTION_STATS))
     {
         PathArg = ValidateAbsolutePath(arg);
         return;
@@ -1738,6 +1870,28 @@ static void StartArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the THRESHOLD argument.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ThresholdArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ThresholdArg = ParseDouble(arg);
+
+    if ((errno != 0) || !(ThresholdArg >= 0))
+    {
+        fprintf(stderr, "Error parsing THRESHOLD argument '%s'.\n"
+                        "Must be a positive number of seconds.\n", arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Command-line argument handler callback for the object type argument (e.g., "source", "default").
@@ -1865,6 +2019,60 @@ static void ObjectTypeArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the FILE argument of the 'config' commands.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FileArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The Data Hub opens the file itself, so relative paths must be resolved here.
+    static char absPath[PATH_MAX];
+
+    if (realpath(arg, absPath) == NULL)
+    {
+        fprintf(stderr, "Can't access '%s' (%m).\n", arg);
+        exit(EXIT_FAILURE);
+    }
+
+    PathArg = absPath;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Command-line argument handler call-back for the argument that follows 'config'.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConfigCommandArgHandler
+(
+    const char* arg
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (strcmp(arg, "estimate") == 0)
+    {
+        Action = ACTION_CONFIG_ESTIMATE;
+
+        // Expect a FILE argument, followed by an optional ENCODING argument.
+        le_arg_AddPositionalCallback(FileArgHandler);
+        le_arg_AddPositionalCallback(ValueArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+        ValueArg = "json";
+    }
+    else
+    {
+        fprintf(stderr, "Unrecognized config command '%s'.  Try 'dhub help' for assistance.\n",
+                arg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Command-line argument handler call-back for the first positional argument, which is the command.
@@ -1940,6 +2148,39 @@ static void CommandArgHandler
         le_arg_AddPositionalCallback(StartArgHandler);
         le_arg_AllowLessPositionalArgsThanCallbacks();
     }
+    else if (strcmp(arg, "stats") == 0)
+    {
+        Action = ACTION_STATS;
+
+        // Accept an optional PATH argument and an optional --reset argument.
+        le_arg_AddPositionalCallback(PathArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+        le_arg_SetFlagVar(&ResetStats, "r", "reset");
+        le_arg_SetFlagVar(&StageTimingOn, "t", "time");
+        le_arg_SetFlagVar(&StageTimingOff, NULL, "no-time");
+    }
+    else if (strcmp(arg, "slow") == 0)
+    {
+        Action = ACTION_SLOW_OPS;
+
+        // Accept an optional THRESHOLD argument and an optional --clear argument.
+        le_arg_AddPositionalCallback(ThresholdArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+        le_arg_SetFlagVar(&ClearSlowOps, "c", "clear");
+    }
+    else if (strcmp(arg, "top") == 0)
+    {
+        Action = ACTION_CPU_TOP;
+
+        // Accept optional --once and --off arguments.
+        le_arg_SetFlagVar(&CpuTopOnce, "o", "once");
+        le_arg_SetFlagVar(&CpuProfilingOff, NULL, "off");
+    }
+    else if (strcmp(arg, "config") == 0)
+    {
+        // Expect a config command ("estimate").
+        le_arg_AddPositionalCallback(ConfigCommandArgHandler);
+    }
     else
     {
         fprintf(stderr, "Unrecognized command '%s'.  Try 'dhub help' for assistance.\n", arg);
@@ -1948,6 +2189,362 @@ static void CommandArgHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print what loading the config file at PathArg would take.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EstimateConfig
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t obsCount, newObsCount, stateCount, bufferEntryCount;
+    uint32_t nonStringSampleCount, stringSampleCount;
+    uint32_t smallStringCount, medStringCount, largeStringCount;
+    double backupBytesPerSec;
+
+    le_result_t result = config_Estimate(PathArg,
+                                         ValueArg,
+                                         &obsCount,
+                                         &newObsCount,
+                                         &stateCount,
+                                         &bufferEntryCount,
+                                         &nonStringSampleCount,
+                                         &stringSampleCount,
+                                         &smallStringCount,
+                                         &medStringCount,
+                                         &largeStringCount,
+                                         &backupBytesPerSec);
+    switch (result)
+    {
+        case LE_OK:
+            break;
+
+        case LE_NOT_FOUND:
+            fprintf(stderr, "Data Hub can't open '%s'.\n", PathArg);
+            exit(EXIT_FAILURE);
+
+        case LE_UNSUPPORTED:
+            fprintf(stderr, "Unsupported encoding '%s'.\n", ValueArg);
+            exit(EXIT_FAILURE);
+
+        default:
+            fprintf(stderr, "'%s' is not a valid configuration (%s).\n",
+                    PathArg,
+                    LE_RESULT_TXT(result));
+            exit(EXIT_FAILURE);
+    }
+
+    printf("observations: %" PRIu32 " (%" PRIu32 " new)\n", obsCount, newObsCount);
+    printf("states: %" PRIu32 "\n", stateCount);
+    printf("buffer entries: %" PRIu32 "\n", bufferEntryCount);
+    printf("non-string samples: %" PRIu32 "\n", nonStringSampleCount);
+    printf("string samples: %" PRIu32 "\n", stringSampleCount);
+    printf("string blocks: %" PRIu32 " small, %" PRIu32 " medium, %" PRIu32 " large\n",
+           smallStringCount,
+           medStringCount,
+           largeStringCount);
+    printf("backup bytes/s: %.1f\n", backupBytesPerSec);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the push statistics of the resource at PathArg or, if there is no PathArg, the push path
+ * latencies.  Then clear the statistics if --reset was given.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintStats
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const char* const counterNames[ADMIN_PUSH_COUNTER_COUNT] =
+    {
+        [ADMIN_PUSH_COUNTER_PUSHED] = "pushed",
+        [ADMIN_PUSH_COUNTER_ACCEPTED] = "accepted",
+        [ADMIN_PUSH_COUNTER_FILTERED_LIMIT] = "filtered (limit)",
+        [ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY] = "filtered (changeBy)",
+        [ADMIN_PUSH_COUNTER_FILTERED_MIN_PERIOD] = "filtered (minPeriod)",
+        [ADMIN_PUSH_COUNTER_REJECTED] = "rejected",
+        [ADMIN_PUSH_COUNTER_DROPPED] = "dropped",
+    };
+    static const char* const stageNames[ADMIN_PUSH_STAGE_COUNT] =
+    {
+        [ADMIN_PUSH_STAGE_JSON_EXTRACTION] = "jsonExtraction",
+        [ADMIN_PUSH_STAGE_TRANSFORM] = "transform",
+        [ADMIN_PUSH_STAGE_FILTER] = "filter",
+        [ADMIN_PUSH_STAGE_COERCION] = "coercion",
+        [ADMIN_PUSH_STAGE_HANDLERS] = "handlers",
+        [ADMIN_PUSH_STAGE_BUFFER] = "buffer",
+    };
+    le_result_t result = LE_OK;
+
+    if (StageTimingOn || StageTimingOff)
+    {
+        result = admin_SetPushStageTiming(StageTimingOn);
+    }
+
+    if ((result == LE_OK) && (PathArg != NULL))
+    {
+        uint32_t counts[ADMIN_PUSH_COUNTER_COUNT];
+        size_t countsSize = ADMIN_PUSH_COUNTER_COUNT;
+
+        result = admin_GetPushCounts(PathArg, counts, &countsSize);
+        if (result == LE_NOT_FOUND)
+        {
+            fprintf(stderr, "No resource found at path '%s'.\n", PathArg);
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t i = 0; (result == LE_OK) && (i < countsSize); i++)
+        {
+            printf("%s: %" PRIu32 "\n", counterNames[i], counts[i]);
+        }
+    }
+    else if (result == LE_OK)
+    {
+        printf("%-16s %10s %10s %10s %10s %10s %10s\n",
+               "stage", "count", "mean", "p50", "p90", "p99", "max");
+
+        for (int stage = 0; (result == LE_OK) && (stage < ADMIN_PUSH_STAGE_COUNT); stage++)
+        {
+            uint64_t count;
+            double mean, p50, p90, p99, max;
+
+            result = admin_GetPushLatency(stage, &count, &mean, &p50, &p90, &p99, &max);
+            if (result == LE_OK)
+            {
+                printf("%-16s %10" PRIu64 " %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                       stageNames[stage],
+                       count,
+                       mean * 1e6,
+                       p50 * 1e6,
+                       p90 * 1e6,
+                       p99 * 1e6,
+                       max * 1e6);
+            }
+        }
+    }
+
+    if ((result == LE_OK) && ResetStats)
+    {
+        result = admin_ResetPushStats();
+    }
+
+    if (result == LE_NOT_IMPLEMENTED)
+    {
+        fprintf(stderr, "The Data Hub was built without push statistics.\n");
+        exit(EXIT_FAILURE);
+    }
+    else if (result != LE_OK)
+    {
+        fprintf(stderr, "Failed to get push statistics (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the slow operation threshold if THRESHOLD was given, then print the threshold and the
+ * most recent slow operations.  Then forget them if --clear was given.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintSlowOps
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = LE_OK;
+    double threshold;
+
+    if (!isnan(ThresholdArg))
+    {
+        result = admin_SetSlowOpThreshold(ThresholdArg);
+    }
+
+    if (result == LE_OK)
+    {
+        result = admin_GetSlowOpThreshold(&threshold);
+    }
+
+    if (result == LE_OK)
+    {
+        printf("threshold: %.1f ms\n", threshold * 1e3);
+        printf("%-23s %10s  %s\n", "start", "ms", "operation");
+    }
+
+    for (uint32_t i = 0; result == LE_OK; i++)
+    {
+        char name[ADMIN_MAX_SLOW_OP_NAME_LEN + 1];
+        char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+        double timestamp, duration;
+
+        result = admin_GetSlowOp(i, name, sizeof(name), path, sizeof(path), &timestamp, &duration);
+        if (result == LE_OUT_OF_RANGE)
+        {
+            result = LE_OK;
+            break;
+        }
+        else if (result == LE_OK)
+        {
+            time_t seconds = (time_t)timestamp;
+            struct tm timeInfo;
+            char timeStr[32];
+
+            localtime_r(&seconds, &timeInfo);
+            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeInfo);
+
+            printf("%s.%03d %10.1f  %s %s\n",
+                   timeStr,
+                   (int)((timestamp - seconds) * 1000),
+                   duration * 1e3,
+                   name,
+                   path);
+        }
+    }
+
+    if ((result == LE_OK) && ClearSlowOps)
+    {
+        result = admin_ClearSlowOps();
+    }
+
+    if (result == LE_NOT_IMPLEMENTED)
+    {
+        fprintf(stderr, "The Data Hub was built without statistics.\n");
+        exit(EXIT_FAILURE);
+    }
+    else if (result != LE_OK)
+    {
+        fprintf(stderr, "Failed to get slow operations (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the resources that took the most CPU time in the last 10 seconds.  If stdout is a
+ * terminal, the screen is cleared first so the table is refreshed in place.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintCpuTop
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t count;
+    double window;
+
+    le_result_t result = admin_UpdateCpuTop(&count, &window);
+    if (result != LE_OK)
+    {
+        fprintf(stderr, "Failed to get CPU times (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
+
+    if (isatty(fileno(stdout)) && !CpuTopOnce)
+    {
+        printf("\033[H\033[J");
+    }
+    printf("window: %.1f s\n", window);
+    printf("%6s %6s %6s %6s  %s\n", "%CPU", "%JSON", "%XFRM", "%HNDL", "path");
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+        double cpuTime[ADMIN_CPU_SITE_COUNT] = { 0 };
+        size_t cpuTimeSize = ADMIN_CPU_SITE_COUNT;
+
+        // The list can't change between the calls, but the path may be truncated.
+        result = admin_GetCpuTopEntry(i, path, sizeof(path), cpuTime, &cpuTimeSize);
+        if ((result != LE_OK) && (result != LE_OVERFLOW))
+        {
+            break;
+        }
+
+        double scale = (window > 0) ? 100 / window : 0;
+
+        printf("%6.2f %6.2f %6.2f %6.2f  %s\n",
+               cpuTime[ADMIN_CPU_SITE_PUSH] * scale,
+               cpuTime[ADMIN_CPU_SITE_JSON_EXTRACTION] * scale,
+               cpuTime[ADMIN_CPU_SITE_TRANSFORM] * scale,
+               cpuTime[ADMIN_CPU_SITE_HANDLERS] * scale,
+               path);
+    }
+
+    fflush(stdout);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called every second by the refresh timer of 'dhub top'.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CpuTopTimerExpired
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(timer);
+
+    PrintCpuTop();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn CPU profiling off if --off was given and exit.  Otherwise, turn it on and print the
+ * heaviest resources, once if --once was given, or every second from a timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CpuTop
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_result_t result = admin_SetCpuProfiling(!CpuProfilingOff);
+
+    if (result == LE_NOT_IMPLEMENTED)
+    {
+        fprintf(stderr, "The Data Hub was built without statistics.\n");
+        exit(EXIT_FAILURE);
+    }
+    else if (result != LE_OK)
+    {
+        fprintf(stderr, "Failed to set CPU profiling (%s).\n", LE_RESULT_TXT(result));
+        exit(EXIT_FAILURE);
+    }
+
+    if (CpuProfilingOff)
+    {
+        exit(EXIT_SUCCESS);
+    }
+
+    PrintCpuTop();
+
+    if (CpuTopOnce)
+    {
+        exit(EXIT_SUCCESS);
+    }
+
+    le_timer_Ref_t timer = le_timer_Create("cpuTop");
+    le_timer_SetMsInterval(timer, 1000);
+    le_timer_SetRepeat(timer, 0);
+    le_timer_SetHandler(timer, CpuTopTimerExpired);
+    le_timer_Start(timer);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read completion callback function.  This gets called when a read operation has completed.
@@ -1971,6 +2568,45 @@ static void ReadComplete
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the administrative update started by StartUpdate(), if it is still open.  Also called at
+ * exit, so that an error that makes the tool exit in the middle of an update does not leave it
+ * open.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndUpdate
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (IsUpdating)
+    {
+        IsUpdating = false;
+        admin_EndUpdate();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an administrative update, to be ended by EndUpdate() (or at exit).
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartUpdate
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    atexit(EndUpdate);
+
+    admin_StartUpdate();
+    IsUpdating = true;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Component initializer.
@@ -1995,8 +2631,8 @@ COMPONENT_INIT
 
         case ACTION_LIST:
 
-            PrintBranch(PathArg, 0);
-            break;
+            PrintBranch(PathArg);
+            return;  // Return instead of falling-through to exit. Wait for completion callback.
 
         case ACTION_GET:
 
@@ -2097,7 +2733,7 @@ COMPONENT_INIT
 
         case ACTION_SET:
 
-            admin_StartUpdate();
+            StartUpdate();
 
             switch (Object)
             {
@@ -2170,7 +2806,7 @@ COMPONENT_INIT
                     exit(EXIT_FAILURE);
             }
 
-            admin_EndUpdate();
+            EndUpdate();
             break;
 
         case ACTION_PUSH:
@@ -2180,7 +2816,7 @@ COMPONENT_INIT
 
         case ACTION_REMOVE:
 
-            admin_StartUpdate();
+            StartUpdate();
 
             switch (Object)
             {
@@ -2249,7 +2885,7 @@ COMPONENT_INIT
                     exit(EXIT_FAILURE);
             }
 
-            admin_EndUpdate();
+            EndUpdate();
             break;
 
         case ACTION_WATCH:
@@ -2274,6 +2910,32 @@ COMPONENT_INIT
 
             return;  // Return instead of falling-through to exit. Wait for completion callback.
 
+        case ACTION_CONFIG_ESTIMATE:
+
+            if (PathArg == NULL)
+            {
+                fprintf(stderr, "Missing FILE argument.\n");
+                exit(EXIT_FAILURE);
+            }
+
+            EstimateConfig();
+            break;
+
+        case ACTION_STATS:
+
+            PrintStats();
+            break;
+
+        case ACTION_SLOW_OPS:
+
+            PrintSlowOps();
+            break;
+
+        case ACTION_CPU_TOP:
+
+            CpuTop();
+            return;  // Return so that we enter the event loop and get timer call-backs.
+
         default:
 
             LE_FATAL("Unimplemented action.");
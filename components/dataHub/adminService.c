@@ -9,8 +9,10 @@
 #include "dataHub.h"
 #include "ioService.h"
 #include "resource.h"
+#include "obsTemplate.h"
 #include "handler.h"
 #include "json.h"
+#include "adminService.h"
 
 typedef struct
 {
@@ -47,6 +49,33 @@ LE_MEM_DEFINE_STATIC_POOL(ResourceTreeChangeHandlerPool,
 //--------------------------------------------------------------------------------------------------
 static unsigned int PushHandlerCount;
 
+/// Default number of admin clients that can have an update open at once.  This may be overridden
+/// in the .cdef.
+#define DEFAULT_UPDATE_SESSION_POOL_SIZE 2
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Administrative update opened by an admin client.  The client's nested admin_StartUpdate() calls
+ * are counted here; the Data Hub sees one update per client, ended by the client's last
+ * admin_EndUpdate() or when the client disconnects.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Used to link into the UpdateSessionList.
+    le_msg_SessionRef_t sessionRef;     ///< Client session.
+    uint32_t depth;                     ///< Number of admin_StartUpdate() calls not yet ended.
+}
+UpdateSession_t;
+
+/// Pool of UpdateSession objects.
+static le_mem_PoolRef_t UpdateSessionPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(UpdateSessionPool, DEFAULT_UPDATE_SESSION_POOL_SIZE,
+                          sizeof(UpdateSession_t));
+
+/// Admin clients that have an update open.
+static le_dls_List_t UpdateSessionList = LE_DLS_LIST_INIT;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -59,7 +88,7 @@ static unsigned int PushHandlerCount;
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist. This will not cause a Placeholder resource to be
  *          created.
@@ -112,7 +141,7 @@ LE_SHARED le_result_t admin_PushTrigger
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist. This will not cause a Placeholder resource to be
  *          created.
@@ -167,7 +196,7 @@ LE_SHARED le_result_t admin_PushBoolean
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist. This will not cause a Placeholder resource to be
  *          created.
@@ -222,7 +251,7 @@ LE_SHARED le_result_t admin_PushNumeric
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist. This will not cause a Placeholder resource to be
  *          created.
@@ -278,7 +307,7 @@ LE_SHARED le_result_t admin_PushString
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit or JSON is invalid.
  *      - LE_NOT_FOUND If the path does not exist. This will not cause a Placeholder resource to be
  *          created.
@@ -591,9 +620,13 @@ void admin_RemoveJsonPushHandler
  *
  * Creates Placeholders for any resources that do not yet exist in the resource tree.
  *
+ * If the source path contains wildcard elements ("*"), the destination must be an existing
+ * Observation with as many wildcards in its path, which becomes a template (see obsTemplate.h).
+ *
  * @return
  *  - LE_OK if route already existed or new route was successfully created.
- *  - LE_BAD_PARAMETER if one of the paths is invalid.
+ *  - LE_BAD_PARAMETER if one of the paths is invalid, or a source pattern does not fit the
+ *    destination.
  *  - LE_DUPLICATE if the addition of this route would result in a loop.
  *  - LE_NO_MEMORY if there was a failure in memory allocation.
  */
@@ -611,6 +644,18 @@ LE_SHARED le_result_t admin_SetSource
     bool createdDestEntry;
     resTree_EntryRef_t srcEntry = NULL;
     resTree_EntryRef_t destEntry = resTree_FindEntry(resTree_GetRoot(), destPath);
+
+    if (obsTemplate_IsPattern(srcPath))
+    {
+        if (   (destEntry == NULL)
+            || (resTree_GetEntryType(destEntry) != ADMIN_ENTRY_TYPE_OBSERVATION))
+        {
+            LE_ERROR("Source pattern %s needs an Observation template, not %s", srcPath, destPath);
+            return LE_BAD_PARAMETER;
+        }
+        return obsTemplate_SetSource(destEntry, srcPath);
+    }
+
     if (destEntry)
     {
         createdDestEntry = false;
@@ -631,6 +676,7 @@ LE_SHARED le_result_t admin_SetSource
     // Set the source.
     if (ret == LE_OK)
     {
+        obsTemplate_RemoveSource(destEntry);
         ret = resTree_SetSource(destEntry, srcEntry);
     }
     if (ret != LE_OK)
@@ -655,6 +701,8 @@ LE_SHARED le_result_t admin_SetSource
  *       from other resources via that route. Inputs only accept values pushed by the app that
  *       created them or from the administrator pushed directly to them via admin_Push().
  *
+ * The source of an Observation template is its path pattern.
+ *
  * @return
  *  - LE_OK if successful.
  *  - LE_BAD_PARAMETER if the path is invalid.
@@ -681,6 +729,13 @@ le_result_t admin_GetSource
     }
     else
     {
+        const char* srcPattern = obsTemplate_GetSource(resEntry);
+
+        if (srcPattern != NULL)
+        {
+            return le_utf8_Copy(srcPath, srcPattern, srcPathSize, NULL);
+        }
+
         resTree_EntryRef_t srcEntry = resTree_GetSource(resEntry);
 
         if (srcEntry == NULL)
@@ -720,6 +775,7 @@ void admin_RemoveSource
 
     if ((destEntry != NULL) && resTree_IsResource(destEntry))
     {
+        obsTemplate_RemoveSource(destEntry);
         resTree_SetSource(destEntry, NULL);
     }
 }
@@ -2545,6 +2601,63 @@ void admin_CallResourceTreeChangeHandlers
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the update opened by an admin client.
+ *
+ * @return Pointer to the update, or NULL if the client has none open.
+ */
+//--------------------------------------------------------------------------------------------------
+static UpdateSession_t* FindUpdateSession
+(
+    le_msg_SessionRef_t sessionRef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&UpdateSessionList);
+
+    while (linkPtr != NULL)
+    {
+        UpdateSession_t* updatePtr = CONTAINER_OF(linkPtr, UpdateSession_t, link);
+
+        if (updatePtr->sessionRef == sessionRef)
+        {
+            return updatePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&UpdateSessionList, linkPtr);
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the update left open by an admin client that disconnected.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateSessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(contextPtr);
+
+    UpdateSession_t* updatePtr = FindUpdateSession(sessionRef);
+
+    if (updatePtr != NULL)
+    {
+        LE_WARN("Admin client disconnected during an administrative update. Ending it.");
+
+        le_dls_Remove(&UpdateSessionList, &updatePtr->link);
+        le_mem_Release(updatePtr);
+
+        adminService_EndUpdate();
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initializes the module.  Must be called before any other functions in the module are called.
@@ -2567,13 +2680,61 @@ void adminService_Init
 #endif
     ResourceTreeChangeHandlerPool = le_mem_InitStaticPool(ResourceTreeChangeHandlerPool,
         DEFAULT_RESOURCE_TREE_CHANGE_HANDLER_POOL_SIZE, sizeof(ResourceTreeChangeHandler_t));
+
+    UpdateSessionPool = le_mem_InitStaticPool(UpdateSessionPool, DEFAULT_UPDATE_SESSION_POOL_SIZE,
+                                              sizeof(UpdateSession_t));
+    le_msg_AddServiceCloseHandler(admin_GetServiceRef(), UpdateSessionCloseHandler, NULL);
+
+    adminService_InitList();
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an administrative update on behalf of the Data Hub itself (e.g., a config load) or of an
+ * admin client.  Updates nest: each must be ended with adminService_EndUpdate().
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_StartUpdate
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_INFO("Data Hub administrative updates starting.");
+
+    ioService_StartUpdate();
+
+    res_StartUpdate();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End an administrative update started with adminService_StartUpdate().
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_EndUpdate
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_INFO("Data Hub administrative updates complete.");
+
+    ioService_EndUpdate();
+
+    res_EndUpdate();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Signal to the Data Hub that administrative changes are about to be performed.
  *
  * This will result in call-backs to any handlers registered using io_AddUpdateStartEndHandler().
+ *
+ * Calls from a client nest, and only end the client's own update: one made by another client, or
+ * by the Data Hub while it loads a config, goes on until it is ended too.
  */
 //--------------------------------------------------------------------------------------------------
 void admin_StartUpdate
@@ -2582,11 +2743,28 @@ void admin_StartUpdate
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LE_INFO("Data Hub administrative updates starting.");
+    le_msg_SessionRef_t sessionRef = admin_GetClientSessionRef();
+    UpdateSession_t* updatePtr = FindUpdateSession(sessionRef);
 
-    ioService_StartUpdate();
+    if (updatePtr == NULL)
+    {
+        updatePtr = hub_MemAlloc(UpdateSessionPool);
+        if (updatePtr == NULL)
+        {
+            LE_ERROR("Too many admin clients updating at once. Update not started.");
+            return;
+        }
 
-    res_StartUpdate();
+        updatePtr->link = LE_DLS_LINK_INIT;
+        updatePtr->sessionRef = sessionRef;
+        updatePtr->depth = 0;
+        le_dls_Queue(&UpdateSessionList, &updatePtr->link);
+    }
+
+    if (updatePtr->depth++ == 0)
+    {
+        adminService_StartUpdate();
+    }
 }
 
 
@@ -2608,11 +2786,21 @@ void admin_EndUpdate
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LE_INFO("Data Hub administrative updates complete.");
+    UpdateSession_t* updatePtr = FindUpdateSession(admin_GetClientSessionRef());
 
-    ioService_EndUpdate();
+    if (updatePtr == NULL)
+    {
+        LE_WARN("admin_EndUpdate() without admin_StartUpdate() from this client. Ignored.");
+        return;
+    }
 
-    res_EndUpdate();
+    if (--updatePtr->depth == 0)
+    {
+        le_dls_Remove(&UpdateSessionList, &updatePtr->link);
+        le_mem_Release(updatePtr);
+
+        adminService_EndUpdate();
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
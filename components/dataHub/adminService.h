@@ -34,4 +34,35 @@ void admin_CallResourceTreeChangeHandlers
     admin_ResourceOperationType_t resourceOperationType
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start an administrative update on behalf of the Data Hub itself (e.g., a config load) or of an
+ * admin client.  Updates nest: each must be ended with adminService_EndUpdate().
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_StartUpdate
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End an administrative update started with adminService_StartUpdate().
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_EndUpdate
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the listings of branches of the resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_InitList
+(
+    void
+);
+
 #endif // ADMIN_SERVICE_H_INCLUDE_GUARD
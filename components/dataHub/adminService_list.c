@@ -0,0 +1,637 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file adminService_list.c
+ *
+ * Listing of branches of the resource tree for the Admin API (see admin_ListSubtree()).
+ *
+ * A listing walks the branch depth first, holding a reference on the entry it is at, and writes
+ * the records to the client's file descriptor as fast as it accepts them.  When the file
+ * descriptor is full, the listing waits for it to become writeable again, so other clients are
+ * served in the meantime.  Entries are never freed while they are referenced, nor removed from
+ * their parent's list of children, so the walk can continue from where it stopped even if the
+ * tree changed in the meantime.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "dataSample.h"
+#include "resTree.h"
+#include "obsTemplate.h"
+#include "adminService.h"
+
+/// Default number of listings in progress at once.  This can be overridden in the .cdef.
+#define DEFAULT_LIST_OPERATION_POOL_SIZE    1
+
+/// Room left in front of a field for its length prefix (e.g., "50002:").
+#define FIELD_PREFIX_BYTES  8
+
+/// Size of the write buffer, which must hold at least the largest field (a string value, in
+/// quotes) and its length prefix.  Smaller fields are gathered into it, to be written together.
+#define LIST_BUFF_BYTES     (FIELD_PREFIX_BYTES + HUB_MAX_STRING_BYTES + 2)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fields of a record, in the order they are written (see @ref c_dataHubAdmin_Discovery).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    FIELD_DEPTH,
+    FIELD_ENTRY_TYPE,
+    FIELD_NAME,
+    FIELD_LAST_NAMESPACE = FIELD_NAME,      ///< Last field of a Namespace's record.
+    FIELD_DATA_TYPE,
+    FIELD_UNITS,
+    FIELD_MANDATORY,
+    FIELD_TIMESTAMP,
+    FIELD_VALUE,
+    FIELD_JSON_EXAMPLE,
+    FIELD_SOURCE,
+    FIELD_OVERRIDE_TYPE,
+    FIELD_OVERRIDE,
+    FIELD_DEFAULT_TYPE,
+    FIELD_DEFAULT,
+    FIELD_LAST_RESOURCE = FIELD_DEFAULT,    ///< Last field of a resource's record.
+    FIELD_JSON_EXTRACTION,
+    FIELD_MIN_PERIOD,
+    FIELD_LOW_LIMIT,
+    FIELD_HIGH_LIMIT,
+    FIELD_CHANGE_BY,
+    FIELD_TRANSFORM,
+    FIELD_BUFFER_MAX_COUNT,
+    FIELD_BACKUP_PERIOD,
+    FIELD_LAST_OBSERVATION = FIELD_BACKUP_PERIOD, ///< Last field of an Observation's record.
+}
+Field_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A listing in progress.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_fdMonitor_Ref_t fdMonitor;       ///< Used to get notified when the fd is clear to write.
+    int fd;                             ///< fd to write to.
+    resTree_EntryRef_t rootRef;         ///< Entry being listed (referenced).
+    resTree_EntryRef_t entryRef;        ///< Entry whose record is being written (referenced), or
+                                        ///< NULL once all the records have been written.
+    uint32_t depth;                     ///< Depth of entryRef below rootRef.
+    Field_t nextField;                  ///< Next field of entryRef's record to write.
+    admin_ListCompletionFunc_t handlerPtr; ///< Completion callback.
+    void* contextPtr;                   ///< Value to be passed to completion callback.
+    size_t writeLen;                    ///< Number of bytes in the writeBuffer.
+    size_t writeOffset;                 ///< Offset into the writeBuffer to write from next.
+    char writeBuffer[LIST_BUFF_BYTES];  ///< Records waiting to be written.
+}
+ListOperation_t;
+
+/// Pool of listings.
+static le_mem_PoolRef_t ListOperationPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ListOperationPool,
+                          DEFAULT_LIST_OPERATION_POOL_SIZE,
+                          sizeof(ListOperation_t));
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip over entries that have been deleted, but are kept around to be reported in snapshots.
+ *
+ * @return The first live entry from entryRef on, or NULL if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t SkipDeleted
+(
+    resTree_EntryRef_t entryRef
+)
+{
+    while ((entryRef != NULL) && resTree_IsDeleted(entryRef))
+    {
+        entryRef = resTree_GetNextSiblingEx(entryRef, true);
+    }
+
+    return entryRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move a listing on to the next entry in the branch (depth first, parents before children).
+ */
+//--------------------------------------------------------------------------------------------------
+static void NextEntry
+(
+    ListOperation_t* opPtr
+)
+{
+    resTree_EntryRef_t entryRef = opPtr->entryRef;
+    resTree_EntryRef_t nextRef = SkipDeleted(resTree_GetFirstChildEx(entryRef, true));
+
+    if (nextRef != NULL)
+    {
+        opPtr->depth++;
+    }
+    else
+    {
+        while ((entryRef != opPtr->rootRef) && (nextRef == NULL))
+        {
+            nextRef = SkipDeleted(resTree_GetNextSiblingEx(entryRef, true));
+
+            if (nextRef == NULL)
+            {
+                entryRef = resTree_GetParent(entryRef);
+                opPtr->depth--;
+            }
+        }
+    }
+
+    if (nextRef != NULL)
+    {
+        le_mem_AddRef(nextRef);
+    }
+    le_mem_Release(opPtr->entryRef);
+
+    opPtr->entryRef = nextRef;
+    opPtr->nextField = FIELD_DEPTH;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the last field of the record of an entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static Field_t GetLastField
+(
+    resTree_EntryRef_t entryRef
+)
+{
+    switch (resTree_GetEntryType(entryRef))
+    {
+        case ADMIN_ENTRY_TYPE_OBSERVATION:
+            return FIELD_LAST_OBSERVATION;
+
+        case ADMIN_ENTRY_TYPE_INPUT:
+        case ADMIN_ENTRY_TYPE_OUTPUT:
+        case ADMIN_ENTRY_TYPE_PLACEHOLDER:
+            return FIELD_LAST_RESOURCE;
+
+        default:
+            return FIELD_LAST_NAMESPACE;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format a number field.  NAN is "not set", so leaves the field empty.
+ *
+ * @return LE_OK if successful, LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatDouble
+(
+    char* buffPtr,
+    size_t buffSize,
+    double value
+)
+{
+    if (isnan(value))
+    {
+        buffPtr[0] = '\0';
+        return (buffSize > 0) ? LE_OK : LE_OVERFLOW;
+    }
+
+    return ((size_t)snprintf(buffPtr, buffSize, "%.17g", value) < buffSize) ? LE_OK : LE_OVERFLOW;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format a data sample field in JSON.  No sample leaves the field empty.
+ *
+ * @return LE_OK if successful, LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatSample
+(
+    char* buffPtr,
+    size_t buffSize,
+    dataSample_Ref_t sampleRef,     ///< Sample, or NULL.
+    io_DataType_t dataType
+)
+{
+    if (sampleRef == NULL)
+    {
+        buffPtr[0] = '\0';
+        return (buffSize > 0) ? LE_OK : LE_OVERFLOW;
+    }
+
+    return dataSample_ConvertToJson(sampleRef, dataType, buffPtr, buffSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Format a field of the record of an entry, as a null-terminated string.
+ *
+ * @return LE_OK if successful, LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatField
+(
+    char* buffPtr,
+    size_t buffSize,
+    resTree_EntryRef_t entryRef,
+    uint32_t depth,
+    Field_t field
+)
+{
+    int len = 0;
+
+    switch (field)
+    {
+        case FIELD_DEPTH:
+            len = snprintf(buffPtr, buffSize, "%" PRIu32, depth);
+            break;
+
+        case FIELD_ENTRY_TYPE:
+            len = snprintf(buffPtr, buffSize, "%d", (int)resTree_GetEntryType(entryRef));
+            break;
+
+        case FIELD_NAME:
+            return le_utf8_Copy(buffPtr, resTree_GetEntryName(entryRef), buffSize, NULL);
+
+        case FIELD_DATA_TYPE:
+            len = snprintf(buffPtr, buffSize, "%d", (int)resTree_GetDataType(entryRef));
+            break;
+
+        case FIELD_UNITS:
+            return le_utf8_Copy(buffPtr, resTree_GetUnits(entryRef), buffSize, NULL);
+
+        case FIELD_MANDATORY:
+            len = snprintf(buffPtr, buffSize, "%d", resTree_IsMandatory(entryRef) ? 1 : 0);
+            break;
+
+        case FIELD_TIMESTAMP:
+        {
+            dataSample_Ref_t sampleRef = resTree_GetCurrentValue(entryRef);
+            return FormatDouble(buffPtr,
+                                buffSize,
+                                (sampleRef != NULL) ? dataSample_GetTimestamp(sampleRef) : NAN);
+        }
+
+        case FIELD_VALUE:
+            return FormatSample(buffPtr,
+                                buffSize,
+                                resTree_GetCurrentValue(entryRef),
+                                resTree_GetDataType(entryRef));
+
+        case FIELD_JSON_EXAMPLE:
+            return FormatSample(buffPtr,
+                                buffSize,
+                                resTree_GetJsonExample(entryRef),
+                                IO_DATA_TYPE_JSON);
+
+        case FIELD_SOURCE:
+        {
+            const char* srcPattern = obsTemplate_GetSource(entryRef);
+            if (srcPattern != NULL)
+            {
+                return le_utf8_Copy(buffPtr, srcPattern, buffSize, NULL);
+            }
+
+            resTree_EntryRef_t srcRef = resTree_GetSource(entryRef);
+            if (srcRef == NULL)
+            {
+                buffPtr[0] = '\0';
+                return LE_OK;
+            }
+
+            ssize_t result = resTree_GetPath(buffPtr, buffSize, resTree_GetRoot(), srcRef);
+            return (result >= 0) ? LE_OK : (le_result_t)result;
+        }
+
+        case FIELD_OVERRIDE_TYPE:
+            if (resTree_HasOverride(entryRef))
+            {
+                len = snprintf(buffPtr, buffSize, "%d", (int)resTree_GetOverrideDataType(entryRef));
+            }
+            else
+            {
+                buffPtr[0] = '\0';
+            }
+            break;
+
+        case FIELD_OVERRIDE:
+            if (resTree_HasOverride(entryRef))
+            {
+                return FormatSample(buffPtr,
+                                    buffSize,
+                                    resTree_GetOverrideValue(entryRef),
+                                    resTree_GetOverrideDataType(entryRef));
+            }
+            return FormatSample(buffPtr, buffSize, NULL, IO_DATA_TYPE_TRIGGER);
+
+        case FIELD_DEFAULT_TYPE:
+            if (resTree_HasDefault(entryRef))
+            {
+                len = snprintf(buffPtr, buffSize, "%d", (int)resTree_GetDefaultDataType(entryRef));
+            }
+            else
+            {
+                buffPtr[0] = '\0';
+            }
+            break;
+
+        case FIELD_DEFAULT:
+            if (resTree_HasDefault(entryRef))
+            {
+                return FormatSample(buffPtr,
+                                    buffSize,
+                                    resTree_GetDefaultValue(entryRef),
+                                    resTree_GetDefaultDataType(entryRef));
+            }
+            return FormatSample(buffPtr, buffSize, NULL, IO_DATA_TYPE_TRIGGER);
+
+        case FIELD_JSON_EXTRACTION:
+            return le_utf8_Copy(buffPtr, resTree_GetJsonExtraction(entryRef), buffSize, NULL);
+
+        case FIELD_MIN_PERIOD:
+            return FormatDouble(buffPtr, buffSize, resTree_GetMinPeriod(entryRef));
+
+        case FIELD_LOW_LIMIT:
+            return FormatDouble(buffPtr, buffSize, resTree_GetLowLimit(entryRef));
+
+        case FIELD_HIGH_LIMIT:
+            return FormatDouble(buffPtr, buffSize, resTree_GetHighLimit(entryRef));
+
+        case FIELD_CHANGE_BY:
+            return FormatDouble(buffPtr, buffSize, resTree_GetChangeBy(entryRef));
+
+        case FIELD_TRANSFORM:
+            len = snprintf(buffPtr, buffSize, "%d", (int)resTree_GetTransform(entryRef));
+            break;
+
+        case FIELD_BUFFER_MAX_COUNT:
+            len = snprintf(buffPtr, buffSize, "%" PRIu32, resTree_GetBufferMaxCount(entryRef));
+            break;
+
+        case FIELD_BACKUP_PERIOD:
+            len = snprintf(buffPtr, buffSize, "%" PRIu32, resTree_GetBufferBackupPeriod(entryRef));
+            break;
+    }
+
+    return ((len >= 0) && ((size_t)len < buffSize)) ? LE_OK : LE_OVERFLOW;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add as many fields as fit to the write buffer, moving on from entry to entry as their records
+ * are completed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillBuffer
+(
+    ListOperation_t* opPtr
+)
+{
+    while (opPtr->entryRef != NULL)
+    {
+        char* fieldPtr = opPtr->writeBuffer + opPtr->writeLen + FIELD_PREFIX_BYTES;
+        size_t fieldRoom = LIST_BUFF_BYTES - opPtr->writeLen - FIELD_PREFIX_BYTES;
+        Field_t lastField = GetLastField(opPtr->entryRef);
+
+        // Leave room for the newline after the last field.
+        if ((opPtr->writeLen + FIELD_PREFIX_BYTES + 1 >= LIST_BUFF_BYTES)
+            || (FormatField(fieldPtr,
+                            fieldRoom - ((opPtr->nextField == lastField) ? 1 : 0),
+                            opPtr->entryRef,
+                            opPtr->depth,
+                            opPtr->nextField) != LE_OK))
+        {
+            // The write buffer holds at least the largest field, so this one will fit once the
+            // fields before it have been written.
+            LE_ASSERT(opPtr->writeLen > 0);
+            return;
+        }
+
+        // Move the field back against the fields before it, behind its length prefix.
+        size_t fieldLen = strlen(fieldPtr);
+        char prefix[FIELD_PREFIX_BYTES + 1];
+        size_t prefixLen = (size_t)snprintf(prefix, sizeof(prefix), "%zu:", fieldLen);
+
+        memmove(opPtr->writeBuffer + opPtr->writeLen + prefixLen, fieldPtr, fieldLen);
+        memcpy(opPtr->writeBuffer + opPtr->writeLen, prefix, prefixLen);
+        opPtr->writeLen += prefixLen + fieldLen;
+
+        if (opPtr->nextField == lastField)
+        {
+            opPtr->writeBuffer[opPtr->writeLen++] = '\n';
+            NextEntry(opPtr);
+        }
+        else
+        {
+            opPtr->nextField++;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Terminate a listing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndList
+(
+    ListOperation_t* opPtr,
+    le_result_t result
+)
+{
+    if (opPtr->entryRef != NULL)
+    {
+        le_mem_Release(opPtr->entryRef);
+    }
+    le_mem_Release(opPtr->rootRef);
+
+    le_fdMonitor_Delete(opPtr->fdMonitor);
+
+    close(opPtr->fd);
+
+    opPtr->handlerPtr(result, opPtr->contextPtr);
+
+    le_mem_Release(opPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Continue a listing, writing until the fd is full or the whole branch is written.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ContinueList
+(
+    ListOperation_t* opPtr
+)
+{
+    for (;;)
+    {
+        if (opPtr->writeOffset == opPtr->writeLen)
+        {
+            opPtr->writeOffset = 0;
+            opPtr->writeLen = 0;
+
+            FillBuffer(opPtr);
+
+            if (opPtr->writeLen == 0)
+            {
+                EndList(opPtr, LE_OK);
+                return;
+            }
+        }
+
+        ssize_t result;
+        do
+        {
+            result = write(opPtr->fd,
+                           opPtr->writeBuffer + opPtr->writeOffset,
+                           opPtr->writeLen - opPtr->writeOffset);
+        }
+        while ((result == -1) && (errno == EINTR));
+
+        if (result == -1)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                // Return and wait for this function to be called again by the FD Monitor.
+                return;
+            }
+
+            LE_ERROR("Error writing (%m).");
+            EndList(opPtr, LE_COMM_ERROR);
+            return;
+        }
+
+        opPtr->writeOffset += result;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler call-back for events on a listing's file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListFdEventHandler
+(
+    int fd,
+    short events
+)
+{
+    LE_UNUSED(fd);
+
+    ListOperation_t* opPtr = le_fdMonitor_GetContextPtr();
+
+    if ((events & POLLERR) || (events & POLLHUP) || (events & POLLRDHUP))
+    {
+        LE_ERROR("Error or hang-up on output stream.");
+        EndList(opPtr, LE_COMM_ERROR);
+    }
+    // Note: The only other reason for this function to be called is POLLOUT (writeable).
+    else
+    {
+        ContinueList(opPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the details of every entry in a branch of the resource tree to a file descriptor, in one
+ * pass through the tree.
+ *
+ * @return
+ *  - LE_OK if the listing started successfully.
+ *  - LE_NOT_FOUND if there's no entry at the given path.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_ListSubtree
+(
+    const char* path,
+        ///< [IN] Absolute path of the branch to list.
+    int outputFile,
+        ///< [IN] File descriptor to write the records to.
+    admin_ListCompletionFunc_t completionFuncPtr,
+        ///< [IN] Called when the listing finishes.
+    void* contextPtr
+        ///< [IN]
+)
+{
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(path);
+
+    if (entryRef == NULL)
+    {
+        close(outputFile);
+        return LE_NOT_FOUND;
+    }
+
+    // Set the fd non-blocking
+    if (0 != fcntl(outputFile, F_SETFL, O_NONBLOCK))
+    {
+        LE_ERROR("Failed to activate non-blocking mode (%m).");
+        close(outputFile);
+        completionFuncPtr(LE_COMM_ERROR, contextPtr);
+        return LE_OK;
+    }
+
+    ListOperation_t* opPtr = hub_MemAlloc(ListOperationPool);
+    if (opPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a listing");
+        close(outputFile);
+        completionFuncPtr(LE_NO_MEMORY, contextPtr);
+        return LE_OK;
+    }
+
+    // Hold the root and the current entry, so the walk never steps onto a freed entry.
+    le_mem_AddRef(entryRef);
+    le_mem_AddRef(entryRef);
+    opPtr->rootRef = entryRef;
+    opPtr->entryRef = entryRef;
+    opPtr->depth = 0;
+    opPtr->nextField = FIELD_DEPTH;
+    opPtr->fd = outputFile;
+    opPtr->handlerPtr = completionFuncPtr;
+    opPtr->contextPtr = contextPtr;
+    opPtr->writeLen = 0;
+    opPtr->writeOffset = 0;
+
+    opPtr->fdMonitor = le_fdMonitor_Create("List", outputFile, ListFdEventHandler, POLLOUT);
+    le_fdMonitor_SetContextPtr(opPtr->fdMonitor, opPtr);
+
+    ContinueList(opPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the listings.
+ */
+//--------------------------------------------------------------------------------------------------
+void adminService_InitList
+(
+    void
+)
+{
+    ListOperationPool = le_mem_InitStaticPool(ListOperationPool,
+                                              DEFAULT_LIST_OPERATION_POOL_SIZE,
+                                              sizeof(ListOperation_t));
+}
@@ -12,32 +12,106 @@
 #include "interfaces.h"
 #include "dataHub.h"
 #include "ioService.h"
+#include "adminService.h"
 
 #include "configService.h"
 #include "parser.h"
+#include "stats.h"
 
-#define CONFIG_DESTINATION_MAX_NUM  6
+/// Maximum number of staged observations and states applied in one event loop turn.
+#define CONFIG_APPLY_CHUNK_SIZE     32
+
+/// Default number of queued config load requests.  This can be overridden in the .cdef.
+#define DEFAULT_LOAD_REQUEST_POOL_SIZE  2
 
 //--------------------------------------------------------------------------------------------------
 /**
- * holds context pointer given to Load function.
+ * A config load request.  Requests are served one at a time, in the order config_Load() was
+ * called.
  */
 //--------------------------------------------------------------------------------------------------
-static void* ContextPtr;
+typedef struct LoadRequest
+{
+    le_sls_Link_t link;                             ///< Used to link into the LoadRequestList.
+    int fd;                                         ///< File descriptor holding the config.
+    configService_Encoding_t encoding;              ///< Encoding of the config.
+    config_LoadResultHandlerFunc_t resultCallback;  ///< Callback to call once load is done.
+    void* contextPtr;                               ///< Context pointer given to Load function.
+    parseError_t parseError;                        ///< Details of the failure, if any.
+    le_result_t stageResult;                        ///< Result of parsing and staging the config.
+    le_clk_Time_t startTime;                        ///< When the load started.
+    uint32_t turnCount;                             ///< Number of event loop turns used so far.
+    uint32_t maxStallMs;                            ///< Longest event loop turn used (ms).
+} LoadRequest_t;
+
+/// Pool of config load requests.
+static le_mem_PoolRef_t LoadRequestPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(LoadRequestPool, DEFAULT_LOAD_REQUEST_POOL_SIZE, sizeof(LoadRequest_t));
+
+/// Queue of config load requests.  The one at the head is the one being served.
+static le_sls_List_t LoadRequestList = LE_SLS_LIST_INIT;
+
+#if LE_CONFIG_LINUX
+/// Thread that parses and stages configs, so that reading a large file does not hold up the
+/// event loop that serves pushes.  Only the parse runs there: pushes, the apply and snapshots
+/// still share the main thread, which is the only one that touches the tree.
+static le_thread_Ref_t StagingThreadRef = NULL;
+
+/// The Data Hub's main thread, where staged configs are applied.
+static le_thread_Ref_t MainThreadRef = NULL;
+
+/// Serializes use of the parser between the staging thread and config_Estimate().
+static le_mutex_Ref_t ParseMutex = NULL;
+#endif
+
+
+/// Default number of destinations that can be interned: those of the push handlers, and those
+/// named by observations that no handler is registered for.  This can be overridden in the .cdef.
+#define DEFAULT_DESTINATION_POOL_SIZE   16
+
+/// Default number of destination push handlers.  This can be overridden in the .cdef.
+#define DEFAULT_DESTINATION_HANDLER_POOL_SIZE   6
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * An interned destination name.  There is one per distinct destination, shared (reference counted)
+ * by the observations configured with it and by the push handlers registered for it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct configService_Destination
+{
+    char destination[CONFIG_MAX_DESTINATION_NAME_BYTES];   ///< Destination string (map key).
+    le_dls_List_t handlerList;                             ///< Push handlers, oldest first.
+    configService_DestinationBatchRef_t batchRef;          ///< Batch, if batched (else NULL).
+} Destination_t;
 
-// Config Service Destination Callback structure
-typedef struct config_DestinationStructure
+//--------------------------------------------------------------------------------------------------
+/**
+ * A destination push handler registered by a client.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct DestinationHandler
 {
-    char destination[CONFIG_MAX_DESTINATION_NAME_BYTES];   ///< Destination string.
+    le_dls_Link_t link;                                    ///< Link in the handlerList.
+    Destination_t* destPtr;                                ///< Destination (holds a reference).
     config_DestinationPushHandlerFunc_t callbackPtr;       ///< handler provided by client.
     void* contextPtr;                                      ///< client context.
+} DestinationHandler_t;
 
-} config_DestinationStructure_t;
+/// Pool of interned destinations.
+static le_mem_PoolRef_t DestinationPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DestinationPool, DEFAULT_DESTINATION_POOL_SIZE, sizeof(Destination_t));
 
+/// Pool of destination push handlers.
+static le_mem_PoolRef_t DestinationHandlerPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DestinationHandlerPool, DEFAULT_DESTINATION_HANDLER_POOL_SIZE,
+                          sizeof(DestinationHandler_t));
 
-// Static Destination Record
-static config_DestinationStructure_t destinationRecord[CONFIG_DESTINATION_MAX_NUM];
+/// Interned destinations, keyed by destination name.  Sized for as many destinations as the
+/// DestinationPool holds, including when its size is overridden in the .cdef.
+static le_hashmap_Ref_t DestinationMap = NULL;
+LE_HASHMAP_DEFINE_STATIC(DestinationMap,
+                         LE_MEM_BLOCKS(DestinationPool, DEFAULT_DESTINATION_POOL_SIZE));
 
 
 //--------------------------------------------------------------------------------------------------
@@ -45,7 +119,8 @@ static config_DestinationStructure_t destinationRecord[CONFIG_DESTINATION_MAX_NU
  * Callback given to configService_TraverseDatahubResourceTree to be called whenever an observation
  * is found.
  * If an observation is created by a previous config file is absent in a new config file, it must
- * be deleted.
+ * be deleted. Observations that are kept have their relevance flag cleared, ready for the next
+ * config.
  *
  * @return none
  */
@@ -53,203 +128,353 @@ static config_DestinationStructure_t destinationRecord[CONFIG_DESTINATION_MAX_NU
 static void FoundObservation
 (
     resTree_EntryRef_t entryRef,      ///< [IN] observation entry
-    void* context                     ///< [IN] context pointer, holds considerRelevance.
+    void* context                     ///< [IN] context pointer, holds deleteIrrelevant.
 )
 {
-    bool considerRelevance = (bool) (int)(intptr_t) context;
+    bool deleteIrrelevant = (bool) (int)(intptr_t) context;
 
-    if (resTree_IsObservationConfig(entryRef))
+    // A config observation that this config did not visit is not part of it anymore.
+    if (deleteIrrelevant && resTree_IsObservationConfig(entryRef) && !resTree_IsRelevant(entryRef))
     {
-        // this entry is a config observation. It must be deleted if either of below conditions is
-        // true:
-        // 1. considerRelevance is false, meaning we're not considering the relevance of resources
-        // during clean up, essentially deleting all config observations.
-        // 2. This observations is not relevant.
-        if (!considerRelevance || !resTree_IsRelevant(entryRef))
-        {
-            resTree_DeleteObservation(entryRef);
-        }
+        resTree_DeleteObservation(entryRef);
+        return;
     }
+
+    // reset the relevance flag
+    resTree_SetRelevance(entryRef, false);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback given to configService_TraverseDatahubResourceTree to be called whenever an observation
- * is found.
- * This callback clears the relevance flag of an observation.
+ * Clean up the datahub tree after a config has been applied or rolled back.
+ *
+ * Clears the relevance flag of all observations.  If deleteIrrelevant is true, config observations
+ * that do not have the relevance flag are deleted.
+ *
+ * Only the /obs subtree is visited, in a single pass.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void ClearRelevanceFlag
+static void CleanupTree
 (
-    resTree_EntryRef_t entryRef,      ///< [IN] observation entry
-    void* context                     ///< [IN] context pointer
+    bool deleteIrrelevant    ///< [IN] whether or not to delete config observations that are not
+                             ///< relevant.
 )
 {
-    LE_UNUSED(context);
-    resTree_SetRelevance(entryRef, false);
+    //traverse the observations and delete config stuff
+    configService_traversalCallbacks_t callbacks = {};
+    callbacks.observationCb = FoundObservation;
+    configService_TraverseDatahubResourceTree(resTree_GetObsNamespace(), &callbacks,
+            (void*)(intptr_t)(int) deleteIrrelevant);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Clean up the datahub tree by deleting observations.
+ * Validate a config.
+ *
+ * The file is parsed only once; its contents are staged in memory for ApplyConfigChunk().
  *
- * If considerRelevance is true, only deletes config resources that do not have the relevance flag.
- * If considerRelevance is false, essentially deletes all config observations.
+ * @return
+ *      - LE_OK            If config was successfully validated.
+ *      - LE_FORMAT_ERROR  The configuration file has an unrecoverable format error.
+ *      - LE_BAD_PARAMETER There is invalid parameters in the configuration file.
+ *      - LE_IO_ERROR      Parser failed to read from file.
+ *      - LE_NO_MEMORY     The configuration could not be staged.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ValidateConfig
+(
+    int fd,                             ///< [IN] File descriptor holding the config.
+    configService_Encoding_t encoding,  ///< [IN] Encoding of the config.
+    parseError_t* parseErrorPtr         ///< [OUT] pointer to a parse error structure
+)
+{
+    // Validate the configuration
+    return configService_StageConfig(fd, encoding, parseErrorPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account for the time spent in the current event loop turn by a load request.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void CleanupTree
+static void RecordTurn
 (
-    bool considerRelevance   ///< [IN] whether or not to consider the relevance flag when
-                             ///< cleaning up the tree.
+    LoadRequest_t* requestPtr,      ///< [IN] Load request being served.
+    le_clk_Time_t turnStart         ///< [IN] When the current turn started.
 )
 {
-    //traverse entire datahub tree and delete config stuff
-    configService_traversalCallbacks_t callbacks = {};
-    callbacks.observationCb = FoundObservation;
-    configService_TraverseDatahubResourceTree(resTree_GetRoot(), &callbacks,
-            (void*)(intptr_t)(int) considerRelevance);
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), turnStart);
+    uint32_t elapsedMs = (uint32_t)(elapsed.sec * 1000 + elapsed.usec / 1000);
 
-    // reset the relevance flag
-    callbacks.observationCb = ClearRelevanceFlag;
-    configService_TraverseDatahubResourceTree(resTree_GetRoot(), &callbacks, NULL);
+    requestPtr->turnCount++;
+    if (elapsedMs > requestPtr->maxStallMs)
+    {
+        requestPtr->maxStallMs = elapsedMs;
+    }
 }
 
 
+static void DoLoad(void* requestPtr_, void* unused);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove all observations marked as config.
+ * Report the result of the load request at the head of the queue, then start the next one.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void RemoveAllConfigObservations
+static void FinishLoad
 (
+    LoadRequest_t* requestPtr,      ///< [IN] Load request being served.
+    le_result_t result              ///< [IN] Overall result of the load.
 )
 {
-    // CleanupTree removes all config observations that are not relevant. Giving false removes
-    // all config observations.
-    CleanupTree(false);
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), requestPtr->startTime);
+
+    LE_INFO("Config load took %" PRIu32 " ms over %" PRIu32 " event loop turns;"
+            " longest stall was %" PRIu32 " ms",
+            (uint32_t)(elapsed.sec * 1000 + elapsed.usec / 1000),
+            requestPtr->turnCount,
+            requestPtr->maxStallMs);
+
+    // Trigger LoadResultHandler callback
+    requestPtr->resultCallback(result,
+                               requestPtr->parseError.errorMsg,
+                               requestPtr->parseError.fileLoc,
+                               requestPtr->contextPtr);
+
+    LE_ASSERT(le_sls_Pop(&LoadRequestList) == &requestPtr->link);
+    le_mem_Release(requestPtr);
+
+    le_sls_Link_t* linkPtr = le_sls_Peek(&LoadRequestList);
+    if (linkPtr != NULL)
+    {
+        le_event_QueueFunction(DoLoad, CONTAINER_OF(linkPtr, LoadRequest_t, link), NULL);
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Validate a config.
+ * Apply the next chunk of the config staged by ValidateConfig().
  *
- * @return
- *      - LE_OK            If config was successfully validated.
- *      - LE_FORMAT_ERROR  The configuration file has an unrecoverable format error.
- *      - LE_BAD_PARAMETER There is invalid parameters in the configuration file.
- *      - LE_IO_ERROR      Parser failed to read from file.
+ * Re-queues itself until the whole config has been applied, so that other events get serviced in
+ * between chunks. The whole apply happens inside a single administrative update.
+ *
+ * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ValidateConfig
+static void ApplyConfigChunk
 (
-    int fd,                      ///< [IN] File descriptor holding the config.
-    parseError_t* parseErrorPtr  ///< [OUT] pointer to a parse error structure
+    void* requestPtr_,              ///< Load request being served.
+    void* unused                    ///< Not used.
 )
 {
-    // Validate the configuration
-    return configService_ParseConfig(fd, true, parseErrorPtr);
+    LE_UNUSED(unused);
+    LoadRequest_t* requestPtr = requestPtr_;
+    le_clk_Time_t turnStart = le_clk_GetRelativeTime();
+    uint64_t startTime = stats_StartOp();
+
+    // The samples of this chunk's states all get the same time.
+    hub_RefreshClock();
+    le_result_t overallResult = configService_ApplyStagedConfig(CONFIG_APPLY_CHUNK_SIZE,
+                                                                &requestPtr->parseError);
+    hub_ReleaseClock();
+    if (overallResult == LE_IN_PROGRESS)
+    {
+        RecordTurn(requestPtr, turnStart);
+        le_event_QueueFunction(ApplyConfigChunk, requestPtr, NULL);
+        stats_EndOp("config apply", NULL, startTime);
+        return;
+    }
+
+    if (overallResult != LE_OK)
+    {
+        LE_ERROR("Applying Config failed at file location: %" PRIuS,
+                 requestPtr->parseError.fileLoc);
+        LE_ERROR("Error message: %s", requestPtr->parseError.errorMsg);
+        // Put back the config that was in place before this load, buffers and all.
+        configService_RollbackStagedConfig();
+        CleanupTree(false);
+        // Failure in apply is always reported as LE_FAULT because that is the error code that the
+        // client recognizes for failure in this phase.
+        overallResult = LE_FAULT;
+    }
+    else
+    {
+        configService_CommitStagedConfig();
+        // Remove old config observations that were not applied in the configuration file
+        CleanupTree(true);
+        LE_INFO("Config successfully Applied");
+    }
+
+    configService_ReleaseStagedConfig();
+
+    adminService_EndUpdate();
+
+    RecordTurn(requestPtr, turnStart);
+    FinishLoad(requestPtr, overallResult);
+    stats_EndOp("config apply", NULL, startTime);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Apply a config.
+ * Carry on with a load request once its config has been parsed and staged: start applying it, or
+ * report why it could not be staged.
  *
- * @return
- *      - LE_OK     If config was successfully applied.
- *      - LE_FAULT  error while applying configuration
+ * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ApplyConfig
+static void ConfigStaged
 (
-    int fd,                      ///< [IN] File descriptor holding the config.
-    parseError_t* parseErrorPtr  ///< [OUT] pointer to a parse error structure
+    void* requestPtr_,              ///< Load request being served.
+    void* unused                    ///< Not used.
 )
 {
-    // Apply the configuration
-    le_result_t overallResult =
-        configService_ParseConfig(
-            fd,
-            false,
-            parseErrorPtr);
+    LE_UNUSED(unused);
+    LoadRequest_t* requestPtr = requestPtr_;
+
+    // The file is not read again once its config is staged.
+    close(requestPtr->fd);
+    requestPtr->fd = -1;
+
+    if (requestPtr->stageResult != LE_OK)
+    {
+        LE_ERROR("Config Validation failed! at file location: %" PRIuS,
+                 requestPtr->parseError.fileLoc);
+        LE_ERROR("Error message: %s", requestPtr->parseError.errorMsg);
+
+        FinishLoad(requestPtr, requestPtr->stageResult);
+        return;
+    }
 
-    // Remove old config observations that were not applied in the configuration file
-    CleanupTree(true);
+    LE_INFO("Config is Valid, Moving on to Apply step");
 
-    return overallResult;
+    // Apply Configuration file, a chunk at a time.
+    adminService_StartUpdate();
+    le_event_QueueFunction(ApplyConfigChunk, requestPtr, NULL);
 }
 
+
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse and stage the config of a load request.  Runs on the staging thread, then hands the
+ * request back to the main thread.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void StageConfig
+(
+    void* requestPtr_,              ///< Load request being served.
+    void* unused                    ///< Not used.
+)
+{
+    LE_UNUSED(unused);
+    LoadRequest_t* requestPtr = requestPtr_;
+
+    le_mutex_Lock(ParseMutex);
+    requestPtr->stageResult = ValidateConfig(requestPtr->fd, requestPtr->encoding,
+                                             &requestPtr->parseError);
+    le_mutex_Unlock(ParseMutex);
+
+    le_event_QueueFunctionToThread(MainThreadRef, ConfigStaged, requestPtr, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the staging thread.
+ *
+ * @return never returns
+ */
+//--------------------------------------------------------------------------------------------------
+static void* StagingThreadMain
+(
+    void* unused                    ///< Not used.
+)
+{
+    LE_UNUSED(unused);
+
+    le_event_RunLoop();
+    return NULL;
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Load a config file.
  *
+ * On Linux, the file is parsed on the staging thread, so only the apply (a chunk per event loop
+ * turn) competes with pushes for the main thread.
+ *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
 static void DoLoad
 (
-    void* fd_,                      ///< File descriptor holding the config.
-    void* resultCallback_           ///< Callback function to call once load is done.
+    void* requestPtr_,              ///< Load request to serve.
+    void* unused                    ///< Not used.
 )
 {
-    int fd = (int)(intptr_t) fd_;
+    LE_UNUSED(unused);
+    LoadRequest_t* requestPtr = requestPtr_;
 
-    config_LoadResultHandlerFunc_t resultCallback =
-        (config_LoadResultHandlerFunc_t) resultCallback_;
+    requestPtr->startTime = le_clk_GetRelativeTime();
 
-    parseError_t parseError = {};
+#if LE_CONFIG_LINUX
+    le_event_QueueFunctionToThread(StagingThreadRef, StageConfig, requestPtr, NULL);
+#else
+    uint64_t startTime = stats_StartOp();
 
     // Validate Configuration file
-    le_result_t overallResult = ValidateConfig(fd, &parseError);
+    requestPtr->stageResult = ValidateConfig(requestPtr->fd, requestPtr->encoding,
+                                             &requestPtr->parseError);
 
-    if (overallResult != LE_OK)
-    {
-        LE_ERROR("Config Validation failed! at file location: %" PRIuS, parseError.fileLoc);
-        LE_ERROR("Error message: %s", parseError.errorMsg);
-
-        // Trigger LoadResultHandler callback
-        resultCallback(overallResult,
-                       parseError.errorMsg,
-                       parseError.fileLoc,
-                       ContextPtr);
-        return;
-    }
-
-    LE_INFO("Config is Valid, Moving on to Apply step");
-
-    lseek(fd, 0, SEEK_SET);
+    RecordTurn(requestPtr, requestPtr->startTime);
+    ConfigStaged(requestPtr, NULL);
+    stats_EndOp("config load", NULL, startTime);
+#endif
+}
 
-    // Apply Configuration file
-    overallResult = ApplyConfig(fd, &parseError);
 
-    if (overallResult != LE_OK)
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the encoding of a config file from its name in the config API.
+ *
+ * @return true if the encoding is supported, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetEncoding
+(
+    const char* encodedType,                ///< [IN] Encoding name ("json" or "cbor").
+    configService_Encoding_t* encodingPtr   ///< [OUT] Encoding.
+)
+{
+    if (strcmp(encodedType, "json") == 0)
     {
-        LE_ERROR("Applying Config failed at file location: %" PRIuS, parseError.fileLoc);
-        LE_ERROR("Error message: %s", parseError.errorMsg);
-        RemoveAllConfigObservations();
-        // Failure in apply is always reported as LE_FAULT because that is the error code that the
-        // client recognizes for failure in this phase.
-        overallResult = LE_FAULT;
+        *encodingPtr = CONFIG_SERVICE_ENCODING_JSON;
+    }
+    else if (strcmp(encodedType, "cbor") == 0)
+    {
+        *encodingPtr = CONFIG_SERVICE_ENCODING_CBOR;
     }
     else
     {
-        LE_INFO("Config successfully Applied");
+        return false;
     }
-
-    // Trigger LoadResultHandler callback
-    resultCallback(overallResult,
-                   parseError.errorMsg,
-                   parseError.fileLoc,
-                   ContextPtr);
+    return true;
 }
 
 
@@ -258,10 +483,13 @@ static void DoLoad
  * Function that causes the Datahub to load a configuration from a file.
  * Any existing configuration will be removed and replaced with the incoming one.
  *
+ * If another load is still in progress, this one starts once that one has completed.
+ *
  * @return
  *  - LE_OK           : Configuration successfully loaded
  *  - LE_NOT_FOUND    : Unable to locate or retrieve configuration file
  *  - LE_UNSUPPORTED  : Configuration encoding format is not supported.
+ *  - LE_NO_MEMORY    : Too many loads are pending.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t config_Load
@@ -273,29 +501,249 @@ le_result_t config_Load
 )
 {
     LE_INFO("Loading Config, file path is %s" , filePath);
-    int fd = -1;
-    if (strcmp(encodedType, "json") == 0)
+    configService_Encoding_t encoding;
+    if (!GetEncoding(encodedType, &encoding))
     {
-        // open the file now so you don't have to copy the file path.
-        fd = open(filePath, O_RDONLY);
-        if (fd < 0)
-        {
-            return LE_NOT_FOUND;
-        }
+        return LE_UNSUPPORTED;
     }
-    else
+
+    // open the file now so you don't have to copy the file path.
+    int fd = open(filePath, O_RDONLY);
+    if (fd < 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    LoadRequest_t* requestPtr = hub_MemAlloc(LoadRequestPool);
+    if (requestPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate a config load request");
+        close(fd);
+        return LE_NO_MEMORY;
+    }
+    memset(requestPtr, 0, sizeof(*requestPtr));
+    requestPtr->link = LE_SLS_LINK_INIT;
+    requestPtr->fd = fd;
+    requestPtr->encoding = encoding;
+    requestPtr->resultCallback = callbackPtr;
+    requestPtr->contextPtr = contextPtr;
+
+    // Only kick off the load now if no other load is being served.
+    bool isIdle = le_sls_IsEmpty(&LoadRequestList);
+    le_sls_Queue(&LoadRequestList, &requestPtr->link);
+    if (isIdle)
+    {
+        le_event_QueueFunction(DoLoad, requestPtr, NULL);
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimate what loading a configuration file would cost, without applying anything.
+ *
+ * @return
+ *  - LE_OK           : The configuration is valid and the estimate has been filled in.
+ *  - LE_NOT_FOUND    : Unable to locate or retrieve configuration file.
+ *  - LE_UNSUPPORTED  : Configuration encoding format is not supported.
+ *  - LE_FORMAT_ERROR : Configuration is not valid due to a format error.
+ *  - LE_BAD_PARAMETER: A parameter in the configuration file is not valid.
+ *  - LE_IO_ERROR     : The configuration file could not be read.
+ *  - LE_BUSY         : A config being loaded is still being parsed; try again later.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t config_Estimate
+(
+    const char* LE_NONNULL filePath,    ///< [IN] Path of configuration file.
+    const char* LE_NONNULL encodedType, ///< [IN] Type of encoding used in the file
+    uint32_t* obsCountPtr,              ///< [OUT] Observations in the file.
+    uint32_t* newObsCountPtr,           ///< [OUT] Observations that would be created.
+    uint32_t* stateCountPtr,            ///< [OUT] State values in the file.
+    uint32_t* bufferEntryCountPtr,      ///< [OUT] Buffer entries of full buffers.
+    uint32_t* nonStringSampleCountPtr,  ///< [OUT] Non-string Data Samples.
+    uint32_t* stringSampleCountPtr,     ///< [OUT] String based Data Samples.
+    uint32_t* smallStringCountPtr,      ///< [OUT] Small string pool blocks.
+    uint32_t* medStringCountPtr,        ///< [OUT] Medium string pool blocks.
+    uint32_t* largeStringCountPtr,      ///< [OUT] Large string pool blocks.
+    double* backupBytesPerSecPtr        ///< [OUT] Buffer backup bytes written per second.
+)
+{
+    configService_Encoding_t encoding;
+    if (!GetEncoding(encodedType, &encoding))
     {
         return LE_UNSUPPORTED;
     }
 
-    ContextPtr = contextPtr;
+    int fd = open(filePath, O_RDONLY);
+    if (fd < 0)
+    {
+        return LE_NOT_FOUND;
+    }
 
-    le_event_QueueFunction(DoLoad, (void*)(intptr_t)fd, (void*)callbackPtr);
+#if LE_CONFIG_LINUX
+    // Rather than waiting on the main thread for the staging thread to finish a parse, let the
+    // client try again.
+    if (le_mutex_TryLock(ParseMutex) != LE_OK)
+    {
+        close(fd);
+        return LE_BUSY;
+    }
+#endif
+
+    // The parse is synchronous and leaves the staged config alone, so this is safe to do while a
+    // load is being applied.
+    configService_Estimate_t estimate;
+    parseError_t parseError = {};
+    le_result_t result = configService_EstimateConfig(fd, encoding, &estimate, &parseError);
+    close(fd);
+
+#if LE_CONFIG_LINUX
+    le_mutex_Unlock(ParseMutex);
+#endif
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Config estimate failed at file location %" PRIuS ": %s",
+                 parseError.fileLoc,
+                 parseError.errorMsg);
+        return result;
+    }
+
+    *obsCountPtr = estimate.obsCount;
+    *newObsCountPtr = estimate.newObsCount;
+    *stateCountPtr = estimate.stateCount;
+    *bufferEntryCountPtr = estimate.bufferEntryCount;
+    *nonStringSampleCountPtr = estimate.nonStringSampleCount;
+    *stringSampleCountPtr = estimate.stringSampleCount;
+    *smallStringCountPtr = estimate.smallStringCount;
+    *medStringCountPtr = estimate.medStringCount;
+    *largeStringCountPtr = estimate.largeStringCount;
+    *backupBytesPerSecPtr = estimate.backupBytesPerSec;
 
     return LE_OK;
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor for interned destinations.  Drops the destination from the map once neither an
+ * observation nor a push handler refers to it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DestinationDestructor
+(
+    void* objectPtr
+)
+{
+    Destination_t* destPtr = objectPtr;
+
+    le_hashmap_Remove(DestinationMap, destPtr->destination);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the interned record for a destination name, creating it if needed.
+ *
+ * Names longer than CONFIG_MAX_DESTINATION_NAME_LEN are truncated.
+ *
+ * @return
+ *      Reference to the destination (the caller must release it with
+ *      configService_ReleaseDestination()), or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+configService_DestinationRef_t configService_GetDestination
+(
+    const char* destination     ///< [IN] Destination name.
+)
+{
+    char key[CONFIG_MAX_DESTINATION_NAME_BYTES];
+    le_utf8_Copy(key, destination, sizeof(key), NULL);
+
+    Destination_t* destPtr = le_hashmap_Get(DestinationMap, key);
+    if (destPtr != NULL)
+    {
+        le_mem_AddRef(destPtr);
+        return destPtr;
+    }
+
+    destPtr = hub_MemAlloc(DestinationPool);
+    if (destPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate destination [%s]", key);
+        return NULL;
+    }
+
+    LE_ASSERT(le_utf8_Copy(destPtr->destination, key, sizeof(destPtr->destination), NULL) == LE_OK);
+    destPtr->handlerList = LE_DLS_LIST_INIT;
+    destPtr->batchRef = NULL;
+    le_hashmap_Put(DestinationMap, destPtr->destination, destPtr);
+
+    return destPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a reference obtained from configService_GetDestination().
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_ReleaseDestination
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+)
+{
+    le_mem_Release(destRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a destination.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* configService_GetDestinationName
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+)
+{
+    return destRef->destination;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the batch of a destination.
+ *
+ * @return The batch, or NULL if the destination is not batched.
+ */
+//--------------------------------------------------------------------------------------------------
+configService_DestinationBatchRef_t configService_GetDestinationBatch
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+)
+{
+    return destRef->batchRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set (or clear, with NULL) the batch of a destination.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_SetDestinationBatch
+(
+    configService_DestinationRef_t destRef,         ///< [IN] Destination reference.
+    configService_DestinationBatchRef_t batchRef    ///< [IN] Batch, or NULL.
+)
+{
+    destRef->batchRef = batchRef;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add handler function for EVENT 'config_DestinationPush'
@@ -308,20 +756,28 @@ config_DestinationPushHandlerRef_t config_AddDestinationPushHandler
     void* contextPtr                                   ///< [IN]
 )
 {
-    // Traverse destination array looking for free entry
-    for (int i = 0; i < CONFIG_DESTINATION_MAX_NUM; i++)
+    DestinationHandler_t* handlerPtr = hub_MemAlloc(DestinationHandlerPool);
+    if (handlerPtr == NULL)
     {
-        if (destinationRecord[i].callbackPtr == NULL)
-        {
-            strncpy(destinationRecord[i].destination, destination, CONFIG_MAX_DESTINATION_NAME_LEN);
-            destinationRecord[i].callbackPtr = callbackPtr;
-            destinationRecord[i].contextPtr = contextPtr;
+        return NULL;
+    }
 
-            return (config_DestinationPushHandlerRef_t)(&destinationRecord[i]);
-        }
+    handlerPtr->destPtr = configService_GetDestination(destination);
+    if (handlerPtr->destPtr == NULL)
+    {
+        le_mem_Release(handlerPtr);
+        return NULL;
     }
 
-    return NULL;
+    handlerPtr->link = LE_DLS_LINK_INIT;
+    handlerPtr->callbackPtr = callbackPtr;
+    handlerPtr->contextPtr = contextPtr;
+
+    // Only the oldest handler of a destination is called, as it was when handlers were kept in
+    // a fixed array.
+    le_dls_Queue(&handlerPtr->destPtr->handlerList, &handlerPtr->link);
+
+    return (config_DestinationPushHandlerRef_t)handlerPtr;
 }
 
 
@@ -336,29 +792,28 @@ void config_RemoveDestinationPushHandler
         ///< [IN]
 )
 {
-    // Look-up AT Command Register entry using handlerRef
-    config_DestinationStructure_t* destinationRecordPtr =
-        (config_DestinationStructure_t*)handlerRef;
+    DestinationHandler_t* handlerPtr = (DestinationHandler_t*)handlerRef;
 
-    memset(destinationRecordPtr->destination, 0, CONFIG_MAX_DESTINATION_NAME_BYTES);
-    destinationRecordPtr->callbackPtr = NULL;
-    destinationRecordPtr->contextPtr = NULL;
+    le_dls_Remove(&handlerPtr->destPtr->handlerList, &handlerPtr->link);
+    configService_ReleaseDestination(handlerPtr->destPtr);
+    le_mem_Release(handlerPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Trigger destination push handler for the specified destination name, if registered
+ * Trigger destination push handler for the specified destination, if registered.  If the
+ * destination is batched, the sample is appended to its batch instead.
  *
  * @return
  *      - LE_OK                Function succeeded.
  *      - LE_BAD_PARAMETER     Invalid destination record variable.
- *      - LE_NOT_FOUND         Unable to find matching destination name
+ *      - LE_NOT_FOUND         No push handler is registered for this destination.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t configService_TriggerDestinationPushHandler
 (
-    const char* destination,     ///< [IN] Destination path of resource
+    configService_DestinationRef_t destRef,     ///< [IN] Destination of the observation
     const char* obsName,         ///< [IN] Observation Name
     const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
     io_DataType_t dataType,      ///< [IN] Data type of the data sample
@@ -367,7 +822,7 @@ le_result_t configService_TriggerDestinationPushHandler
 {
     LE_DEBUG("[%s] destination [%s], obsName [%s]",
              __FUNCTION__,
-             destination,
+             destRef->destination,
              obsName);
 
     LE_DEBUG("[%s] srcPath [%s], dataType [%d]",
@@ -375,83 +830,128 @@ le_result_t configService_TriggerDestinationPushHandler
              srcPath,
              dataType);
 
-    // Traverse destination array searching for matching destination name
-    for (int i = 0; i < CONFIG_DESTINATION_MAX_NUM; i++)
+    if ((destRef->batchRef != NULL) &&
+        (configService_AppendToBatch(destRef->batchRef, obsName, srcPath, dataType, dataSample)
+         == LE_OK))
     {
-        if (strncmp(destinationRecord[i].destination, destination,
-                    sizeof(destinationRecord[i].destination)) == 0)
+        return LE_OK;
+    }
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&destRef->handlerList);
+    if (linkPtr == NULL)
+    {
+        LE_ERROR("[%s] Unable to find matching push handler, destination [%s]",
+                 __FUNCTION__,
+                 destRef->destination);
+
+        return LE_NOT_FOUND;
+    }
+
+    DestinationHandler_t* handlerPtr = CONTAINER_OF(linkPtr, DestinationHandler_t, link);
+
+    bool valueBool = false;
+    double valueNumeric = 0.0;
+    const char* valueString = "";
+
+    if (handlerPtr->callbackPtr == NULL)
+    {
+        LE_ERROR("Destination PushHandler callback is NULL!");
+        return LE_BAD_PARAMETER;
+    }
+
+    double timestamp = dataSample_GetTimestamp(dataSample);
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+        {
+            break;
+        }
+
+        case IO_DATA_TYPE_BOOLEAN:
+        {
+            // Set the valueBool
+            valueBool = dataSample_GetBoolean(dataSample);
+            break;
+        }
+
+        case IO_DATA_TYPE_NUMERIC:
         {
-            bool valueBool = false;
-            double valueNumeric = 0.0;
-            const char* valueString = "";
-
-            if (destinationRecord[i].callbackPtr == NULL)
-            {
-                LE_ERROR("Destination PushHandler callback is NULL!");
-                return LE_BAD_PARAMETER;
-            }
-
-            double timestamp = dataSample_GetTimestamp(dataSample);
-
-            switch (dataType)
-            {
-                case IO_DATA_TYPE_TRIGGER:
-                {
-                    break;
-                }
-
-                case IO_DATA_TYPE_BOOLEAN:
-                {
-                    // Set the valueBool
-                    valueBool = dataSample_GetBoolean(dataSample);
-                    break;
-                }
-
-                case IO_DATA_TYPE_NUMERIC:
-                {
-                    // Set the valueNumeric
-                    valueNumeric = dataSample_GetNumeric(dataSample);
-                    break;
-                }
-
-                case IO_DATA_TYPE_STRING:
-                {
-                    // Set the valueString
-                    valueString = dataSample_GetString(dataSample);
-                    break;
-                }
-
-                case IO_DATA_TYPE_JSON:
-                {
-                    // Set the valueString using the JSON string
-                    valueString = dataSample_GetJson(dataSample);
-                    break;
-                }
-            }
-
-            LE_DEBUG("[%s] Calling push handler, destination [%s]",
-                     __FUNCTION__,
-                     destinationRecord[i].destination);
-
-            // Trigger the Destination PushHandler callback registered
-            // for this destination name
-            destinationRecord[i].callbackPtr(
-                timestamp,
-                obsName,
-                srcPath,
-                dataType,
-                valueBool,
-                valueNumeric,
-                valueString,
-                destinationRecord[i].contextPtr);
-
-            return LE_OK;
+            // Set the valueNumeric
+            valueNumeric = dataSample_GetNumeric(dataSample);
+            break;
+        }
+
+        case IO_DATA_TYPE_STRING:
+        {
+            // Set the valueString
+            valueString = dataSample_GetString(dataSample);
+            break;
+        }
+
+        case IO_DATA_TYPE_JSON:
+        {
+            // Set the valueString using the JSON string
+            valueString = dataSample_GetJson(dataSample);
+            break;
         }
     }
 
-    LE_ERROR("[%s] Unable to find matching push handler, destination [%s]",
+    LE_DEBUG("[%s] Calling push handler, destination [%s]",
              __FUNCTION__,
-             destination);
+             destRef->destination);
+
+    // Trigger the Destination PushHandler callback registered
+    // for this destination name
+    handlerPtr->callbackPtr(
+        timestamp,
+        obsName,
+        srcPath,
+        dataType,
+        valueBool,
+        valueNumeric,
+        valueString,
+        handlerPtr->contextPtr);
+
+    return LE_OK;
+}
+
 
-    return LE_NOT_FOUND;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the Config Service.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_Init
+(
+    void
+)
+{
+    LoadRequestPool = le_mem_InitStaticPool(LoadRequestPool, DEFAULT_LOAD_REQUEST_POOL_SIZE,
+                        sizeof(LoadRequest_t));
+
+    DestinationPool = le_mem_InitStaticPool(DestinationPool, DEFAULT_DESTINATION_POOL_SIZE,
+                                            sizeof(Destination_t));
+    le_mem_SetDestructor(DestinationPool, DestinationDestructor);
+
+    DestinationHandlerPool = le_mem_InitStaticPool(DestinationHandlerPool,
+                                                   DEFAULT_DESTINATION_HANDLER_POOL_SIZE,
+                                                   sizeof(DestinationHandler_t));
+
+    DestinationMap = le_hashmap_InitStatic(DestinationMap,
+                                           LE_MEM_BLOCKS(DestinationPool,
+                                                         DEFAULT_DESTINATION_POOL_SIZE),
+                                           le_hashmap_HashString, le_hashmap_EqualsString);
+
+    configService_InitParse();
+    configService_InitBatch();
+
+#if LE_CONFIG_LINUX
+    ParseMutex = le_mutex_CreateNonRecursive("ConfigParse");
+    MainThreadRef = le_thread_GetCurrent();
+    StagingThreadRef = le_thread_Create("ConfigStaging", StagingThreadMain, NULL);
+    le_thread_Start(StagingThreadRef);
+#endif
 }
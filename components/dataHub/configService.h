@@ -27,6 +27,35 @@ typedef struct ParseError
 } parseError_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Encodings a config file can use.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    CONFIG_SERVICE_ENCODING_JSON,   ///< JSON text.
+    CONFIG_SERVICE_ENCODING_CBOR    ///< CBOR (RFC 7049), with the same schema as JSON.
+} configService_Encoding_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Reference to an interned destination name.  Observations that push to the same destination
+ *  share one.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct configService_Destination* configService_DestinationRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Reference to the batch of a destination whose samples are delivered in batches.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct DestinationBatch* configService_DestinationBatchRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Callbacks for configService_TraverseDatahubResourceTree
@@ -85,37 +114,234 @@ void configService_TraverseDatahubResourceTree
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Parse a config file.
+ *  Parse and validate a config file in a single pass, staging its contents for
+ *  configService_ApplyStagedConfig().
+ *
+ *  @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER parsing failed because a parameter was invalid.
+ *      - LE_FORMAT_ERROR parsing failed because of a format error in file.
+ *      - LE_IO_ERROR parsing failed because cannot read the file.
+ *      - LE_NO_MEMORY parsing failed because the config could not be staged.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_StageConfig
+(
+    int fd,                                ///< [IN] File descriptor of the configuration file.
+    configService_Encoding_t encoding,     ///< [IN] Encoding of the configuration file.
+    parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory and storage a config would take once applied (see config_Estimate()).
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct configService_Estimate
+{
+    uint32_t obsCount;                  ///< Observations in the config.
+    uint32_t newObsCount;               ///< Observations that do not exist yet.
+    uint32_t stateCount;                ///< State values in the config.
+    uint32_t bufferEntryCount;          ///< Buffer entries of the full Observation buffers.
+    uint32_t nonStringSampleCount;      ///< Non-string Data Samples.
+    uint32_t stringSampleCount;         ///< String based Data Samples.
+    uint32_t smallStringCount;          ///< Small string pool blocks.
+    uint32_t medStringCount;            ///< Medium string pool blocks.
+    uint32_t largeStringCount;          ///< Large string pool blocks.
+    double backupBytesPerSec;           ///< Buffer backup bytes written per second.
+} configService_Estimate_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse and validate a config file and estimate what applying it would cost, without staging
+ *  or applying anything.
  *
  *  @return
  *      - LE_OK if successful.
  *      - LE_BAD_PARAMETER parsing failed because a parameter was invalid.
  *      - LE_FORMAT_ERROR parsing failed because of a format error in file.
  *      - LE_IO_ERROR parsing failed because cannot read the file.
- *      - LE_FAULT parsing failed in apply phase.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t configService_ParseConfig
+le_result_t configService_EstimateConfig
 (
     int fd,                                ///< [IN] File descriptor of the configuration file.
-    bool validateOnly,                     ///< [IN] Boolean to indicate if this is a validate or
-                                           /// apply operation.
+    configService_Encoding_t encoding,     ///< [IN] Encoding of the configuration file.
+    configService_Estimate_t* estimatePtr, ///< [OUT] Estimate.
+    parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Apply up to maxCount entries of the config staged by configService_StageConfig().
+ *
+ *  @return
+ *      - LE_OK if the whole config has been applied.
+ *      - LE_IN_PROGRESS if there are entries left to apply.
+ *      - LE_FAULT failed in apply phase.
+ *      - LE_NO_MEMORY if the changes could not be recorded, so that they can be rolled back.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_ApplyStagedConfig
+(
+    size_t maxCount,                       ///< [IN] Max number of entries to apply in this call.
     parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
 );
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Trigger the registered callback for the specified destination, if available
+ *  Commit the config applied by configService_ApplyStagedConfig().  Must be called before
+ *  configService_ReleaseStagedConfig().
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_CommitStagedConfig
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Undo what configService_ApplyStagedConfig() has applied, putting back the previous
+ *  configuration.  Must be called before configService_ReleaseStagedConfig().
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_RollbackStagedConfig
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Release the config staged by configService_StageConfig().
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_ReleaseStagedConfig
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Initialize the config parsing and staging module.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_InitParse
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Initialize the Config Service.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the interned record for a destination name, creating it if needed.
+ *
+ * Names longer than CONFIG_MAX_DESTINATION_NAME_LEN are truncated.
+ *
+ * @return
+ *      Reference to the destination (the caller must release it with
+ *      configService_ReleaseDestination()), or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+configService_DestinationRef_t configService_GetDestination
+(
+    const char* destination     ///< [IN] Destination name.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a reference obtained from configService_GetDestination().
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_ReleaseDestination
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a destination.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* configService_GetDestinationName
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the batch of a destination.
+ *
+ * @return The batch, or NULL if the destination is not batched.
+ */
+//--------------------------------------------------------------------------------------------------
+configService_DestinationBatchRef_t configService_GetDestinationBatch
+(
+    configService_DestinationRef_t destRef      ///< [IN] Destination reference.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set (or clear, with NULL) the batch of a destination.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_SetDestinationBatch
+(
+    configService_DestinationRef_t destRef,         ///< [IN] Destination reference.
+    configService_DestinationBatchRef_t batchRef    ///< [IN] Batch, or NULL.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a sample of an observation to the batch of its destination.
+ *
+ * @return
+ *      - LE_OK if the record was buffered (or dropped because the reader is too slow).
+ *      - LE_OVERFLOW if the record is larger than the batch buffer.  The caller should deliver it
+ *        through the push handler instead.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_AppendToBatch
+(
+    configService_DestinationBatchRef_t batchRef,   ///< [IN] Batched destination.
+    const char* obsName,         ///< [IN] Observation Name
+    const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
+    io_DataType_t dataType,      ///< [IN] Data type of the data sample
+    dataSample_Ref_t dataSample  ///< [IN] Data sample
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Initialize destination batching.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_InitBatch
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Trigger the registered callback for the specified destination, if available.  If the
+ * destination is batched, the sample is appended to its batch instead.
  *
  * @return
  *      - LE_OK                Function succeeded.
  *      - LE_BAD_PARAMETER     Invalid destination record variable.
- *      - LE_NOUT_FOUND        Unable to find matching destination name
+ *      - LE_NOT_FOUND         No push handler is registered for this destination.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t configService_TriggerDestinationPushHandler
 (
-    const char* destination,     ///< [IN] Destination path of resource
+    configService_DestinationRef_t destRef,     ///< [IN] Destination of the observation
     const char* obsName,         ///< [IN] Observation Name
     const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
     io_DataType_t dataType,      ///< [IN] Data type of the data sample
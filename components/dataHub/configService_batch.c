@@ -0,0 +1,565 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file configService_batch.c
+ *
+ * Batched delivery of config observation samples to external destinations.
+ *
+ * Instead of one DestinationPush event per sample, the samples of a batched destination are
+ * appended as binary records to a buffer, which is written to a pipe in one go once it holds
+ * enough data or once the oldest record has waited long enough.  See config_StartDestinationBatch()
+ * for the record layout.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "dataSample.h"
+
+#include "configService.h"
+
+/// Default number of batched destinations.  This can be overridden in the .cdef.
+#define DEFAULT_DESTINATION_BATCH_POOL_SIZE     1
+
+/// Size of the record buffer of a batched destination.
+#define DEFAULT_DESTINATION_BATCH_BUFFER_BYTES  8192
+
+/// Size of the fixed part of a record.
+#define BATCH_RECORD_HEADER_BYTES   20
+
+#if LE_CONFIG_RTOS
+/// Name of the FIFO used to carry the records, with the destination name appended.
+#define BATCH_FIFO_PREFIX   "/tmp/datahub_batch_"
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A batched destination.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct DestinationBatch
+{
+    configService_DestinationRef_t destRef;     ///< Destination (holds a reference).
+    int fd;                                     ///< Write end of the batch stream.
+    le_fdMonitor_Ref_t monitor;                 ///< FD monitor for the batch stream.
+    le_timer_Ref_t timer;                       ///< Flushes the records after maxDelayMs.
+    uint32_t maxDelayMs;                        ///< Longest time a record waits (0 = one turn).
+    bool flushQueued;                           ///< A flush is queued for the next loop turn.
+    size_t flushBytes;                          ///< Flush as soon as this many bytes are buffered.
+    uint32_t droppedCount;                      ///< Records dropped since the last report.
+    size_t next;                                ///< Offset of the first byte not yet written.
+    size_t available;                           ///< Number of bytes not yet written.
+    uint8_t buffer[DEFAULT_DESTINATION_BATCH_BUFFER_BYTES]; ///< Records.
+} DestinationBatch_t;
+
+/// Pool of batched destinations.
+static le_mem_PoolRef_t DestinationBatchPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DestinationBatchPool, DEFAULT_DESTINATION_BATCH_POOL_SIZE,
+                          sizeof(DestinationBatch_t));
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop batching a destination, closing the batch stream.  Records still buffered are discarded.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndBatch
+(
+    DestinationBatch_t* batchPtr    ///< [IN] Batched destination.
+)
+{
+    configService_SetDestinationBatch(batchPtr->destRef, NULL);
+
+    le_fdMonitor_Delete(batchPtr->monitor);
+    le_timer_Delete(batchPtr->timer);
+    le_fd_Close(batchPtr->fd);
+
+    if (batchPtr->available > 0)
+    {
+        LE_WARN("Discarding %" PRIuS " bytes of records for destination '%s'",
+                batchPtr->available,
+                configService_GetDestinationName(batchPtr->destRef));
+    }
+
+    configService_ReleaseDestination(batchPtr->destRef);
+
+    if (batchPtr->flushQueued)
+    {
+        // The queued flush will release the batch.
+        batchPtr->fd = -1;
+    }
+    else
+    {
+        le_mem_Release(batchPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write as much of the buffered records as the batch stream accepts.
+ *
+ * @return
+ *      - LE_OK if everything was written.
+ *      - LE_WOULD_BLOCK if data remains to be written once the stream is writable.
+ *      - LE_CLOSED if the stream is broken.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SendData
+(
+    DestinationBatch_t* batchPtr    ///< [IN] Batched destination.
+)
+{
+    while (batchPtr->available > 0)
+    {
+        ssize_t count = le_fd_Write(batchPtr->fd,
+                                    &batchPtr->buffer[batchPtr->next],
+                                    batchPtr->available);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN)
+            {
+                // Reader is behind, keep the data and wait for the stream to become writable.
+                le_fdMonitor_Enable(batchPtr->monitor, POLLOUT);
+                return LE_WOULD_BLOCK;
+            }
+
+            LE_ERROR("Failed to write batch for destination '%s' (errno: %d)",
+                     configService_GetDestinationName(batchPtr->destRef),
+                     errno);
+            return LE_CLOSED;
+        }
+
+        batchPtr->next += count;
+        batchPtr->available -= count;
+    }
+
+    batchPtr->next = 0;
+    le_fdMonitor_Disable(batchPtr->monitor, POLLOUT);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush the buffered records.  Ends the batch if the stream is broken.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Flush
+(
+    DestinationBatch_t* batchPtr    ///< [IN] Batched destination.
+)
+{
+    le_timer_Stop(batchPtr->timer);
+
+    le_result_t result = SendData(batchPtr);
+    if (result == LE_CLOSED)
+    {
+        EndBatch(batchPtr);
+    }
+    else if ((result == LE_OK) && (batchPtr->droppedCount > 0))
+    {
+        LE_WARN("Dropped %" PRIu32 " records for destination '%s', reader is too slow",
+                batchPtr->droppedCount,
+                configService_GetDestinationName(batchPtr->destRef));
+        batchPtr->droppedCount = 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush queued by configService_AppendToBatch() when no delay is allowed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueuedFlush
+(
+    void* param1Ptr,    ///< [IN] Batched destination.
+    void* param2Ptr     ///< [IN] Unused.
+)
+{
+    DestinationBatch_t* batchPtr = param1Ptr;
+    LE_UNUSED(param2Ptr);
+
+    batchPtr->flushQueued = false;
+
+    if (batchPtr->fd < 0)
+    {
+        // Batch was ended while the flush was queued.
+        le_mem_Release(batchPtr);
+        return;
+    }
+
+    Flush(batchPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush timer expiry handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerExpired
+(
+    le_timer_Ref_t timer
+)
+{
+    Flush(le_timer_GetContextPtr(timer));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle an event on the batch stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StreamHandler
+(
+    int fd,         ///< [IN] Batch stream file descriptor.
+    short events    ///< [IN] Event bitmask.
+)
+{
+    DestinationBatch_t* batchPtr = le_fdMonitor_GetContextPtr();
+    LE_UNUSED(fd);
+
+    if (events & (POLLERR | POLLHUP))
+    {
+        // Reader has gone away.
+        LE_INFO("Batch stream of destination '%s' closed",
+                configService_GetDestinationName(batchPtr->destRef));
+        EndBatch(batchPtr);
+    }
+    else if (events & POLLOUT)
+    {
+        Flush(batchPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the pipe carrying the records of a destination.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void InitPipe
+(
+    const char* destination,    ///< [IN] Destination name.
+    int* sinkPtr,               ///< [OUT] Write end.
+    int* sourcePtr              ///< [OUT] Read end.
+)
+#if LE_CONFIG_RTOS
+{
+    char fifoPath[sizeof(BATCH_FIFO_PREFIX) + CONFIG_MAX_DESTINATION_NAME_LEN];
+
+    snprintf(fifoPath, sizeof(fifoPath), BATCH_FIFO_PREFIX "%s", destination);
+    le_fd_MkFifo(fifoPath, S_IRUSR | S_IWUSR);
+
+    *sinkPtr = le_fd_Open(fifoPath, O_WRONLY | O_NONBLOCK);
+    *sourcePtr = le_fd_Open(fifoPath, O_RDONLY | O_NONBLOCK);
+}
+#else /* not LE_CONFIG_RTOS */
+{
+    int fds[2] = { -1, -1 };
+    LE_UNUSED(destination);
+
+    // The FDs are checked by the caller.
+    pipe2(fds, O_NONBLOCK);
+    *sinkPtr = fds[1];
+    *sourcePtr = fds[0];
+}
+#endif /* end not LE_CONFIG_RTOS */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a sample of an observation to the batch of its destination.
+ *
+ * @return
+ *      - LE_OK if the record was buffered (or dropped because the reader is too slow).
+ *      - LE_OVERFLOW if the record is larger than the batch buffer.  The caller should deliver it
+ *        through the push handler instead.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_AppendToBatch
+(
+    configService_DestinationBatchRef_t batchRef,   ///< [IN] Batched destination.
+    const char* obsName,         ///< [IN] Observation Name
+    const char* srcPath,         ///< [IN] Source path + JSON extraction, if applicable
+    io_DataType_t dataType,      ///< [IN] Data type of the data sample
+    dataSample_Ref_t dataSample  ///< [IN] Data sample
+)
+{
+    DestinationBatch_t* batchPtr = batchRef;
+    configService_DestinationRef_t destRef = batchPtr->destRef;
+
+    size_t obsNameLen = strlen(obsName);
+    size_t srcPathLen = strlen(srcPath);
+    uint8_t boolValue;
+    double numericValue;
+    const void* valuePtr = NULL;
+    uint32_t valueLen = 0;
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            boolValue = dataSample_GetBoolean(dataSample);
+            valuePtr = &boolValue;
+            valueLen = sizeof(boolValue);
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            numericValue = dataSample_GetNumeric(dataSample);
+            valuePtr = &numericValue;
+            valueLen = sizeof(numericValue);
+            break;
+
+        case IO_DATA_TYPE_STRING:
+            valuePtr = dataSample_GetString(dataSample);
+            valueLen = strlen(valuePtr);
+            break;
+
+        case IO_DATA_TYPE_JSON:
+            valuePtr = dataSample_GetJson(dataSample);
+            valueLen = strlen(valuePtr);
+            break;
+    }
+
+    // Names are bounded by the API, so their lengths always fit in one byte.
+    LE_ASSERT((obsNameLen <= UINT8_MAX) && (srcPathLen <= UINT8_MAX));
+
+    uint32_t recordLen = BATCH_RECORD_HEADER_BYTES + obsNameLen + srcPathLen + valueLen;
+    if (recordLen > sizeof(batchPtr->buffer))
+    {
+        return LE_OVERFLOW;
+    }
+
+    // Make room at the end of the buffer, flushing first if the reader keeps up.
+    if (batchPtr->next + batchPtr->available + recordLen > sizeof(batchPtr->buffer))
+    {
+        if (batchPtr->available + recordLen <= sizeof(batchPtr->buffer))
+        {
+            memmove(batchPtr->buffer, &batchPtr->buffer[batchPtr->next], batchPtr->available);
+            batchPtr->next = 0;
+        }
+        else
+        {
+            Flush(batchPtr);
+            if (configService_GetDestinationBatch(destRef) != batchRef)
+            {
+                // Stream broke, batch has ended.
+                return LE_OK;
+            }
+            if (batchPtr->available + recordLen > sizeof(batchPtr->buffer))
+            {
+                batchPtr->droppedCount++;
+                return LE_OK;
+            }
+            if (batchPtr->next + batchPtr->available + recordLen > sizeof(batchPtr->buffer))
+            {
+                memmove(batchPtr->buffer, &batchPtr->buffer[batchPtr->next], batchPtr->available);
+                batchPtr->next = 0;
+            }
+        }
+    }
+
+    bool wasEmpty = (batchPtr->available == 0);
+
+    uint8_t* recordPtr = &batchPtr->buffer[batchPtr->next + batchPtr->available];
+    double timestamp = dataSample_GetTimestamp(dataSample);
+    uint8_t type = (uint8_t)dataType;
+    uint8_t obsNameLen8 = (uint8_t)obsNameLen;
+    uint8_t srcPathLen8 = (uint8_t)srcPathLen;
+
+    memcpy(recordPtr + 0, &recordLen, sizeof(recordLen));
+    memcpy(recordPtr + 4, &timestamp, sizeof(timestamp));
+    recordPtr[12] = type;
+    recordPtr[13] = obsNameLen8;
+    recordPtr[14] = srcPathLen8;
+    recordPtr[15] = 0;
+    memcpy(recordPtr + 16, &valueLen, sizeof(valueLen));
+    recordPtr += BATCH_RECORD_HEADER_BYTES;
+    memcpy(recordPtr, obsName, obsNameLen);
+    recordPtr += obsNameLen;
+    memcpy(recordPtr, srcPath, srcPathLen);
+    recordPtr += srcPathLen;
+    if (valueLen > 0)
+    {
+        memcpy(recordPtr, valuePtr, valueLen);
+    }
+
+    batchPtr->available += recordLen;
+
+    if (batchPtr->available >= batchPtr->flushBytes)
+    {
+        Flush(batchPtr);
+    }
+    else if (wasEmpty)
+    {
+        // First record of a new batch.  Bound the time it can wait.
+        if (batchPtr->maxDelayMs > 0)
+        {
+            le_timer_Start(batchPtr->timer);
+        }
+        else if (!batchPtr->flushQueued)
+        {
+            batchPtr->flushQueued = true;
+            le_event_QueueFunction(QueuedFlush, batchPtr, NULL);
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start batched delivery for a destination.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_DUPLICATE if the destination is already batched.
+ *      - LE_NO_MEMORY if too many destinations are batched.
+ *      - LE_CLOSED if the batch stream could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t config_StartDestinationBatch
+(
+    const char* destination,    ///< [IN] Destination to batch.
+    uint32_t maxBytes,          ///< [IN] Flush once this many bytes are buffered.
+    uint32_t maxDelayMs,        ///< [IN] Flush once the oldest record is this old.
+    int* batchStreamPtr         ///< [OUT] Read end of the batch stream.
+)
+{
+    *batchStreamPtr = -1;
+
+    configService_DestinationRef_t destRef = configService_GetDestination(destination);
+    if (destRef == NULL)
+    {
+        return LE_NO_MEMORY;
+    }
+
+    if (configService_GetDestinationBatch(destRef) != NULL)
+    {
+        configService_ReleaseDestination(destRef);
+        return LE_DUPLICATE;
+    }
+
+    DestinationBatch_t* batchPtr = hub_MemAlloc(DestinationBatchPool);
+    if (batchPtr == NULL)
+    {
+        configService_ReleaseDestination(destRef);
+        return LE_NO_MEMORY;
+    }
+
+    int sink;
+    InitPipe(configService_GetDestinationName(destRef), &sink, batchStreamPtr);
+    if ((sink < 0) || (*batchStreamPtr < 0))
+    {
+        LE_ERROR("Failed to open pipe (sink: %d, source: %d)", sink, *batchStreamPtr);
+        if (sink >= 0)
+        {
+            le_fd_Close(sink);
+        }
+        if (*batchStreamPtr >= 0)
+        {
+            le_fd_Close(*batchStreamPtr);
+            *batchStreamPtr = -1;
+        }
+        le_mem_Release(batchPtr);
+        configService_ReleaseDestination(destRef);
+        return LE_CLOSED;
+    }
+
+    batchPtr->destRef = destRef;
+    batchPtr->fd = sink;
+    batchPtr->maxDelayMs = maxDelayMs;
+    batchPtr->flushQueued = false;
+    batchPtr->droppedCount = 0;
+    batchPtr->next = 0;
+    batchPtr->available = 0;
+    batchPtr->flushBytes = sizeof(batchPtr->buffer);
+    if ((maxBytes > 0) && (maxBytes < batchPtr->flushBytes))
+    {
+        batchPtr->flushBytes = maxBytes;
+    }
+
+    batchPtr->monitor = le_fdMonitor_Create("Batch", sink, StreamHandler, POLLOUT);
+    le_fdMonitor_SetContextPtr(batchPtr->monitor, batchPtr);
+    le_fdMonitor_Disable(batchPtr->monitor, POLLOUT);
+
+    batchPtr->timer = le_timer_Create("Batch");
+    LE_ASSERT(le_timer_SetMsInterval(batchPtr->timer, maxDelayMs) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(batchPtr->timer, FlushTimerExpired) == LE_OK);
+    LE_ASSERT(le_timer_SetContextPtr(batchPtr->timer, batchPtr) == LE_OK);
+
+    configService_SetDestinationBatch(destRef, batchPtr);
+
+    LE_INFO("Batching destination '%s' (flush at %" PRIuS " bytes or %" PRIu32 " ms)",
+            configService_GetDestinationName(destRef),
+            batchPtr->flushBytes,
+            maxDelayMs);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop batched delivery for a destination.  Buffered records are flushed first, as far as the
+ * batch stream accepts them, then the stream is closed.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_NOT_FOUND if the destination is not batched.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t config_StopDestinationBatch
+(
+    const char* destination     ///< [IN] Batched destination.
+)
+{
+    configService_DestinationRef_t destRef = configService_GetDestination(destination);
+    if (destRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    DestinationBatch_t* batchPtr = configService_GetDestinationBatch(destRef);
+    configService_ReleaseDestination(destRef);
+
+    if (batchPtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    SendData(batchPtr);
+    EndBatch(batchPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize destination batching.
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_InitBatch
+(
+    void
+)
+{
+    DestinationBatchPool = le_mem_InitStaticPool(DestinationBatchPool,
+                                                 DEFAULT_DESTINATION_BATCH_POOL_SIZE,
+                                                 sizeof(DestinationBatch_t));
+}
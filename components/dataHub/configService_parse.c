@@ -19,6 +19,15 @@
 #include "configService.h"
 #include "parser.h"
 
+/// Size of the chunks the staged config is stored in.
+#define DEFAULT_STAGING_CHUNK_BYTES         2048
+/// Default number of staging chunks.  This can be overridden in the .cdef.
+#define DEFAULT_STAGING_CHUNK_POOL_SIZE     2
+
+/// Alignment of the records allocated from the staging chunks.
+#define STAGING_ALIGN                       sizeof(double)
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Hold the config parse environment parameters.
@@ -26,16 +35,204 @@
 //--------------------------------------------------------------------------------------------------
 typedef struct ParseContext
 {
-    bool validateOnly;                      ///< Only validate the config, do not apply
     le_result_t result;                     ///< Overall parse result.
     parseError_t* parserErrorPtr;           ///< Pointer to parser error structure passed to us.
+    size_t fileLoc;                         ///< File location of the entry being processed.
+    bool obsDone;                           ///< End of the "o" section has been reached.
+    bool statesDone;                        ///< End of the "s" section has been reached.
+    configService_Estimate_t* estimatePtr;  ///< Estimate being worked out, if estimating.
 } ParseContext_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chunk of memory the staged config is allocated from.  Records are carved out of chunks one after
+ * the other and are never freed individually; all chunks are released once the config has been
+ * applied (or rejected).  This keeps the cost of staging proportional to the content of the file,
+ * rather than to the largest value each field may hold.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct StagingChunk
+{
+    le_sls_Link_t link;                             ///< Used to link into the StagingChunkList.
+    size_t used;                                    ///< Number of bytes of data in use.
+    uint8_t data[DEFAULT_STAGING_CHUNK_BYTES] __attribute__((aligned(STAGING_ALIGN)));
+                                                    ///< Records.
+} StagingChunk_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Observation found in the config file, kept until the config is applied.  The strings are
+ * allocated from the staging chunks, right after the record.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct StagedObs
+{
+    le_sls_Link_t link;             ///< Used to link into the StagedObsList.
+    size_t fileLoc;                 ///< Number of bytes read from file when the obs was parsed.
+    uint32_t bitmask;               ///< Fields present in the file (see parser_ObsData_t).
+    uint32_t bufferMaxCount;        ///< Value of "b".
+    admin_TransformType_t transform;///< Value of "f".
+    double minPeriod;               ///< Value of "p".
+    double changeBy;                ///< Value of "st".
+    double lowerThan;               ///< Value of "lt".
+    double greaterThan;             ///< Value of "gt".
+    const char* obsName;            ///< Name of observation.
+    const char* resourcePath;       ///< Value of "r".
+    const char* destination;        ///< Value of "d".
+    const char* jsonExtraction;     ///< Value of "s".
+} StagedObs_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State found in the config file, kept until the config is applied.
+ *
+ * The value is held in a Data Sample so that string and JSON values only take as much space as
+ * they need.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct StagedState
+{
+    le_sls_Link_t link;                                 ///< Used to link into the StagedStateList.
+    size_t fileLoc;                                     ///< Bytes read when the state was parsed.
+    io_DataType_t dataType;                             ///< Data type of the state value.
+    dataSample_Ref_t sampleRef;                         ///< State value.
+    const char* resourcePath;                           ///< Absolute path of the resource.
+} StagedState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of changes recorded in the apply journal.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    JOURNAL_OBS_CREATED,        ///< Observation created by the config.
+    JOURNAL_OBS_CHANGED,        ///< Settings of an Observation that existed before the config.
+    JOURNAL_SOURCE_CHANGED,     ///< Source of a resource used as an Observation's destination.
+}
+JournalType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change made to the resource tree while applying the staged config, with what is needed to undo
+ * it.  The entries and their strings are allocated from the staging chunks.
+ *
+ * Changing the buffer size or the transform of an existing Observation discards its buffered
+ * samples, so those changes are not made during the apply; they are kept here and only made when
+ * the config is committed.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct JournalEntry
+{
+    le_sls_Link_t link;             ///< Used to link into the JournalList.
+    JournalType_t type;             ///< Kind of change.
+    const char* path;               ///< Observation name, or absolute path of the resource.
+    const char* source;             ///< Previous source ("" = none).
+    const char* destination;        ///< Previous destination string.
+    const char* jsonExtraction;     ///< Previous JSON extraction.
+    double minPeriod;               ///< Previous minimum period.
+    double changeBy;                ///< Previous change by.
+    double highLimit;               ///< Previous high limit.
+    double lowLimit;                ///< Previous low limit.
+    uint32_t fingerprint;           ///< Previous config fingerprint.
+    uint32_t bufferMaxCount;        ///< Buffer size to set on commit.
+    admin_TransformType_t transform;///< Transform to set on commit.
+} JournalEntry_t;
+
+
+/// Pool of staging chunks.
+static le_mem_PoolRef_t StagingChunkPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(StagingChunkPool, DEFAULT_STAGING_CHUNK_POOL_SIZE,
+                          sizeof(StagingChunk_t));
+
+/// Chunks holding the staged config, the one being filled last.
+static le_sls_List_t StagingChunkList = LE_SLS_LIST_INIT;
+
+/// Number of staging chunks in use.
+static size_t StagingChunkCount = 0;
+
+/// Observations of the staged config, in file order.
+static le_sls_List_t StagedObsList = LE_SLS_LIST_INIT;
+
+/// States of the staged config, in file order.
+static le_sls_List_t StagedStateList = LE_SLS_LIST_INIT;
+
+/// Changes made while applying the staged config, the latest first.
+static le_sls_List_t JournalList = LE_SLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate memory for the staged config.
+ *
+ * @return Pointer to the memory, or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* StagingAlloc
+(
+    size_t size                 ///< [IN] Number of bytes needed.
+)
+{
+    size = (size + STAGING_ALIGN - 1) & ~(STAGING_ALIGN - 1);
+    LE_ASSERT(size <= DEFAULT_STAGING_CHUNK_BYTES);
+
+    le_sls_Link_t* linkPtr = le_sls_PeekTail(&StagingChunkList);
+    StagingChunk_t* chunkPtr = (linkPtr != NULL) ? CONTAINER_OF(linkPtr, StagingChunk_t, link) :
+                                                   NULL;
+
+    if ((chunkPtr == NULL) || (chunkPtr->used + size > sizeof(chunkPtr->data)))
+    {
+        chunkPtr = hub_MemAlloc(StagingChunkPool);
+        if (chunkPtr == NULL)
+        {
+            return NULL;
+        }
+        chunkPtr->link = LE_SLS_LINK_INIT;
+        chunkPtr->used = 0;
+        le_sls_Queue(&StagingChunkList, &chunkPtr->link);
+        StagingChunkCount++;
+    }
+
+    void* ptr = &chunkPtr->data[chunkPtr->used];
+    chunkPtr->used += size;
+    return ptr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string into the memory of the staged config.
+ *
+ * @return Pointer to the copy, or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* StagingStrDup
+(
+    const char* str             ///< [IN] String to copy.
+)
+{
+    size_t size = strlen(str) + 1;
+    char* copyPtr = StagingAlloc(size);
+
+    if (copyPtr != NULL)
+    {
+        memcpy(copyPtr, str, size);
+    }
+    return copyPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function to Handle Parser Errors.
  *
+ * The error is reported at the file location of the entry currently being processed.
+ *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
@@ -51,12 +248,10 @@ static void HandleError
     LE_ERROR("Error message: [%s]", msg);
     strncpy(parseContextPtr->parserErrorPtr->errorMsg, msg, CONFIG_MAX_ERROR_MSG_LEN);
 
-    parseContextPtr->parserErrorPtr->fileLoc = parser_GetNumBytesRead();
+    parseContextPtr->parserErrorPtr->fileLoc = parseContextPtr->fileLoc;
 
     // Set the Parse Context result code
     parseContextPtr->result = result;
-
-    parser_StopParse(parser_GetParseSessionRef());
 }
 
 
@@ -75,12 +270,87 @@ static void ErrorEventCb
 )
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
-    if (!parseContextPtr->validateOnly)
+
+    parseContextPtr->fileLoc = parser_GetNumBytesRead();
+    HandleError(parseContextPtr, error, msg);
+
+    parser_StopParse(parser_GetParseSessionRef());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report that there is no memory left to record a change in the apply journal.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void JournalOutOfMemory
+(
+    const char* path,                   ///< [IN] Observation name or resource path.
+    ParseContext_t* parseContextPtr     ///< [IN] Pointer to the Parser Context structure
+)
+{
+    char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+    snprintf(msg, CONFIG_MAX_ERROR_MSG_LEN, "Out of memory to record changes to %s", path);
+
+    HandleError(parseContextPtr, LE_NO_MEMORY, msg);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocate an apply journal entry.  The caller adds it to the JournalList once it is filled in.
+ *
+ * @return Pointer to the entry, or NULL if out of memory (the error has been reported).
+ */
+//--------------------------------------------------------------------------------------------------
+static JournalEntry_t* NewJournalEntry
+(
+    JournalType_t type,                 ///< [IN] Kind of change.
+    const char* path,                   ///< [IN] Observation name or resource path.
+    ParseContext_t* parseContextPtr     ///< [IN] Pointer to the Parser Context structure
+)
+{
+    JournalEntry_t* entryPtr = StagingAlloc(sizeof(JournalEntry_t));
+    const char* pathCopy = StagingStrDup(path);
+
+    if ((entryPtr == NULL) || (pathCopy == NULL))
+    {
+        JournalOutOfMemory(path, parseContextPtr);
+        return NULL;
+    }
+
+    memset(entryPtr, 0, sizeof(*entryPtr));
+    entryPtr->link = LE_SLS_LINK_INIT;
+    entryPtr->type = type;
+    entryPtr->path = pathCopy;
+    entryPtr->source = "";
+    entryPtr->destination = "";
+    entryPtr->jsonExtraction = "";
+    return entryPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the path of the current source of a resource into the memory of the staged config.
+ *
+ * @return The source path ("" if there is none), or NULL if out of memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* GetSourceCopy
+(
+    const char* absPath                 ///< [IN] Absolute path of the resource.
+)
+{
+    char srcPath[HUB_MAX_RESOURCE_PATH_BYTES];
+
+    if (admin_GetSource(absPath, srcPath, sizeof(srcPath)) != LE_OK)
     {
-        // errors in the apply phase are reported as LE_FAULT.
-        error = LE_FAULT;
+        return "";
     }
-    HandleError(context, error, msg);
+    return StagingStrDup(srcPath);
 }
 
 
@@ -89,8 +359,8 @@ static void ErrorEventCb
  * Helper functions for processing an observation.
  *
  * Each function processes one field.
- * Return value is a boolean. true indicates that field was successfully processed and parser can
- * move forward to other fields, false means there was an error and parser should stop.
+ * Return value is a boolean. true indicates that field was successfully applied and we can
+ * move forward to other fields, false means there was an error and the apply should stop.
  */
 //--------------------------------------------------------------------------------------------------
 
@@ -114,36 +384,33 @@ static bool ObsNameHelper
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
     LE_ASSERT(!hub_IsResourcePathMalformed(obsName));
 
-    if (!parseContextPtr->validateOnly)
-    {
-        // if we're applying configs, we can create the observation now:
-        // admin_CreateObs will return LE_OK even if it already exists.
-        le_result_t obsCreateRes = admin_CreateObs(obsName);
+    // if we're applying configs, we can create the observation now:
+    // admin_CreateObs will return LE_OK even if it already exists.
+    le_result_t obsCreateRes = admin_CreateObs(obsName);
 
-        if (obsCreateRes != LE_OK)
-        {
+    if (obsCreateRes != LE_OK)
+    {
 
-            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-            snprintf(msg,
-                     CONFIG_MAX_ERROR_MSG_LEN,
-                     "Error in Creating Observation %s, error: %s",
-                     obsName,
-                     LE_RESULT_TXT(obsCreateRes));
+        char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+        snprintf(msg,
+                 CONFIG_MAX_ERROR_MSG_LEN,
+                 "Error in Creating Observation %s, error: %s",
+                 obsName,
+                 LE_RESULT_TXT(obsCreateRes));
 
-            HandleError(parseContextPtr, LE_FAULT, msg);
-            return false;
-        }
+        HandleError(parseContextPtr, LE_FAULT, msg);
+        return false;
+    }
 
-        // Set the relevance flag so we know this obs was visited during application of this config
-        resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsName);
-        LE_ASSERT(entryRef); // we just created it, so it must exist.
-        resTree_SetRelevance(entryRef, true);
+    // Set the relevance flag so we know this obs was visited during application of this config
+    resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsName);
+    LE_ASSERT(entryRef); // we just created it, so it must exist.
+    resTree_SetRelevance(entryRef, true);
 
-        // Mark as config if it's a new observation:
-        if (IsANewObs)
-        {
-            resTree_MarkObservationAsConfig(entryRef);
-        }
+    // Mark as config if it's a new observation:
+    if (IsANewObs)
+    {
+        resTree_MarkObservationAsConfig(entryRef);
     }
     return true;
 }
@@ -168,25 +435,22 @@ static bool ObsResourceHelper
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
     LE_ASSERT(!hub_IsResourcePathMalformed(resourcePath));
 
-    if (!parseContextPtr->validateOnly)
-    {
-        char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
-        snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", obsName);
-
-        // Set the Observation Source
-        le_result_t result = admin_SetSource(absPath, resourcePath);
-        if (result != LE_OK)
-        {
-            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-            snprintf(msg,
-                     CONFIG_MAX_ERROR_MSG_LEN,
-                     "failed to set source for obs %s, error: %s",
-                     obsName,
-                     LE_RESULT_TXT(result));
+    char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
+    snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", obsName);
 
-            HandleError(parseContextPtr, LE_FAULT, msg);
-            return false;
-        }
+    // Set the Observation Source
+    le_result_t result = admin_SetSource(absPath, resourcePath);
+    if (result != LE_OK)
+    {
+        char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+        snprintf(msg,
+                 CONFIG_MAX_ERROR_MSG_LEN,
+                 "failed to set source for obs %s, error: %s",
+                 obsName,
+                 LE_RESULT_TXT(result));
+
+        HandleError(parseContextPtr, LE_FAULT, msg);
+        return false;
     }
     return true;
 }
@@ -214,39 +478,48 @@ static bool ObsDestinationHelper
     if (dest[0] == '/')
     {
         // value is a resource path:
-        if (!parseContextPtr->validateOnly)
+        char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
+        snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", obsName);
+
+        // Record the current source of the resource, so that it can be put back.
+        JournalEntry_t* jEntryPtr = NewJournalEntry(JOURNAL_SOURCE_CHANGED, dest,
+                                                    parseContextPtr);
+        if (jEntryPtr == NULL)
+        {
+            return false;
+        }
+        jEntryPtr->source = GetSourceCopy(dest);
+        if (jEntryPtr->source == NULL)
         {
-            char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
-            snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", obsName);
+            JournalOutOfMemory(dest, parseContextPtr);
+            return false;
+        }
+        le_sls_Stack(&JournalList, &jEntryPtr->link);
 
-            // Set the Observation Source
-            le_result_t result = admin_SetSource(dest, absPath);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "failed to set destination for obs %s, error: %s",
-                         obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+        // Set the Observation Source
+        le_result_t result = admin_SetSource(dest, absPath);
+        if (result != LE_OK)
+        {
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "failed to set destination for obs %s, error: %s",
+                     obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     else
     {
         // value is not a resource path, in this case, there's no validation to be done.
-        if (!parseContextPtr->validateOnly)
-        {
-            // value is a destination string:
-            resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsName);
-            LE_ASSERT(entryRef); // we wouldn't have come this far if this obs didn't exist.
+        // value is a destination string:
+        resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsName);
+        LE_ASSERT(entryRef); // we wouldn't have come this far if this obs didn't exist.
 
-            // Set the Observation Destination name
-            resTree_SetDestination(entryRef, dest);
-        }
+        // Set the Observation Destination name
+        resTree_SetDestination(entryRef, dest);
     }
     return true;
 }
@@ -269,24 +542,21 @@ static bool ObsMinPeriodHelper
 )
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK) || !IsANewObs)
+        // Set the Observation Minimum period
+        le_result_t result = admin_SetMinPeriod(obsDataPtr->obsName, obsDataPtr->minPeriod);
+        if (result != LE_OK)
         {
-            // Set the Observation Minimum period
-            le_result_t result = admin_SetMinPeriod(obsDataPtr->obsName, obsDataPtr->minPeriod);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set Min Period for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set Min Period for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -310,24 +580,21 @@ static bool ObsChangeByHelper
 )
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK) || !IsANewObs)
+        // Set the Observation Change By field
+        le_result_t result = admin_SetChangeBy(obsDataPtr->obsName, obsDataPtr->changeBy);
+        if (result != LE_OK)
         {
-            // Set the Observation Change By field
-            le_result_t result = admin_SetChangeBy(obsDataPtr->obsName, obsDataPtr->changeBy);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set Changeby for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set Changeby for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -352,24 +619,21 @@ static bool ObsLowerThanHelper
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK) || !IsANewObs)
+        // Set the Observation High Limit
+        le_result_t result = admin_SetHighLimit(obsDataPtr->obsName, obsDataPtr->lowerThan);
+        if (result != LE_OK)
         {
-            // Set the Observation High Limit
-            le_result_t result = admin_SetHighLimit(obsDataPtr->obsName, obsDataPtr->lowerThan);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set high limit for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set high limit for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -394,24 +658,21 @@ static bool ObsGreaterThanHelper
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK) || !IsANewObs)
+        // Set the Observation Low Limit
+        le_result_t result = admin_SetLowLimit(obsDataPtr->obsName, obsDataPtr->greaterThan);
+        if (result != LE_OK)
         {
-            // Set the Observation Low Limit
-            le_result_t result = admin_SetLowLimit(obsDataPtr->obsName, obsDataPtr->greaterThan);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set low limit for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set low limit for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -436,25 +697,22 @@ static bool ObsMaxBufferHelper
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK) || !IsANewObs)
+        // Set the Observation Max Buffer Count
+        le_result_t result = admin_SetBufferMaxCount(obsDataPtr->obsName,
+            obsDataPtr->bufferMaxCount);
+        if (result != LE_OK)
         {
-            // Set the Observation Max Buffer Count
-            le_result_t result = admin_SetBufferMaxCount(obsDataPtr->obsName,
-                obsDataPtr->bufferMaxCount);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set buffer maxCount for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set buffer maxCount for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -479,25 +737,22 @@ static bool ObsTransformFunctionHelper
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK) || !IsANewObs)
+        // Set the Observation transform
+        le_result_t result = admin_SetTransform(obsDataPtr->obsName,
+            (obsDataPtr->transform), NULL, 0);
+        if (result != LE_OK)
         {
-            // Set the Observation transform
-            le_result_t result = admin_SetTransform(obsDataPtr->obsName,
-                (obsDataPtr->transform), NULL, 0);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set obs transform for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set obs transform for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -522,25 +777,22 @@ static bool ObsJsonExtractionHelper
 {
     ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    if (!parseContextPtr->validateOnly)
+    if ((obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK) || !IsANewObs)
     {
-        if ((obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK) || !IsANewObs)
+        // Set the JSON Extraction
+        le_result_t result = admin_SetJsonExtraction(obsDataPtr->obsName,
+            obsDataPtr->jsonExtraction);
+        if (result != LE_OK)
         {
-            // Set the JSON Extraction
-            le_result_t result = admin_SetJsonExtraction(obsDataPtr->obsName,
-                obsDataPtr->jsonExtraction);
-            if (result != LE_OK)
-            {
-                char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
-                snprintf(msg,
-                         CONFIG_MAX_ERROR_MSG_LEN,
-                         "Failed to set JSON extraction for obs %s, error: %s",
-                         obsDataPtr->obsName,
-                         LE_RESULT_TXT(result));
-
-                HandleError(parseContextPtr, LE_FAULT, msg);
-                return false;
-            }
+            char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+            snprintf(msg,
+                     CONFIG_MAX_ERROR_MSG_LEN,
+                     "Failed to set JSON extraction for obs %s, error: %s",
+                     obsDataPtr->obsName,
+                     LE_RESULT_TXT(result));
+
+            HandleError(parseContextPtr, LE_FAULT, msg);
+            return false;
         }
     }
     return true;
@@ -549,27 +801,232 @@ static bool ObsJsonExtractionHelper
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to process an 'observation' entry.
+ * Fold a block of bytes into a 32-bit FNV-1a hash.
  *
- * @return none
+ * @return The updated hash.
  */
 //--------------------------------------------------------------------------------------------------
-static void OneObservationCb
+static uint32_t HashBytes
 (
-    parser_ObsData_t* obsDataPtr,  ///< [IN] Pointer to Observation Data structure
-    void* context                  ///< [IN] Context pointer
+    uint32_t hash,          ///< [IN] Hash so far.
+    const void* dataPtr,    ///< [IN] Bytes to fold in.
+    size_t len              ///< [IN] Number of bytes.
 )
 {
-    bool newObs = false;
+    const uint8_t* bytePtr = dataPtr;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= bytePtr[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compute the fingerprint of an observation's settings in the config file.
+ *
+ * Each field is hashed separately so that unused bytes in the string buffers and structure padding
+ * do not affect the result.
+ *
+ * @return The fingerprint (never 0, which means "no fingerprint").
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t ObsFingerprint
+(
+    const parser_ObsData_t* obsDataPtr  ///< [IN] Pointer to Observation Data structure
+)
+{
+    uint32_t hash = 2166136261u;
+
+    hash = HashBytes(hash, &obsDataPtr->bitmask, sizeof(obsDataPtr->bitmask));
+    hash = HashBytes(hash, obsDataPtr->resourcePath, strlen(obsDataPtr->resourcePath) + 1);
+    hash = HashBytes(hash, obsDataPtr->destination, strlen(obsDataPtr->destination) + 1);
+    hash = HashBytes(hash, &obsDataPtr->minPeriod, sizeof(obsDataPtr->minPeriod));
+    hash = HashBytes(hash, &obsDataPtr->changeBy, sizeof(obsDataPtr->changeBy));
+    hash = HashBytes(hash, &obsDataPtr->lowerThan, sizeof(obsDataPtr->lowerThan));
+    hash = HashBytes(hash, &obsDataPtr->greaterThan, sizeof(obsDataPtr->greaterThan));
+    hash = HashBytes(hash, &obsDataPtr->bufferMaxCount, sizeof(obsDataPtr->bufferMaxCount));
+    hash = HashBytes(hash, &obsDataPtr->transform, sizeof(obsDataPtr->transform));
+    hash = HashBytes(hash, obsDataPtr->jsonExtraction, strlen(obsDataPtr->jsonExtraction) + 1);
+
+    return (hash != 0) ? hash : 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the settings of an existing Observation in the apply journal, before they are changed.
+ *
+ * @return
+ *      - true            The settings were recorded.
+ *      - false           Out of memory (the error has been reported).
+ */
+//--------------------------------------------------------------------------------------------------
+static bool JournalObservation
+(
+    resTree_EntryRef_t entryRef,        ///< [IN] Observation entry.
+    parser_ObsData_t* obsDataPtr,       ///< [IN] Settings about to be applied.
+    ParseContext_t* parseContextPtr     ///< [IN] Pointer to the Parser Context structure
+)
+{
+    JournalEntry_t* jEntryPtr = NewJournalEntry(JOURNAL_OBS_CHANGED, obsDataPtr->obsName,
+                                                parseContextPtr);
+    if (jEntryPtr == NULL)
+    {
+        return false;
+    }
+
+    char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
+    snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", obsDataPtr->obsName);
+
+    jEntryPtr->source = GetSourceCopy(absPath);
+    jEntryPtr->destination = StagingStrDup(resTree_GetDestination(entryRef));
+    jEntryPtr->jsonExtraction = StagingStrDup(resTree_GetJsonExtraction(entryRef));
+    if ((jEntryPtr->source == NULL) ||
+        (jEntryPtr->destination == NULL) ||
+        (jEntryPtr->jsonExtraction == NULL))
+    {
+        JournalOutOfMemory(obsDataPtr->obsName, parseContextPtr);
+        return false;
+    }
+
+    jEntryPtr->minPeriod = resTree_GetMinPeriod(entryRef);
+    jEntryPtr->changeBy = resTree_GetChangeBy(entryRef);
+    jEntryPtr->highLimit = resTree_GetHighLimit(entryRef);
+    jEntryPtr->lowLimit = resTree_GetLowLimit(entryRef);
+    jEntryPtr->fingerprint = resTree_GetConfigFingerprint(entryRef);
+    jEntryPtr->bufferMaxCount = obsDataPtr->bufferMaxCount;
+    jEntryPtr->transform = obsDataPtr->transform;
+
+    le_sls_Stack(&JournalList, &jEntryPtr->link);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put back the source of a resource, as recorded in the apply journal.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void RestoreSource
+(
+    const char* absPath,                ///< [IN] Absolute path of the resource.
+    const char* srcPath                 ///< [IN] Absolute path of the source ("" = none).
+)
+{
+    if (srcPath[0] == '\0')
+    {
+        admin_RemoveSource(absPath);
+    }
+    else
+    {
+        le_result_t result = admin_SetSource(absPath, srcPath);
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to restore source %s of %s, error: %s",
+                     srcPath,
+                     absPath,
+                     LE_RESULT_TXT(result));
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put back the settings of an Observation, as recorded in the apply journal.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void RestoreObservation
+(
+    const JournalEntry_t* jEntryPtr     ///< [IN] Journal entry of the Observation.
+)
+{
+    resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), jEntryPtr->path);
+    if ((entryRef == NULL) || (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_OBSERVATION))
+    {
+        LE_WARN("Observation %s no longer exists, cannot restore it", jEntryPtr->path);
+        return;
+    }
+
+    char absPath[HUB_MAX_RESOURCE_PATH_BYTES]= {};
+    snprintf(absPath, HUB_MAX_RESOURCE_PATH_BYTES, "/obs/%s", jEntryPtr->path);
+
+    RestoreSource(absPath, jEntryPtr->source);
+    resTree_SetDestination(entryRef, jEntryPtr->destination);
+    resTree_SetMinPeriod(entryRef, jEntryPtr->minPeriod);
+    resTree_SetChangeBy(entryRef, jEntryPtr->changeBy);
+    resTree_SetHighLimit(entryRef, jEntryPtr->highLimit);
+    resTree_SetLowLimit(entryRef, jEntryPtr->lowLimit);
+    resTree_SetJsonExtraction(entryRef, jEntryPtr->jsonExtraction);
+    resTree_SetConfigFingerprint(entryRef, jEntryPtr->fingerprint);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply one staged 'observation' entry.
+ *
+ * If the observation was created by a previous config file and its settings are identical to the
+ * ones last applied, it is only marked as relevant, so that its buffer and filter state are left
+ * untouched.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void ApplyObservation
+(
+    parser_ObsData_t* obsDataPtr,  ///< [IN] Pointer to Observation Data structure
+    void* context                  ///< [IN] Context pointer
+)
+{
+    bool newObs = false;
+    uint32_t fingerprint = ObsFingerprint(obsDataPtr);
     resTree_EntryRef_t entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsDataPtr->obsName);
+    if (entryRef &&
+        (resTree_GetEntryType(entryRef) == ADMIN_ENTRY_TYPE_OBSERVATION) &&
+        resTree_IsObservationConfig(entryRef) &&
+        (resTree_GetConfigFingerprint(entryRef) == fingerprint))
+    {
+        LE_DEBUG("Observation %s is unchanged", obsDataPtr->obsName);
+        resTree_SetRelevance(entryRef, true);
+        return;
+    }
     if (!entryRef || resTree_IsResource(entryRef))
     {
         newObs = true;
     }
+
+    // Record what is about to change, so that it can be undone if the config cannot be applied.
+    JournalEntry_t* createdPtr = NULL;
+    if (newObs)
+    {
+        createdPtr = NewJournalEntry(JOURNAL_OBS_CREATED, obsDataPtr->obsName, context);
+        if (createdPtr == NULL)
+        {
+            return;
+        }
+    }
+    else if (!JournalObservation(entryRef, obsDataPtr, context))
+    {
+        return;
+    }
+
     if (!ObsNameHelper(obsDataPtr->obsName, newObs, context))
     {
         return;
     }
+    if (createdPtr != NULL)
+    {
+        le_sls_Stack(&JournalList, &createdPtr->link);
+    }
 
     if (!ObsResourceHelper(obsDataPtr->obsName, obsDataPtr->resourcePath, context))
     {
@@ -601,12 +1058,15 @@ static void OneObservationCb
         return;
     }
 
-    if (!ObsMaxBufferHelper(obsDataPtr, newObs, context))
+    // The buffer size and transform of an existing observation are only set once the whole config
+    // has been applied (see configService_CommitStagedConfig()), as setting them can discard the
+    // buffered samples.
+    if (newObs && !ObsMaxBufferHelper(obsDataPtr, newObs, context))
     {
         return;
     }
 
-    if (!ObsTransformFunctionHelper(obsDataPtr, newObs, context))
+    if (newObs && !ObsTransformFunctionHelper(obsDataPtr, newObs, context))
     {
         return;
     }
@@ -615,13 +1075,22 @@ static void OneObservationCb
     {
         return;
     }
+
+    // Remember what was applied so that the next config can skip this observation if it is
+    // unchanged.
+    entryRef = resTree_FindEntry(resTree_GetObsNamespace(), obsDataPtr->obsName);
+    LE_ASSERT(entryRef);
+    if (resTree_IsObservationConfig(entryRef))
+    {
+        resTree_SetConfigFingerprint(entryRef, fingerprint);
+    }
 }
 
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to process a 'state' entry.
+ * Apply one staged 'state' entry.
  *
  *
  * States are values which are pushed to resources and set as default value of those resources.
@@ -635,211 +1104,561 @@ static void OneObservationCb
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void StateCb
+static void ApplyState
 (
-    parser_StateData_t* stateDataPtr,  ///< [IN] Pointer to State Data structure
-    void* context                      ///< [IN] Context pointer
+    StagedState_t* statePtr  ///< [IN] Pointer to the staged state
 )
 {
-    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
-    const char* resPath = stateDataPtr->resourcePath;
+    const char* resPath = statePtr->resourcePath;
     LE_ASSERT (!hub_IsResourcePathMalformed(resPath));
-    if (!parseContextPtr->validateOnly)
-    {
-        le_result_t ret = LE_OK;
+    le_result_t ret = LE_OK;
 
-        // set default and push
-        switch(stateDataPtr->dataType)
+    // set default and push
+    switch(statePtr->dataType)
+    {
+        case (IO_DATA_TYPE_TRIGGER):
         {
-            case (IO_DATA_TYPE_TRIGGER):
+            ret = admin_PushTrigger(resPath, 0);
+            break;
+        }
+        case (IO_DATA_TYPE_NUMERIC):
+        {
+            double value = dataSample_GetNumeric(statePtr->sampleRef);
+            ret = admin_SetNumericDefault(resPath, value);
+            if (ret == LE_OK)
             {
-                ret = admin_PushTrigger(resPath, 0);
-                break;
+                ret = admin_PushNumeric(resPath, 0, value);
             }
-            case (IO_DATA_TYPE_NUMERIC):
-            {
-                ret = admin_SetNumericDefault(resPath, stateDataPtr->value.number);
-                if (ret == LE_OK)
-                {
-                    ret = admin_PushNumeric(resPath, 0, stateDataPtr->value.number);
-                }
-                break;
-            }
-            case (IO_DATA_TYPE_BOOLEAN):
+            break;
+        }
+        case (IO_DATA_TYPE_BOOLEAN):
+        {
+            bool value = dataSample_GetBoolean(statePtr->sampleRef);
+            ret = admin_SetBooleanDefault(resPath, value);
+            if (ret == LE_OK)
             {
-                ret = admin_SetBooleanDefault(resPath, stateDataPtr->value.boolean);
-                if (ret == LE_OK)
-                {
-                    ret = admin_PushBoolean(resPath, 0, stateDataPtr->value.boolean);
-                }
-                break;
+                ret = admin_PushBoolean(resPath, 0, value);
             }
-            case (IO_DATA_TYPE_STRING):
-            {
-                ret = admin_SetStringDefault(resPath, stateDataPtr->value.string);
+            break;
+        }
+        case (IO_DATA_TYPE_STRING):
+        {
+            const char* value = dataSample_GetString(statePtr->sampleRef);
+            ret = admin_SetStringDefault(resPath, value);
 
-                if (ret == LE_OK)
-                {
-                    ret = admin_PushString(resPath, 0, stateDataPtr->value.string);
-                };
-                break;
-            }
-            case (IO_DATA_TYPE_JSON):
+            if (ret == LE_OK)
             {
-                ret = admin_SetJsonDefault(resPath, stateDataPtr->value.string);
-                if (ret == LE_OK)
-                {
-                    ret = admin_PushJson(resPath, 0, stateDataPtr->value.string);
-                }
-                break;
-            }
-            default:
+                ret = admin_PushString(resPath, 0, value);
+            };
+            break;
+        }
+        case (IO_DATA_TYPE_JSON):
+        {
+            const char* value = dataSample_GetJson(statePtr->sampleRef);
+            ret = admin_SetJsonDefault(resPath, value);
+            if (ret == LE_OK)
             {
-                //this should not happen
-                LE_FATAL("Unexpected DataType in State");
+                ret = admin_PushJson(resPath, 0, value);
             }
+            break;
         }
-        if (ret != LE_OK)
+        default:
         {
-            // ignoring the result code to keep the current behavior
-            // processing a state could fail due to lack of memory for placeholder resources or
-            // lack of memory for data samples or type mismatch
-            LE_WARN("Problem in processing state for resource at %s, result: %d", resPath, ret);
+            //this should not happen
+            LE_FATAL("Unexpected DataType in State");
         }
     }
+    if (ret != LE_OK)
+    {
+        // ignoring the result code to keep the current behavior
+        // processing a state could fail due to lack of memory for placeholder resources or
+        // lack of memory for data samples or type mismatch
+        LE_WARN("Problem in processing state for resource at %s, result: %d", resPath, ret);
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to indicate the end of 'state' parsing.
+ * Stop the parse once both the observations and the states have been staged, since they are the
+ * last things we care about.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void StatesEndCb
+static void StopIfDone
 (
-    void* context    ///< [IN] Context pointer
+    ParseContext_t* parseContextPtr    ///< [IN] Pointer to the Parser Context structure
 )
 {
-    LE_UNUSED(context);
-    // we finished parsing states, which is the last thing we care about.
-    // so we can stop the parse here.
-    parser_StopParse(parser_GetParseSessionRef());
+    if (parseContextPtr->obsDone && parseContextPtr->statesDone)
+    {
+        parser_StopParse(parser_GetParseSessionRef());
+    }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to indicate the start of 'state' parsing.
+ * Callback function to stage an 'observation' entry.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void StatesStartCb
+static void StageObservationCb
 (
-    void* context    ///< [IN] Context pointer
+    parser_ObsData_t* obsDataPtr,  ///< [IN] Pointer to Observation Data structure
+    void* context                  ///< [IN] Context pointer
 )
 {
-    LE_UNUSED(context);
-    // we've found observations, so we can move on with states.
-    parser_Callbacks_t* callbacksPtr = parser_GetCallbacks(
-            parser_GetParseSessionRef());
+    StagedObs_t* obsPtr = StagingAlloc(sizeof(StagedObs_t));
+    if (obsPtr != NULL)
+    {
+        obsPtr->obsName = StagingStrDup(obsDataPtr->obsName);
+        obsPtr->resourcePath = StagingStrDup(obsDataPtr->resourcePath);
+        obsPtr->destination = StagingStrDup(obsDataPtr->destination);
+        obsPtr->jsonExtraction = StagingStrDup(obsDataPtr->jsonExtraction);
+    }
+    if ((obsPtr == NULL) || (obsPtr->obsName == NULL) || (obsPtr->resourcePath == NULL) ||
+        (obsPtr->destination == NULL) || (obsPtr->jsonExtraction == NULL))
+    {
+        char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+        snprintf(msg,
+                 CONFIG_MAX_ERROR_MSG_LEN,
+                 "Out of memory staging obs %s",
+                 obsDataPtr->obsName);
 
-    // Add callbacks for parsing states
-    callbacksPtr->state = StateCb;
-    callbacksPtr->sObjectEnd = StatesEndCb;
+        ErrorEventCb(LE_NO_MEMORY, msg, context);
+        return;
+    }
+
+    obsPtr->link = LE_SLS_LINK_INIT;
+    obsPtr->fileLoc = parser_GetNumBytesRead();
+    obsPtr->bitmask = obsDataPtr->bitmask;
+    obsPtr->bufferMaxCount = obsDataPtr->bufferMaxCount;
+    obsPtr->transform = obsDataPtr->transform;
+    obsPtr->minPeriod = obsDataPtr->minPeriod;
+    obsPtr->changeBy = obsDataPtr->changeBy;
+    obsPtr->lowerThan = obsDataPtr->lowerThan;
+    obsPtr->greaterThan = obsDataPtr->greaterThan;
+    le_sls_Queue(&StagedObsList, &obsPtr->link);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to indicate the end of 'observation' parsing.
+ * Rebuild the observation data given by the parser from a staged observation.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void ObservationsEndCb
+static void UnstageObservation
+(
+    const StagedObs_t* obsPtr,          ///< [IN] Staged observation.
+    parser_ObsData_t* obsDataPtr        ///< [OUT] Observation data.
+)
+{
+    obsDataPtr->bitmask = obsPtr->bitmask;
+    obsDataPtr->bufferMaxCount = obsPtr->bufferMaxCount;
+    obsDataPtr->transform = obsPtr->transform;
+    obsDataPtr->minPeriod = obsPtr->minPeriod;
+    obsDataPtr->changeBy = obsPtr->changeBy;
+    obsDataPtr->lowerThan = obsPtr->lowerThan;
+    obsDataPtr->greaterThan = obsPtr->greaterThan;
+
+    // These were copied from the same buffers, so they fit.
+    LE_ASSERT(LE_OK == le_utf8_Copy(obsDataPtr->obsName, obsPtr->obsName,
+                                    sizeof(obsDataPtr->obsName), NULL));
+    LE_ASSERT(LE_OK == le_utf8_Copy(obsDataPtr->resourcePath, obsPtr->resourcePath,
+                                    sizeof(obsDataPtr->resourcePath), NULL));
+    LE_ASSERT(LE_OK == le_utf8_Copy(obsDataPtr->destination, obsPtr->destination,
+                                    sizeof(obsDataPtr->destination), NULL));
+    LE_ASSERT(LE_OK == le_utf8_Copy(obsDataPtr->jsonExtraction, obsPtr->jsonExtraction,
+                                    sizeof(obsDataPtr->jsonExtraction), NULL));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function to stage a 'state' entry.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void StageStateCb
+(
+    parser_StateData_t* stateDataPtr,  ///< [IN] Pointer to State Data structure
+    void* context                      ///< [IN] Context pointer
+)
+{
+    dataSample_Ref_t sampleRef = NULL;
+
+    switch(stateDataPtr->dataType)
+    {
+        case (IO_DATA_TYPE_TRIGGER):
+            sampleRef = dataSample_CreateTrigger(0);
+            break;
+
+        case (IO_DATA_TYPE_NUMERIC):
+            sampleRef = dataSample_CreateNumeric(0, stateDataPtr->value.number);
+            break;
+
+        case (IO_DATA_TYPE_BOOLEAN):
+            sampleRef = dataSample_CreateBoolean(0, stateDataPtr->value.boolean);
+            break;
+
+        case (IO_DATA_TYPE_STRING):
+            sampleRef = dataSample_CreateString(0, stateDataPtr->value.string);
+            break;
+
+        case (IO_DATA_TYPE_JSON):
+            sampleRef = dataSample_CreateJson(0, stateDataPtr->value.string);
+            break;
+
+        default:
+            //this should not happen
+            LE_FATAL("Unexpected DataType in State");
+    }
+
+    StagedState_t* statePtr = (sampleRef != NULL) ? StagingAlloc(sizeof(StagedState_t)) : NULL;
+    if (statePtr != NULL)
+    {
+        statePtr->resourcePath = StagingStrDup(stateDataPtr->resourcePath);
+    }
+    if ((statePtr == NULL) || (statePtr->resourcePath == NULL))
+    {
+        if (sampleRef != NULL)
+        {
+            le_mem_Release(sampleRef);
+        }
+
+        char msg[CONFIG_MAX_ERROR_MSG_LEN] = {0};
+        snprintf(msg,
+                 CONFIG_MAX_ERROR_MSG_LEN,
+                 "Out of memory staging state %s",
+                 stateDataPtr->resourcePath);
+
+        ErrorEventCb(LE_NO_MEMORY, msg, context);
+        return;
+    }
+
+    statePtr->link = LE_SLS_LINK_INIT;
+    statePtr->fileLoc = parser_GetNumBytesRead();
+    statePtr->dataType = stateDataPtr->dataType;
+    statePtr->sampleRef = sampleRef;
+    le_sls_Queue(&StagedStateList, &statePtr->link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function to indicate the end of 'state' parsing.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void StatesEndCb
 (
     void* context    ///< [IN] Context pointer
 )
 {
-    LE_UNUSED(context);
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    // Observations ended, stop the parser now. We will start it again for states.
-    parser_StopParse(parser_GetParseSessionRef());
+    parseContextPtr->statesDone = true;
+    StopIfDone(parseContextPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Callback function to indicate the start of 'observation' parsing.
+ * Callback function to indicate the end of 'observation' parsing.
  *
  * @return none
  */
 //--------------------------------------------------------------------------------------------------
-static void ObservationsStartCb
+static void ObservationsEndCb
 (
     void* context    ///< [IN] Context pointer
 )
 {
-    LE_UNUSED(context);
-    parser_Callbacks_t* callbacksPtr = parser_GetCallbacks(
-            parser_GetParseSessionRef());
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
 
-    // Add callbacks for parsing observations
-    callbacksPtr->observation = OneObservationCb;
-    callbacksPtr->oObjectEnd = ObservationsEndCb;
+    parseContextPtr->obsDone = true;
+    StopIfDone(parseContextPtr);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Function to parse the specified configuration.
+ * Parse and validate the specified configuration, keeping its observations and states in memory
+ * so they can be applied with configService_ApplyStagedConfig() without reading the file again.
+ *
+ * Anything left over from a previous call is released first.
  *
  * @return
  *      - LE_OK            The function succeeded.
  *      - LE_FORMAT_ERROR  The configuration file has an unrecoverable format error.
  *      - LE_BAD_PARAMETER There is invalid parameters in the configuration file.
  *      - LE_IO_ERROR      Parser failed to read from file.
- *      - LE_FAULT         The configuration cannot be applied successfully.
+ *      - LE_NO_MEMORY     Ran out of memory while staging the configuration.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t configService_ParseConfig
+le_result_t configService_StageConfig
 (
     int fd,                                ///< [IN] File descriptor of the configuration file.
-    bool validateOnly,                     ///< [IN] Boolean to indicate if this is a validate or
-                                            /// apply operation.
+    configService_Encoding_t encoding,     ///< [IN] Encoding of the configuration file.
     parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
 )
 {
+    configService_ReleaseStagedConfig();
+
     ParseContext_t parseContext = {};
-    parseContext.validateOnly = validateOnly;
     parseContext.parserErrorPtr = parseErrorPtr;
     parseContext.result = LE_OK;
 
     parser_Callbacks_t callbacks = {};
 
-    // At the beginning the only thing we care about is the start of the "o" section.
-    // so we'll register a callback for that event and then take it from there.
-    callbacks.oObject = ObservationsStartCb;
+    // Observations and states are both collected in this single pass over the file.
+    callbacks.observation = StageObservationCb;
+    callbacks.oObjectEnd = ObservationsEndCb;
+    callbacks.state = StageStateCb;
+    callbacks.sObjectEnd = StatesEndCb;
     callbacks.error = ErrorEventCb;
 
-    // Start parsing the config file to process observations ("o")
-    parser_Parse(fd, &callbacks, &parseContext);
+    if (encoding == CONFIG_SERVICE_ENCODING_CBOR)
+    {
+        parser_ParseCbor(fd, &callbacks, &parseContext);
+    }
+    else
+    {
+        parser_Parse(fd, &callbacks, &parseContext);
+    }
+
+    if (parseContext.result != LE_OK)
+    {
+        configService_ReleaseStagedConfig();
+    }
+    else
+    {
+        LE_INFO("Config staged in %" PRIuS " chunks of %d bytes",
+                StagingChunkCount,
+                DEFAULT_STAGING_CHUNK_BYTES);
+    }
+
+    return parseContext.result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a Data Sample of a given type, and the string pool block taken by its value, in an
+ * estimate.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void EstimateSamples
+(
+    configService_Estimate_t* estimatePtr,  ///< [IN,OUT] Estimate.
+    io_DataType_t dataType,                 ///< [IN] Data type of the samples.
+    size_t strLen,                          ///< [IN] Length of the string or JSON value.
+    uint32_t count                          ///< [IN] Number of samples.
+)
+{
+    if ((dataType != IO_DATA_TYPE_STRING) && (dataType != IO_DATA_TYPE_JSON))
+    {
+        estimatePtr->nonStringSampleCount += count;
+        return;
+    }
 
-    if (parseContext.result == LE_OK)
+    estimatePtr->stringSampleCount += count;
+
+    switch (dataSample_GetStringSize(strLen))
     {
-        // At this point observations are parsed but states are not.
-        // so we'll parse again but with state callbacks enabled.
-        // need to empty the callbacks because we don't want to get callbacks for observations for
-        // a second time.
-        memset(&callbacks, 0, sizeof(parser_Callbacks_t));
+        case DATA_SAMPLE_STRING_SMALL:
+            estimatePtr->smallStringCount += count;
+            break;
+
+        case DATA_SAMPLE_STRING_MED:
+            estimatePtr->medStringCount += count;
+            break;
+
+        case DATA_SAMPLE_STRING_LARGE:
+            estimatePtr->largeStringCount += count;
+            break;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of bytes a buffered sample takes in a buffer backup file (see obs.c).
+ *
+ * @return The number of bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BackupSampleBytes
+(
+    io_DataType_t dataType,     ///< [IN] Data type of the sample.
+    size_t strLen               ///< [IN] Length of the string or JSON value.
+)
+{
+    // Timestamp, then the value.
+    size_t bytes = sizeof(double);
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+            bytes += sizeof(bool);
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            bytes += sizeof(double);
+            break;
+
+        case IO_DATA_TYPE_STRING:
+        case IO_DATA_TYPE_JSON:
+            bytes += sizeof(uint32_t) + strLen;
+            break;
+    }
+    return bytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function to add an 'observation' entry to the estimate.
+ *
+ * The samples buffered by the observation are assumed to have the type and size of the current
+ * value of its source.  JSON extractions, and sources without a value, are counted as numeric.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void EstimateObservationCb
+(
+    parser_ObsData_t* obsDataPtr,  ///< [IN] Pointer to Observation Data structure
+    void* context                  ///< [IN] Context pointer
+)
+{
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
+    configService_Estimate_t* estimatePtr = parseContextPtr->estimatePtr;
+
+    estimatePtr->obsCount++;
+
+    resTree_EntryRef_t obsEntry = resTree_FindEntry(resTree_GetObsNamespace(),
+                                                    obsDataPtr->obsName);
+    if ((obsEntry == NULL) || (resTree_GetEntryType(obsEntry) != ADMIN_ENTRY_TYPE_OBSERVATION))
+    {
+        estimatePtr->newObsCount++;
+        obsEntry = NULL;
+    }
+
+    io_DataType_t dataType = IO_DATA_TYPE_NUMERIC;
+    size_t strLen = 0;
 
-        callbacks.sObject = StatesStartCb;
-        callbacks.error = ErrorEventCb;
-        lseek(fd, 0, SEEK_SET);
-        // Start parsing the config file to process states ("s")
+    resTree_EntryRef_t srcEntry = NULL;
+    if (obsDataPtr->resourcePath[0] == '/')
+    {
+        srcEntry = resTree_FindEntryAtAbsolutePath(obsDataPtr->resourcePath);
+    }
+    dataSample_Ref_t valueRef = (srcEntry != NULL) ? resTree_GetCurrentValue(srcEntry) : NULL;
+    if ((valueRef != NULL) && (obsDataPtr->jsonExtraction[0] == '\0'))
+    {
+        dataType = resTree_GetDataType(srcEntry);
+        if ((dataType == IO_DATA_TYPE_STRING) || (dataType == IO_DATA_TYPE_JSON))
+        {
+            strLen = strlen(dataSample_GetString(valueRef));
+        }
+    }
+
+    uint32_t count = obsDataPtr->bufferMaxCount;
+    estimatePtr->bufferEntryCount += count;
+    EstimateSamples(estimatePtr, dataType, strLen, count);
+
+    // Config files do not set backup periods, so only observations that exist can be backed up.
+    uint32_t backupPeriod = (obsEntry != NULL) ? resTree_GetBufferBackupPeriod(obsEntry) : 0;
+    if ((backupPeriod > 0) && (count > 0))
+    {
+        // Version byte, data type byte and sample count, then the samples.
+        size_t fileBytes = 2 + sizeof(uint32_t) + count * BackupSampleBytes(dataType, strLen);
+        estimatePtr->backupBytesPerSec += (double)fileBytes / backupPeriod;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Callback function to add a 'state' entry to the estimate.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+static void EstimateStateCb
+(
+    parser_StateData_t* stateDataPtr,  ///< [IN] Pointer to State Data structure
+    void* context                      ///< [IN] Context pointer
+)
+{
+    ParseContext_t* parseContextPtr = (ParseContext_t*) context;
+    configService_Estimate_t* estimatePtr = parseContextPtr->estimatePtr;
+
+    size_t strLen = 0;
+    if ((stateDataPtr->dataType == IO_DATA_TYPE_STRING) ||
+        (stateDataPtr->dataType == IO_DATA_TYPE_JSON))
+    {
+        strLen = strlen(stateDataPtr->value.string);
+    }
+
+    estimatePtr->stateCount++;
+    EstimateSamples(estimatePtr, stateDataPtr->dataType, strLen, 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse and validate the specified configuration and estimate the memory and storage it would take
+ * once applied.  Nothing is staged or applied, so this can be done while a config is being applied.
+ *
+ * @return
+ *      - LE_OK            The function succeeded.
+ *      - LE_FORMAT_ERROR  The configuration file has an unrecoverable format error.
+ *      - LE_BAD_PARAMETER There is invalid parameters in the configuration file.
+ *      - LE_IO_ERROR      Parser failed to read from file.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_EstimateConfig
+(
+    int fd,                                ///< [IN] File descriptor of the configuration file.
+    configService_Encoding_t encoding,     ///< [IN] Encoding of the configuration file.
+    configService_Estimate_t* estimatePtr, ///< [OUT] Estimate.
+    parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
+)
+{
+    memset(estimatePtr, 0, sizeof(*estimatePtr));
+
+    ParseContext_t parseContext = {};
+    parseContext.parserErrorPtr = parseErrorPtr;
+    parseContext.result = LE_OK;
+    parseContext.estimatePtr = estimatePtr;
+
+    parser_Callbacks_t callbacks = {};
+
+    callbacks.observation = EstimateObservationCb;
+    callbacks.oObjectEnd = ObservationsEndCb;
+    callbacks.state = EstimateStateCb;
+    callbacks.sObjectEnd = StatesEndCb;
+    callbacks.error = ErrorEventCb;
+
+    if (encoding == CONFIG_SERVICE_ENCODING_CBOR)
+    {
+        parser_ParseCbor(fd, &callbacks, &parseContext);
+    }
+    else
+    {
         parser_Parse(fd, &callbacks, &parseContext);
     }
 
@@ -847,6 +1666,204 @@ le_result_t configService_ParseConfig
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Apply part of the configuration staged by configService_StageConfig().  Observations are
+ * applied first, then states.  Each entry is dropped from the staged configuration once it has been
+ * applied, so the function can be called repeatedly (e.g., once per event loop turn) until the
+ * whole configuration has been applied.  The memory is only released by
+ * configService_ReleaseStagedConfig().
+ *
+ * @return
+ *      - LE_OK            The whole staged configuration has been applied.
+ *      - LE_IN_PROGRESS   maxCount entries were applied, but there are more left to apply.
+ *      - LE_FAULT         The configuration cannot be applied successfully.
+ *      - LE_NO_MEMORY     The changes could not be recorded, so that they can be rolled back.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t configService_ApplyStagedConfig
+(
+    size_t maxCount,                       ///< [IN] Max number of entries to apply in this call.
+    parseError_t* parseErrorPtr            ///< [OUT] Pointer to the Parse Error structure.
+)
+{
+    ParseContext_t parseContext = {};
+    parseContext.parserErrorPtr = parseErrorPtr;
+    parseContext.result = LE_OK;
+
+    le_sls_Link_t* linkPtr;
+    size_t count = 0;
+
+    while ((count < maxCount) && (NULL != (linkPtr = le_sls_Pop(&StagedObsList))))
+    {
+        StagedObs_t* obsPtr = CONTAINER_OF(linkPtr, StagedObs_t, link);
+        parser_ObsData_t obsData;
+
+        UnstageObservation(obsPtr, &obsData);
+        parseContext.fileLoc = obsPtr->fileLoc;
+        ApplyObservation(&obsData, &parseContext);
+        count++;
+
+        if (parseContext.result != LE_OK)
+        {
+            return parseContext.result;
+        }
+    }
+
+    while ((count < maxCount) && (NULL != (linkPtr = le_sls_Pop(&StagedStateList))))
+    {
+        StagedState_t* statePtr = CONTAINER_OF(linkPtr, StagedState_t, link);
+
+        ApplyState(statePtr);
+        le_mem_Release(statePtr->sampleRef);
+        count++;
+    }
+
+    if (le_sls_IsEmpty(&StagedObsList) && le_sls_IsEmpty(&StagedStateList))
+    {
+        return LE_OK;
+    }
+
+    return LE_IN_PROGRESS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Commit the config applied by configService_ApplyStagedConfig(), making the changes that were
+ * left until the whole config had been applied.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_CommitStagedConfig
+(
+    void
+)
+{
+    le_sls_List_t fileOrderList = LE_SLS_LIST_INIT;
+    le_sls_Link_t* linkPtr;
+
+    // The journal is latest first; an observation may appear more than once in the file, so the
+    // changes are made in file order.
+    while (NULL != (linkPtr = le_sls_Pop(&JournalList)))
+    {
+        le_sls_Stack(&fileOrderList, linkPtr);
+    }
+
+    while (NULL != (linkPtr = le_sls_Pop(&fileOrderList)))
+    {
+        JournalEntry_t* jEntryPtr = CONTAINER_OF(linkPtr, JournalEntry_t, link);
+
+        if (jEntryPtr->type != JOURNAL_OBS_CHANGED)
+        {
+            continue;
+        }
+
+        le_result_t result = admin_SetBufferMaxCount(jEntryPtr->path, jEntryPtr->bufferMaxCount);
+        if (result == LE_OK)
+        {
+            result = admin_SetTransform(jEntryPtr->path, jEntryPtr->transform, NULL, 0);
+        }
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to set buffer maxCount or transform for obs %s, error: %s",
+                     jEntryPtr->path,
+                     LE_RESULT_TXT(result));
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Undo the changes made by configService_ApplyStagedConfig(), latest first, putting back the
+ * configuration that was in place before.  Observations that existed before keep their buffered
+ * samples and backups.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_RollbackStagedConfig
+(
+    void
+)
+{
+    le_sls_Link_t* linkPtr;
+    size_t count = 0;
+
+    while (NULL != (linkPtr = le_sls_Pop(&JournalList)))
+    {
+        JournalEntry_t* jEntryPtr = CONTAINER_OF(linkPtr, JournalEntry_t, link);
+
+        switch (jEntryPtr->type)
+        {
+            case JOURNAL_OBS_CREATED:
+                admin_DeleteObs(jEntryPtr->path);
+                break;
+
+            case JOURNAL_OBS_CHANGED:
+                RestoreObservation(jEntryPtr);
+                break;
+
+            case JOURNAL_SOURCE_CHANGED:
+                RestoreSource(jEntryPtr->path, jEntryPtr->source);
+                break;
+        }
+        count++;
+    }
+
+    LE_INFO("Rolled back %" PRIuS " config changes", count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release everything held by the staged configuration.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_ReleaseStagedConfig
+(
+    void
+)
+{
+    le_sls_Link_t* linkPtr;
+
+    StagedObsList = LE_SLS_LIST_INIT;
+    JournalList = LE_SLS_LIST_INIT;
+
+    while (NULL != (linkPtr = le_sls_Pop(&StagedStateList)))
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, StagedState_t, link)->sampleRef);
+    }
+
+    while (NULL != (linkPtr = le_sls_Pop(&StagingChunkList)))
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, StagingChunk_t, link));
+    }
+    StagingChunkCount = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the config parsing and staging module.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void configService_InitParse
+(
+    void
+)
+{
+    StagingChunkPool = le_mem_InitStaticPool(StagingChunkPool, DEFAULT_STAGING_CHUNK_POOL_SIZE,
+                        sizeof(StagingChunk_t));
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Traverse Datahub Tree
@@ -874,12 +1891,22 @@ void configService_TraverseDatahubResourceTree
         underObsTree = true;
     }
 
-    // visit children:
+    // visit children, holding the next sibling as deleting an observation template also deletes
+    // its instances, which may include that sibling:
     resTree_EntryRef_t childEntry = resTree_GetFirstChild(currEntry);
+    if (childEntry)
+    {
+        le_mem_AddRef(childEntry);
+    }
     while(childEntry)
     {
         resTree_EntryRef_t tempEntry = resTree_GetNextSibling(childEntry);
+        if (tempEntry)
+        {
+            le_mem_AddRef(tempEntry);
+        }
         configService_TraverseDatahubResourceTree(childEntry, callbacksPtr, context);
+        le_mem_Release(childEntry);
         childEntry = tempEntry;
     }
 
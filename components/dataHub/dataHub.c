@@ -29,10 +29,26 @@
 #include "resTree.h"
 #include "ioPoint.h"
 #include "obs.h"
+#include "obsTemplate.h"
 #include "ioService.h"
+#include "queryService.h"
 #include "adminService.h"
 #include "snapshot.h"
 #include "configService.h"
+#include "stats.h"
+
+
+/// Thread that runs the Data Hub's services.  Only it uses the cached clock.
+static le_thread_Ref_t MainThreadRef = NULL;
+
+/// Times read from the clock during the current unit of work, if the Is*Valid flags are set.
+static le_clk_Time_t CachedAbsoluteTime;
+static le_clk_Time_t CachedRelativeTime;
+static bool IsAbsoluteTimeValid = false;
+static bool IsRelativeTimeValid = false;
+
+/// true between hub_RefreshClock() and hub_ReleaseClock(), while the cached times can be used.
+static bool IsClockHeld = false;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -46,15 +62,21 @@ COMPONENT_INIT
 void initDataHub(void)
 #endif
 {
+    MainThreadRef = le_thread_GetCurrent();
+
     dataSample_Init();
     handler_Init();
     res_Init();
     ioPoint_Init();
     obs_Init();
+    obsTemplate_Init();
     resTree_Init();
     ioService_Init();
+    queryService_Init();
     adminService_Init();
+    configService_Init();
     snapshot_Init();
+    stats_Init();
 
     LE_INFO("Data Hub started.");
 }
@@ -238,6 +260,118 @@ void* hub_MemAlloc
 #endif
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the cached clock can be used by the calling thread: only by the main thread, and
+ * only within a unit of work started with hub_RefreshClock().
+ *
+ * @return true if the cached clock can be used.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool UseCachedClock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The config staging thread has its own event loop, so reads the clock every time.
+    return (IsClockHeld && (le_thread_GetCurrent() == MainThreadRef));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current absolute (wall clock) time.  While the Data Hub's main thread handles a message
+ * or batch (see hub_RefreshClock()), the clock is read at most once, so that every sample pushed
+ * while handling it is stamped with the same time.  Otherwise, the clock is read every time.
+ *
+ * @return The time.
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t hub_GetAbsoluteTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!UseCachedClock())
+    {
+        return le_clk_GetAbsoluteTime();
+    }
+
+    if (!IsAbsoluteTimeValid)
+    {
+        CachedAbsoluteTime = le_clk_GetAbsoluteTime();
+        IsAbsoluteTimeValid = true;
+    }
+
+    return CachedAbsoluteTime;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative (monotonic) time.  Cached like hub_GetAbsoluteTime().
+ *
+ * @return The time.
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t hub_GetRelativeTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!UseCachedClock())
+    {
+        return le_clk_GetRelativeTime();
+    }
+
+    if (!IsRelativeTimeValid)
+    {
+        CachedRelativeTime = le_clk_GetRelativeTime();
+        IsRelativeTimeValid = true;
+    }
+
+    return CachedRelativeTime;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a unit of work (a message, batch or config chunk) on the main thread: the next
+ * hub_GetAbsoluteTime() and hub_GetRelativeTime() read the clock again, and the times they read
+ * are used until hub_ReleaseClock() is called at the end of the unit of work.
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_RefreshClock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    IsAbsoluteTimeValid = false;
+    IsRelativeTimeValid = false;
+    IsClockHeld = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the unit of work started with hub_RefreshClock(): until the next one, hub_GetAbsoluteTime()
+ * and hub_GetRelativeTime() read the clock every time.
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_ReleaseClock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    IsClockHeld = false;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Is resource Path malformed?
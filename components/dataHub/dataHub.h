@@ -102,6 +102,55 @@ void* hub_MemAlloc
     le_mem_PoolRef_t    pool    ///< [IN] Pool from which the object is to be allocated.
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current absolute (wall clock) time.  While the Data Hub's main thread handles a message
+ * or batch (see hub_RefreshClock()), the clock is read at most once, so that every sample pushed
+ * while handling it is stamped with the same time.  Otherwise, the clock is read every time.
+ *
+ * @return The time.
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t hub_GetAbsoluteTime
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current relative (monotonic) time.  Cached like hub_GetAbsoluteTime().
+ *
+ * @return The time.
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t hub_GetRelativeTime
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a unit of work (a message, batch or config chunk) on the main thread: the next
+ * hub_GetAbsoluteTime() and hub_GetRelativeTime() read the clock again, and the times they read
+ * are used until hub_ReleaseClock() is called at the end of the unit of work.
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_RefreshClock
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End the unit of work started with hub_RefreshClock(): until the next one, hub_GetAbsoluteTime()
+ * and hub_GetRelativeTime() read the clock every time.
+ */
+//--------------------------------------------------------------------------------------------------
+void hub_ReleaseClock
+(
+    void
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Is resource Path malformed?
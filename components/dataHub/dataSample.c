@@ -152,7 +152,7 @@ static inline DataSample_t* CreateSample
 
     if (timestamp == IO_NOW)
     {
-        le_clk_Time_t currentTime = le_clk_GetAbsoluteTime();
+        le_clk_Time_t currentTime = hub_GetAbsoluteTime();
         timestamp = (((double)(currentTime.usec)) / 1000000) + currentTime.sec;
     }
 
@@ -588,3 +588,29 @@ void dataSample_SetTimestamp
 {
     sample->timestamp = timestamp;
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find which string pool the value of a string or JSON Data Sample would be allocated from.
+ *
+ * @return The size class of the block.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_StringSize_t dataSample_GetStringSize
+(
+    size_t len  ///< [IN] Length of the string value, not including the null terminator.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // le_mem_StrDup() takes the smallest block the string and its terminator fit in.
+    if (len < STRING_SMALL_BYTES)
+    {
+        return DATA_SAMPLE_STRING_SMALL;
+    }
+    if (len < STRING_MED_BYTES)
+    {
+        return DATA_SAMPLE_STRING_MED;
+    }
+    return DATA_SAMPLE_STRING_LARGE;
+}
@@ -264,4 +264,31 @@ void dataSample_SetTimestamp
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size classes of the blocks that hold the values of string and JSON Data Samples.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    DATA_SAMPLE_STRING_SMALL,   ///< Block from the small string pool.
+    DATA_SAMPLE_STRING_MED,     ///< Block from the medium string pool.
+    DATA_SAMPLE_STRING_LARGE,   ///< Block from the large string pool.
+}
+dataSample_StringSize_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find which string pool the value of a string or JSON Data Sample would be allocated from.
+ *
+ * @return The size class of the block.
+ */
+//--------------------------------------------------------------------------------------------------
+dataSample_StringSize_t dataSample_GetStringSize
+(
+    size_t len  ///< [IN] Length of the string value, not including the null terminator.
+);
+
+
 #endif // DATA_SAMPLE_H_INCLUDE_GUARD
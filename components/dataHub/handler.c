@@ -10,6 +10,7 @@
 
 #include "dataHub.h"
 #include "handler.h"
+#include "ioService.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -145,6 +146,9 @@ le_result_t handler_Remove
         le_dls_Remove(handlerPtr->listPtr, &handlerPtr->link);
 
         DeleteHandler(handlerPtr);
+
+        // The resource has lost a consumer.
+        ioService_DemandChanged();
     }
     else
     {
@@ -478,6 +478,87 @@ le_result_t ioPoint_DoTypeCoercion
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Coerce an array of values, all of the same Trigger, Boolean or numeric data type, to the data
+ * type of an Input or Output, in place.  Boolean values are held as 0 (false) or non-zero (true)
+ * and come out as 0 or 1; Trigger values are ignored.  Gives the same values as
+ * ioPoint_DoTypeCoercion() would, but without creating and releasing a data sample per value.
+ *
+ * @return
+ *      - LE_OK if the values are now of type toType.
+ *      - LE_UNSUPPORTED if either type is String or JSON (the values are left unchanged).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t ioPoint_CoerceNumbers
+(
+    io_DataType_t toType,       ///< Data type of the Input or Output.
+    io_DataType_t fromType,     ///< Data type of the values.
+    double* valuesPtr,          ///< [INOUT] Values.
+    size_t count                ///< Number of values.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (   (fromType != IO_DATA_TYPE_TRIGGER)
+        && (fromType != IO_DATA_TYPE_BOOLEAN)
+        && (fromType != IO_DATA_TYPE_NUMERIC)  )
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    // Each case is a single pass with no branches in the loop body, so the compiler can vectorize
+    // it.
+    switch (toType)
+    {
+        case IO_DATA_TYPE_TRIGGER:
+            // Triggers have no value.
+            break;
+
+        case IO_DATA_TYPE_BOOLEAN:
+
+            if (fromType == IO_DATA_TYPE_TRIGGER)
+            {
+                // Triggers become false.
+                for (size_t i = 0; i < count; i++)
+                {
+                    valuesPtr[i] = 0;
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    valuesPtr[i] = (valuesPtr[i] != 0);
+                }
+            }
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+
+            if (fromType == IO_DATA_TYPE_TRIGGER)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    valuesPtr[i] = NAN;
+                }
+            }
+            else if (fromType == IO_DATA_TYPE_BOOLEAN)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    valuesPtr[i] = (valuesPtr[i] != 0);
+                }
+            }
+            break;
+
+        default:
+            return LE_UNSUPPORTED;
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
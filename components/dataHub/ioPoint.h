@@ -144,6 +144,27 @@ le_result_t ioPoint_DoTypeCoercion
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Coerce an array of values, all of the same Trigger, Boolean or numeric data type, to the data
+ * type of an Input or Output, in place.  Boolean values are held as 0 (false) or non-zero (true)
+ * and come out as 0 or 1; Trigger values are ignored.  Gives the same values as
+ * ioPoint_DoTypeCoercion() would, but without creating and releasing a data sample per value.
+ *
+ * @return
+ *      - LE_OK if the values are now of type toType.
+ *      - LE_UNSUPPORTED if either type is String or JSON (the values are left unchanged).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t ioPoint_CoerceNumbers
+(
+    io_DataType_t toType,       ///< Data type of the Input or Output.
+    io_DataType_t fromType,     ///< Data type of the values.
+    double* valuesPtr,          ///< [INOUT] Values.
+    size_t count                ///< Number of values.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark an Output resource "optional".  (By default, they are marked "mandatory".)
@@ -9,6 +9,8 @@
 #include "dataHub.h"
 #include "handler.h"
 #include "json.h"
+#include "ioService.h"
+#include "stats.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -34,6 +36,10 @@ UpdateStartEndHandler_t;
 //--------------------------------------------------------------------------------------------------
 static le_dls_List_t UpdateStartEndHandlerList = LE_DLS_LIST_INIT;
 
+/// Number of administrative updates in progress.  Apps are only told when the first one starts
+/// and when the last one ends.
+static unsigned int UpdateDepth = 0;
+
 /// Default number of update handlers.  This can be overridden in the .cdef.
 #define DEFAULT_UPDATE_HANDLER_POOL_SIZE 5
 
@@ -359,7 +365,7 @@ le_result_t io_DeleteResource
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS If Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist.
  *      - LE_FAULT If any other error happened during push.
@@ -375,6 +381,11 @@ le_result_t io_PushTrigger
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A sample stamped IO_NOW gets the time this message is handled, even if other work ran
+    // earlier in the same event loop turn.
+    hub_RefreshClock();
+
+    uint64_t startTime = stats_StartOp();
     resTree_EntryRef_t resRef = FindResource(path);
     le_result_t ret;
     if (resRef == NULL)
@@ -398,6 +409,8 @@ le_result_t io_PushTrigger
             ret = LE_NO_MEMORY;
         }
     }
+    stats_EndOp("io_PushTrigger", resRef, startTime);
+    hub_ReleaseClock();
     return ret;
 }
 
@@ -414,7 +427,7 @@ le_result_t io_PushTrigger
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS If Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist.
  *      - LE_FAULT If any other error happened during push.
@@ -432,6 +445,11 @@ le_result_t io_PushBoolean
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A sample stamped IO_NOW gets the time this message is handled, even if other work ran
+    // earlier in the same event loop turn.
+    hub_RefreshClock();
+
+    uint64_t startTime = stats_StartOp();
     resTree_EntryRef_t resRef = FindResource(path);
     le_result_t ret;
     if (resRef == NULL)
@@ -455,6 +473,8 @@ le_result_t io_PushBoolean
             ret = LE_NO_MEMORY;
         }
     }
+    stats_EndOp("io_PushBoolean", resRef, startTime);
+    hub_ReleaseClock();
     return ret;
 }
 
@@ -471,7 +491,7 @@ le_result_t io_PushBoolean
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS If Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist.
  *      - LE_FAULT If any other error happened during push.
@@ -489,6 +509,11 @@ le_result_t io_PushNumeric
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A sample stamped IO_NOW gets the time this message is handled, even if other work ran
+    // earlier in the same event loop turn.
+    hub_RefreshClock();
+
+    uint64_t startTime = stats_StartOp();
     resTree_EntryRef_t resRef = FindResource(path);
     le_result_t ret;
     if (resRef == NULL)
@@ -512,6 +537,8 @@ le_result_t io_PushNumeric
             ret = LE_NO_MEMORY;
         }
     }
+    stats_EndOp("io_PushNumeric", resRef, startTime);
+    hub_ReleaseClock();
     return ret;
 }
 
@@ -528,7 +555,7 @@ le_result_t io_PushNumeric
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS If Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_NOT_FOUND If the path does not exist.
  *      - LE_FAULT If any other error happened during push.
@@ -546,6 +573,11 @@ le_result_t io_PushString
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A sample stamped IO_NOW gets the time this message is handled, even if other work ran
+    // earlier in the same event loop turn.
+    hub_RefreshClock();
+
+    uint64_t startTime = stats_StartOp();
     resTree_EntryRef_t resRef = FindResource(path);
     le_result_t ret;
     if (resRef == NULL)
@@ -569,6 +601,8 @@ le_result_t io_PushString
             ret = LE_NO_MEMORY;
         }
     }
+    stats_EndOp("io_PushString", resRef, startTime);
+    hub_ReleaseClock();
     return ret;
 }
 
@@ -584,7 +618,7 @@ le_result_t io_PushString
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS If Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS If Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit or JSON is not valid.
  *      - LE_NOT_FOUND If the path does not exist.
  *      - LE_FAULT If any other error happened during push.
@@ -602,6 +636,11 @@ le_result_t io_PushJson
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A sample stamped IO_NOW gets the time this message is handled, even if other work ran
+    // earlier in the same event loop turn.
+    hub_RefreshClock();
+
+    uint64_t startTime = stats_StartOp();
     resTree_EntryRef_t resRef = FindResource(path);
     le_result_t ret;
     if (resRef == NULL)
@@ -630,6 +669,8 @@ le_result_t io_PushJson
         LE_WARN("Rejecting invalid JSON string '%s'.", value);
         ret = LE_BAD_PARAMETER;
     }
+    stats_EndOp("io_PushJson", resRef, startTime);
+    hub_ReleaseClock();
     return ret;
 }
 
@@ -1532,12 +1573,16 @@ void ioService_Init
     UpdateStartEndHandlerPool = le_mem_InitStaticPool(UpdateStartEndHandlerPool,
                                                       DEFAULT_UPDATE_HANDLER_POOL_SIZE,
                                                       sizeof(UpdateStartEndHandler_t));
+
+    ioService_InitIngest();
+    ioService_InitDemand();
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Notify apps that care that administrative changes are about to be performed.
+ * Notify apps that care that administrative changes are about to be performed.  Updates nest, so
+ * apps are only notified of the outermost one.
  *
  * This will result in call-backs to any handlers registered using io_AddUpdateStartEndHandler().
  */
@@ -1548,7 +1593,10 @@ void ioService_StartUpdate
 )
 //--------------------------------------------------------------------------------------------------
 {
-    CallUpdateStartEndHandlers(true);
+    if (UpdateDepth++ == 0)
+    {
+        CallUpdateStartEndHandlers(true);
+    }
 }
 
 
@@ -1566,5 +1614,8 @@ void ioService_EndUpdate
 )
 //--------------------------------------------------------------------------------------------------
 {
-    CallUpdateStartEndHandlers(false);
+    if ((UpdateDepth > 0) && (--UpdateDepth == 0))
+    {
+        CallUpdateStartEndHandlers(false);
+    }
 }
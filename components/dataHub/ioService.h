@@ -48,5 +48,39 @@ void ioService_EndUpdate
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the shared-memory ingest rings and batched pushes.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_InitIngest
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the demand notifications.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_InitDemand
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note that the consumers of some resources may have changed, so the demand handlers need to be
+ * re-evaluated.  They are re-evaluated once, on a later turn of the event loop, however many
+ * changes are made in the meantime.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_DemandChanged
+(
+    void
+);
+
 
 #endif // IO_SERVICE_H_INCLUDE_GUARD
@@ -0,0 +1,281 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file ioService_demand.c
+ *
+ * Demand notifications of the I/O API (see io_AddDemandHandler()).
+ *
+ * Changes to the consumers of resources (push handlers added or removed, sources set or cleared,
+ * minimum periods changed) only flag that the demand may have changed.  The demand of every
+ * registered Input is then re-evaluated once, on the next turn of the event loop, and only the
+ * handlers whose demand actually changed are called.  This keeps a configuration update that
+ * rewires many Observations from generating a notification per change.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "resTree.h"
+#include "ioService.h"
+
+/// Default number of demand handlers.  This can be overridden in the .cdef.
+#define DEFAULT_DEMAND_HANDLER_POOL_SIZE    16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A registered demand handler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Link in the DemandHandlerList.
+    le_msg_SessionRef_t sessionRef;     ///< Client session.
+    resTree_EntryRef_t entryRef;        ///< Resource (referenced).
+    io_DemandHandlerFunc_t callback;    ///< Client's handler function.
+    void* contextPtr;                   ///< Client's context.
+    double period;                      ///< Period last reported.
+    uint32_t consumerCount;             ///< Number of consumers last reported.
+}
+DemandHandler_t;
+
+/// Pool of demand handlers.
+static le_mem_PoolRef_t DemandHandlerPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(DemandHandlerPool,
+                          DEFAULT_DEMAND_HANDLER_POOL_SIZE,
+                          sizeof(DemandHandler_t));
+
+/// Registered demand handlers.
+static le_dls_List_t DemandHandlerList = LE_DLS_LIST_INIT;
+
+/// true if a re-evaluation of the demand is queued for the next event loop turn.
+static bool IsRecomputeQueued = false;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current demand for the resource of a handler.  A resource that has been deleted since
+ * the handler was registered has no consumers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetDemand
+(
+    DemandHandler_t* handlerPtr,
+    double* periodPtr,          ///< [OUT]
+    uint32_t* consumerCountPtr  ///< [OUT]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resTree_IsResource(handlerPtr->entryRef))
+    {
+        *periodPtr = resTree_GetDemandedPeriod(handlerPtr->entryRef, consumerCountPtr);
+    }
+    else
+    {
+        *periodPtr = 0;
+        *consumerCountPtr = 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a demand handler and the resource it holds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteHandler
+(
+    DemandHandler_t* handlerPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Remove(&DemandHandlerList, &handlerPtr->link);
+    le_mem_Release(handlerPtr->entryRef);
+    le_mem_Release(handlerPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Re-evaluate the demand of every registered resource, and call the handlers for which it changed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Recompute
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(param1Ptr);
+    LE_UNUSED(param2Ptr);
+
+    IsRecomputeQueued = false;
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&DemandHandlerList);
+
+    while (linkPtr != NULL)
+    {
+        DemandHandler_t* handlerPtr = CONTAINER_OF(linkPtr, DemandHandler_t, link);
+        double period;
+        uint32_t consumerCount;
+
+        // The callback only sends an event to the client, so cannot change the list.
+        linkPtr = le_dls_PeekNext(&DemandHandlerList, linkPtr);
+
+        GetDemand(handlerPtr, &period, &consumerCount);
+
+        if ((period != handlerPtr->period) || (consumerCount != handlerPtr->consumerCount))
+        {
+            handlerPtr->period = period;
+            handlerPtr->consumerCount = consumerCount;
+
+            handlerPtr->callback(period, consumerCount, handlerPtr->contextPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the demand handlers of a client that disconnected.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(contextPtr);
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&DemandHandlerList);
+
+    while (linkPtr != NULL)
+    {
+        DemandHandler_t* handlerPtr = CONTAINER_OF(linkPtr, DemandHandler_t, link);
+
+        linkPtr = le_dls_PeekNext(&DemandHandlerList, linkPtr);
+
+        if (handlerPtr->sessionRef == sessionRef)
+        {
+            DeleteHandler(handlerPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add handler function for EVENT 'io_Demand'
+ *
+ * The handler is called right away with the current demand, then whenever it changes.
+ */
+//--------------------------------------------------------------------------------------------------
+io_DemandHandlerRef_t io_AddDemandHandler
+(
+    const char* path,
+        ///< [IN] Resource path within the client app's namespace.
+    io_DemandHandlerFunc_t callbackPtr,
+        ///< [IN]
+    void* contextPtr
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_SessionRef_t sessionRef = io_GetClientSessionRef();
+
+    resTree_EntryRef_t entryRef = hub_GetClientNamespace(sessionRef);
+    if (entryRef != NULL)
+    {
+        entryRef = resTree_FindEntry(entryRef, path);
+    }
+    if (   (entryRef == NULL)
+        || (   (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_INPUT)
+            && (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_OUTPUT)))
+    {
+        LE_ERROR("Attempt to register Demand handler on non-existent resource '%s'.", path);
+        return NULL;
+    }
+
+    DemandHandler_t* handlerPtr = hub_MemAlloc(DemandHandlerPool);
+    if (handlerPtr == NULL)
+    {
+        LE_WARN("Cannot add any more demand handlers. Rejecting handler for %s", path);
+        return NULL;
+    }
+
+    // Hold the entry, so the handler never refers to a freed entry.
+    le_mem_AddRef(entryRef);
+
+    handlerPtr->link = LE_DLS_LINK_INIT;
+    handlerPtr->sessionRef = sessionRef;
+    handlerPtr->entryRef = entryRef;
+    handlerPtr->callback = callbackPtr;
+    handlerPtr->contextPtr = contextPtr;
+    GetDemand(handlerPtr, &handlerPtr->period, &handlerPtr->consumerCount);
+
+    le_dls_Queue(&DemandHandlerList, &handlerPtr->link);
+
+    callbackPtr(handlerPtr->period, handlerPtr->consumerCount, contextPtr);
+
+    return (io_DemandHandlerRef_t)handlerPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove handler function for EVENT 'io_Demand'
+ */
+//--------------------------------------------------------------------------------------------------
+void io_RemoveDemandHandler
+(
+    io_DemandHandlerRef_t handlerRef
+        ///< [IN]
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DeleteHandler((DemandHandler_t*)handlerRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note that the consumers of some resources may have changed, so the demand handlers need to be
+ * re-evaluated.  They are re-evaluated once, on a later turn of the event loop, however many
+ * changes are made in the meantime.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_DemandChanged
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsRecomputeQueued && !le_dls_IsEmpty(&DemandHandlerList))
+    {
+        IsRecomputeQueued = true;
+        le_event_QueueFunction(Recompute, NULL, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the demand notifications.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_InitDemand
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DemandHandlerPool = le_mem_InitStaticPool(DemandHandlerPool,
+                                              DEFAULT_DEMAND_HANDLER_POOL_SIZE,
+                                              sizeof(DemandHandler_t));
+
+    le_msg_AddServiceCloseHandler(io_GetServiceRef(), SessionCloseHandler, NULL);
+}
@@ -0,0 +1,909 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file ioService_ingest.c
+ *
+ * Shared-memory ingest rings and batched pushes of the I/O API (see io_OpenIngestRing() and
+ * io_PushBatch()).
+ *
+ * Each client can open one ring.  Records are drained from the ring when the client rings the
+ * doorbell, a bounded batch per event loop turn so that a busy producer cannot starve the other
+ * services, and pushed to their resource exactly as io_PushNumeric() and friends would.
+ *
+ * The handles used in ring records and batches belong to the client session, not to its ring, so
+ * a client can push batches without opening a ring.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "dataSample.h"
+#include "resTree.h"
+#include "ioPoint.h"
+#include "ioService.h"
+#include "stats.h"
+
+#if LE_CONFIG_LINUX
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+/// Default number of open ingest rings.  This can be overridden in the .cdef.
+#define DEFAULT_INGEST_RING_POOL_SIZE       2
+
+/// Default number of clients that can hold handles.  This can be overridden in the .cdef.
+#define DEFAULT_HANDLE_TABLE_POOL_SIZE      4
+
+/// Number of resources a client can get handles for.
+#define DEFAULT_INGEST_HANDLE_COUNT         256
+
+/// Maximum number of records pushed per event loop turn.
+#define INGEST_BATCH_RECORDS                256
+
+/// Longest time before its batch a record is taken to have been pushed, in seconds.  Records with
+/// older timestamps are taken to have been pushed this long before their batch.
+#define MAX_RECORD_AGE_SEC                  10
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A record in an ingest ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t handle;        ///< Handle from io_GetIngestHandle().
+    uint8_t type;           ///< io_DataType_t.
+    uint8_t reserved[3];    ///< Reserved (0).
+    double timestamp;       ///< Timestamp, or IO_NOW.
+    double value;           ///< Value.
+}
+IngestRecord_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of an ingest ring, followed by the record slots.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t head;                  ///< Records written by the client.
+    uint8_t pad1[IO_INGEST_TAIL_OFFSET - IO_INGEST_HEAD_OFFSET - sizeof(uint32_t)];
+    uint32_t tail;                  ///< Records consumed by the Data Hub.
+    uint8_t pad2[IO_INGEST_WAITING_OFFSET - IO_INGEST_TAIL_OFFSET - sizeof(uint32_t)];
+    uint32_t waiting;               ///< Non-zero while the Data Hub waits for the doorbell.
+    uint32_t count;                 ///< Number of record slots.
+    uint8_t pad3[IO_INGEST_RECORDS_OFFSET - IO_INGEST_COUNT_OFFSET - sizeof(uint32_t)];
+    IngestRecord_t records[];       ///< Record slots.
+}
+IngestRing_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A client's ingest ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Link in the RingList.
+    le_msg_SessionRef_t sessionRef;     ///< Client session.
+    IngestRing_t* ringPtr;              ///< Shared memory.
+    size_t ringBytes;                   ///< Size of the shared memory.
+    uint32_t count;                     ///< Number of record slots (not trusted from the ring).
+    int doorbell;                       ///< Data Hub's end of the doorbell.
+    le_fdMonitor_Ref_t monitor;         ///< Doorbell monitor.
+    bool drainQueued;                   ///< A drain is queued for the next loop turn.
+    bool closed;                        ///< Ring was closed while a drain was queued.
+    uint32_t droppedCount;              ///< Records dropped since the last report.
+}
+Ingest_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The handles given out to a client.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Link in the HandleTableList.
+    le_msg_SessionRef_t sessionRef;     ///< Client session.
+    uint32_t count;                     ///< Number of handles given out.
+    resTree_EntryRef_t entries[DEFAULT_INGEST_HANDLE_COUNT]; ///< Resources (each referenced).
+}
+HandleTable_t;
+
+/// Pool of ingest rings.
+static le_mem_PoolRef_t IngestPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(IngestPool, DEFAULT_INGEST_RING_POOL_SIZE, sizeof(Ingest_t));
+
+/// Open ingest rings.
+static le_dls_List_t RingList = LE_DLS_LIST_INIT;
+
+/// Pool of handle tables.
+static le_mem_PoolRef_t HandleTablePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(HandleTablePool, DEFAULT_HANDLE_TABLE_POOL_SIZE, sizeof(HandleTable_t));
+
+/// Handle tables of the clients that got handles.
+static le_dls_List_t HandleTableList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the ingest ring of a client.
+ *
+ * @return Pointer to the ring, or NULL if the client has none open.
+ */
+//--------------------------------------------------------------------------------------------------
+static Ingest_t* FindIngest
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&RingList);
+
+    while (linkPtr != NULL)
+    {
+        Ingest_t* ingestPtr = CONTAINER_OF(linkPtr, Ingest_t, link);
+
+        if (ingestPtr->sessionRef == sessionRef)
+        {
+            return ingestPtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&RingList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the handle table of a client.
+ *
+ * @return Pointer to the table, or NULL if the client has not got any handles.
+ */
+//--------------------------------------------------------------------------------------------------
+static HandleTable_t* FindHandleTable
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&HandleTableList);
+
+    while (linkPtr != NULL)
+    {
+        HandleTable_t* tablePtr = CONTAINER_OF(linkPtr, HandleTable_t, link);
+
+        if (tablePtr->sessionRef == sessionRef)
+        {
+            return tablePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&HandleTableList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a client's handle table and the resources it holds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FreeHandleTable
+(
+    HandleTable_t* tablePtr
+)
+{
+    for (uint32_t i = 0; i < tablePtr->count; i++)
+    {
+        le_mem_Release(tablePtr->entries[i]);
+    }
+
+    le_dls_Remove(&HandleTableList, &tablePtr->link);
+    le_mem_Release(tablePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the resource a record is for.
+ *
+ * @return The resource, or NULL if the handle is unknown, its resource was deleted, or the
+ *         record's data type is not supported.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t GetRecordEntry
+(
+    HandleTable_t* tablePtr,        ///< Client's handles (NULL if it has none).
+    const IngestRecord_t* recordPtr
+)
+{
+    if (   (tablePtr == NULL)
+        || (recordPtr->handle >= tablePtr->count)
+        || (   (recordPtr->type != IO_DATA_TYPE_TRIGGER)
+            && (recordPtr->type != IO_DATA_TYPE_BOOLEAN)
+            && (recordPtr->type != IO_DATA_TYPE_NUMERIC)))
+    {
+        return NULL;
+    }
+
+    resTree_EntryRef_t entryRef = tablePtr->entries[recordPtr->handle];
+    admin_EntryType_t entryType = resTree_GetEntryType(entryRef);
+
+    if ((entryType != ADMIN_ENTRY_TYPE_INPUT) && (entryType != ADMIN_ENTRY_TYPE_OUTPUT))
+    {
+        // Deleted by the client since the handle was given out.
+        return NULL;
+    }
+
+    return entryRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time a record was pushed by its client, from its timestamp, so that time based filters
+ * (e.g., minPeriod) see the records of a batch arriving as they were taken rather than all at once.
+ *
+ * @return The time (relative clock).
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t GetRecordPushTime
+(
+    double timestamp,           ///< Record's timestamp, or IO_NOW.
+    double now,                 ///< Time the batch arrived (seconds since the Epoch).
+    le_clk_Time_t relativeNow   ///< Time the batch arrived (relative clock).
+)
+{
+    double age = now - timestamp;
+
+    if ((timestamp == IO_NOW) || !(age > 0))
+    {
+        return relativeNow;
+    }
+    if (age > MAX_RECORD_AGE_SEC)
+    {
+        age = MAX_RECORD_AGE_SEC;
+    }
+    if (age > relativeNow.sec)
+    {
+        age = relativeNow.sec;
+    }
+
+    le_clk_Time_t ageTime = { .sec = (time_t)age };
+    ageTime.usec = (long)((age - ageTime.sec) * 1000000);
+
+    return le_clk_Sub(relativeNow, ageTime);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of records to their resources.
+ *
+ * The values are coerced to the data types of their resources before the data samples are
+ * created, one pass over each run of records of the same type going to resources of the same
+ * type (usually the whole batch), rather than one sample being created, coerced into another and
+ * released per record.
+ *
+ * @return
+ *  - LE_OK if all the records were pushed (or dropped).
+ *  - LE_IN_PROGRESS if some records are held back until a configuration update is complete.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushRecords
+(
+    HandleTable_t* tablePtr,            ///< Client's handles (NULL if it has none).
+    const IngestRecord_t* recordsPtr,
+    size_t count,                       ///< Number of records (at most INGEST_BATCH_RECORDS).
+    uint32_t* droppedCountPtr           ///< [INOUT] Incremented for each record not pushed.
+)
+{
+    resTree_EntryRef_t entries[INGEST_BATCH_RECORDS];
+    io_DataType_t types[INGEST_BATCH_RECORDS];
+    double values[INGEST_BATCH_RECORDS];
+    bool isHeldBack = false;
+
+    LE_ASSERT(count <= INGEST_BATCH_RECORDS);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        entries[i] = GetRecordEntry(tablePtr, &recordsPtr[i]);
+        types[i] = recordsPtr[i].type;
+        values[i] = recordsPtr[i].value;
+    }
+
+    // Coerce each run of records that have the same data type and go to resources of the same
+    // data type.  Runs going to String or JSON resources are left to resTree_Push().
+    for (size_t i = 0; i < count; )
+    {
+        if (entries[i] == NULL)
+        {
+            i++;
+            continue;
+        }
+
+        io_DataType_t toType = resTree_GetIoDataType(entries[i]);
+        size_t end = i + 1;
+
+        while (   (end < count)
+               && (entries[end] != NULL)
+               && (types[end] == types[i])
+               && (resTree_GetIoDataType(entries[end]) == toType))
+        {
+            end++;
+        }
+
+        if (ioPoint_CoerceNumbers(toType, types[i], &values[i], end - i) == LE_OK)
+        {
+            for (size_t j = i; j < end; j++)
+            {
+                types[j] = toType;
+            }
+        }
+
+        i = end;
+    }
+
+    le_clk_Time_t absoluteNow = hub_GetAbsoluteTime();
+    double now = (double)absoluteNow.sec + ((double)absoluteNow.usec / 1000000);
+    le_clk_Time_t relativeNow = hub_GetRelativeTime();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (entries[i] == NULL)
+        {
+            (*droppedCountPtr)++;
+            continue;
+        }
+
+        double timestamp = recordsPtr[i].timestamp;
+        dataSample_Ref_t sampleRef;
+        le_clk_Time_t pushTime = GetRecordPushTime(timestamp, now, relativeNow);
+
+        switch (types[i])
+        {
+            case IO_DATA_TYPE_TRIGGER:
+                sampleRef = dataSample_CreateTrigger(timestamp);
+                break;
+
+            case IO_DATA_TYPE_BOOLEAN:
+                sampleRef = dataSample_CreateBoolean(timestamp, (values[i] != 0));
+                break;
+
+            default:
+                sampleRef = dataSample_CreateNumeric(timestamp, values[i]);
+                break;
+        }
+
+        res_SetPushTime(&pushTime);
+        le_result_t result = (sampleRef == NULL ? LE_NO_MEMORY
+                                                : resTree_Push(entries[i], types[i], sampleRef));
+        res_SetPushTime(NULL);
+
+        // Records held back for a configuration update are pushed once it completes.
+        if (result == LE_IN_PROGRESS)
+        {
+            isHeldBack = true;
+        }
+        else if (result != LE_OK)
+        {
+            (*droppedCountPtr)++;
+        }
+    }
+
+    return (isHeldBack ? LE_IN_PROGRESS : LE_OK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push up to one batch of records from a ring.
+ *
+ * @return true if records remain in the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DrainBatch
+(
+    Ingest_t* ingestPtr
+)
+{
+    IngestRing_t* ringPtr = ingestPtr->ringPtr;
+    uint32_t mask = ingestPtr->count - 1;
+    uint32_t tail = ringPtr->tail;
+    uint32_t head = __atomic_load_n(&ringPtr->head, __ATOMIC_ACQUIRE);
+
+    if (head - tail > ingestPtr->count)
+    {
+        LE_ERROR("Corrupt ingest ring (head %" PRIu32 ", tail %" PRIu32 "), resetting",
+                 head,
+                 tail);
+        __atomic_store_n(&ringPtr->tail, head, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    uint32_t end = ((head - tail) > INGEST_BATCH_RECORDS ? tail + INGEST_BATCH_RECORDS : head);
+    IngestRecord_t records[INGEST_BATCH_RECORDS];
+    size_t count = 0;
+
+    // Records stamped IO_NOW in this batch all get the same time.
+    hub_RefreshClock();
+
+    // Copy the records first, so the client cannot change them while they are being used.
+    for (; tail != end; tail++)
+    {
+        records[count++] = ringPtr->records[tail & mask];
+    }
+
+    uint64_t startTime = stats_StartOp();
+    (void)PushRecords(FindHandleTable(ingestPtr->sessionRef),
+                      records,
+                      count,
+                      &ingestPtr->droppedCount);
+    stats_EndOp("ingest drain", NULL, startTime);
+    hub_ReleaseClock();
+
+    // Give the slots back to the client.
+    __atomic_store_n(&ringPtr->tail, tail, __ATOMIC_RELEASE);
+
+    if (ingestPtr->droppedCount > 0)
+    {
+        LE_WARN("Dropped %" PRIu32 " ingest records", ingestPtr->droppedCount);
+        ingestPtr->droppedCount = 0;
+    }
+
+    if (tail != head)
+    {
+        return true;
+    }
+
+    // Ask for the doorbell, then check again in case the client wrote a record before seeing
+    // the flag.
+    __atomic_store_n(&ringPtr->waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ringPtr->head, __ATOMIC_SEQ_CST) != tail)
+    {
+        __atomic_store_n(&ringPtr->waiting, 0, __ATOMIC_SEQ_CST);
+        return true;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a ring and the resources it holds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FreeIngest
+(
+    Ingest_t* ingestPtr
+)
+{
+    munmap(ingestPtr->ringPtr, ingestPtr->ringBytes);
+    le_mem_Release(ingestPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drain queued by the doorbell handler when a batch did not empty the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueuedDrain
+(
+    void* param1Ptr,    ///< Ring.
+    void* param2Ptr     ///< Unused.
+)
+{
+    Ingest_t* ingestPtr = param1Ptr;
+    LE_UNUSED(param2Ptr);
+
+    ingestPtr->drainQueued = false;
+
+    if (ingestPtr->closed)
+    {
+        // Ring was closed while the drain was queued.
+        FreeIngest(ingestPtr);
+        return;
+    }
+
+    if (DrainBatch(ingestPtr))
+    {
+        ingestPtr->drainQueued = true;
+        le_event_QueueFunction(QueuedDrain, ingestPtr, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Doorbell handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DoorbellHandler
+(
+    int fd,
+    short events
+)
+{
+    Ingest_t* ingestPtr = le_fdMonitor_GetContextPtr();
+
+    if (events & POLLIN)
+    {
+        uint64_t rings;
+        if (read(fd, &rings, sizeof(rings)) < 0)
+        {
+            LE_DEBUG("Doorbell read failed (errno: %d)", errno);
+        }
+
+        if ((!ingestPtr->drainQueued) && DrainBatch(ingestPtr))
+        {
+            ingestPtr->drainQueued = true;
+            le_event_QueueFunction(QueuedDrain, ingestPtr, NULL);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a ring, pushing the records it still holds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseIngest
+(
+    Ingest_t* ingestPtr
+)
+{
+    while (DrainBatch(ingestPtr))
+    {
+    }
+
+    le_dls_Remove(&RingList, &ingestPtr->link);
+    le_fdMonitor_Delete(ingestPtr->monitor);
+    close(ingestPtr->doorbell);
+
+    if (ingestPtr->drainQueued)
+    {
+        // The queued drain will release the ring.
+        ingestPtr->closed = true;
+    }
+    else
+    {
+        FreeIngest(ingestPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the ring and release the handles of a client that disconnected.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    Ingest_t* ingestPtr = FindIngest(sessionRef);
+
+    if (ingestPtr != NULL)
+    {
+        // Pushes the records still in the ring, so must be done before the handles are released.
+        CloseIngest(ingestPtr);
+    }
+
+    HandleTable_t* tablePtr = FindHandleTable(sessionRef);
+
+    if (tablePtr != NULL)
+    {
+        FreeHandleTable(tablePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a shared-memory ingest ring for this client.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_DUPLICATE if the client already has a ring open.
+ *  - LE_OUT_OF_RANGE if recordCount is 0, not a power of 2, or more than IO_MAX_INGEST_RECORDS.
+ *  - LE_NO_MEMORY if too many rings are open.
+ *  - LE_FAULT if the ring or the doorbell could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_OpenIngestRing
+(
+    uint32_t recordCount,   ///< [IN] Number of record slots (a power of 2).
+    int* ringPtr,           ///< [OUT] Shared memory holding the ring.
+    int* doorbellPtr        ///< [OUT] Eventfd to wake up the Data Hub.
+)
+{
+    le_msg_SessionRef_t sessionRef = io_GetClientSessionRef();
+
+    *ringPtr = -1;
+    *doorbellPtr = -1;
+
+    if (   (recordCount == 0)
+        || ((recordCount & (recordCount - 1)) != 0)
+        || (recordCount > IO_MAX_INGEST_RECORDS))
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    if (FindIngest(sessionRef) != NULL)
+    {
+        return LE_DUPLICATE;
+    }
+
+    Ingest_t* ingestPtr = hub_MemAlloc(IngestPool);
+    if (ingestPtr == NULL)
+    {
+        return LE_NO_MEMORY;
+    }
+
+    size_t ringBytes = IO_INGEST_RECORDS_OFFSET + (size_t)recordCount * IO_INGEST_RECORD_BYTES;
+    int ringFd = memfd_create("dataHubIngest", MFD_CLOEXEC);
+    int doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    void* mapPtr = MAP_FAILED;
+
+    if ((ringFd >= 0) && (ftruncate(ringFd, ringBytes) == 0))
+    {
+        mapPtr = mmap(NULL, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED, ringFd, 0);
+    }
+
+    // The client gets its own copy of the doorbell, as the one sent is closed once sent.
+    *doorbellPtr = (doorbell >= 0 ? dup(doorbell) : -1);
+
+    if ((mapPtr == MAP_FAILED) || (*doorbellPtr < 0))
+    {
+        LE_ERROR("Failed to create ingest ring of %" PRIu32 " records (errno: %d)",
+                 recordCount,
+                 errno);
+        if (mapPtr != MAP_FAILED)
+        {
+            munmap(mapPtr, ringBytes);
+        }
+        if (ringFd >= 0)
+        {
+            close(ringFd);
+        }
+        if (doorbell >= 0)
+        {
+            close(doorbell);
+        }
+        if (*doorbellPtr >= 0)
+        {
+            close(*doorbellPtr);
+            *doorbellPtr = -1;
+        }
+        le_mem_Release(ingestPtr);
+        return LE_FAULT;
+    }
+
+    // The shared memory is zero-filled, so only the slot count needs to be set.
+    ingestPtr->ringPtr = mapPtr;
+    ingestPtr->ringPtr->count = recordCount;
+    ingestPtr->ringPtr->waiting = 1;
+
+    ingestPtr->link = LE_DLS_LINK_INIT;
+    ingestPtr->sessionRef = sessionRef;
+    ingestPtr->ringBytes = ringBytes;
+    ingestPtr->count = recordCount;
+    ingestPtr->doorbell = doorbell;
+    ingestPtr->drainQueued = false;
+    ingestPtr->closed = false;
+    ingestPtr->droppedCount = 0;
+
+    ingestPtr->monitor = le_fdMonitor_Create("Ingest", doorbell, DoorbellHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(ingestPtr->monitor, ingestPtr);
+
+    le_dls_Queue(&RingList, &ingestPtr->link);
+
+    *ringPtr = ringFd;
+
+    LE_INFO("Opened ingest ring of %" PRIu32 " records", recordCount);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the handle identifying one of the client's Inputs or Outputs in ingest ring records and in
+ * io_PushBatch().
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the resource does not exist.
+ *  - LE_NO_MEMORY if the client has no more handles.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_GetIngestHandle
+(
+    const char* path,       ///< [IN] Resource path within the client app's namespace.
+    uint32_t* handlePtr     ///< [OUT] Handle of the resource.
+)
+{
+    le_msg_SessionRef_t sessionRef = io_GetClientSessionRef();
+
+    resTree_EntryRef_t entryRef = hub_GetClientNamespace(sessionRef);
+    if (entryRef != NULL)
+    {
+        entryRef = resTree_FindEntry(entryRef, path);
+    }
+    if (   (entryRef == NULL)
+        || (   (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_INPUT)
+            && (resTree_GetEntryType(entryRef) != ADMIN_ENTRY_TYPE_OUTPUT)))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    HandleTable_t* tablePtr = FindHandleTable(sessionRef);
+
+    if (tablePtr == NULL)
+    {
+        tablePtr = hub_MemAlloc(HandleTablePool);
+        if (tablePtr == NULL)
+        {
+            return LE_NO_MEMORY;
+        }
+
+        tablePtr->link = LE_DLS_LINK_INIT;
+        tablePtr->sessionRef = sessionRef;
+        tablePtr->count = 0;
+        le_dls_Queue(&HandleTableList, &tablePtr->link);
+    }
+
+    for (uint32_t i = 0; i < tablePtr->count; i++)
+    {
+        if (tablePtr->entries[i] == entryRef)
+        {
+            *handlePtr = i;
+            return LE_OK;
+        }
+    }
+
+    if (tablePtr->count >= NUM_ARRAY_MEMBERS(tablePtr->entries))
+    {
+        return LE_NO_MEMORY;
+    }
+
+    // Hold the entry, so a handle never refers to a freed entry.
+    le_mem_AddRef(entryRef);
+    tablePtr->entries[tablePtr->count] = entryRef;
+    *handlePtr = tablePtr->count++;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the client's ingest ring.  Records still in the ring are pushed first.  Does nothing if
+ * the client has no ring open.
+ */
+//--------------------------------------------------------------------------------------------------
+void io_CloseIngestRing
+(
+    void
+)
+{
+    Ingest_t* ingestPtr = FindIngest(io_GetClientSessionRef());
+
+    if (ingestPtr != NULL)
+    {
+        CloseIngest(ingestPtr);
+    }
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a batch of Trigger, Boolean and numeric samples.
+ *
+ * @return
+ *  - LE_OK if all samples were pushed.
+ *  - LE_IN_PROGRESS if some samples are held back until a configuration update is complete.
+ *  - LE_BAD_PARAMETER if the arrays are not all the same size.
+ *  - LE_FAULT if some samples were dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t io_PushBatch
+(
+    const uint32_t* handlesPtr,     ///< [IN] Handles, from io_GetIngestHandle().
+    size_t handlesSize,             ///< [IN]
+    const uint8_t* typesPtr,        ///< [IN] Data types.
+    size_t typesSize,               ///< [IN]
+    const double* timestampsPtr,    ///< [IN] Timestamps, or IO_NOW.
+    size_t timestampsSize,          ///< [IN]
+    const double* valuesPtr,        ///< [IN] Values.
+    size_t valuesSize               ///< [IN]
+)
+{
+    // The IPC layer already limits the arrays to IO_MAX_BATCH_SAMPLES.
+    if (   (typesSize != handlesSize) || (timestampsSize != handlesSize)
+        || (valuesSize != handlesSize) || (handlesSize > IO_MAX_BATCH_SAMPLES))
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    IngestRecord_t records[IO_MAX_BATCH_SAMPLES];
+    uint32_t droppedCount = 0;
+
+    // Samples stamped IO_NOW in this batch all get the same time.
+    hub_RefreshClock();
+
+    for (size_t i = 0; i < handlesSize; i++)
+    {
+        records[i] = (IngestRecord_t)
+        {
+            .handle = handlesPtr[i],
+            .type = typesPtr[i],
+            .timestamp = timestampsPtr[i],
+            .value = valuesPtr[i]
+        };
+    }
+
+    uint64_t startTime = stats_StartOp();
+    bool isHeldBack = (PushRecords(FindHandleTable(io_GetClientSessionRef()),
+                                   records,
+                                   handlesSize,
+                                   &droppedCount) == LE_IN_PROGRESS);
+    stats_EndOp("io_PushBatch", NULL, startTime);
+    hub_ReleaseClock();
+
+    if (droppedCount > 0)
+    {
+        LE_WARN("Dropped %" PRIu32 " of %" PRIuS " batched samples", droppedCount, handlesSize);
+        return LE_FAULT;
+    }
+
+    return (isHeldBack ? LE_IN_PROGRESS : LE_OK);
+}
+
+#endif /* end LE_CONFIG_LINUX */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the ingest rings and batched pushes.  Rings need shared memory and eventfds, so they
+ * are only available on Linux; the RTOS build uses the lite io API, which has neither.
+ */
+//--------------------------------------------------------------------------------------------------
+void ioService_InitIngest
+(
+    void
+)
+{
+#if LE_CONFIG_LINUX
+    // The ring layout is part of the io API, so it must match the offsets published there.
+    static_assert(sizeof(IngestRecord_t) == IO_INGEST_RECORD_BYTES, "Bad ingest record size");
+    static_assert(offsetof(IngestRing_t, tail) == IO_INGEST_TAIL_OFFSET, "Bad tail offset");
+    static_assert(offsetof(IngestRing_t, waiting) == IO_INGEST_WAITING_OFFSET,
+                  "Bad waiting offset");
+    static_assert(offsetof(IngestRing_t, count) == IO_INGEST_COUNT_OFFSET, "Bad count offset");
+    static_assert(offsetof(IngestRing_t, records) == IO_INGEST_RECORDS_OFFSET,
+                  "Bad records offset");
+
+    IngestPool = le_mem_InitStaticPool(IngestPool,
+                                       DEFAULT_INGEST_RING_POOL_SIZE,
+                                       sizeof(Ingest_t));
+    HandleTablePool = le_mem_InitStaticPool(HandleTablePool,
+                                            DEFAULT_HANDLE_TABLE_POOL_SIZE,
+                                            sizeof(HandleTable_t));
+
+    le_msg_AddServiceCloseHandler(io_GetServiceRef(), SessionCloseHandler, NULL);
+#endif
+}
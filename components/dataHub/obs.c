@@ -41,6 +41,7 @@
 #include "json.h"
 #include "obs.h"
 #include "configService.h"
+#include "stats.h"
 
 #if LE_CONFIG_LINUX
 #   include <ftw.h>
@@ -69,17 +70,35 @@
 #define DEFAULT_BUFFER_ENTRY_POOL_SIZE      5
 /// Default number of read operations.  This can be overridden in the .cdef.
 #define DEFAULT_READ_OPERATION_POOL_SIZE    2
-
-/// Observation Resource.  Allocated from the Observation Pool.
+/// Default number of observation settings blocks.  This can be overridden in the .cdef.
+#define DEFAULT_OBS_SETTINGS_POOL_SIZE      DEFAULT_OBSERVATION_POOL_SIZE
+/// Default number of backup directories remembered for clean-up.  This can be overridden in the
+/// .cdef.
+#define DEFAULT_BACKUP_DIR_POOL_SIZE        4
+
+/// Filter settings of an Observation.  Allocated from the Settings Pool.  The instances of an
+/// Observation template share the template's block until a setting is changed on the instance.
 typedef struct
 {
-    res_Resource_t resource;    ///< The base class (MUST BE FIRST).
-
     double highLimit; ///< Filter deadband/liveband high limit; NAN = disabled.
     double lowLimit;  ///< Filter deadband/liveband low limit; NAN = disabled.
     double changeBy;  ///< Drop values that differ by less than this from current; NAN/0 = disabled.
 
     double minPeriod; ///< Min number of seconds before accepting another value; NAN/0 = disabled.
+
+    char jsonExtraction[ADMIN_MAX_JSON_EXTRACTOR_LEN + 1]; ///< JSON extraction specifier (or "").
+}
+Settings_t;
+
+/// Observation Resource.  Allocated from the Observation Pool.
+typedef struct
+{
+    res_Resource_t resource;    ///< The base class (MUST BE FIRST).
+
+    Settings_t* settingsPtr;  ///< Filter settings (reference counted).
+    bool sharesSettings;      ///< settingsPtr is the block of the template this is an instance of.
+    resTree_EntryRef_t templateEntry; ///< Template this is an instance of (NULL = none).
+
     uint32_t lastPushTime; ///< Time at which last push was accepted (ms, relative clock).
 
     obs_TransformType_t transformType; ///< Buffer transform type
@@ -97,8 +116,10 @@ typedef struct
 
     le_dls_List_t readOpList; ///< List of ongoing Read Operations on the buffered samples.
 
-    char jsonExtraction[ADMIN_MAX_JSON_EXTRACTOR_LEN + 1]; ///< JSON extraction specifier (or "").
-    char destination[CONFIG_MAX_DESTINATION_NAME_BYTES];   ///< Destination name string
+    configService_DestinationRef_t destinationRef; ///< Destination (NULL = none).
+    char srcPath[CONFIG_MAX_DESTINATION_SRC_BYTES]; ///< Cached source path + JSON extraction
+                                                    /// reported to the destination ("" = stale).
+    uint32_t configFingerprint; ///< Fingerprint of the config file settings last applied (or 0).
 }
 Observation_t;
 
@@ -149,6 +170,10 @@ ReadOperation_t;
 static le_mem_PoolRef_t ObservationPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(ObservationPool, DEFAULT_OBSERVATION_POOL_SIZE, sizeof(Observation_t));
 
+/// Pool of Settings objects.
+static le_mem_PoolRef_t SettingsPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(SettingsPool, DEFAULT_OBS_SETTINGS_POOL_SIZE, sizeof(Settings_t));
+
 /// Pool of Buffer Entry objects.
 static le_mem_PoolRef_t BufferEntryPool = NULL;
 LE_MEM_DEFINE_STATIC_POOL(BufferEntryPool, DEFAULT_BUFFER_ENTRY_POOL_SIZE, sizeof(BufferEntry_t));
@@ -159,10 +184,34 @@ LE_MEM_DEFINE_STATIC_POOL(ReadOperationPool,
                           DEFAULT_READ_OPERATION_POOL_SIZE,
                           sizeof(ReadOperation_t));
 
+#if LE_CONFIG_LINUX
+/// Directory under BACKUP_DIR that held a backup file that has been deleted, and may have to be
+/// removed once empty.  Allocated from the Backup Dir Pool.
+typedef struct
+{
+    le_sls_Link_t link;                         ///< Link in the BackupDirList.
+    char path[MAX_BACKUP_FILE_PATH_BYTES];      ///< Path of the directory.
+}
+BackupDir_t;
+
+/// Pool of Backup Dir objects.
+static le_mem_PoolRef_t BackupDirPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(BackupDirPool, DEFAULT_BACKUP_DIR_POOL_SIZE, sizeof(BackupDir_t));
+
+/// Directories to check at the next clean-up of the backup files.
+static le_sls_List_t BackupDirList = LE_SLS_LIST_INIT;
+
+/// true if the next clean-up must walk the whole backup directory: the first time, to delete
+/// backups left behind by Observations that no longer exist, and whenever a deleted backup could
+/// not be remembered.
+static bool IsBackupDirWalkNeeded = true;
+#endif /* end LE_CONFIG_LINUX */
+
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the relative time in milliseconds.
+ * Get the time the sample being pushed was pushed, in milliseconds.  For a sample held back during
+ * an administrative update, that is when it was first pushed, not when it is replayed.
  *
  * @return the relative time (ms).
  */
@@ -173,7 +222,7 @@ static uint32_t GetRelativeTimeMs
 )
 //--------------------------------------------------------------------------------------------------
 {
-    le_clk_Time_t structuredTime = le_clk_GetRelativeTime();
+    le_clk_Time_t structuredTime = res_GetPushTime();
 
     return (structuredTime.sec * 1000 + structuredTime.usec / 1000);
 }
@@ -223,6 +272,46 @@ static le_result_t GetBackupFilePath
 }
 
 
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remember the directory of a deleted backup file, so that it can be removed by the next clean-up
+ * if it is left empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RememberBackupDir
+(
+    const char* filePath    ///< Path of the deleted backup file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t dirLen = strrchr(filePath, '/') - filePath;
+
+    le_sls_Link_t* linkPtr = le_sls_Peek(&BackupDirList);
+    while (linkPtr != NULL)
+    {
+        BackupDir_t* dirPtr = CONTAINER_OF(linkPtr, BackupDir_t, link);
+        if ((strncmp(dirPtr->path, filePath, dirLen) == 0) && (dirPtr->path[dirLen] == '\0'))
+        {
+            return;
+        }
+        linkPtr = le_sls_PeekNext(&BackupDirList, linkPtr);
+    }
+
+    BackupDir_t* dirPtr = le_mem_TryAlloc(BackupDirPool);
+    if (dirPtr == NULL)
+    {
+        IsBackupDirWalkNeeded = true;
+        return;
+    }
+    memcpy(dirPtr->path, filePath, dirLen);
+    dirPtr->path[dirLen] = '\0';
+    dirPtr->link = LE_SLS_LINK_INIT;
+    le_sls_Queue(&BackupDirList, &dirPtr->link);
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete the observation's buffer backup file, if it exists.
@@ -238,8 +327,20 @@ static void DeleteBackup
     le_result_t result = GetBackupFilePath(path, sizeof(path), obsPtr);
     if (result == LE_OK)
     {
-        unlink(path);
+        if (unlink(path) == 0)
+        {
+#if LE_CONFIG_LINUX
+            RememberBackupDir(path);
+#endif
+        }
+    }
+#if LE_CONFIG_LINUX
+    else
+    {
+        // Can't tell which file it was, so leave it to a walk of the whole backup directory.
+        IsBackupDirWalkNeeded = true;
     }
+#endif
 }
 
 
@@ -328,6 +429,15 @@ static void ObservationDestructor
                 LE_COMM_ERROR);
     }
 
+    if (obsPtr->destinationRef != NULL)
+    {
+        configService_ReleaseDestination(obsPtr->destinationRef);
+        obsPtr->destinationRef = NULL;
+    }
+
+    le_mem_Release(obsPtr->settingsPtr);
+    obsPtr->settingsPtr = NULL;
+
     res_Destruct(&obsPtr->resource);
 }
 
@@ -1244,10 +1354,10 @@ error:
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform a backup to non-volatile storage of an observation's data sample buffer.
+ * Write an observation's data sample buffer to non-volatile storage.
  */
 //--------------------------------------------------------------------------------------------------
-static void Backup
+static void WriteBackup
 (
     Observation_t* obsPtr
 )
@@ -1261,7 +1371,7 @@ static void Backup
     }
 
     // Update the time of last backup.
-    le_clk_Time_t now = le_clk_GetRelativeTime();
+    le_clk_Time_t now = hub_GetRelativeTime();
     obsPtr->lastBackupTime = now.sec;
 
 #if LE_CONFIG_FILESYSTEM
@@ -1346,6 +1456,26 @@ static void Backup
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Perform a backup to non-volatile storage of an observation's data sample buffer.  Large buffers
+ * can take a while, so this is timed as a slow operation candidate.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Backup
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t startTime = stats_StartOp();
+
+    WriteBackup(obsPtr);
+
+    stats_EndOp("backup", res_GetResTreeEntry(&obsPtr->resource), startTime);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Disable backups of a given Observation's data sample buffer.
@@ -1409,6 +1539,9 @@ void obs_Init
                         sizeof(Observation_t));
     le_mem_SetDestructor(ObservationPool, ObservationDestructor);
 
+    SettingsPool = le_mem_InitStaticPool(SettingsPool, DEFAULT_OBS_SETTINGS_POOL_SIZE,
+                        sizeof(Settings_t));
+
     BufferEntryPool = le_mem_InitStaticPool(BufferEntryPool, DEFAULT_BUFFER_ENTRY_POOL_SIZE,
                         sizeof(BufferEntry_t));
     le_mem_SetDestructor(BufferEntryPool, BufferEntryDestructor);
@@ -1416,6 +1549,11 @@ void obs_Init
     ReadOperationPool = le_mem_InitStaticPool(ReadOperationPool,
                                               DEFAULT_READ_OPERATION_POOL_SIZE,
                                               sizeof(ReadOperation_t));
+
+#if LE_CONFIG_LINUX
+    BackupDirPool = le_mem_InitStaticPool(BackupDirPool, DEFAULT_BACKUP_DIR_POOL_SIZE,
+                                          sizeof(BackupDir_t));
+#endif
 }
 
 
@@ -1433,19 +1571,33 @@ res_Resource_t* obs_Create
 )
 //--------------------------------------------------------------------------------------------------
 {
+    Settings_t* settingsPtr = hub_MemAlloc(SettingsPool);
+
+    if (settingsPtr == NULL)
+    {
+        LE_ERROR("Failed to allocate observation settings");
+        return NULL;
+    }
+
     Observation_t* obsPtr = hub_MemAlloc(ObservationPool);
 
     if (obsPtr == NULL)
     {
         LE_ERROR("Failed to allocate observation");
+        le_mem_Release(settingsPtr);
         return NULL;
     }
     res_Construct(&obsPtr->resource, entryRef);
 
-    obsPtr->lowLimit = NAN;
-    obsPtr->highLimit = NAN;
-    obsPtr->changeBy = NAN;
-    obsPtr->minPeriod = NAN;
+    settingsPtr->lowLimit = NAN;
+    settingsPtr->highLimit = NAN;
+    settingsPtr->changeBy = NAN;
+    settingsPtr->minPeriod = NAN;
+    settingsPtr->jsonExtraction[0] = '\0';
+
+    obsPtr->settingsPtr = settingsPtr;
+    obsPtr->sharesSettings = false;
+    obsPtr->templateEntry = NULL;
 
     obsPtr->maxCount = 0;
     obsPtr->count = 0;
@@ -1462,9 +1614,10 @@ res_Resource_t* obs_Create
 
     obsPtr->readOpList = LE_DLS_LIST_INIT;
 
-    obsPtr->jsonExtraction[0] = '\0';
+    obsPtr->destinationRef = NULL;
+    obsPtr->srcPath[0] = '\0';
 
-    obsPtr->destination[0] = '\0';
+    obsPtr->configFingerprint = 0;
 
     return &obsPtr->resource;
 }
@@ -1580,9 +1733,10 @@ le_result_t obs_DoJsonExtraction
 //--------------------------------------------------------------------------------------------------
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    const char* extractionSpec = obsPtr->settingsPtr->jsonExtraction;
 
     // If JSON extraction is enabled,
-    if (obsPtr->jsonExtraction[0] != '\0')
+    if (extractionSpec[0] != '\0')
     {
         if (*dataTypePtr != IO_DATA_TYPE_JSON)
         {
@@ -1593,7 +1747,7 @@ le_result_t obs_DoJsonExtraction
         // Extract the appropriate JSON data element from the value.
         io_DataType_t extractedType;
         dataSample_Ref_t extractedValue = dataSample_ExtractJson(*valueRefPtr,
-                                                                 obsPtr->jsonExtraction,
+                                                                 extractionSpec,
                                                                  &extractedType);
         if (extractedValue == NULL)
         {
@@ -1617,18 +1771,20 @@ le_result_t obs_DoJsonExtraction
  *
  * @warning JSON extraction should be performed first if the data type is JSON.
  *
- * @return true if the value should be accepted.
+ * @return true if the value should be accepted, false if a filter rejects it.
  */
 //--------------------------------------------------------------------------------------------------
 bool obs_ShouldAccept
 (
     res_Resource_t* resPtr,
     io_DataType_t dataType,     ///< [IN] the data type
-    dataSample_Ref_t valueRef   ///< [IN] the data sample
+    dataSample_Ref_t valueRef,  ///< [IN] the data sample
+    admin_PushCounter_t* filterPtr ///< [OUT] Filter that rejected the value, if it is rejected.
 )
 //--------------------------------------------------------------------------------------------------
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    const Settings_t* settingsPtr = obsPtr->settingsPtr;
 
     // Check the high limit and low limit before other limits.
     if (dataType == IO_DATA_TYPE_NUMERIC)
@@ -1637,25 +1793,28 @@ bool obs_ShouldAccept
 
         // If both limits are enabled and the low limit is higher than the high limit, then
         // this is the "deadband" case. ( - <------HxxxxxxxxxL------> + )
-        if (   (!isnan(obsPtr->highLimit))
-            && (!isnan(obsPtr->lowLimit))
-            && (obsPtr->lowLimit > obsPtr->highLimit)  )
+        if (   (!isnan(settingsPtr->highLimit))
+            && (!isnan(settingsPtr->lowLimit))
+            && (settingsPtr->lowLimit > settingsPtr->highLimit)  )
         {
-            if ((numericValue < obsPtr->lowLimit) && (numericValue > obsPtr->highLimit))
+            if ((numericValue < settingsPtr->lowLimit) && (numericValue > settingsPtr->highLimit))
             {
+                *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_LIMIT;
                 return false;
             }
         }
         // In all other cases, reject if lower than non-NAN low limit or higher than non-NAN high.
         else
         {
-            if ((!isnan(obsPtr->lowLimit)) && (numericValue < obsPtr->lowLimit))
+            if ((!isnan(settingsPtr->lowLimit)) && (numericValue < settingsPtr->lowLimit))
             {
+                *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_LIMIT;
                 return false;
             }
 
-            if ((!isnan(obsPtr->highLimit)) && (numericValue > obsPtr->highLimit))
+            if ((!isnan(settingsPtr->highLimit)) && (numericValue > settingsPtr->highLimit))
             {
+                *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_LIMIT;
                 return false;
             }
         }
@@ -1670,11 +1829,12 @@ bool obs_ShouldAccept
     if (previousValue != NULL)
     {
         // If there is a changedBy filter in effect,
-        if ((obsPtr->changeBy != 0) && (!isnan(obsPtr->changeBy)))
+        if ((settingsPtr->changeBy != 0) && (!isnan(settingsPtr->changeBy)))
         {
             // If overridden, reject everything because the value won't change.
             if (res_IsOverridden(resPtr))
             {
+                *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY;
                 return false;
             }
 
@@ -1689,8 +1849,9 @@ bool obs_ShouldAccept
                     // Reject changes in the current value smaller than the changeBy setting.
                     double previousNumber = dataSample_GetNumeric(previousValue);
                     if (  fabs(dataSample_GetNumeric(valueRef) - previousNumber)
-                        < obsPtr->changeBy)
+                        < settingsPtr->changeBy)
                     {
+                        *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY;
                         return false;
                     }
                 }
@@ -1699,6 +1860,7 @@ bool obs_ShouldAccept
                 {
                     if (dataSample_GetBoolean(valueRef) == dataSample_GetBoolean(previousValue))
                     {
+                        *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY;
                         return false;
                     }
                 }
@@ -1709,20 +1871,22 @@ bool obs_ShouldAccept
                     if (0 == strcmp(dataSample_GetString(valueRef),
                                     dataSample_GetString(previousValue)))
                     {
+                        *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY;
                         return false;
                     }
                 }
             }
         }
 
-        // All of the above can be done without a system call, so that's why we do the
+        // All of the above can be done without reading the clock, so that's why we do the
         // minPeriod check last.
-        if ((obsPtr->minPeriod != 0) && (!isnan(obsPtr->minPeriod)))
+        if ((settingsPtr->minPeriod != 0) && (!isnan(settingsPtr->minPeriod)))
         {
-            now = GetRelativeTimeMs();  // system call
+            now = GetRelativeTimeMs();
 
-            if ((now - obsPtr->lastPushTime) < (obsPtr->minPeriod * 1000))
+            if ((now - obsPtr->lastPushTime) < (settingsPtr->minPeriod * 1000))
             {
+                *filterPtr = ADMIN_PUSH_COUNTER_FILTERED_MIN_PERIOD;
                 return false;
             }
         }
@@ -1731,7 +1895,7 @@ bool obs_ShouldAccept
     // Update the time of last update.
     if (now == 0)
     {
-        now = GetRelativeTimeMs(); // system call
+        now = GetRelativeTimeMs();
     }
     obsPtr->lastPushTime = now;
 
@@ -1778,7 +1942,7 @@ void obs_ProcessAccepted
         {
             // If more than the backup period has passed since the time of last backup, do a backup.
             uint32_t nextBackupTime = obsPtr->lastBackupTime + obsPtr->backupPeriod;
-            le_clk_Time_t now = le_clk_GetRelativeTime();
+            le_clk_Time_t now = hub_GetRelativeTime();
             if (nextBackupTime <= now.sec)
             {
                 Backup(obsPtr);
@@ -1854,6 +2018,41 @@ dataSample_Ref_t obs_ApplyTransform
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the settings of an Observation for modification.  An instance still sharing the settings of
+ * its template gets a copy of its own first, so that the template and its other instances are not
+ * affected.
+ *
+ * @return Pointer to the settings, or NULL if a copy could not be allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+static Settings_t* GetOwnSettings
+(
+    Observation_t* obsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (obsPtr->sharesSettings)
+    {
+        Settings_t* settingsPtr = hub_MemAlloc(SettingsPool);
+
+        if (settingsPtr == NULL)
+        {
+            LE_ERROR("Failed to allocate observation settings");
+            return NULL;
+        }
+
+        *settingsPtr = *obsPtr->settingsPtr;
+        le_mem_Release(obsPtr->settingsPtr);
+        obsPtr->settingsPtr = settingsPtr;
+        obsPtr->sharesSettings = false;
+    }
+
+    return obsPtr->settingsPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the minimum period between data samples accepted by a given Observation.
@@ -1868,9 +2067,12 @@ void obs_SetMinPeriod
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Settings_t* settingsPtr = GetOwnSettings(CONTAINER_OF(resPtr, Observation_t, resource));
 
-    obsPtr->minPeriod = minPeriod;
+    if (settingsPtr != NULL)
+    {
+        settingsPtr->minPeriod = minPeriod;
+    }
 }
 
 
@@ -1889,7 +2091,7 @@ double obs_GetMinPeriod
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->minPeriod;
+    return obsPtr->settingsPtr->minPeriod;
 }
 
 
@@ -1907,9 +2109,12 @@ void obs_SetHighLimit
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Settings_t* settingsPtr = GetOwnSettings(CONTAINER_OF(resPtr, Observation_t, resource));
 
-    obsPtr->highLimit = highLimit;
+    if (settingsPtr != NULL)
+    {
+        settingsPtr->highLimit = highLimit;
+    }
 }
 
 
@@ -1928,7 +2133,7 @@ double obs_GetHighLimit
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->highLimit;
+    return obsPtr->settingsPtr->highLimit;
 }
 
 
@@ -1946,9 +2151,12 @@ void obs_SetLowLimit
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Settings_t* settingsPtr = GetOwnSettings(CONTAINER_OF(resPtr, Observation_t, resource));
 
-    obsPtr->lowLimit = lowLimit;
+    if (settingsPtr != NULL)
+    {
+        settingsPtr->lowLimit = lowLimit;
+    }
 }
 
 
@@ -1967,7 +2175,7 @@ double obs_GetLowLimit
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->lowLimit;
+    return obsPtr->settingsPtr->lowLimit;
 }
 
 
@@ -1988,9 +2196,12 @@ void obs_SetChangeBy
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Settings_t* settingsPtr = GetOwnSettings(CONTAINER_OF(resPtr, Observation_t, resource));
 
-    obsPtr->changeBy = change;
+    if (settingsPtr != NULL)
+    {
+        settingsPtr->changeBy = change;
+    }
 }
 
 
@@ -2010,7 +2221,7 @@ double obs_GetChangeBy
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->changeBy;
+    return obsPtr->settingsPtr->changeBy;
 }
 
 
@@ -2177,7 +2388,7 @@ void obs_SetBufferBackupPeriod
                         // If the backup period has passed since the last backup,
                         // release the timer and do a backup now.
                         uint32_t nextBackupTime = obsPtr->lastBackupTime + seconds;
-                        le_clk_Time_t now = le_clk_GetRelativeTime();
+                        le_clk_Time_t now = hub_GetRelativeTime();
                         if (nextBackupTime < now.sec)
                         {
                             le_timer_Delete(obsPtr->backupTimer);
@@ -2321,9 +2532,54 @@ static int BackupDirTreeWalkCallback
 #endif /* end LE_CONFIG_LINUX */
 
 
+#if LE_CONFIG_LINUX
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a directory under BACKUP_DIR if it is empty, then its parents up to BACKUP_DIR itself,
+ * stopping at the first one that is not empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveEmptyBackupDirs
+(
+    char* path      ///< Path of the directory.  Modified.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    size_t len = strlen(path);
+
+    while (len >= BACKUP_DIR_PATH_LEN - 1)
+    {
+        path[len] = '\0';
+        if (rmdir(path) != 0)
+        {
+            if ((errno != ENOTEMPTY) && (errno != EEXIST) && (errno != ENOENT))
+            {
+                LE_CRIT("Failed to remove directory '%s' (%m).", path);
+            }
+            if (errno != ENOENT)
+            {
+                return;
+            }
+        }
+
+        char* lastSlashPtr = strrchr(path, '/');
+        if (lastSlashPtr == NULL)
+        {
+            return;
+        }
+        len = lastSlashPtr - path;
+    }
+}
+#endif /* end LE_CONFIG_LINUX */
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete buffer backup files that aren't being used.
+ *
+ * Backup files are deleted along with their Observation, so only the directories they were in
+ * need checking.  The whole backup directory is only walked the first time, and when one of
+ * those directories could not be remembered.
  */
 //--------------------------------------------------------------------------------------------------
 void obs_DeleteUnusedBackupFiles
@@ -2333,6 +2589,24 @@ void obs_DeleteUnusedBackupFiles
 //--------------------------------------------------------------------------------------------------
 {
 #if LE_CONFIG_LINUX
+    le_sls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_sls_Pop(&BackupDirList)))
+    {
+        BackupDir_t* dirPtr = CONTAINER_OF(linkPtr, BackupDir_t, link);
+
+        if (!IsBackupDirWalkNeeded)
+        {
+            RemoveEmptyBackupDirs(dirPtr->path);
+        }
+        le_mem_Release(dirPtr);
+    }
+
+    if (!IsBackupDirWalkNeeded)
+    {
+        return;
+    }
+    IsBackupDirWalkNeeded = false;
+
     LE_DEBUG("Cleaning up unused buffer backup files.");
 
     // Walk the directory tree under the backup directory.
@@ -2386,7 +2660,7 @@ static BufferEntry_t* FindBufferEntry
         // absolute timestamp by subtracting it from the current time.
         if (startTime <= THIRTY_YEARS)
         {
-            le_clk_Time_t now = le_clk_GetAbsoluteTime();
+            le_clk_Time_t now = hub_GetAbsoluteTime();
             startTime = ((((double)(now.usec)) / 1000000) + now.sec) - startTime;
         }
 
@@ -2499,11 +2773,20 @@ void obs_SetJsonExtraction
 //--------------------------------------------------------------------------------------------------
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Settings_t* settingsPtr = GetOwnSettings(obsPtr);
 
-    LE_ASSERT(LE_OK == le_utf8_Copy(obsPtr->jsonExtraction,
+    if (settingsPtr == NULL)
+    {
+        return;
+    }
+
+    LE_ASSERT(LE_OK == le_utf8_Copy(settingsPtr->jsonExtraction,
                                     extractionSpec,
-                                    sizeof(obsPtr->jsonExtraction),
+                                    sizeof(settingsPtr->jsonExtraction),
                                     NULL));
+
+    // The source path reported to the destination includes the extraction.
+    obsPtr->srcPath[0] = '\0';
 }
 
 
@@ -2523,7 +2806,7 @@ const char* obs_GetJsonExtraction
 {
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
-    return obsPtr->jsonExtraction;
+    return obsPtr->settingsPtr->jsonExtraction;
 }
 
 
@@ -2858,7 +3141,6 @@ void obs_TriggerDestinationCallback
 //--------------------------------------------------------------------------------------------------
 {
     le_result_t result;
-    char srcPath[CONFIG_MAX_DESTINATION_SRC_BYTES];
     Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
 
     if (obsPtr == NULL)
@@ -2868,17 +3150,21 @@ void obs_TriggerDestinationCallback
     }
 
     // Verify the destination has been configured on the observation
-    if (strlen(obsPtr->destination) == 0)
+    if (obsPtr->destinationRef == NULL)
     {
         return;
     }
 
-    // Get Observation source path
-    result = obs_GetSource(resPtr, srcPath, sizeof(srcPath));
-    if (result != LE_OK)
+    // Get Observation source path, unless it is cached from an earlier push.
+    if (obsPtr->srcPath[0] == '\0')
     {
-        LE_ERROR("Error retrieving Observation Source path, result [%d]", result);
-        return;
+        result = obs_GetSource(resPtr, obsPtr->srcPath, sizeof(obsPtr->srcPath));
+        if (result != LE_OK)
+        {
+            LE_ERROR("Error retrieving Observation Source path, result [%d]", result);
+            obsPtr->srcPath[0] = '\0';
+            return;
+        }
     }
 
     LE_DEBUG("[%s] Calling configServices to trigger Destination Push Handler, dataType [%d]",
@@ -2887,9 +3173,9 @@ void obs_TriggerDestinationCallback
 
     // Trigger the Destination PushHandler
     result = configService_TriggerDestinationPushHandler(
-                 obsPtr->destination,
+                 obsPtr->destinationRef,
                  resTree_GetEntryName(resPtr->entryRef),
-                 srcPath,
+                 obsPtr->srcPath,
                  dataType,
                  dataSample);
 
@@ -2923,6 +3209,154 @@ void obs_SetDestination
         return;
     }
 
-    // Set the desination string
-    strncpy(obsPtr->destination, destination, CONFIG_MAX_DESTINATION_NAME_BYTES);
+    if (obsPtr->destinationRef != NULL)
+    {
+        configService_ReleaseDestination(obsPtr->destinationRef);
+        obsPtr->destinationRef = NULL;
+    }
+
+    // Look up the interned destination once, rather than on every push.
+    if (destination[0] != '\0')
+    {
+        obsPtr->destinationRef = configService_GetDestination(destination);
+    }
+    obsPtr->srcPath[0] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* obs_GetDestination
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    if (obsPtr->destinationRef == NULL)
+    {
+        return "";
+    }
+
+    return configService_GetDestinationName(obsPtr->destinationRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget the source path cached for the destination of an Observation.  Must be called whenever
+ * the Observation's source changes.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ClearSourcePathCache
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    obsPtr->srcPath[0] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetConfigFingerprint
+(
+    res_Resource_t* resPtr,      ///< Ptr to Observation resource
+    uint32_t fingerprint         ///< Fingerprint of the applied settings (0 = none)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    obsPtr->configFingerprint = fingerprint;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t obs_GetConfigFingerprint
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    return obsPtr->configFingerprint;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation.  A new instance shares the filter
+ * settings (limits, change by, minimum period and JSON extraction) of its template, so that changes
+ * to the template apply to it, until one of them is set on the instance itself.
+ *
+ * Calling this again for the same template keeps the instance's settings, but refreshes what is
+ * derived from them (the source path reported to its destination).
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetTemplate
+(
+    res_Resource_t* resPtr,         ///< Ptr to the instance Observation resource
+    res_Resource_t* templateResPtr  ///< Ptr to the template Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+    Observation_t* templatePtr = CONTAINER_OF(templateResPtr, Observation_t, resource);
+
+    if (obsPtr->templateEntry != templateResPtr->entryRef)
+    {
+        le_mem_AddRef(templatePtr->settingsPtr);
+        le_mem_Release(obsPtr->settingsPtr);
+        obsPtr->settingsPtr = templatePtr->settingsPtr;
+        obsPtr->sharesSettings = true;
+        obsPtr->templateEntry = templateResPtr->entryRef;
+    }
+
+    // The source path reported to the destination includes the JSON extraction.
+    obsPtr->srcPath[0] = '\0';
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template's resource tree entry, or NULL if the Observation is not an instance.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t obs_GetTemplate
+(
+    res_Resource_t* resPtr      ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Observation_t* obsPtr = CONTAINER_OF(resPtr, Observation_t, resource);
+
+    return obsPtr->templateEntry;
 }
@@ -87,14 +87,15 @@ le_result_t obs_DoJsonExtraction
  *
  * @warning JSON extraction should be performed first if the data type is JSON.
  *
- * @return true if the value should be accepted.
+ * @return true if the value should be accepted, false if a filter rejects it.
  */
 //--------------------------------------------------------------------------------------------------
 bool obs_ShouldAccept
 (
     res_Resource_t* resPtr,
     io_DataType_t dataType,     ///< [IN] the data type
-    dataSample_Ref_t valueRef   ///< [IN] the data sample
+    dataSample_Ref_t valueRef,  ///< [IN] the data sample
+    admin_PushCounter_t* filterPtr ///< [OUT] Filter that rejected the value, if it is rejected.
 );
 
 
@@ -498,4 +499,86 @@ void obs_SetDestination
     const char* destination      ///< Destination string
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* obs_GetDestination
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget the source path cached for the destination of an Observation.  Must be called whenever
+ * the Observation's source changes.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_ClearSourcePathCache
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetConfigFingerprint
+(
+    res_Resource_t* resPtr,      ///< Ptr to Observation resource
+    uint32_t fingerprint         ///< Fingerprint of the applied settings (0 = none)
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t obs_GetConfigFingerprint
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation, sharing the template's filter settings
+ * until one of them is set on the instance itself.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void obs_SetTemplate
+(
+    res_Resource_t* resPtr,         ///< Ptr to the instance Observation resource
+    res_Resource_t* templateResPtr  ///< Ptr to the template Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template's resource tree entry, or NULL if the Observation is not an instance.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t obs_GetTemplate
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
 #endif // OBS_H_INCLUDE_GUARD
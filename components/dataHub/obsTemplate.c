@@ -0,0 +1,680 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file obsTemplate.c
+ *
+ * Implementation of Observation templates.  See obsTemplate.h.
+ *
+ * Templates are kept in a short list, which is scanned whenever a resource is added to the
+ * resource tree.  Instances are not recorded anywhere; they are found by walking the /obs
+ * namespace and comparing their template reference (see obs_GetTemplate()).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "resTree.h"
+#include "obsTemplate.h"
+
+/// Default number of templates.  This can be overridden in the .cdef.
+#define DEFAULT_OBS_TEMPLATE_POOL_SIZE  2
+
+/// Path element that matches any single element.
+#define WILDCARD    "*"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A template Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct ObsTemplate
+{
+    le_dls_Link_t link;                         ///< Link in the TemplateList.
+    resTree_EntryRef_t obsEntry;                ///< Template Observation.
+    char srcPattern[HUB_MAX_RESOURCE_PATH_BYTES]; ///< Absolute path pattern of the sources.
+} ObsTemplate_t;
+
+/// Pool of templates.
+static le_mem_PoolRef_t ObsTemplatePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ObsTemplatePool, DEFAULT_OBS_TEMPLATE_POOL_SIZE, sizeof(ObsTemplate_t));
+
+/// List of templates.
+static le_dls_List_t TemplateList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next element of a path, skipping any leading '/'.
+ *
+ * @return Pointer to the element, or NULL if there are no more elements.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* NextElement
+(
+    const char** pathPtrPtr,    ///< [INOUT] Path, advanced past the element returned.
+    size_t* lenPtr              ///< [OUT] Length of the element returned.
+)
+{
+    const char* elementPtr = *pathPtrPtr;
+
+    while (*elementPtr == '/')
+    {
+        elementPtr++;
+    }
+
+    if (*elementPtr == '\0')
+    {
+        return NULL;
+    }
+
+    *lenPtr = strcspn(elementPtr, "/");
+    *pathPtrPtr = elementPtr + *lenPtr;
+
+    return elementPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a path element is a wildcard.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsWildcard
+(
+    const char* elementPtr,     ///< Path element (not null-terminated).
+    size_t len                  ///< Length of the element.
+)
+{
+    return ((len == 1) && (elementPtr[0] == WILDCARD[0]));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the wildcard elements of a path.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t CountWildcards
+(
+    const char* path
+)
+{
+    size_t count = 0;
+    size_t len;
+    const char* elementPtr;
+
+    while ((elementPtr = NextElement(&path, &len)) != NULL)
+    {
+        if (IsWildcard(elementPtr, len))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a resource path matches a source pattern and, if so, build the path of the
+ * matching instance, relative to /obs.  A wildcard matches any single element except "*" itself.
+ *
+ * @return
+ *  - LE_OK if the path matches.
+ *  - LE_NOT_FOUND if it does not.
+ *  - LE_OVERFLOW if the instance path does not fit in the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MakeInstancePath
+(
+    const char* srcPattern,     ///< Absolute path pattern of the sources.
+    const char* srcPath,        ///< Absolute path of the resource.
+    const char* obsPattern,     ///< Template path, relative to /obs.
+    char* instancePath,         ///< [OUT] Instance path, relative to /obs.
+    size_t instancePathSize     ///< Size of the instance path buffer.
+)
+{
+    const char* patternPtr = srcPattern;
+    const char* pathPtr = srcPath;
+    const char* patternElementPtr;
+    const char* pathElementPtr;
+    size_t patternLen;
+    size_t pathLen;
+
+    // Check the whole path first, so nothing is built for a resource that only partially matches.
+    for (;;)
+    {
+        patternElementPtr = NextElement(&patternPtr, &patternLen);
+        pathElementPtr = NextElement(&pathPtr, &pathLen);
+
+        if ((patternElementPtr == NULL) || (pathElementPtr == NULL))
+        {
+            break;
+        }
+
+        if (IsWildcard(patternElementPtr, patternLen))
+        {
+            if (IsWildcard(pathElementPtr, pathLen))
+            {
+                return LE_NOT_FOUND;
+            }
+        }
+        else if (   (patternLen != pathLen)
+                 || (strncmp(patternElementPtr, pathElementPtr, pathLen) != 0))
+        {
+            return LE_NOT_FOUND;
+        }
+    }
+
+    if ((patternElementPtr != NULL) || (pathElementPtr != NULL))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    // Replace the wildcards of the template path with the matching elements, in order.
+    const char* obsPtr = obsPattern;
+    const char* obsElementPtr;
+    size_t obsLen;
+    size_t used = 0;
+
+    patternPtr = srcPattern;
+    pathPtr = srcPath;
+
+    while ((obsElementPtr = NextElement(&obsPtr, &obsLen)) != NULL)
+    {
+        if (IsWildcard(obsElementPtr, obsLen))
+        {
+            do
+            {
+                patternElementPtr = NextElement(&patternPtr, &patternLen);
+                pathElementPtr = NextElement(&pathPtr, &pathLen);
+                LE_ASSERT(patternElementPtr != NULL);
+            }
+            while (!IsWildcard(patternElementPtr, patternLen));
+
+            obsElementPtr = pathElementPtr;
+            obsLen = pathLen;
+        }
+
+        int len = snprintf(instancePath + used,
+                           instancePathSize - used,
+                           "%s%.*s",
+                           (used == 0 ? "" : "/"),
+                           (int)obsLen,
+                           obsElementPtr);
+        if ((len < 0) || ((size_t)len >= instancePathSize - used))
+        {
+            return LE_OVERFLOW;
+        }
+        used += len;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the template record of an Observation.
+ *
+ * @return Pointer to the record, or NULL if the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+static ObsTemplate_t* FindTemplate
+(
+    resTree_EntryRef_t obsEntry
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&TemplateList);
+
+    while (linkPtr != NULL)
+    {
+        ObsTemplate_t* templatePtr = CONTAINER_OF(linkPtr, ObsTemplate_t, link);
+
+        if (templatePtr->obsEntry == obsEntry)
+        {
+            return templatePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&TemplateList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the settings each instance keeps on its own from the template.  Settings are only set when
+ * they differ, because setting the transform or the buffer size discards the instance's buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CopySettings
+(
+    resTree_EntryRef_t templateEntry,
+    resTree_EntryRef_t instanceEntry
+)
+{
+    admin_TransformType_t transform = resTree_GetTransform(templateEntry);
+    uint32_t maxCount = resTree_GetBufferMaxCount(templateEntry);
+    uint32_t backupPeriod = resTree_GetBufferBackupPeriod(templateEntry);
+    const char* destination = resTree_GetDestination(templateEntry);
+
+    if (resTree_GetTransform(instanceEntry) != transform)
+    {
+        resTree_SetTransform(instanceEntry, transform, NULL, 0);
+    }
+    if (resTree_GetBufferMaxCount(instanceEntry) != maxCount)
+    {
+        resTree_SetBufferMaxCount(instanceEntry, maxCount);
+    }
+    if (resTree_GetBufferBackupPeriod(instanceEntry) != backupPeriod)
+    {
+        resTree_SetBufferBackupPeriod(instanceEntry, backupPeriod);
+    }
+    if (strcmp(resTree_GetDestination(instanceEntry), destination) != 0)
+    {
+        resTree_SetDestination(instanceEntry, destination);
+    }
+
+    // Share the template's filter settings, or refresh what the instance derives from them.
+    resTree_SetObsTemplate(instanceEntry, templateEntry);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the instance of a template for a matching resource, if it does not exist yet.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Instantiate
+(
+    ObsTemplate_t* templatePtr,
+    resTree_EntryRef_t srcEntry     ///< Resource matching the template's source pattern.
+)
+{
+    resTree_EntryRef_t obsNamespace = resTree_GetObsNamespace();
+    char srcPath[HUB_MAX_RESOURCE_PATH_BYTES];
+    char obsPattern[HUB_MAX_RESOURCE_PATH_BYTES];
+    char instancePath[HUB_MAX_RESOURCE_PATH_BYTES];
+
+    if (   (resTree_GetPath(srcPath, sizeof(srcPath), resTree_GetRoot(), srcEntry) < 0)
+        || (resTree_GetPath(obsPattern, sizeof(obsPattern), obsNamespace,
+                            templatePtr->obsEntry) < 0))
+    {
+        return;
+    }
+
+    le_result_t result = MakeInstancePath(templatePtr->srcPattern,
+                                          srcPath,
+                                          obsPattern,
+                                          instancePath,
+                                          sizeof(instancePath));
+    if (result != LE_OK)
+    {
+        if (result == LE_OVERFLOW)
+        {
+            LE_WARN("Instance path of template '%s' for '%s' is too long", obsPattern, srcPath);
+        }
+        return;
+    }
+
+    resTree_EntryRef_t instanceEntry = resTree_FindEntry(obsNamespace, instancePath);
+
+    if (   (instanceEntry != NULL)
+        && (resTree_GetEntryType(instanceEntry) == ADMIN_ENTRY_TYPE_OBSERVATION))
+    {
+        if (resTree_GetObsTemplate(instanceEntry) != templatePtr->obsEntry)
+        {
+            LE_WARN("Observation '%s' already exists; not instantiating template '%s'",
+                    instancePath,
+                    obsPattern);
+        }
+        return;
+    }
+
+    result = resTree_GetObservation(obsNamespace, instancePath, &instanceEntry);
+    if (result != LE_OK)
+    {
+        LE_ERROR("Failed to instantiate template '%s' as '%s' (%s)",
+                 obsPattern,
+                 instancePath,
+                 LE_RESULT_TXT(result));
+        return;
+    }
+
+    CopySettings(templatePtr->obsEntry, instanceEntry);
+
+    result = resTree_SetSource(instanceEntry, srcEntry);
+    if (result != LE_OK)
+    {
+        LE_WARN("Failed to route '%s' to '%s' (%s)", srcPath, instancePath, LE_RESULT_TXT(result));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the instances of a template for the resources under a namespace that match the rest of
+ * its source pattern.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InstantiateUnder
+(
+    ObsTemplate_t* templatePtr,
+    resTree_EntryRef_t nsEntry,     ///< Namespace the pattern is relative to.
+    const char* patternPtr          ///< Rest of the source pattern.
+)
+{
+    size_t len;
+    const char* elementPtr = NextElement(&patternPtr, &len);
+
+    if (elementPtr == NULL)
+    {
+        return;
+    }
+
+    const char* restPtr = patternPtr;
+    size_t restLen;
+    bool isLast = (NextElement(&restPtr, &restLen) == NULL);
+    bool isWildcard = IsWildcard(elementPtr, len);
+    resTree_EntryRef_t childEntry = resTree_GetFirstChild(nsEntry);
+
+    while (childEntry != NULL)
+    {
+        const char* name = resTree_GetEntryName(childEntry);
+
+        if (isWildcard ? (strcmp(name, WILDCARD) != 0)
+                       : ((strncmp(name, elementPtr, len) == 0) && (name[len] == '\0')))
+        {
+            if (!isLast)
+            {
+                InstantiateUnder(templatePtr, childEntry, patternPtr);
+            }
+            else
+            {
+                switch (resTree_GetEntryType(childEntry))
+                {
+                    case ADMIN_ENTRY_TYPE_INPUT:
+                    case ADMIN_ENTRY_TYPE_OUTPUT:
+                    case ADMIN_ENTRY_TYPE_OBSERVATION:
+                        Instantiate(templatePtr, childEntry);
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+        }
+
+        childEntry = resTree_GetNextSibling(childEntry);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Call a function for each instance of a template under a namespace.  The function may delete the
+ * instance.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ForEachInstanceUnder
+(
+    resTree_EntryRef_t nsEntry,
+    resTree_EntryRef_t templateEntry,
+    void (*func)(resTree_EntryRef_t templateEntry, resTree_EntryRef_t instanceEntry)
+)
+{
+    // Deleted entries are walked too, so that the walk does not stop at one.
+    resTree_EntryRef_t childEntry = resTree_GetFirstChildEx(nsEntry, true);
+
+    while (childEntry != NULL)
+    {
+        // Hold the entry while visiting it, so its link to the next sibling stays valid if the
+        // instance is deleted.
+        le_mem_AddRef(childEntry);
+
+        ForEachInstanceUnder(childEntry, templateEntry, func);
+
+        if (resTree_GetObsTemplate(childEntry) == templateEntry)
+        {
+            func(templateEntry, childEntry);
+        }
+
+        resTree_EntryRef_t nextEntry = resTree_GetNextSiblingEx(childEntry, true);
+        le_mem_Release(childEntry);
+        childEntry = nextEntry;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete an instance of a template.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteInstance
+(
+    resTree_EntryRef_t templateEntry,
+    resTree_EntryRef_t instanceEntry
+)
+{
+    LE_UNUSED(templateEntry);
+
+    resTree_DeleteObservation(instanceEntry);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the instances of a template and forget it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteTemplate
+(
+    ObsTemplate_t* templatePtr
+)
+{
+    // Unlink first, so the template is not instantiated again while its instances are deleted.
+    le_dls_Remove(&TemplateList, &templatePtr->link);
+
+    ForEachInstanceUnder(resTree_GetObsNamespace(), templatePtr->obsEntry, DeleteInstance);
+
+    le_mem_Release(templatePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a path contains wildcard elements.
+ *
+ * @return true if at least one element of the path is "*".
+ */
+//--------------------------------------------------------------------------------------------------
+bool obsTemplate_IsPattern
+(
+    const char* path    ///< Resource path.
+)
+{
+    return (CountWildcards(path) > 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation a template by setting a path pattern as its source, and create instances
+ * for the resources that already match it.  Any instances created for a previous pattern are
+ * deleted.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the pattern and the Observation path have different numbers of wildcards.
+ *  - LE_NO_MEMORY if the template could not be recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t obsTemplate_SetSource
+(
+    resTree_EntryRef_t obsEntry,    ///< Template Observation.
+    const char* srcPattern          ///< Absolute path pattern of the sources.
+)
+{
+    resTree_EntryRef_t obsNamespace = resTree_GetObsNamespace();
+    char obsPattern[HUB_MAX_RESOURCE_PATH_BYTES] = "";
+
+    LE_ASSERT(resTree_GetEntryType(obsEntry) == ADMIN_ENTRY_TYPE_OBSERVATION);
+
+    if (   (resTree_GetPath(obsPattern, sizeof(obsPattern), obsNamespace, obsEntry) < 0)
+        || (CountWildcards(obsPattern) != CountWildcards(srcPattern))
+        || (strlen(srcPattern) >= HUB_MAX_RESOURCE_PATH_BYTES))
+    {
+        LE_ERROR("Source pattern '%s' does not fit observation '%s'", srcPattern, obsPattern);
+        return LE_BAD_PARAMETER;
+    }
+
+    ObsTemplate_t* templatePtr = FindTemplate(obsEntry);
+
+    if (templatePtr != NULL)
+    {
+        if (strcmp(templatePtr->srcPattern, srcPattern) == 0)
+        {
+            return LE_OK;
+        }
+
+        DeleteTemplate(templatePtr);
+    }
+
+    templatePtr = hub_MemAlloc(ObsTemplatePool);
+    if (templatePtr == NULL)
+    {
+        return LE_NO_MEMORY;
+    }
+
+    templatePtr->link = LE_DLS_LINK_INIT;
+    templatePtr->obsEntry = obsEntry;
+    LE_ASSERT(le_utf8_Copy(templatePtr->srcPattern,
+                           srcPattern,
+                           sizeof(templatePtr->srcPattern),
+                           NULL) == LE_OK);
+
+    // The template itself receives nothing.
+    resTree_SetSource(obsEntry, NULL);
+
+    le_dls_Queue(&TemplateList, &templatePtr->link);
+
+    InstantiateUnder(templatePtr, resTree_GetRoot(), templatePtr->srcPattern);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the source pattern of a template Observation.
+ *
+ * @return The pattern, or NULL if the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* obsTemplate_GetSource
+(
+    resTree_EntryRef_t obsEntry     ///< Observation.
+)
+{
+    ObsTemplate_t* templatePtr = FindTemplate(obsEntry);
+
+    return (templatePtr != NULL ? templatePtr->srcPattern : NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the source pattern of a template Observation, deleting its instances.  Does nothing if
+ * the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_RemoveSource
+(
+    resTree_EntryRef_t obsEntry     ///< Observation.
+)
+{
+    ObsTemplate_t* templatePtr = FindTemplate(obsEntry);
+
+    if (templatePtr != NULL)
+    {
+        DeleteTemplate(templatePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the instances of the templates whose pattern matches a resource that was just added to
+ * the resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_ResourceAdded
+(
+    resTree_EntryRef_t entryRef     ///< Input, Output or Observation that was added.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&TemplateList);
+
+    while (linkPtr != NULL)
+    {
+        Instantiate(CONTAINER_OF(linkPtr, ObsTemplate_t, link), entryRef);
+
+        linkPtr = le_dls_PeekNext(&TemplateList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget a template Observation that is about to be deleted, deleting its instances.  Does
+ * nothing if the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_ObservationDeleted
+(
+    resTree_EntryRef_t obsEntry     ///< Observation about to be deleted.
+)
+{
+    obsTemplate_RemoveSource(obsEntry);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the settings that each instance keeps on its own (transform, buffer size, backup period
+ * and destination) from a template Observation to its instances.  Does nothing if the
+ * Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_UpdateInstances
+(
+    resTree_EntryRef_t obsEntry     ///< Observation whose settings changed.
+)
+{
+    if (FindTemplate(obsEntry) != NULL)
+    {
+        ForEachInstanceUnder(resTree_GetObsNamespace(), obsEntry, CopySettings);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_Init
+(
+    void
+)
+{
+    ObsTemplatePool = le_mem_InitStaticPool(ObsTemplatePool,
+                                            DEFAULT_OBS_TEMPLATE_POOL_SIZE,
+                                            sizeof(ObsTemplate_t));
+}
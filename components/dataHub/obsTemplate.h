@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file obsTemplate.h
+ *
+ * Interface of the Observation template module, used inside the Data Hub only.
+ *
+ * A template is an Observation whose path contains wildcard elements ("*"), and whose source is a
+ * path pattern with the same number of wildcard elements.  For every resource matching the
+ * pattern, an instance Observation is created with each wildcard of the template path replaced by
+ * the matching element of the resource path.  E.g., a template at /obs/adc/ with the pattern
+ * /app/adc/ as source, both followed by a "*" element, gets an instance /obs/adc/ch0 for the
+ * resource /app/adc/ch0.  Instances are created as matching resources appear and are deleted with
+ * their template.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef OBS_TEMPLATE_H_INCLUDE_GUARD
+#define OBS_TEMPLATE_H_INCLUDE_GUARD
+
+#include "resTree.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a path contains wildcard elements.
+ *
+ * @return true if at least one element of the path is "*".
+ */
+//--------------------------------------------------------------------------------------------------
+bool obsTemplate_IsPattern
+(
+    const char* path    ///< Resource path.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation a template by setting a path pattern as its source, and create instances
+ * for the resources that already match it.  Any instances created for a previous pattern are
+ * deleted.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the pattern and the Observation path have different numbers of wildcards.
+ *  - LE_NO_MEMORY if the template could not be recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t obsTemplate_SetSource
+(
+    resTree_EntryRef_t obsEntry,    ///< Template Observation.
+    const char* srcPattern          ///< Absolute path pattern of the sources.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the source pattern of a template Observation.
+ *
+ * @return The pattern, or NULL if the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* obsTemplate_GetSource
+(
+    resTree_EntryRef_t obsEntry     ///< Observation.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the source pattern of a template Observation, deleting its instances.  Does nothing if
+ * the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_RemoveSource
+(
+    resTree_EntryRef_t obsEntry     ///< Observation.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the instances of the templates whose pattern matches a resource that was just added to
+ * the resource tree.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_ResourceAdded
+(
+    resTree_EntryRef_t entryRef     ///< Input, Output or Observation that was added.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget a template Observation that is about to be deleted, deleting its instances.  Does
+ * nothing if the Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_ObservationDeleted
+(
+    resTree_EntryRef_t obsEntry     ///< Observation about to be deleted.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the settings that each instance keeps on its own (transform, buffer size, backup period
+ * and destination) from a template Observation to its instances.  Does nothing if the
+ * Observation is not a template.
+ */
+//--------------------------------------------------------------------------------------------------
+void obsTemplate_UpdateInstances
+(
+    resTree_EntryRef_t obsEntry     ///< Observation whose settings changed.
+);
+
+#endif // OBS_TEMPLATE_H_INCLUDE_GUARD
@@ -8,6 +8,8 @@
 
 #include "dataHub.h"
 #include "handler.h"
+#include "queryService.h"
+#include "stats.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -113,7 +115,9 @@ le_result_t query_ReadBufferJson
         return LE_OK;   // Doesn't matter what we return.
     }
 
+    uint64_t startTime = stats_StartOp();
     resTree_ReadBufferJson(entryRef, startAfter, outputFile, completionFuncPtr, contextPtr);
+    stats_EndOp("query_ReadBufferJson", entryRef, startTime);
 
     return LE_OK;
 }
@@ -563,7 +567,7 @@ double query_GetStdDev
  * @return Reference to the resource or NULL if not found.
  */
 //--------------------------------------------------------------------------------------------------
-static resTree_EntryRef_t FindResource
+resTree_EntryRef_t queryService_FindResource
 (
     const char* path
 )
@@ -622,7 +626,7 @@ le_result_t query_GetDataType
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -668,7 +672,7 @@ le_result_t query_GetUnits
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -708,7 +712,7 @@ le_result_t query_GetTimestamp
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -762,7 +766,7 @@ le_result_t query_GetBoolean
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -822,7 +826,7 @@ le_result_t query_GetNumeric
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -885,7 +889,7 @@ le_result_t query_GetString
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -945,7 +949,7 @@ le_result_t query_GetJson
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -1007,7 +1011,7 @@ le_result_t query_GetJsonExample
 )
 //--------------------------------------------------------------------------------------------------
 {
-    resTree_EntryRef_t entryRef = FindResource(path);
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
 
     if (entryRef == NULL)
     {
@@ -1278,3 +1282,18 @@ void query_RemoveJsonPushHandler
         PushHandlerCount--;
     }
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    queryService_InitRead();
+}
@@ -0,0 +1,54 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file queryService.h
+ *
+ * Declarations of functions that are provided by the queryService module to other modules inside
+ * the Data Hub.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef QUERY_SERVICE_H_INCLUDE_GUARD
+#define QUERY_SERVICE_H_INCLUDE_GUARD
+
+#include "resTree.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a resource at a given path.  The path can be absolute (beginning with a '/'), or relative
+ * to the calling app's namespace.
+ *
+ * @return Reference to the resource or NULL if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t queryService_FindResource
+(
+    const char* path
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the read handles.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_InitRead
+(
+    void
+);
+
+
+#endif // QUERY_SERVICE_H_INCLUDE_GUARD
@@ -0,0 +1,314 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file queryService_read.c
+ *
+ * Read handles of the Query API (see query_GetReadHandle() and query_ReadValues()).
+ *
+ * A client looks each resource up by path once, and then reads the current values of many of
+ * them per IPC call, without any further path lookups.  The handles belong to the client session,
+ * and hold their resource tree entries, so a handle never refers to a freed entry.  A handle
+ * whose resource has been deleted reads as having no value.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "dataSample.h"
+#include "resTree.h"
+#include "queryService.h"
+#include "stats.h"
+
+/// Default number of clients that can hold read handles.  This can be overridden in the .cdef.
+#define DEFAULT_READ_TABLE_POOL_SIZE        4
+
+/// Number of resources a client can get read handles for.
+#define DEFAULT_READ_HANDLE_COUNT           256
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The read handles given out to a client.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Link in the ReadTableList.
+    le_msg_SessionRef_t sessionRef;     ///< Client session.
+    uint32_t count;                     ///< Number of handles given out.
+    resTree_EntryRef_t entries[DEFAULT_READ_HANDLE_COUNT]; ///< Resources (each referenced).
+}
+ReadTable_t;
+
+/// Pool of read handle tables.
+static le_mem_PoolRef_t ReadTablePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ReadTablePool, DEFAULT_READ_TABLE_POOL_SIZE, sizeof(ReadTable_t));
+
+/// Read handle tables of the clients that got handles.
+static le_dls_List_t ReadTableList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the read handle table of a client.
+ *
+ * @return Pointer to the table, or NULL if the client has not got any handles.
+ */
+//--------------------------------------------------------------------------------------------------
+static ReadTable_t* FindReadTable
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&ReadTableList);
+
+    while (linkPtr != NULL)
+    {
+        ReadTable_t* tablePtr = CONTAINER_OF(linkPtr, ReadTable_t, link);
+
+        if (tablePtr->sessionRef == sessionRef)
+        {
+            return tablePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&ReadTableList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release the read handles of a client that disconnected, and the resources they hold.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SessionCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void* contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    ReadTable_t* tablePtr = FindReadTable(sessionRef);
+
+    if (tablePtr != NULL)
+    {
+        for (uint32_t i = 0; i < tablePtr->count; i++)
+        {
+            le_mem_Release(tablePtr->entries[i]);
+        }
+
+        le_dls_Remove(&ReadTableList, &tablePtr->link);
+        le_mem_Release(tablePtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the current value of a resource into element i of the output arrays.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadValue
+(
+    resTree_EntryRef_t entryRef,    ///< Resource, or NULL if the handle is unknown.
+    size_t i,
+    uint8_t* typesPtr,              ///< [OUT]
+    double* timestampsPtr,          ///< [OUT]
+    double* valuesPtr               ///< [OUT]
+)
+{
+    dataSample_Ref_t sampleRef = NULL;
+
+    // A deleted resource leaves a namespace behind it.
+    if ((entryRef != NULL) && resTree_IsResource(entryRef))
+    {
+        sampleRef = resTree_GetCurrentValue(entryRef);
+    }
+
+    if (sampleRef == NULL)
+    {
+        typesPtr[i] = QUERY_READ_NO_VALUE;
+        timestampsPtr[i] = NAN;
+        valuesPtr[i] = NAN;
+        return;
+    }
+
+    io_DataType_t dataType = resTree_GetDataType(entryRef);
+
+    typesPtr[i] = dataType;
+    timestampsPtr[i] = dataSample_GetTimestamp(sampleRef);
+
+    switch (dataType)
+    {
+        case IO_DATA_TYPE_BOOLEAN:
+            valuesPtr[i] = dataSample_GetBoolean(sampleRef) ? 1 : 0;
+            break;
+
+        case IO_DATA_TYPE_NUMERIC:
+            valuesPtr[i] = dataSample_GetNumeric(sampleRef);
+            break;
+
+        default:
+            // Triggers have no value, and strings and JSON are fetched by path.
+            valuesPtr[i] = NAN;
+            break;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a handle to read the current value of a resource with query_ReadValues().  Getting a handle
+ * for the same resource again returns the same handle.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if the resource was not found.
+ *  - LE_UNSUPPORTED if the path refers to a namespace (which can't have a value).
+ *  - LE_NO_MEMORY if the client has too many handles.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_GetReadHandle
+(
+    const char* path,       ///< [IN] Resource path, absolute or relative to the app's namespace.
+    uint32_t* handlePtr     ///< [OUT] Handle of the resource.
+)
+{
+    resTree_EntryRef_t entryRef = queryService_FindResource(path);
+
+    if (entryRef == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+    else if (!resTree_IsResource(entryRef))
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    le_msg_SessionRef_t sessionRef = query_GetClientSessionRef();
+    ReadTable_t* tablePtr = FindReadTable(sessionRef);
+
+    if (tablePtr == NULL)
+    {
+        tablePtr = hub_MemAlloc(ReadTablePool);
+        if (tablePtr == NULL)
+        {
+            return LE_NO_MEMORY;
+        }
+
+        tablePtr->link = LE_DLS_LINK_INIT;
+        tablePtr->sessionRef = sessionRef;
+        tablePtr->count = 0;
+        le_dls_Queue(&ReadTableList, &tablePtr->link);
+    }
+
+    for (uint32_t i = 0; i < tablePtr->count; i++)
+    {
+        if (tablePtr->entries[i] == entryRef)
+        {
+            *handlePtr = i;
+            return LE_OK;
+        }
+    }
+
+    if (tablePtr->count >= NUM_ARRAY_MEMBERS(tablePtr->entries))
+    {
+        return LE_NO_MEMORY;
+    }
+
+    // Hold the entry, so a handle never refers to a freed entry.
+    le_mem_AddRef(entryRef);
+    tablePtr->entries[tablePtr->count] = entryRef;
+    *handlePtr = tablePtr->count++;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the current values of several resources at once.  Element i of each output array is
+ * filled in for handles[i].
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if a handle is unknown (its elements are filled in as READ_NO_VALUE).
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t query_ReadValues
+(
+    const uint32_t* handlesPtr,     ///< [IN] Handles, from query_GetReadHandle().
+    size_t handlesSize,             ///< [IN]
+    uint8_t* typesPtr,              ///< [OUT] Data type of each value, or READ_NO_VALUE.
+    size_t* typesSizePtr,           ///< [INOUT]
+    double* timestampsPtr,          ///< [OUT] Timestamp of each value.
+    size_t* timestampsSizePtr,      ///< [INOUT]
+    double* valuesPtr,              ///< [OUT] Value, for Boolean and numeric types.
+    size_t* valuesSizePtr           ///< [INOUT]
+)
+{
+    size_t count = handlesSize;
+
+    if (count > *typesSizePtr)
+    {
+        count = *typesSizePtr;
+    }
+    if (count > *timestampsSizePtr)
+    {
+        count = *timestampsSizePtr;
+    }
+    if (count > *valuesSizePtr)
+    {
+        count = *valuesSizePtr;
+    }
+
+    uint64_t startTime = stats_StartOp();
+    ReadTable_t* tablePtr = FindReadTable(query_GetClientSessionRef());
+    le_result_t result = (count == handlesSize) ? LE_OK : LE_BAD_PARAMETER;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        resTree_EntryRef_t entryRef = NULL;
+
+        if ((tablePtr != NULL) && (handlesPtr[i] < tablePtr->count))
+        {
+            entryRef = tablePtr->entries[handlesPtr[i]];
+        }
+        else
+        {
+            result = LE_BAD_PARAMETER;
+        }
+
+        ReadValue(entryRef, i, typesPtr, timestampsPtr, valuesPtr);
+    }
+
+    *typesSizePtr = count;
+    *timestampsSizePtr = count;
+    *valuesSizePtr = count;
+
+    stats_EndOp("query_ReadValues", NULL, startTime);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the read handles.
+ */
+//--------------------------------------------------------------------------------------------------
+void queryService_InitRead
+(
+    void
+)
+{
+    ReadTablePool = le_mem_InitStaticPool(ReadTablePool,
+                                          DEFAULT_READ_TABLE_POOL_SIZE,
+                                          sizeof(ReadTable_t));
+
+    le_msg_AddServiceCloseHandler(query_GetServiceRef(), SessionCloseHandler, NULL);
+}
@@ -10,9 +10,11 @@
 #include "dataHub.h"
 #include "dataSample.h"
 #include "resource.h"
+#include "ioPoint.h"
 #include "resTree.h"
 #include "adminService.h"
 #include "snapshot.h"
+#include "obsTemplate.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -494,6 +496,12 @@ static void CallResourceTreeChangeHandlers
     char absolutePath[HUB_MAX_RESOURCE_PATH_BYTES];
     resTree_GetPath(absolutePath, HUB_MAX_RESOURCE_PATH_BYTES, RootPtr, entryRef);
     admin_CallResourceTreeChangeHandlers(absolutePath, entryType, resourceOperationType);
+
+    // Instantiate any Observation templates whose source pattern matches the new resource.
+    if (resourceOperationType == ADMIN_RESOURCE_ADDED)
+    {
+        obsTemplate_ResourceAdded(entryRef);
+    }
 }
 
 
@@ -1139,7 +1147,7 @@ resTree_EntryRef_t resTree_GetNextSibling
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_FAULT is any other error happened during push.
  */
@@ -1226,6 +1234,27 @@ dataSample_Ref_t resTree_GetCurrentValue
 }
 
 
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_GetPushCounts
+(
+    resTree_EntryRef_t resRef,
+    uint32_t* countsPtr     ///< [OUT] ADMIN_PUSH_COUNTER_COUNT counts, indexed by
+                            ///< admin_PushCounter_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(resTree_IsResource(resRef));
+
+    res_GetPushCounts(resRef->u.resourcePtr, countsPtr);
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a data flow route from one resource to another by setting the data source for the
@@ -1333,6 +1362,9 @@ void resTree_DeleteObservation
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // A template takes its instances with it.
+    obsTemplate_ObservationDeleted(obsEntry);
+
     CallResourceTreeChangeHandlers(obsEntry, ADMIN_ENTRY_TYPE_OBSERVATION, ADMIN_RESOURCE_REMOVED);
 
     // Delete the Observation resource object.
@@ -1385,6 +1417,47 @@ double resTree_GetMinPeriod
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fixed data type of an Input or Output, which every value pushed to it is coerced to.
+ *
+ * @return The data type.
+ */
+//--------------------------------------------------------------------------------------------------
+io_DataType_t resTree_GetIoDataType
+(
+    resTree_EntryRef_t ioEntry
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(   (ioEntry->type == ADMIN_ENTRY_TYPE_INPUT)
+              || (ioEntry->type == ADMIN_ENTRY_TYPE_OUTPUT));
+
+    return ioPoint_GetDataType(ioEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find out how often the data samples pushed to a resource are wanted by its consumers (push
+ * handlers, and resources that have it as their source).
+ *
+ * @return The shortest period (s) at which a consumer wants samples (0 = every sample).
+ */
+//--------------------------------------------------------------------------------------------------
+double resTree_GetDemandedPeriod
+(
+    resTree_EntryRef_t resEntry,
+    uint32_t* consumerCountPtr  ///< [OUT] Number of consumers (0 = no demand).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(resTree_IsResource(resEntry));
+
+    return res_GetDemandedPeriod(resEntry->u.resourcePtr, consumerCountPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the highest value in a range that will be accepted by a given Observation.
@@ -1512,6 +1585,7 @@ void resTree_SetTransform
 //--------------------------------------------------------------------------------------------------
 {
     res_SetTransform(obsEntry->u.resourcePtr, transformType, paramsPtr, paramsSize);
+    obsTemplate_UpdateInstances(obsEntry);
 }
 
 
@@ -1546,6 +1620,7 @@ void resTree_SetBufferMaxCount
 //--------------------------------------------------------------------------------------------------
 {
     res_SetBufferMaxCount(obsEntry->u.resourcePtr, count);
+    obsTemplate_UpdateInstances(obsEntry);
 }
 
 
@@ -1582,6 +1657,7 @@ void resTree_SetBufferBackupPeriod
 //--------------------------------------------------------------------------------------------------
 {
     res_SetBufferBackupPeriod(obsEntry->u.resourcePtr, seconds);
+    obsTemplate_UpdateInstances(obsEntry);
 }
 
 
@@ -2034,8 +2110,9 @@ bool resTree_IsDeleted
  *
  * Any resource whose filter or routing (source or destination) settings are changed after a
  * call to res_StartUpdate() will stop accepting new data samples until res_EndUpdate() is called.
- * If new samples are pushed to a resource that is in this state of suspended operation, only
- * the newest one will be remembered and processed when res_EndUpdate() is called.
+ * Samples pushed to a resource that is in this state of suspended operation are held back, up to
+ * a limit per resource (the oldest are dropped first), and processed in order when
+ * res_EndUpdate() is called.
  */
 //--------------------------------------------------------------------------------------------------
 void resTree_StartUpdate
@@ -2264,6 +2341,7 @@ void resTree_SetJsonExtraction
     {
         LE_ASSERT(resEntry->u.resourcePtr != NULL);
         res_SetJsonExtraction(resEntry->u.resourcePtr, extractionSpec);
+        obsTemplate_UpdateInstances(resEntry);
     }
 }
 
@@ -2468,4 +2546,115 @@ void resTree_SetDestination
 
     LE_ASSERT(obsEntry->u.resourcePtr != NULL);
     res_SetDestination(obsEntry->u.resourcePtr, destination);
+    obsTemplate_UpdateInstances(obsEntry);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* resTree_GetDestination
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+)
+{
+    if (obsEntry->type != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        return "";
+    }
+
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+    return res_GetDestination(obsEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to a config Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetConfigFingerprint
+(
+    resTree_EntryRef_t obsEntry,  ///< Observation entry
+    uint32_t fingerprint          ///< Fingerprint of the applied settings (0 = none)
+)
+{
+    if (obsEntry->type != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        return;
+    }
+
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+    res_SetConfigFingerprint(obsEntry->u.resourcePtr, fingerprint);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to a config Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t resTree_GetConfigFingerprint
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+)
+{
+    if (obsEntry->type != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        return 0;
+    }
+
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+    return res_GetConfigFingerprint(obsEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation (see obsTemplate.h).  The instance
+ * shares the template's filter settings until one of them is set on the instance itself.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetObsTemplate
+(
+    resTree_EntryRef_t obsEntry,      ///< Instance Observation entry
+    resTree_EntryRef_t templateEntry  ///< Template Observation entry
+)
+{
+    LE_ASSERT(obsEntry->type == ADMIN_ENTRY_TYPE_OBSERVATION);
+    LE_ASSERT(templateEntry->type == ADMIN_ENTRY_TYPE_OBSERVATION);
+
+    res_SetTemplate(obsEntry->u.resourcePtr, templateEntry->u.resourcePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template Observation entry, or NULL if none or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t resTree_GetObsTemplate
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+)
+{
+    if (obsEntry->type != ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        return NULL;
+    }
+
+    LE_ASSERT(obsEntry->u.resourcePtr != NULL);
+    return res_GetTemplate(obsEntry->u.resourcePtr);
 }
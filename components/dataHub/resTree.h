@@ -409,7 +409,7 @@ LE_SHARED resTree_EntryRef_t resTree_GetNextSibling
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch of datasample unit.
  *      - LE_FAULT is any other error happened during push.
  */
@@ -453,6 +453,21 @@ LE_SHARED dataSample_Ref_t resTree_GetCurrentValue
 );
 
 
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_GetPushCounts
+(
+    resTree_EntryRef_t resRef,
+    uint32_t* countsPtr     ///< [OUT] ADMIN_PUSH_COUNTER_COUNT counts, indexed by
+                            ///< admin_PushCounter_t.
+);
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a data flow route from one resource to another by setting the data source for the
@@ -542,6 +557,34 @@ double resTree_GetMinPeriod
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fixed data type of an Input or Output, which every value pushed to it is coerced to.
+ *
+ * @return The data type.
+ */
+//--------------------------------------------------------------------------------------------------
+io_DataType_t resTree_GetIoDataType
+(
+    resTree_EntryRef_t ioEntry
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find out how often the data samples pushed to a resource are wanted by its consumers (push
+ * handlers, and resources that have it as their source).
+ *
+ * @return The shortest period (s) at which a consumer wants samples (0 = every sample).
+ */
+//--------------------------------------------------------------------------------------------------
+double resTree_GetDemandedPeriod
+(
+    resTree_EntryRef_t resEntry,
+    uint32_t* consumerCountPtr  ///< [OUT] Number of consumers (0 = no demand).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the highest value in a range that will be accepted by a given Observation.
@@ -983,8 +1026,9 @@ LE_SHARED bool resTree_IsDeleted
  *
  * Any resource whose filter or routing (source or destination) settings are changed after a
  * call to res_StartUpdate() will stop accepting new data samples until res_EndUpdate() is called.
- * If new samples are pushed to a resource that is in this state of suspended operation, only
- * the newest one will be remembered and processed when res_EndUpdate() is called.
+ * Samples pushed to a resource that is in this state of suspended operation are held back, up to
+ * a limit per resource (the oldest are dropped first), and processed in order when
+ * res_EndUpdate() is called.
  */
 //--------------------------------------------------------------------------------------------------
 void resTree_StartUpdate
@@ -1237,4 +1281,67 @@ void resTree_SetDestination
     const char* destination       ///< Destination string
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* resTree_GetDestination
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to a config Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetConfigFingerprint
+(
+    resTree_EntryRef_t obsEntry,  ///< Observation entry
+    uint32_t fingerprint          ///< Fingerprint of the applied settings (0 = none)
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to a config Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t resTree_GetConfigFingerprint
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation (see obsTemplate.h).  The instance
+ * shares the template's filter settings until one of them is set on the instance itself.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void resTree_SetObsTemplate
+(
+    resTree_EntryRef_t obsEntry,      ///< Instance Observation entry
+    resTree_EntryRef_t templateEntry  ///< Template Observation entry
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template Observation entry, or NULL if none or the entry is not an Observation.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t resTree_GetObsTemplate
+(
+    resTree_EntryRef_t obsEntry   ///< Observation entry
+);
+
 #endif // NAMESPACE_H_INCLUDE_GUARD
@@ -11,9 +11,70 @@
 #include "ioPoint.h"
 #include "obs.h"
 #include "handler.h"
+#include "ioService.h"
+#include "stats.h"
 
-/// true if an extended configuration update is in progress, false if in normal operating mode.
-static bool IsUpdateInProgress = false;
+/// Number of extended configuration updates in progress (0 = normal operating mode).  Updates
+/// nest (e.g., a snapshot taken while a config is applied a chunk at a time), and only the end of
+/// the outermost one resumes normal operation.
+static uint32_t UpdateDepth = 0;
+
+/// Resources flagged with RES_FLAG_CHANGING_CONFIG during the current update, so that the end of
+/// the update only has to visit those rather than the whole resource tree.
+static le_dls_List_t ChangingConfigList = LE_DLS_LIST_INIT;
+
+/// Default number of data samples that can be held back for resources whose configuration is
+/// changing: enough for two resources at their limit, as an update rarely catches more than a
+/// couple of busy resources.  This can be overridden in the .cdef.
+#define DEFAULT_PENDING_SAMPLE_POOL_SIZE    32
+
+/// Maximum number of data samples held back for all resources.  Once it is reached, the oldest
+/// held back sample of any resource is dropped for each new one, so the pool never has to expand.
+#define MAX_PENDING_SAMPLES                 DEFAULT_PENDING_SAMPLE_POOL_SIZE
+
+/// Maximum number of data samples held back for a single resource, which caps the memory a burst
+/// of pushes to one resource can take during a long update.
+#define MAX_PENDING_SAMPLES_PER_RESOURCE    16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A data sample pushed to a resource whose configuration is changing, held back until the end of
+ * the update.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                 ///< Link in the PendingSampleList.
+    le_dls_Link_t resLink;              ///< Link in the resource's pendingList.
+    res_Resource_t* resPtr;             ///< Resource the sample was pushed to.
+    io_DataType_t dataType;             ///< Data type of the sample.
+    dataSample_Ref_t sampleRef;         ///< The sample (holds a reference).
+    bool hasUnits;                      ///< false if the units are taken from the resource.
+    char units[HUB_MAX_UNITS_BYTES];    ///< Units the sample was pushed with.
+    le_clk_Time_t pushTime;             ///< When it was pushed (relative clock).
+}
+PendingSample_t;
+
+/// Pool of held back data samples.
+static le_mem_PoolRef_t PendingSamplePool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(PendingSamplePool, DEFAULT_PENDING_SAMPLE_POOL_SIZE,
+                          sizeof(PendingSample_t));
+
+/// Held back data samples of all resources, in the order they were pushed.
+static le_dls_List_t PendingSampleList = LE_DLS_LIST_INIT;
+
+/// Number of data samples in the PendingSampleList.
+static uint32_t PendingSampleCount = 0;
+
+/// Time the sample being pushed was pushed, if not now (a held back sample being replayed, or a
+/// sample from a batch), or NULL.
+static const le_clk_Time_t* PushTimePtr = NULL;
+
+#ifndef DHUB_NO_STATS
+/// CPU time (cycle counter ticks) taken so far by the pushes to other resources nested in the
+/// push in progress, so it can be left out of that push's own time.
+static uint64_t NestedPushTicks = 0;
+#endif
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -27,6 +88,263 @@ void res_Init
     void
 )
 {
+    PendingSamplePool = le_mem_InitStaticPool(PendingSamplePool,
+                                              DEFAULT_PENDING_SAMPLE_POOL_SIZE,
+                                              sizeof(PendingSample_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the oldest data sample held back for a given resource, or for any resource.
+ *
+ * @return Pointer to the held back sample, or NULL if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static PendingSample_t* GetOldestPending
+(
+    res_Resource_t* resPtr      ///< The resource, or NULL for any resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+
+    if (resPtr == NULL)
+    {
+        linkPtr = le_dls_Peek(&PendingSampleList);
+        return (linkPtr == NULL ? NULL : CONTAINER_OF(linkPtr, PendingSample_t, link));
+    }
+
+    linkPtr = le_dls_Peek(&resPtr->pendingList);
+    return (linkPtr == NULL ? NULL : CONTAINER_OF(linkPtr, PendingSample_t, resLink));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a held back data sample from the lists, keeping the block and the sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnlinkPending
+(
+    PendingSample_t* pendingPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Remove(&PendingSampleList, &pendingPtr->link);
+    PendingSampleCount--;
+    le_dls_Remove(&pendingPtr->resPtr->pendingList, &pendingPtr->resLink);
+    pendingPtr->resPtr->pendingCount--;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a held back data sample from the lists and drop the sample, keeping the block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropPending
+(
+    PendingSample_t* pendingPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    UnlinkPending(pendingPtr);
+    le_mem_Release(pendingPtr->sampleRef);
+    pendingPtr->sampleRef = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a pushed sample in one of a resource's push statistics counters.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void CountPush
+(
+    res_Resource_t* resPtr,
+    admin_PushCounter_t counter
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(resPtr);
+    LE_UNUSED(counter);
+#else
+    resPtr->pushCounts[counter]++;
+#endif
+}
+
+
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a resource's CPU time accounting current, moving on from the period it was last updated
+ * in to the given one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RollCpuPeriod
+(
+    res_Resource_t* resPtr,
+    uint32_t period
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resPtr->cpuPeriod + 1 == period)
+    {
+        memcpy(resPtr->cpuTicks[1], resPtr->cpuTicks[0], sizeof(resPtr->cpuTicks[1]));
+    }
+    else
+    {
+        memset(resPtr->cpuTicks[1], 0, sizeof(resPtr->cpuTicks[1]));
+    }
+    memset(resPtr->cpuTicks[0], 0, sizeof(resPtr->cpuTicks[0]));
+    resPtr->cpuPeriod = period;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add CPU time to a resource's account for one of its CPU profiling sites.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddCpuTicks
+(
+    res_Resource_t* resPtr,
+    admin_CpuSite_t site,
+    uint64_t ticks
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t period = stats_GetCpuPeriod();
+
+    if (resPtr->cpuPeriod != period)
+    {
+        RollCpuPeriod(resPtr, period);
+    }
+    resPtr->cpuTicks[0][site] += ticks;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Account for the CPU time a profiling site took, if CPU profiling was on when it started.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void EndCpu
+(
+    res_Resource_t* resPtr,
+    admin_CpuSite_t site,
+    uint64_t startTicks     ///< Value returned by stats_StartCpu() when the site started.
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(resPtr);
+    LE_UNUSED(site);
+    LE_UNUSED(startTicks);
+#else
+    if (startTicks != 0)
+    {
+        AddCpuTicks(resPtr, site, stats_ReadCycleCounter() - startTicks);
+    }
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hold back a data sample pushed to a resource whose configuration is changing, until the end of
+ * the update.  If the resource already has too many held back, its oldest one is dropped; if all
+ * resources together have too many held back, or there is no memory left for more, the oldest one
+ * of any resource is dropped.
+ *
+ * @note Takes ownership of the data sample reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeferPush
+(
+    res_Resource_t* resPtr,
+    io_DataType_t dataType,
+    const char* units,              ///< The units (NULL = take on resource's units)
+    dataSample_Ref_t dataSample
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PendingSample_t* pendingPtr = NULL;
+
+    if (resPtr->pendingCount >= MAX_PENDING_SAMPLES_PER_RESOURCE)
+    {
+        pendingPtr = GetOldestPending(resPtr);
+    }
+    else if (PendingSampleCount < MAX_PENDING_SAMPLES)
+    {
+        pendingPtr = hub_MemAlloc(PendingSamplePool);
+        if (pendingPtr != NULL)
+        {
+            pendingPtr->sampleRef = NULL;
+        }
+    }
+
+    if (pendingPtr == NULL)
+    {
+        pendingPtr = GetOldestPending(NULL);
+        if (pendingPtr == NULL)
+        {
+            LE_WARN("Dropping pushed value; too many held back for the configuration update.");
+            CountPush(resPtr, ADMIN_PUSH_COUNTER_PUSHED);
+            CountPush(resPtr, ADMIN_PUSH_COUNTER_DROPPED);
+            le_mem_Release(dataSample);
+            return;
+        }
+    }
+
+    if (pendingPtr->sampleRef != NULL)
+    {
+        LE_WARN("Dropping oldest pushed value held back for the configuration update.");
+        CountPush(pendingPtr->resPtr, ADMIN_PUSH_COUNTER_PUSHED);
+        CountPush(pendingPtr->resPtr, ADMIN_PUSH_COUNTER_DROPPED);
+        DropPending(pendingPtr);
+    }
+
+    pendingPtr->link = LE_DLS_LINK_INIT;
+    pendingPtr->resLink = LE_DLS_LINK_INIT;
+    pendingPtr->resPtr = resPtr;
+    pendingPtr->dataType = dataType;
+    pendingPtr->sampleRef = dataSample;
+    pendingPtr->hasUnits = (units != NULL);
+    pendingPtr->pushTime = res_GetPushTime();
+    if (units != NULL)
+    {
+        LE_ASSERT(LE_OK == le_utf8_Copy(pendingPtr->units, units, sizeof(pendingPtr->units),
+                                        NULL));
+    }
+
+    le_dls_Queue(&PendingSampleList, &pendingPtr->link);
+    PendingSampleCount++;
+    le_dls_Queue(&resPtr->pendingList, &pendingPtr->resLink);
+    resPtr->pendingCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag that the configuration of a resource is changing, so acceptance of new pushed values is
+ * suspended until the update finishes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MarkChangingConfig
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((resPtr->flags & RES_FLAG_CHANGING_CONFIG) == 0)
+    {
+        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        le_dls_Queue(&ChangingConfigList, &resPtr->changingLink);
+    }
 }
 
 
@@ -126,6 +444,14 @@ void res_Construct
     resPtr->flags = RES_FLAG_NEW;
     resPtr->pushHandlerList = LE_DLS_LIST_INIT;
     resPtr->jsonExample = NULL;
+    resPtr->changingLink = LE_DLS_LINK_INIT;
+    resPtr->pendingList = LE_DLS_LIST_INIT;
+    resPtr->pendingCount = 0;
+#ifndef DHUB_NO_STATS
+    memset(resPtr->pushCounts, 0, sizeof(resPtr->pushCounts));
+    resPtr->cpuPeriod = 0;
+    memset(resPtr->cpuTicks, 0, sizeof(resPtr->cpuTicks));
+#endif
 }
 
 
@@ -389,6 +715,19 @@ void res_Destruct
 {
     resPtr->entryRef = NULL;
 
+    if (resPtr->flags & RES_FLAG_CHANGING_CONFIG)
+    {
+        le_dls_Remove(&ChangingConfigList, &resPtr->changingLink);
+        resPtr->flags &= ~RES_FLAG_CHANGING_CONFIG;
+    }
+
+    PendingSample_t* pendingPtr;
+    while (NULL != (pendingPtr = GetOldestPending(resPtr)))
+    {
+        DropPending(pendingPtr);
+        le_mem_Release(pendingPtr);
+    }
+
     if (resPtr->currentValue != NULL)
     {
         le_mem_Release(resPtr->currentValue);
@@ -484,6 +823,79 @@ dataSample_Ref_t res_GetCurrentValue
 }
 
 
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_GetPushCounts
+(
+    res_Resource_t* resPtr,
+    uint32_t* countsPtr     ///< [OUT] ADMIN_PUSH_COUNTER_COUNT counts, indexed by
+                            ///< admin_PushCounter_t.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memcpy(countsPtr, resPtr->pushCounts, sizeof(resPtr->pushCounts));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ResetPushCounts
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(resPtr->pushCounts, 0, sizeof(resPtr->pushCounts));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time a resource took in each admin_CpuSite_t, in a given CPU profiling period and
+ * the one before it.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_GetCpuTicks
+(
+    res_Resource_t* resPtr,
+    uint32_t period,            ///< Profiling period (see stats_GetCpuPeriod()).
+    uint64_t* currentTicksPtr,  ///< [OUT] ADMIN_CPU_SITE_COUNT times in period (ticks).
+    uint64_t* previousTicksPtr  ///< [OUT] ADMIN_CPU_SITE_COUNT times in period - 1 (ticks).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (resPtr->cpuPeriod != period)
+    {
+        RollCpuPeriod(resPtr, period);
+    }
+    memcpy(currentTicksPtr, resPtr->cpuTicks[0], sizeof(resPtr->cpuTicks[0]));
+    memcpy(previousTicksPtr, resPtr->cpuTicks[1], sizeof(resPtr->cpuTicks[1]));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the CPU time a resource has taken.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ResetCpuTicks
+(
+    res_Resource_t* resPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    memset(resPtr->cpuTicks, 0, sizeof(resPtr->cpuTicks));
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the source resource of a given resource.
@@ -510,6 +922,11 @@ le_result_t res_SetSource
         return LE_OK;
     }
 
+    if (resTree_GetEntryType(destPtr->entryRef) == ADMIN_ENTRY_TYPE_OBSERVATION)
+    {
+        obs_ClearSourcePathCache(destPtr);
+    }
+
     // If the destination has some other source, remove that.
     if (destPtr->srcPtr != NULL)
     {
@@ -541,10 +958,10 @@ le_result_t res_SetSource
         // If an extended update is in progress, flag that the configuration of both the
         // source and destination resources are changing, so acceptance of new pushed values
         // should be suspended until the update finishes.
-        if (IsUpdateInProgress)
+        if (UpdateDepth > 0)
         {
-            srcPtr->flags |= RES_FLAG_CHANGING_CONFIG;
-            destPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+            MarkChangingConfig(srcPtr);
+            MarkChangingConfig(destPtr);
         }
     }
     // If the source is being set to a NULL source (removing the source) and the resource is
@@ -560,6 +977,9 @@ le_result_t res_SetSource
         }
     }
 
+    // The old and new sources have gained or lost a consumer.
+    ioService_DemandChanged();
+
     return LE_OK;
 }
 
@@ -619,10 +1039,13 @@ static le_result_t UpdateCurrentValue
                 hub_GetDataTypeName(ioPoint_GetDataType(resPtr)));
 
         le_mem_Release(dataSample);
+        CountPush(resPtr, ADMIN_PUSH_COUNTER_REJECTED);
 
         return LE_BAD_PARAMETER;
     }
 
+    CountPush(resPtr, ADMIN_PUSH_COUNTER_ACCEPTED);
+
     // Set the current value to the new data sample.
     if (resPtr->currentValue != NULL)
     {
@@ -675,6 +1098,9 @@ static le_result_t UpdateCurrentValue
         linkPtr = le_dls_PeekNext(&(resPtr->destList), linkPtr);
     }
 
+    uint64_t startTime = stats_StartStage();
+    uint64_t startTicks = stats_StartCpu();
+
     // Call any the push handlers that match the data type of the sample.
     handler_CallAll(&resPtr->pushHandlerList, dataType, dataSample);
 
@@ -685,25 +1111,23 @@ static le_result_t UpdateCurrentValue
         obs_TriggerDestinationCallback(resPtr, dataType, dataSample);
     }
 
+    EndCpu(resPtr, ADMIN_CPU_SITE_HANDLERS, startTicks);
+    stats_EndStage(ADMIN_PUSH_STAGE_HANDLERS, startTime);
+
     return res;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Push a data sample to a resource.
+ * Push a data sample to a resource (see res_Push()).
  *
  * @note Takes ownership of the data sample reference.
  *
- * @return
- *      - LE_OK If datasample was pushed successfully.
- *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
- *      - LE_BAD_PARAMETER If there is a mismatch if datasample unit.
- *      - LE_FAULT If any other error happened during push.
+ * @return Same as res_Push().
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t res_Push
+static le_result_t Push
 (
     res_Resource_t* resPtr,         ///< The resource to push to.
     io_DataType_t dataType,         ///< The data type.
@@ -719,25 +1143,55 @@ le_result_t res_Push
         units = NULL;
     }
 
+    // If the resource is undergoing a change to its routing or filtering configuration,
+    // then the sample is held back until the configuration change is done, so that it goes
+    // through the new configuration.
+    if (resPtr->flags & RES_FLAG_CHANGING_CONFIG)
+    {
+        LE_DEBUG("Deferring pushed value because configuration update is in progress.");
+        DeferPush(resPtr, dataType, units, dataSample);
+        return LE_IN_PROGRESS;
+    }
+
+    CountPush(resPtr, ADMIN_PUSH_COUNTER_PUSHED);
+
     if (ADMIN_ENTRY_TYPE_OBSERVATION == resTree_GetEntryType(resPtr->entryRef))
     {
         // Do JSON extraction (if applicable) before filtering.
-        if (obs_DoJsonExtraction(resPtr, &dataType, &dataSample) != LE_OK)
+        uint64_t startTime = stats_StartStage();
+        uint64_t startTicks = stats_StartCpu();
+        le_result_t extractRes = obs_DoJsonExtraction(resPtr, &dataType, &dataSample);
+        EndCpu(resPtr, ADMIN_CPU_SITE_JSON_EXTRACTION, startTicks);
+        stats_EndStage(ADMIN_PUSH_STAGE_JSON_EXTRACTION, startTime);
+        if (extractRes != LE_OK)
         {
             le_mem_Release(dataSample);
+            CountPush(resPtr, ADMIN_PUSH_COUNTER_REJECTED);
             LE_ERROR("Rejecting push because failed to do JSON extraction on datasample");
             return LE_FAULT;
         }
 
         // Buffer and possibly backup the sample
+        startTime = stats_StartStage();
         obs_ProcessAccepted(resPtr, dataType, dataSample);
+        stats_EndStage(ADMIN_PUSH_STAGE_BUFFER, startTime);
 
         // Perform any transforms on the buffered data
+        startTime = stats_StartStage();
+        startTicks = stats_StartCpu();
         dataSample = obs_ApplyTransform(resPtr, dataType, dataSample);
+        EndCpu(resPtr, ADMIN_CPU_SITE_TRANSFORM, startTicks);
 
-        if (true != obs_ShouldAccept(resPtr, dataType, dataSample))
+        stats_EndStage(ADMIN_PUSH_STAGE_TRANSFORM, startTime);
+
+        admin_PushCounter_t filter = ADMIN_PUSH_COUNTER_REJECTED;
+        startTime = stats_StartStage();
+        bool shouldAccept = obs_ShouldAccept(resPtr, dataType, dataSample, &filter);
+        stats_EndStage(ADMIN_PUSH_STAGE_FILTER, startTime);
+        if (!shouldAccept)
         {
             le_mem_Release(dataSample);
+            CountPush(resPtr, filter);
             LE_ERROR("Rejecting push because datasample should not be accepted");
             return LE_FAULT;
         }
@@ -753,15 +1207,6 @@ le_result_t res_Push
     resPtr->pushedValue = dataSample;
     resPtr->pushedType = dataType;
 
-    // If the resource is undergoing a change to its routing or filtering configuration,
-    // then acceptance of new samples is suspended until the configuration change is done.
-    if (resPtr->flags & RES_FLAG_CHANGING_CONFIG)
-    {
-        LE_WARN("Rejecting pushed value because configuration update is in progress.");
-        le_mem_Release(dataSample);
-        return LE_IN_PROGRESS;
-    }
-
     // If an override is in effect, the current value becomes a new data sample that has
     // the same timestamp as the pushed sample but the override's value (and we drop the
     // original sample).
@@ -790,14 +1235,19 @@ le_result_t res_Push
                         units,
                         resPtr->units);
                 le_mem_Release(dataSample);
+                CountPush(resPtr, ADMIN_PUSH_COUNTER_REJECTED);
                 return LE_BAD_PARAMETER;
             }
 
             // Inputs and outputs have a fixed type.  This means that if a different type
             // of value is received, we must do a type conversion before we can accept it.
+            uint64_t startTime = stats_StartStage();
             le_result_t res = ioPoint_DoTypeCoercion(resPtr, &dataType, &dataSample);
+            stats_EndStage(ADMIN_PUSH_STAGE_COERCION, startTime);
             if (res != LE_OK)
             {
+                CountPush(resPtr, (res == LE_NO_MEMORY) ? ADMIN_PUSH_COUNTER_DROPPED
+                                                        : ADMIN_PUSH_COUNTER_REJECTED);
                 LE_ERROR("Rejecting push because failed to do type coercion on datasample");
                 return res;
             }
@@ -829,6 +1279,57 @@ le_result_t res_Push
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push a data sample to a resource.
+ *
+ * @note Takes ownership of the data sample reference.
+ *
+ * @return
+ *      - LE_OK If datasample was pushed successfully.
+ *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
+ *      - LE_BAD_PARAMETER If there is a mismatch if datasample unit.
+ *      - LE_FAULT If any other error happened during push.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t res_Push
+(
+    res_Resource_t* resPtr,         ///< The resource to push to.
+    io_DataType_t dataType,         ///< The data type.
+    const char* units,              ///< The units (NULL or "" = take on resource's units)
+    dataSample_Ref_t dataSample     ///< The data sample (timestamp + value).
+)
+//--------------------------------------------------------------------------------------------------
+{
+#ifdef DHUB_NO_STATS
+    return Push(resPtr, dataType, units, dataSample);
+#else
+    uint64_t startTicks = stats_StartCpu();
+
+    if (startTicks == 0)
+    {
+        return Push(resPtr, dataType, units, dataSample);
+    }
+
+    // The time taken by pushes to the resources this one feeds is accounted for by those
+    // resources, so is left out of this one's.
+    uint64_t outerNestedTicks = NestedPushTicks;
+    NestedPushTicks = 0;
+
+    le_result_t result = Push(resPtr, dataType, units, dataSample);
+
+    uint64_t ticks = stats_ReadCycleCounter() - startTicks;
+    AddCpuTicks(resPtr,
+                ADMIN_CPU_SITE_PUSH,
+                (ticks > NestedPushTicks) ? (ticks - NestedPushTicks) : 0);
+    NestedPushTicks = outerNestedTicks + ticks;
+
+    return result;
+#endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add a Push Handler to an Output resource.
@@ -849,7 +1350,75 @@ hub_HandlerRef_t res_AddPushHandler
 {
     LE_ASSERT(resTree_IsResource(resPtr->entryRef));
 
-    return handler_Add(&resPtr->pushHandlerList, dataType, callbackPtr, contextPtr);
+    hub_HandlerRef_t handlerRef = handler_Add(&resPtr->pushHandlerList,
+                                              dataType,
+                                              callbackPtr,
+                                              contextPtr);
+    if (handlerRef != NULL)
+    {
+        ioService_DemandChanged();
+    }
+
+    return handlerRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find out how often the data samples pushed to a resource are wanted by its consumers: the push
+ * handlers registered on it, and the resources that have it as their source.  Push handlers and
+ * non-Observations take every sample; an Observation takes at most one per its minimum period.
+ *
+ * @return The shortest period (s) at which a consumer wants samples (0 = every sample).
+ */
+//--------------------------------------------------------------------------------------------------
+double res_GetDemandedPeriod
+(
+    res_Resource_t* resPtr,
+    uint32_t* consumerCountPtr  ///< [OUT] Number of consumers (0 = no demand).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    double period = 0;
+    uint32_t count = 0;
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&resPtr->pushHandlerList);
+    while (linkPtr != NULL)
+    {
+        count++;
+        linkPtr = le_dls_PeekNext(&resPtr->pushHandlerList, linkPtr);
+    }
+
+    bool isEverySample = (count > 0);
+
+    linkPtr = le_dls_Peek(&resPtr->destList);
+    while (linkPtr != NULL)
+    {
+        res_Resource_t* destPtr = CONTAINER_OF(linkPtr, res_Resource_t, destListLink);
+        double minPeriod = 0;
+
+        if (resTree_GetEntryType(destPtr->entryRef) == ADMIN_ENTRY_TYPE_OBSERVATION)
+        {
+            minPeriod = obs_GetMinPeriod(destPtr);
+        }
+
+        // Not set (0 or NAN) means every sample is accepted.
+        if (!(minPeriod > 0))
+        {
+            isEverySample = true;
+        }
+        else if ((count == 0) || (minPeriod < period))
+        {
+            period = minPeriod;
+        }
+
+        count++;
+        linkPtr = le_dls_PeekNext(&resPtr->destList, linkPtr);
+    }
+
+    *consumerCountPtr = count;
+
+    return (isEverySample ? 0 : period);
 }
 
 
@@ -974,9 +1543,12 @@ void res_SetMinPeriod
 {
     obs_SetMinPeriod(resPtr, minPeriod);
 
-    if (IsUpdateInProgress)
+    // The Observation's source is now demanded at a different rate.
+    ioService_DemandChanged();
+
+    if (UpdateDepth > 0)
     {
-        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        MarkChangingConfig(resPtr);
     }
 }
 
@@ -1014,9 +1586,9 @@ void res_SetHighLimit
 {
     obs_SetHighLimit(resPtr, highLimit);
 
-    if (IsUpdateInProgress)
+    if (UpdateDepth > 0)
     {
-        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        MarkChangingConfig(resPtr);
     }
 }
 
@@ -1054,9 +1626,9 @@ void res_SetLowLimit
 {
     obs_SetLowLimit(resPtr, lowLimit);
 
-    if (IsUpdateInProgress)
+    if (UpdateDepth > 0)
     {
-        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        MarkChangingConfig(resPtr);
     }
 }
 
@@ -1097,9 +1669,9 @@ void res_SetChangeBy
 {
     obs_SetChangeBy(resPtr, change);
 
-    if (IsUpdateInProgress)
+    if (UpdateDepth > 0)
     {
-        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        MarkChangingConfig(resPtr);
     }
 }
 
@@ -1141,9 +1713,9 @@ void res_SetTransform
 {
     obs_SetTransform(resPtr, (obs_TransformType_t)transformType, paramsPtr, paramsSize);
 
-    if (IsUpdateInProgress)
+    if (UpdateDepth > 0)
     {
-        resPtr->flags |= RES_FLAG_CHANGING_CONFIG;
+        MarkChangingConfig(resPtr);
     }
 }
 
@@ -1663,8 +2235,12 @@ bool res_IsNew
  *
  * Any resource whose filter or routing (source or destination) settings are changed after a
  * call to res_StartUpdate() will stop accepting new data samples until res_EndUpdate() is called.
- * If new samples are pushed to a resource that is in this state of suspended operation, only
- * the newest one will be remembered and processed when res_EndUpdate() is called.
+ * Samples pushed to a resource that is in this state of suspended operation are held back, up to
+ * a limit per resource (the oldest are dropped first), and processed in order when
+ * res_EndUpdate() is called.
+ *
+ * Updates nest: each call must be matched by a call to res_EndUpdate(), and only the last of
+ * those resumes normal operation.
  */
 //--------------------------------------------------------------------------------------------------
 void res_StartUpdate
@@ -1673,44 +2249,101 @@ void res_StartUpdate
 )
 //--------------------------------------------------------------------------------------------------
 {
-    IsUpdateInProgress = true;
+    UpdateDepth++;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Clear the config changing flag on a given resource.
+ * Notify that all pending administrative changes have been applied, so normal operation may resume,
+ * and it's safe to delete buffer backup files that aren't being used.
+ *
+ * Does nothing but end the update if it is nested in another one (see res_StartUpdate()).
  */
 //--------------------------------------------------------------------------------------------------
-static void ClearConfigChangingFlag
+void res_EndUpdate
 (
-    res_Resource_t* resPtr,
-    admin_EntryType_t entryType
+    void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    LE_UNUSED(entryType);
-    resPtr->flags &= ~RES_FLAG_CHANGING_CONFIG;
+    // An end without a start (e.g., from an Admin client) is harmless, as it always has been.
+    if (UpdateDepth > 0)
+    {
+        UpdateDepth--;
+    }
+    if (UpdateDepth > 0)
+    {
+        return;
+    }
+
+    // Only the resources whose configuration changed during the update have the flag set.
+    le_dls_Link_t* linkPtr;
+    while (NULL != (linkPtr = le_dls_Pop(&ChangingConfigList)))
+    {
+        res_Resource_t* resPtr = CONTAINER_OF(linkPtr, res_Resource_t, changingLink);
+
+        resPtr->flags &= ~RES_FLAG_CHANGING_CONFIG;
+    }
+
+    // Now push the held back samples through the new configuration, in the order they came in.
+    PendingSample_t* pendingPtr;
+    while (NULL != (pendingPtr = GetOldestPending(NULL)))
+    {
+        res_Resource_t* resPtr = pendingPtr->resPtr;
+
+        UnlinkPending(pendingPtr);
+        PushTimePtr = &pendingPtr->pushTime;
+        res_Push(resPtr,
+                 pendingPtr->dataType,
+                 pendingPtr->hasUnits ? pendingPtr->units : NULL,
+                 pendingPtr->sampleRef);
+        PushTimePtr = NULL;
+        le_mem_Release(pendingPtr);
+    }
+
+    obs_DeleteUnusedBackupFiles();
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Notify that all pending administrative changes have been applied, so normal operation may resume,
- * and it's safe to delete buffer backup files that aren't being used.
+ * Set the time the data samples pushed from now on were pushed, for samples that were not pushed
+ * one at a time as they were taken (e.g., samples from a batch).
  */
 //--------------------------------------------------------------------------------------------------
-void res_EndUpdate
+void res_SetPushTime
 (
-    void
+    const le_clk_Time_t* timePtr    ///< Time (relative clock), or NULL to go back to now.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    IsUpdateInProgress = false;
+    PushTimePtr = timePtr;
+}
 
-    resTree_ForEachResource(ClearConfigChangingFlag);
 
-    obs_DeleteUnusedBackupFiles();
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time the data sample being pushed was pushed: now, the time set by res_SetPushTime(),
+ * or, while a sample held back during an administrative update is replayed, the time it was first
+ * pushed.  Time based filters (e.g., minPeriod) use this, so that the samples held back or
+ * batched don't all seem to arrive at once.
+ *
+ * @return The time (relative clock).
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t res_GetPushTime
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (PushTimePtr != NULL)
+    {
+        return *PushTimePtr;
+    }
+
+    return hub_GetRelativeTime();
 }
 
 
@@ -2014,3 +2647,91 @@ void res_SetDestination
 {
     obs_SetDestination(resPtr, destination);
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* res_GetDestination
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return obs_GetDestination(resPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetConfigFingerprint
+(
+    res_Resource_t* resPtr,      ///< Ptr to Observation resource
+    uint32_t fingerprint         ///< Fingerprint of the applied settings (0 = none)
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_SetConfigFingerprint(resPtr, fingerprint);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t res_GetConfigFingerprint
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return obs_GetConfigFingerprint(resPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation, sharing the template's filter settings
+ * until one of them is set on the instance itself.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetTemplate
+(
+    res_Resource_t* resPtr,         ///< Ptr to the instance Observation resource
+    res_Resource_t* templateResPtr  ///< Ptr to the template Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    obs_SetTemplate(resPtr, templateResPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template's resource tree entry, or NULL if the Observation is not an instance.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t res_GetTemplate
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return obs_GetTemplate(resPtr);
+}
@@ -53,6 +53,18 @@ typedef struct res_Resource
     uint32_t flags;  ///< Resource status flags.
     le_dls_List_t pushHandlerList;  ///< List of Push Handler callbacks registered on this resource.
     dataSample_Ref_t jsonExample; ///< Ref to JSON example value; NULL if not set.
+    le_dls_Link_t changingLink; ///< Used to link into the list of resources whose config is
+                                ///< changing (while RES_FLAG_CHANGING_CONFIG is set).
+    le_dls_List_t pendingList; ///< Samples held back until the config update ends, oldest first.
+    uint32_t pendingCount; ///< Number of samples in the pendingList.
+#ifndef DHUB_NO_STATS
+    uint32_t pushCounts[ADMIN_PUSH_COUNTER_COUNT]; ///< Push statistics, indexed by
+                                                    ///< admin_PushCounter_t.
+    uint32_t cpuPeriod; ///< CPU profiling period that cpuTicks[0] is for.
+    uint64_t cpuTicks[2][ADMIN_CPU_SITE_COUNT]; ///< CPU time (cycle counter ticks) in each
+                                                ///< admin_CpuSite_t, in periods cpuPeriod and
+                                                ///< cpuPeriod - 1.
+#endif
 }
 res_Resource_t;
 
@@ -299,6 +311,58 @@ dataSample_Ref_t res_GetCurrentValue
 );
 
 
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_GetPushCounts
+(
+    res_Resource_t* resPtr,
+    uint32_t* countsPtr     ///< [OUT] ADMIN_PUSH_COUNTER_COUNT counts, indexed by
+                            ///< admin_PushCounter_t.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the push statistics counters of a resource.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ResetPushCounts
+(
+    res_Resource_t* resPtr
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the CPU time a resource took in each admin_CpuSite_t, in a given CPU profiling period and
+ * the one before it.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_GetCpuTicks
+(
+    res_Resource_t* resPtr,
+    uint32_t period,            ///< Profiling period (see stats_GetCpuPeriod()).
+    uint64_t* currentTicksPtr,  ///< [OUT] ADMIN_CPU_SITE_COUNT times in period (ticks).
+    uint64_t* previousTicksPtr  ///< [OUT] ADMIN_CPU_SITE_COUNT times in period - 1 (ticks).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the CPU time a resource has taken.
+ */
+//--------------------------------------------------------------------------------------------------
+void res_ResetCpuTicks
+(
+    res_Resource_t* resPtr
+);
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the source resource of a given resource.
@@ -340,7 +404,7 @@ resTree_EntryRef_t res_GetSource
  * @return
  *      - LE_OK If datasample was pushed successfully.
  *      - LE_NO_MEMORY If failed to push the data sample because of failure in memory allocation.
- *      - LE_IN_PROGRESS Push is rejected because a configuration update is in progress.
+ *      - LE_IN_PROGRESS Push is deferred until a configuration update is complete.
  *      - LE_BAD_PARAMETER If there is a mismatch if datasample unit.
  *      - LE_FAULT If any other error happened during push.
  */
@@ -372,6 +436,21 @@ hub_HandlerRef_t res_AddPushHandler
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find out how often the data samples pushed to a resource are wanted by its consumers: the push
+ * handlers registered on it, and the resources that have it as their source.
+ *
+ * @return The shortest period (s) at which a consumer wants samples (0 = every sample).
+ */
+//--------------------------------------------------------------------------------------------------
+double res_GetDemandedPeriod
+(
+    res_Resource_t* resPtr,
+    uint32_t* consumerCountPtr  ///< [OUT] Number of consumers (0 = no demand).
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Check whether a given resource has administrative settings.
@@ -855,8 +934,9 @@ bool res_IsNew
  *
  * Any resource whose filter or routing (source or destination) settings are changed after a
  * call to res_StartUpdate() will stop accepting new data samples until res_EndUpdate() is called.
- * If new samples are pushed to a resource that is in this state of suspended operation, only
- * the newest one will be remembered and processed when res_EndUpdate() is called.
+ * Samples pushed to a resource that is in this state of suspended operation are held back, up to
+ * a limit per resource (the oldest are dropped first), and processed in order when
+ * res_EndUpdate() is called.
  */
 //--------------------------------------------------------------------------------------------------
 void res_StartUpdate
@@ -877,6 +957,33 @@ void res_EndUpdate
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the time the data samples pushed from now on were pushed, for samples that were not pushed
+ * one at a time as they were taken (e.g., samples from a batch).
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetPushTime
+(
+    const le_clk_Time_t* timePtr    ///< Time (relative clock), or NULL to go back to now.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time the data sample being pushed was pushed: now, the time set by res_SetPushTime(),
+ * or, while a sample held back during an administrative update is replayed, the time it was first
+ * pushed.
+ *
+ * @return The time (relative clock).
+ */
+//--------------------------------------------------------------------------------------------------
+le_clk_Time_t res_GetPushTime
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data out of a buffer.  Data is written to a given file descriptor in JSON-encoded format
@@ -1099,4 +1206,72 @@ void res_SetDestination
     const char* destination      ///< Destination string
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the destination string of a specific Observation.
+ *
+ * @return The destination string, or "" if none is set.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* res_GetDestination
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetConfigFingerprint
+(
+    res_Resource_t* resPtr,      ///< Ptr to Observation resource
+    uint32_t fingerprint         ///< Fingerprint of the applied settings (0 = none)
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the fingerprint of the config file settings last applied to an Observation.
+ *
+ * @return The fingerprint, or 0 if none has been recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t res_GetConfigFingerprint
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make an Observation an instance of a template Observation, sharing the template's filter settings
+ * until one of them is set on the instance itself.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void res_SetTemplate
+(
+    res_Resource_t* resPtr,         ///< Ptr to the instance Observation resource
+    res_Resource_t* templateResPtr  ///< Ptr to the template Observation resource
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the template an Observation is an instance of.
+ *
+ * @return The template's resource tree entry, or NULL if the Observation is not an instance.
+ */
+//--------------------------------------------------------------------------------------------------
+resTree_EntryRef_t res_GetTemplate
+(
+    res_Resource_t* resPtr       ///< Ptr to Observation resource
+);
+
 #endif // RESOURCE_H_INCLUDE_GUARD
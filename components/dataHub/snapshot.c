@@ -10,6 +10,7 @@
 #include "interfaces.h"
 
 #include "dataHub.h"
+#include "stats.h"
 #include "jsonFormatter.h"
 #ifdef WITH_OCTAVE
 #include "octaveFormatter.h"
@@ -524,6 +525,25 @@ static void TreeEnd
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/*
+ * Run a step of the snapshot state machine, timing it as a slow operation candidate.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunStep
+(
+    void    *stepPtr,   ///< [IN] Step to run (its le_event_DeferredFunc_t).
+    void    *unused     ///< [IN] Unused parameter.
+)
+{
+    uint64_t startTime = stats_StartOp();
+
+    ((le_event_DeferredFunc_t) (uintptr_t) stepPtr)(NULL, unused);
+
+    // The tree is only held still while the snapshot is running.
+    stats_EndOp("snapshot", (IsRunning ? Snapshot.rootRef : NULL), startTime);
+}
+
 //--------------------------------------------------------------------------------------------------
 /*
  * Transition the tree-walking snapshot state machine to the next state.
@@ -557,7 +577,7 @@ void snapshot_Step
 #if LE_DEBUG_ENABLED
     LE_DEBUG("Snapshot transition: -> %s", stepNames[Snapshot.nextState]);
 #endif /* end LE_DEBUG_ENABLED */
-    le_event_QueueFunction(steps[Snapshot.nextState], NULL, NULL);
+    le_event_QueueFunction(&RunStep, (void *) (uintptr_t) steps[Snapshot.nextState], NULL);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,1017 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file stats.c
+ *
+ * Push statistics (see @ref c_dataHubAdmin_Stats), the slow operation trace (see
+ * @ref c_dataHubAdmin_SlowOps), CPU profiling (see @ref c_dataHubAdmin_CpuProfile), and the Admin
+ * API functions that read them.
+ *
+ * Each stage of the push path has an HDR-style latency histogram: times under 8 ns have a bucket
+ * each, and each power of two above that is split into 8 buckets, so a bucket is never wider than
+ * 1/8 of the times in it.  Recording a time is a few integer operations, and the histograms take
+ * a fixed amount of memory however many samples go through.  The per-resource counters are kept
+ * by the Resource module.
+ *
+ * Everything the Data Hub does runs on one event loop, so one slow operation holds up every
+ * client.  Operations run from the event loop are timed, and those over the threshold go in a
+ * ring of the most recent ones.  A periodic timer also checks how late it runs, to catch stalls
+ * in operations that aren't timed.
+ *
+ * CPU profiling reads a cycle counter around the costly parts of each push, and each resource
+ * accounts for its time in the current and the previous CPU_PERIOD_SECS period.  The sliding
+ * window is the last CPU_PERIOD_SECS: the current period, plus the part of the previous one that
+ * is still in the window, assuming its time was spread evenly over it.  That takes two sets of
+ * counters per resource whatever the window, and no timer.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "resource.h"
+#include "resTree.h"
+#include "stats.h"
+
+#ifndef DHUB_NO_STATS
+
+#if LE_CONFIG_LINUX
+#   include <time.h>
+#endif
+
+/// Number of bits of a time that select the bucket within its power of two.
+#define SUB_BUCKET_BITS     3
+
+/// Number of buckets per power of two.
+#define SUB_BUCKET_COUNT    (1 << SUB_BUCKET_BITS)
+
+/// Times of 2^MAX_TIME_BITS ns (about 18 minutes) or more are counted in the last bucket.
+#define MAX_TIME_BITS       40
+
+/// Number of buckets in a histogram.
+#define BUCKET_COUNT        ((MAX_TIME_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Latency histogram of one stage of the push path.  Times are in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t count;                     ///< Number of times recorded.
+    uint64_t sum;                       ///< Sum of the times recorded.
+    uint64_t max;                       ///< Longest time recorded.
+    uint32_t buckets[BUCKET_COUNT];     ///< Number of times recorded in each bucket.
+}
+Histogram_t;
+
+/// Latency histograms, indexed by stage.
+static Histogram_t Histograms[ADMIN_PUSH_STAGE_COUNT];
+
+/// Are the stages of the push path timed?  Off by default, as it takes two clock reads per stage.
+static bool IsTimingStages = false;
+
+/// Number of slow operations kept.
+#define SLOW_OP_COUNT                   32
+
+/// Default slow operation threshold (ns).
+#define DEFAULT_SLOW_OP_THRESHOLD_NS    100000000
+
+/// Interval of the event loop watchdog timer (ms).
+#define WATCHDOG_INTERVAL_MS            1000
+
+/// The event loop watchdog ignores timer jitter below this, whatever the threshold (ns).
+#define WATCHDOG_MIN_STALL_NS           10000000
+
+/// Name given to stalls caught by the event loop watchdog.
+#define WATCHDOG_OP_NAME                "event loop"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An operation that took longer than the threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char name[ADMIN_MAX_SLOW_OP_NAME_LEN + 1];  ///< Name of the operation.
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];     ///< Path of the entry it was on, or "".
+    double timestamp;                           ///< When it started (s since the Epoch).
+    double duration;                            ///< How long it took (s).
+}
+SlowOp_t;
+
+/// Ring of the most recent slow operations.
+static SlowOp_t SlowOps[SLOW_OP_COUNT];
+
+/// Number of slow operations recorded since they were last cleared.  The next one goes in
+/// SlowOps[SlowOpCount % SLOW_OP_COUNT].
+static uint32_t SlowOpCount = 0;
+
+/// Operations taking at least this long are recorded (ns).
+static uint64_t SlowOpThreshold = DEFAULT_SLOW_OP_THRESHOLD_NS;
+
+/// Number of timed operations in progress (they may nest).
+static unsigned int OpDepth = 0;
+
+/// When the event loop watchdog timer last ran.
+static uint64_t LastWatchdogTime;
+
+/// SlowOpCount when the event loop watchdog timer last ran.
+static uint32_t LastWatchdogSlowOpCount;
+
+/// Length of the CPU profiling periods, and of the sliding window (s).
+#define CPU_PERIOD_SECS                 10
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A resource in the list of the heaviest resources.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    resTree_EntryRef_t entryRef;                ///< Resource (only while the list is built).
+    uint64_t ticks[ADMIN_CPU_SITE_COUNT];       ///< CPU time in the window (ticks).
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];     ///< Absolute path of the resource.
+}
+CpuTopEntry_t;
+
+/// Is CPU profiling on?
+static bool IsProfiling = false;
+
+/// Cycle counter and monotonic clock (ns) when CPU profiling was turned on, to calibrate the
+/// counter.
+static uint64_t ProfileStartTicks;
+static uint64_t ProfileStartTime;
+
+/// The heaviest resources in the window, heaviest first, as of the last admin_UpdateCpuTop().
+static CpuTopEntry_t CpuTop[ADMIN_MAX_CPU_TOP_COUNT];
+
+/// Number of entries in CpuTop.
+static uint32_t CpuTopCount = 0;
+
+/// Profiling period, and fraction of it elapsed, while CpuTop is being built.
+static uint32_t CpuTopPeriod;
+static double CpuTopElapsed;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bucket a time belongs in.
+ *
+ * @return The bucket index.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetBucket
+(
+    uint64_t time
+)
+{
+    if (time < SUB_BUCKET_COUNT)
+    {
+        return time;
+    }
+
+    if (time >= ((uint64_t)1 << MAX_TIME_BITS))
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    // The top bit selects the power of two, and the SUB_BUCKET_BITS below it the bucket within it.
+    unsigned int topBit = 63 - __builtin_clzll(time);
+
+    return ((topBit - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+           + ((time >> (topBit - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the longest time that belongs in a bucket.
+ *
+ * @return The time, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetBucketLimit
+(
+    size_t bucket
+)
+{
+    if (bucket < SUB_BUCKET_COUNT)
+    {
+        return bucket;
+    }
+
+    unsigned int shift = (bucket / SUB_BUCKET_COUNT) - 1;
+    uint64_t first = ((uint64_t)(SUB_BUCKET_COUNT + (bucket % SUB_BUCKET_COUNT))) << shift;
+
+    return first + ((uint64_t)1 << shift) - 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a percentile of the times in a histogram.
+ *
+ * @return The percentile, in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetPercentile
+(
+    const Histogram_t* histPtr,
+    double percent
+)
+{
+    uint64_t rank = (uint64_t)ceil(histPtr->count * percent / 100);
+    uint64_t seen = 0;
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += histPtr->buckets[i];
+
+        if (seen >= rank)
+        {
+            // The bucket limit may be above the longest time actually recorded.
+            uint64_t limit = GetBucketLimit(i);
+            return ((limit < histPtr->max) ? limit : histPtr->max) / 1e9;
+        }
+    }
+
+    return histPtr->max / 1e9;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the monotonic clock.
+ *
+ * @return The time (ns).
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_GetTime
+(
+    void
+)
+{
+#if LE_CONFIG_LINUX
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+#else
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000000000) + ((uint64_t)now.usec * 1000);
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the time a stage of the push path starts.
+ *
+ * @return The start time, to be passed to stats_EndStage(), or 0 if stage timing is off.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartStage
+(
+    void
+)
+{
+    return IsTimingStages ? stats_GetTime() : 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the time taken by a stage of the push path in the stage's latency histogram, unless stage
+ * timing was off when it started.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_EndStage
+(
+    admin_PushStage_t stage,
+    uint64_t startTime      ///< Value returned by stats_StartStage() when the stage started.
+)
+{
+    if (startTime == 0)
+    {
+        return;
+    }
+
+    uint64_t time = stats_GetTime() - startTime;
+    Histogram_t* histPtr = &Histograms[stage];
+
+    histPtr->count++;
+    histPtr->sum += time;
+    if (time > histPtr->max)
+    {
+        histPtr->max = time;
+    }
+    histPtr->buckets[GetBucket(time)]++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a slow operation, overwriting the oldest one if the ring is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordSlowOp
+(
+    const char* name,               ///< Name of the operation.
+    resTree_EntryRef_t entryRef,    ///< Entry the operation was on, or NULL.
+    uint64_t duration               ///< Time taken (ns).
+)
+{
+    SlowOp_t* opPtr = &SlowOps[SlowOpCount % SLOW_OP_COUNT];
+    le_clk_Time_t now = le_clk_GetAbsoluteTime();
+
+    SlowOpCount++;
+
+    LE_ASSERT(le_utf8_Copy(opPtr->name, name, sizeof(opPtr->name), NULL) == LE_OK);
+    opPtr->path[0] = '\0';
+    if ((entryRef != NULL)
+        && (resTree_GetPath(opPtr->path, sizeof(opPtr->path), resTree_GetRoot(), entryRef) < 0))
+    {
+        opPtr->path[0] = '\0';
+    }
+    opPtr->duration = duration / 1e9;
+    opPtr->timestamp = now.sec + (now.usec / 1e6) - opPtr->duration;
+
+    LE_WARN("Slow operation: %s%s%s took %.1f ms",
+            opPtr->name,
+            (opPtr->path[0] != '\0') ? " on " : "",
+            opPtr->path,
+            opPtr->duration * 1e3);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the time an operation run from the event loop starts: a service call, or a deferred
+ * function or timer handler.  Operations may nest; only the outermost one is traced.
+ *
+ * @return The start time, to be passed to stats_EndOp().
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartOp
+(
+    void
+)
+{
+    OpDepth++;
+
+    return stats_GetTime();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the end of an operation started with stats_StartOp(), and record it in the slow operation
+ * trace if it took longer than the threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_EndOp
+(
+    const char* name,               ///< Name of the operation (a string literal).
+    resTree_EntryRef_t entryRef,    ///< Entry the operation was on, or NULL.  Must still exist.
+    uint64_t startTime              ///< Value returned by stats_StartOp().
+)
+{
+    LE_ASSERT(OpDepth > 0);
+
+    if (--OpDepth > 0)
+    {
+        return;
+    }
+
+    uint64_t duration = stats_GetTime() - startTime;
+
+    if (duration >= SlowOpThreshold)
+    {
+        RecordSlowOp(name, entryRef, duration);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event loop watchdog timer handler.  If the timer ran late by more than the threshold, and no
+ * slow operation was recorded to account for it, something that isn't timed stalled the event
+ * loop, so record that.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WatchdogTimerExpired
+(
+    le_timer_Ref_t timer
+)
+{
+    LE_UNUSED(timer);
+
+    uint64_t now = stats_GetTime();
+    uint64_t interval = now - LastWatchdogTime;
+    uint64_t expected = (uint64_t)WATCHDOG_INTERVAL_MS * 1000000;
+    uint64_t minStall = (SlowOpThreshold > WATCHDOG_MIN_STALL_NS) ?
+                        SlowOpThreshold : WATCHDOG_MIN_STALL_NS;
+
+    if ((interval >= expected + minStall) && (SlowOpCount == LastWatchdogSlowOpCount))
+    {
+        RecordSlowOp(WATCHDOG_OP_NAME, NULL, interval - expected);
+    }
+
+    LastWatchdogTime = now;
+    LastWatchdogSlowOpCount = SlowOpCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the cycle counter when a CPU profiling site starts.
+ *
+ * @return The cycle counter, or 0 if CPU profiling is off (in which case the site must not be
+ *         accounted for).
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartCpu
+(
+    void
+)
+{
+    return IsProfiling ? stats_ReadCycleCounter() : 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current CPU profiling period.  Resources account for their CPU time per period; the
+ * sliding window is made of the current period and the one before it.
+ *
+ * @return The period number.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t stats_GetCpuPeriod
+(
+    void
+)
+{
+    return hub_GetRelativeTime().sec / CPU_PERIOD_SECS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the CPU time of a resource.  Called for each resource in the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetCpuTicks
+(
+    res_Resource_t* resPtr,
+    admin_EntryType_t entryType
+)
+{
+    LE_UNUSED(entryType);
+
+    res_ResetCpuTicks(resPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a resource to the list of the heaviest resources if its own push time in the window is
+ * among the highest.  Called for each resource in the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddToCpuTop
+(
+    res_Resource_t* resPtr,
+    admin_EntryType_t entryType
+)
+{
+    LE_UNUSED(entryType);
+
+    uint64_t current[ADMIN_CPU_SITE_COUNT];
+    uint64_t previous[ADMIN_CPU_SITE_COUNT];
+    CpuTopEntry_t entry = { .entryRef = res_GetResTreeEntry(resPtr) };
+
+    res_GetCpuTicks(resPtr, CpuTopPeriod, current, previous);
+    for (int site = 0; site < ADMIN_CPU_SITE_COUNT; site++)
+    {
+        entry.ticks[site] = current[site] + (uint64_t)(previous[site] * (1 - CpuTopElapsed));
+    }
+
+    uint64_t ticks = entry.ticks[ADMIN_CPU_SITE_PUSH];
+    if ((ticks == 0) || (   (CpuTopCount == ADMIN_MAX_CPU_TOP_COUNT)
+                         && (ticks <= CpuTop[CpuTopCount - 1].ticks[ADMIN_CPU_SITE_PUSH])))
+    {
+        return;
+    }
+
+    // Insert it in order, dropping the lightest if the list is full.
+    uint32_t i = (CpuTopCount < ADMIN_MAX_CPU_TOP_COUNT) ? CpuTopCount++ : CpuTopCount - 1;
+    for (; (i > 0) && (CpuTop[i - 1].ticks[ADMIN_CPU_SITE_PUSH] < ticks); i--)
+    {
+        CpuTop[i].entryRef = CpuTop[i - 1].entryRef;
+        memcpy(CpuTop[i].ticks, CpuTop[i - 1].ticks, sizeof(CpuTop[i].ticks));
+    }
+    CpuTop[i].entryRef = entry.entryRef;
+    memcpy(CpuTop[i].ticks, entry.ticks, sizeof(CpuTop[i].ticks));
+}
+
+#endif /* end DHUB_NO_STATS */
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the push statistics counters of a resource (see @ref c_dataHubAdmin_Stats).
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_FOUND if there's no resource at the given path (namespaces have no counters).
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPushCounts
+(
+    const char* path,       ///< [IN] Absolute path of the resource.
+    uint32_t* countsPtr,    ///< [OUT] Counts, indexed by admin_PushCounter_t.
+    size_t* countsSizePtr   ///< [INOUT]
+)
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(path);
+    LE_UNUSED(countsPtr);
+    *countsSizePtr = 0;
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(path);
+
+    if ((entryRef == NULL) || !resTree_IsResource(entryRef))
+    {
+        *countsSizePtr = 0;
+        return LE_NOT_FOUND;
+    }
+
+    uint32_t counts[ADMIN_PUSH_COUNTER_COUNT];
+
+    resTree_GetPushCounts(entryRef, counts);
+
+    if (*countsSizePtr > ADMIN_PUSH_COUNTER_COUNT)
+    {
+        *countsSizePtr = ADMIN_PUSH_COUNTER_COUNT;
+    }
+    memcpy(countsPtr, counts, *countsSizePtr * sizeof(counts[0]));
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a summary of the latency histogram of one stage of the push path, for all resources
+ * together.  Times are in seconds, and are all 0 if the stage has not run.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the stage is unknown.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetPushLatency
+(
+    admin_PushStage_t stage,    ///< [IN] Stage of the push path.
+    uint64_t* countPtr,         ///< [OUT] Number of times the stage ran.
+    double* meanPtr,            ///< [OUT] Mean time taken.
+    double* p50Ptr,             ///< [OUT] Median time taken.
+    double* p90Ptr,             ///< [OUT] 90th percentile.
+    double* p99Ptr,             ///< [OUT] 99th percentile.
+    double* maxPtr              ///< [OUT] Longest time taken.
+)
+{
+    *countPtr = 0;
+    *meanPtr = 0;
+    *p50Ptr = 0;
+    *p90Ptr = 0;
+    *p99Ptr = 0;
+    *maxPtr = 0;
+
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(stage);
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    if ((unsigned int)stage >= ADMIN_PUSH_STAGE_COUNT)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    const Histogram_t* histPtr = &Histograms[stage];
+
+    if (histPtr->count > 0)
+    {
+        *countPtr = histPtr->count;
+        *meanPtr = ((double)histPtr->sum / histPtr->count) / 1e9;
+        *p50Ptr = GetPercentile(histPtr, 50);
+        *p90Ptr = GetPercentile(histPtr, 90);
+        *p99Ptr = GetPercentile(histPtr, 99);
+        *maxPtr = histPtr->max / 1e9;
+    }
+
+    return LE_OK;
+#endif
+}
+
+
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the push statistics counters of a resource.  Called for each resource in the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetPushCounts
+(
+    res_Resource_t* resPtr,
+    admin_EntryType_t entryType
+)
+{
+    LE_UNUSED(entryType);
+
+    res_ResetPushCounts(resPtr);
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Clear the push statistics counters of every resource, and the latency histograms.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_ResetPushStats
+(
+    void
+)
+{
+#ifdef DHUB_NO_STATS
+    return LE_NOT_IMPLEMENTED;
+#else
+    resTree_ForEachResource(ResetPushCounts);
+    memset(Histograms, 0, sizeof(Histograms));
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn the timing of the stages of the push path on or off (see @ref c_dataHubAdmin_Stats).
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetPushStageTiming
+(
+    bool enable             ///< [IN] true = on, false = off.
+)
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(enable);
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    IsTimingStages = enable;
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set how long an operation must hold up the event loop to be recorded as a slow operation (see
+ * @ref c_dataHubAdmin_SlowOps).
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_BAD_PARAMETER if the threshold is negative or not a number.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetSlowOpThreshold
+(
+    double threshold        ///< [IN] Threshold (s).
+)
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(threshold);
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    // Also rejects NAN.
+    if (!(threshold >= 0))
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    SlowOpThreshold = (uint64_t)(threshold * 1e9);
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the slow operation threshold (see @ref c_dataHubAdmin_SlowOps).
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetSlowOpThreshold
+(
+    double* thresholdPtr    ///< [OUT] Threshold (s).
+)
+{
+#ifdef DHUB_NO_STATS
+    *thresholdPtr = 0;
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    *thresholdPtr = SlowOpThreshold / 1e9;
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get one of the most recent slow operations (see @ref c_dataHubAdmin_SlowOps).  Index 0 is the
+ * most recent.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if fewer slow operations than index + 1 are kept.
+ *  - LE_OVERFLOW if the name or path didn't fit in the buffers (they are truncated).
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetSlowOp
+(
+    uint32_t index,         ///< [IN] Index of the slow operation, from the most recent.
+    char* name,             ///< [OUT] Name of the operation.
+    size_t nameSize,        ///< [IN]
+    char* path,             ///< [OUT] Path of the entry it was on, or "".
+    size_t pathSize,        ///< [IN]
+    double* timestampPtr,   ///< [OUT] When it started (s since the Epoch).
+    double* durationPtr     ///< [OUT] How long it took (s).
+)
+{
+    if (nameSize > 0)
+    {
+        name[0] = '\0';
+    }
+    if (pathSize > 0)
+    {
+        path[0] = '\0';
+    }
+    *timestampPtr = 0;
+    *durationPtr = 0;
+
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(index);
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    if ((index >= SlowOpCount) || (index >= SLOW_OP_COUNT))
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    const SlowOp_t* opPtr = &SlowOps[(SlowOpCount - 1 - index) % SLOW_OP_COUNT];
+    le_result_t result = le_utf8_Copy(name, opPtr->name, nameSize, NULL);
+
+    if (le_utf8_Copy(path, opPtr->path, pathSize, NULL) != LE_OK)
+    {
+        result = LE_OVERFLOW;
+    }
+    *timestampPtr = opPtr->timestamp;
+    *durationPtr = opPtr->duration;
+
+    return result;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forget the slow operations recorded so far.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_ClearSlowOps
+(
+    void
+)
+{
+#ifdef DHUB_NO_STATS
+    return LE_NOT_IMPLEMENTED;
+#else
+    SlowOpCount = 0;
+    LastWatchdogSlowOpCount = 0;
+
+    return LE_OK;
+#endif
+}
+
+
+#ifndef DHUB_NO_STATS
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the statistics module, and start the event loop watchdog.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_Init
+(
+    void
+)
+{
+    le_timer_Ref_t timer = le_timer_Create("eventLoopWatchdog");
+
+    LE_ASSERT(le_timer_SetMsInterval(timer, WATCHDOG_INTERVAL_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(timer, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(timer, WatchdogTimerExpired) == LE_OK);
+    // Don't wake the device up just to check the event loop.
+    LE_ASSERT(le_timer_SetWakeup(timer, false) == LE_OK);
+
+    LastWatchdogTime = stats_GetTime();
+    LE_ASSERT(le_timer_Start(timer) == LE_OK);
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Turn CPU profiling on or off (see @ref c_dataHubAdmin_CpuProfile).  Turning it on when it is off
+ * clears the CPU time of every resource.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_SetCpuProfiling
+(
+    bool enable             ///< [IN] true = on, false = off.
+)
+{
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(enable);
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    if (enable && !IsProfiling)
+    {
+        resTree_ForEachResource(ResetCpuTicks);
+        CpuTopCount = 0;
+        ProfileStartTicks = stats_ReadCycleCounter();
+        ProfileStartTime = stats_GetTime();
+    }
+    IsProfiling = enable;
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the resources that took the most CPU time in the sliding window (see
+ * @ref c_dataHubAdmin_CpuProfile), to be read with admin_GetCpuTopEntry().
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_UpdateCpuTop
+(
+    uint32_t* countPtr,     ///< [OUT] Number of resources found (at most ADMIN_MAX_CPU_TOP_COUNT).
+    double* windowPtr       ///< [OUT] Length of the window (s), shorter if profiling was turned
+                            ///<       on less than a window ago.
+)
+{
+    *countPtr = 0;
+    *windowPtr = 0;
+
+#ifdef DHUB_NO_STATS
+    return LE_NOT_IMPLEMENTED;
+#else
+    CpuTopCount = 0;
+
+    // Nothing has been accounted for if profiling has never been on.
+    if (ProfileStartTime == 0)
+    {
+        return LE_OK;
+    }
+
+    le_clk_Time_t now = hub_GetRelativeTime();
+
+    CpuTopPeriod = stats_GetCpuPeriod();
+    CpuTopElapsed = ((now.sec % CPU_PERIOD_SECS) + (now.usec / 1e6)) / CPU_PERIOD_SECS;
+    resTree_ForEachResource(AddToCpuTop);
+
+    for (uint32_t i = 0; i < CpuTopCount; i++)
+    {
+        if (resTree_GetPath(CpuTop[i].path, sizeof(CpuTop[i].path), resTree_GetRoot(),
+                            CpuTop[i].entryRef) < 0)
+        {
+            CpuTop[i].path[0] = '\0';
+        }
+        CpuTop[i].entryRef = NULL;
+    }
+
+    double sinceStart = (stats_GetTime() - ProfileStartTime) / 1e9;
+
+    *countPtr = CpuTopCount;
+    *windowPtr = (sinceStart < CPU_PERIOD_SECS) ? sinceStart : CPU_PERIOD_SECS;
+
+    return LE_OK;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get one of the resources found by the last admin_UpdateCpuTop(), heaviest first.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - LE_OUT_OF_RANGE if the index is not below the count returned by admin_UpdateCpuTop().
+ *  - LE_OVERFLOW if the path didn't fit in the buffer (it is truncated).
+ *  - LE_NOT_IMPLEMENTED if the Data Hub was built without statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t admin_GetCpuTopEntry
+(
+    uint32_t index,         ///< [IN] 0 = the heaviest.
+    char* path,             ///< [OUT] Absolute path of the resource.
+    size_t pathSize,        ///< [IN]
+    double* cpuTimePtr,     ///< [OUT] CPU time (s) in the window, indexed by admin_CpuSite_t.
+    size_t* cpuTimeSizePtr  ///< [INOUT]
+)
+{
+    if (pathSize > 0)
+    {
+        path[0] = '\0';
+    }
+
+#ifdef DHUB_NO_STATS
+    LE_UNUSED(index);
+    LE_UNUSED(cpuTimePtr);
+    *cpuTimeSizePtr = 0;
+
+    return LE_NOT_IMPLEMENTED;
+#else
+    if (index >= CpuTopCount)
+    {
+        *cpuTimeSizePtr = 0;
+        return LE_OUT_OF_RANGE;
+    }
+
+    // Calibrate the cycle counter against the monotonic clock, over the time profiling has been on.
+    uint64_t elapsedTime = stats_GetTime() - ProfileStartTime;
+    uint64_t elapsedTicks = stats_ReadCycleCounter() - ProfileStartTicks;
+    double secsPerTick = (elapsedTicks > 0) ? (elapsedTime / 1e9) / elapsedTicks : 0;
+
+    if (*cpuTimeSizePtr > ADMIN_CPU_SITE_COUNT)
+    {
+        *cpuTimeSizePtr = ADMIN_CPU_SITE_COUNT;
+    }
+    for (size_t site = 0; site < *cpuTimeSizePtr; site++)
+    {
+        cpuTimePtr[site] = CpuTop[index].ticks[site] * secsPerTick;
+    }
+
+    return le_utf8_Copy(path, CpuTop[index].path, pathSize, NULL);
+#endif
+}
@@ -0,0 +1,179 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Inter-module interfaces provided by the push statistics module, which keeps latency histograms
+ * of the stages of the push path (see @ref c_dataHubAdmin_Stats) and traces operations that hold
+ * up the event loop (see @ref c_dataHubAdmin_SlowOps) and, while CPU profiling is on, the CPU
+ * time each resource takes (see @ref c_dataHubAdmin_CpuProfile).
+ *
+ * The statistics are stripped from the build if DHUB_NO_STATS is defined, in which case the stage
+ * and operation timing functions do nothing, and CPU profiling is never on.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef STATS_H_INCLUDE_GUARD
+#define STATS_H_INCLUDE_GUARD
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+
+#ifdef DHUB_NO_STATS
+
+static inline uint64_t stats_StartStage(void) { return 0; }
+static inline void stats_EndStage(admin_PushStage_t stage, uint64_t startTime)
+{
+    LE_UNUSED(stage);
+    LE_UNUSED(startTime);
+}
+static inline uint64_t stats_StartOp(void) { return 0; }
+static inline void stats_EndOp(const char* name, resTree_EntryRef_t entryRef, uint64_t startTime)
+{
+    LE_UNUSED(name);
+    LE_UNUSED(entryRef);
+    LE_UNUSED(startTime);
+}
+static inline void stats_Init(void) {}
+static inline uint64_t stats_StartCpu(void) { return 0; }
+
+#else
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the monotonic clock.
+ *
+ * @return The time (ns).
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_GetTime
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the time a stage of the push path starts, if stage timing is on.
+ *
+ * @return The start time, to be passed to stats_EndStage(), or 0 if stage timing is off.
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartStage
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the time taken by a stage of the push path in the stage's latency histogram.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_EndStage
+(
+    admin_PushStage_t stage,
+    uint64_t startTime      ///< Value returned by stats_StartStage() when the stage started.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the time an operation run from the event loop starts: a service call, or a deferred
+ * function or timer handler.  Operations may nest; only the outermost one is traced.
+ *
+ * @return The start time, to be passed to stats_EndOp().
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartOp
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the end of an operation started with stats_StartOp(), and record it in the slow operation
+ * trace if it took longer than the threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_EndOp
+(
+    const char* name,               ///< Name of the operation (a string literal).
+    resTree_EntryRef_t entryRef,    ///< Entry the operation was on, or NULL.  Must still exist.
+    uint64_t startTime              ///< Value returned by stats_StartOp().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a cheap, monotonic cycle counter: the time stamp counter on x86, the virtual counter on
+ * 64-bit ARM, and the monotonic clock (in ns) elsewhere.  On 32-bit ARM, the virtual counter is
+ * not read (with mrrc) because the kernel may not give user space access to it, in which case the
+ * read would fault; the clock_gettime() fallback is documented in admin.api.  Ticks are converted
+ * to time by calibrating the counter against the monotonic clock while CPU profiling is on.
+ *
+ * @return The counter value (ticks).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline uint64_t stats_ReadCycleCounter
+(
+    void
+)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (ticks));
+
+    return ticks;
+#else
+    return stats_GetTime();
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Note the cycle counter when a CPU profiling site starts.
+ *
+ * @return The cycle counter, or 0 if CPU profiling is off (in which case the site must not be
+ *         accounted for).
+ */
+//--------------------------------------------------------------------------------------------------
+uint64_t stats_StartCpu
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current CPU profiling period.  Resources account for their CPU time per period; the
+ * sliding window is made of the current period and the one before it.
+ *
+ * @return The period number.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t stats_GetCpuPeriod
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the statistics module, and start the event loop watchdog.
+ */
+//--------------------------------------------------------------------------------------------------
+void stats_Init
+(
+    void
+);
+
+#endif /* end DHUB_NO_STATS */
+
+
+#endif // STATS_H_INCLUDE_GUARD
@@ -110,6 +110,8 @@ typedef struct parser_ObsData
  * datatype), the dataType field of this strucutre is always valid. The value of this field will be
  * set according to the json value's type. A JSON string will set this field to IO_DATA_TYPE_STRING
  * unless "dt":"json" is also present in the state object.
+ * A string value is held in a buffer owned by the parse session, which is reused for the next
+ * state. It must be copied if it is needed after the callback returns.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct parser_StateData
@@ -120,7 +122,7 @@ typedef struct parser_StateData
     {
         double number;
         bool boolean;
-        char string[PARSER_STATE_MAX_STRING_BYTES];
+        const char* string;                                  ///< Only valid during the callback.
     } value;
     io_DataType_t dataType;                                  ///< Type of value
     char resourcePath[PARSER_STATE_MAX_PATH_BYTES];          ///< Key of state
@@ -267,4 +269,19 @@ LE_SHARED void parser_Parse
     void* context                                    ///< [IN] Context to provide to callbacks
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a CBOR (RFC 7049) encoded file.
+ *
+ *  The file follows the same schema as the JSON config file, with maps in place of objects, and
+ *  results in the same callbacks as parser_Parse().
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_ParseCbor
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+);
+
 #endif // PARSER_H_INCLUDE_GUARD
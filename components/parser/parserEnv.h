@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parserEnv.h
+ *
+ *  Parse session environment shared by the parser's file format back-ends.  Not to be used
+ *  outside of the parser component.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PARSER_ENV_H_INCLUDE_GUARD
+#define PARSER_ENV_H_INCLUDE_GUARD
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "parser.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Temporary storage to use during parse.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef union TempStorage
+{
+    parser_ObsData_t o;
+    parser_StateData_t s;
+} tempStorage_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  File formats understood by the parser.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    PARSER_FORMAT_JSON,                     ///< Parsed by le_json.
+    PARSER_FORMAT_CBOR                      ///< Parsed by parser_cbor.c.
+} parser_Format_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Holds the parse environment parameters.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct ParseEnv
+{
+    int fd;                                 ///< File descriptor.
+    parser_Callbacks_t* callbacksPtr;       ///< Callbacks structure
+    tempStorage_t tempStorage;              ///< Temp storage for observation or state data.
+    bool stopped;                           ///< Whether the parse has been stopped by the client.
+    le_json_EventHandler_t fallbackHandler; ///< Sometimes we have to ignore an entire json object,
+                                            /// this field holds a handler to use when we are
+                                            /// finished with that object.
+    void* context;                          ///< User context.
+    parser_Format_t format;                 ///< Format of the file being parsed.
+    size_t bytesRead;                       ///< Bytes consumed so far. Only maintained for formats
+                                            /// that are not parsed by le_json.
+    char* valueBufferPtr;                   ///< Holds the string value of the current state
+                                            /// (PARSER_STATE_MAX_STRING_BYTES).
+} ParseEnv_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start a parse session, making it the current one.
+ *
+ *  The error callback is called if the session cannot be started.
+ *
+ * @return
+ *      - LE_OK if the session was started.
+ *      - LE_BUSY if another parse is ongoing.
+ *      - LE_IO_ERROR if the file descriptor is invalid.
+ *      - LE_NO_MEMORY if the state value buffer cannot be allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t parser_StartSession
+(
+    ParseEnv_t* parseEnvPtr,                         ///< [OUT] Parse environment to initialize.
+    parser_Format_t format,                          ///< [IN] Format of the file.
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End the current parse session.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_EndSession
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert function text to transform type.  Unknown text maps to ADMIN_OBS_TRANSFORM_TYPE_NONE.
+ *
+ * @return
+ *      obs transform type.
+ */
+//--------------------------------------------------------------------------------------------------
+admin_TransformType_t parser_FunctionToTransformType
+(
+    const char* function            ///< [IN] transform function name in the config file.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the fields of an observation that were not present in the file to their default value.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_SetMissingObsFields
+(
+    parser_ObsData_t* obsDataPtr                    ///< [INOUT] observation data.
+);
+
+#endif // PARSER_ENV_H_INCLUDE_GUARD
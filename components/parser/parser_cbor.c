@@ -0,0 +1,1224 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parser_cbor.c
+ *
+ *  Parsing a file with CBOR (RFC 7049) format.
+ *
+ *  The file follows the same schema as a JSON config file: a root map holding an "o" map of
+ *  observations and an "s" map of states.  Tags are accepted and ignored, byte strings and
+ *  unknown members are skipped, and both definite and indefinite length items are supported.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+
+#include "parser.h"
+#include "parserEnv.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes read from the file at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_READ_BUFFER_BYTES          256
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deepest nesting of arrays and maps accepted in values that are skipped.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MAX_NESTING_DEPTH          16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer holding a member key of an observation, a state or the root.  Longer keys
+ * are never known members.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MEMBER_KEY_MAX_BYTES       8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * CBOR major types.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_MAJOR_UINT                 0
+#define CBOR_MAJOR_NEGINT               1
+#define CBOR_MAJOR_BYTES                2
+#define CBOR_MAJOR_TEXT                 3
+#define CBOR_MAJOR_ARRAY                4
+#define CBOR_MAJOR_MAP                  5
+#define CBOR_MAJOR_TAG                  6
+#define CBOR_MAJOR_SIMPLE               7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Additional information values of interest.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CBOR_INFO_FALSE                 20
+#define CBOR_INFO_TRUE                  21
+#define CBOR_INFO_UINT8                 24
+#define CBOR_INFO_HALF                  25
+#define CBOR_INFO_FLOAT                 26
+#define CBOR_INFO_DOUBLE                27
+#define CBOR_INFO_INDEFINITE            31
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decoded head of a CBOR data item.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct CborHead
+{
+    uint8_t major;                      ///< Major type.
+    uint8_t info;                       ///< Additional information.
+    uint64_t arg;                       ///< Argument: value, length, count or float bits.
+    bool indefinite;                    ///< Indefinite length item (or break, for major type 7).
+} CborHead_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffered reader over the file being parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct CborReader
+{
+    ParseEnv_t* parseEnvPtr;                        ///< Current parse session.
+    uint8_t buffer[CBOR_READ_BUFFER_BYTES];         ///< Bytes read from the file.
+    size_t length;                                  ///< Number of valid bytes in buffer.
+    size_t pos;                                     ///< Position of the next byte in buffer.
+    char errorMsg[PARSER_MAX_ERROR_MSG_BYTES];      ///< Message of the error that ended the parse.
+} CborReader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Record the error that ends the parse.
+ *
+ * @return
+ *      The error code passed in.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Fail
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    le_result_t error,                          ///< [IN] result code
+    const char* msg                             ///< [IN] error message
+)
+{
+    le_utf8_Copy(readerPtr->errorMsg, msg, sizeof(readerPtr->errorMsg), NULL);
+    return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check whether the client stopped the parse from within a callback.
+ *
+ * @return
+ *      - LE_OK to carry on.
+ *      - LE_TERMINATED if the parse has been stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CheckStopped
+(
+    CborReader_t* readerPtr                     ///< [IN] reader
+)
+{
+    return (readerPtr->parseEnvPtr->stopped ? LE_TERMINATED : LE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read bytes from the file.
+ *
+ * @return
+ *      - LE_OK if all bytes were read.
+ *      - LE_IO_ERROR if reading from the file failed.
+ *      - LE_FORMAT_ERROR if the file ended first.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadBytes
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    void* destPtr,                              ///< [OUT] where to copy the bytes, NULL to skip.
+    uint64_t count                              ///< [IN] number of bytes
+)
+{
+    uint8_t* bytePtr = destPtr;
+
+    while (count > 0)
+    {
+        if (readerPtr->pos == readerPtr->length)
+        {
+            ssize_t readCount;
+            do
+            {
+                readCount = read(readerPtr->parseEnvPtr->fd,
+                                 readerPtr->buffer,
+                                 sizeof(readerPtr->buffer));
+            }
+            while ((readCount < 0) && (errno == EINTR));
+
+            if (readCount < 0)
+            {
+                return Fail(readerPtr, LE_IO_ERROR, "Failed to read from file");
+            }
+            if (readCount == 0)
+            {
+                return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected end of file");
+            }
+            readerPtr->length = readCount;
+            readerPtr->pos = 0;
+        }
+
+        size_t chunk = readerPtr->length - readerPtr->pos;
+        if (count < chunk)
+        {
+            chunk = count;
+        }
+        if (bytePtr)
+        {
+            memcpy(bytePtr, &readerPtr->buffer[readerPtr->pos], chunk);
+            bytePtr += chunk;
+        }
+        readerPtr->pos += chunk;
+        readerPtr->parseEnvPtr->bytesRead += chunk;
+        count -= chunk;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the head of the next data item.  Tags are skipped.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadHead
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* headPtr                         ///< [OUT] head of the item
+)
+{
+    do
+    {
+        uint8_t initial;
+        le_result_t result = ReadBytes(readerPtr, &initial, 1);
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        headPtr->major = initial >> 5;
+        headPtr->info = initial & 0x1f;
+        headPtr->arg = 0;
+        headPtr->indefinite = false;
+
+        if (headPtr->info < CBOR_INFO_UINT8)
+        {
+            headPtr->arg = headPtr->info;
+        }
+        else if (headPtr->info <= CBOR_INFO_DOUBLE)
+        {
+            uint8_t bytes[8];
+            size_t size = 1 << (headPtr->info - CBOR_INFO_UINT8);
+
+            result = ReadBytes(readerPtr, bytes, size);
+            if (result != LE_OK)
+            {
+                return result;
+            }
+            for (size_t i = 0; i < size; i++)
+            {
+                headPtr->arg = (headPtr->arg << 8) | bytes[i];
+            }
+        }
+        else if ((headPtr->info == CBOR_INFO_INDEFINITE) &&
+                 (headPtr->major >= CBOR_MAJOR_BYTES) &&
+                 (headPtr->major != CBOR_MAJOR_TAG))
+        {
+            headPtr->indefinite = true;
+        }
+        else
+        {
+            return Fail(readerPtr, LE_FORMAT_ERROR, "Malformed CBOR item");
+        }
+    }
+    while (headPtr->major == CBOR_MAJOR_TAG);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Whether a head is the "break" stop code ending an indefinite length item.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsBreak
+(
+    const CborHead_t* headPtr                   ///< [IN] head of the item
+)
+{
+    return ((headPtr->major == CBOR_MAJOR_SIMPLE) && headPtr->indefinite);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Convert a half precision float to a double.
+ */
+//--------------------------------------------------------------------------------------------------
+static double HalfToDouble
+(
+    uint16_t half                               ///< [IN] IEEE 754 half precision bits
+)
+{
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double value;
+
+    if (exponent == 0)
+    {
+        value = ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = (mantissa == 0) ? INFINITY : NAN;
+    }
+
+    return ((half & 0x8000) ? -value : value);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get the numeric value of an item whose head has been read.
+ *
+ * @return
+ *      - LE_OK if the item is an integer or a float.
+ *      - LE_FORMAT_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetNumber
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const CborHead_t* headPtr,                  ///< [IN] head of the item
+    double* valuePtr                            ///< [OUT] value
+)
+{
+    if (headPtr->major == CBOR_MAJOR_UINT)
+    {
+        *valuePtr = (double)headPtr->arg;
+    }
+    else if (headPtr->major == CBOR_MAJOR_NEGINT)
+    {
+        *valuePtr = -1.0 - (double)headPtr->arg;
+    }
+    else if ((headPtr->major == CBOR_MAJOR_SIMPLE) && (headPtr->info == CBOR_INFO_HALF))
+    {
+        *valuePtr = HalfToDouble((uint16_t)headPtr->arg);
+    }
+    else if ((headPtr->major == CBOR_MAJOR_SIMPLE) && (headPtr->info == CBOR_INFO_FLOAT))
+    {
+        uint32_t bits = (uint32_t)headPtr->arg;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        *valuePtr = value;
+    }
+    else if ((headPtr->major == CBOR_MAJOR_SIMPLE) && (headPtr->info == CBOR_INFO_DOUBLE))
+    {
+        memcpy(valuePtr, &headPtr->arg, sizeof(*valuePtr));
+    }
+    else
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the content of a text string whose head has been read.  The whole string is consumed
+ *  even if it does not fit in the buffer.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_OVERFLOW if the string was truncated to fit in the buffer.
+ *      - LE_FORMAT_ERROR if the item is not a text string.
+ *      - LE_IO_ERROR if reading from the file failed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadText
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const CborHead_t* headPtr,                  ///< [IN] head of the item
+    char* bufferPtr,                            ///< [OUT] null-terminated string
+    size_t bufferSize                           ///< [IN] size of the buffer
+)
+{
+    if (headPtr->major != CBOR_MAJOR_TEXT)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    size_t length = 0;
+    bool truncated = false;
+    CborHead_t chunkHead = *headPtr;
+
+    // An indefinite length string is a sequence of definite length chunks ended by a break.
+    while (true)
+    {
+        if (headPtr->indefinite)
+        {
+            le_result_t result = ReadHead(readerPtr, &chunkHead);
+            if (result != LE_OK)
+            {
+                return result;
+            }
+            if (IsBreak(&chunkHead))
+            {
+                break;
+            }
+            if ((chunkHead.major != CBOR_MAJOR_TEXT) || chunkHead.indefinite)
+            {
+                return Fail(readerPtr, LE_FORMAT_ERROR, "Malformed CBOR text string");
+            }
+        }
+
+        uint64_t copyCount = 0;
+        if (length < bufferSize - 1)
+        {
+            copyCount = bufferSize - 1 - length;
+            if (chunkHead.arg < copyCount)
+            {
+                copyCount = chunkHead.arg;
+            }
+        }
+        truncated = truncated || (copyCount < chunkHead.arg);
+
+        le_result_t result = ReadBytes(readerPtr, bufferPtr + length, copyCount);
+        if (result == LE_OK)
+        {
+            result = ReadBytes(readerPtr, NULL, chunkHead.arg - copyCount);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+        length += copyCount;
+
+        if (!headPtr->indefinite)
+        {
+            break;
+        }
+    }
+
+    bufferPtr[length] = '\0';
+
+    return (truncated ? LE_OVERFLOW : LE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Skip over an item whose head has been read.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SkipItem
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const CborHead_t* headPtr,                  ///< [IN] head of the item
+    int depth                                   ///< [IN] nesting depth of the item
+)
+{
+    le_result_t result = LE_OK;
+    CborHead_t itemHead;
+
+    if (depth > CBOR_MAX_NESTING_DEPTH)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "CBOR nesting is too deep");
+    }
+
+    switch (headPtr->major)
+    {
+        case CBOR_MAJOR_BYTES:
+        case CBOR_MAJOR_TEXT:
+        {
+            if (!headPtr->indefinite)
+            {
+                return ReadBytes(readerPtr, NULL, headPtr->arg);
+            }
+            while ((result = ReadHead(readerPtr, &itemHead)) == LE_OK && !IsBreak(&itemHead))
+            {
+                if ((itemHead.major != headPtr->major) || itemHead.indefinite)
+                {
+                    return Fail(readerPtr, LE_FORMAT_ERROR, "Malformed CBOR string");
+                }
+                result = ReadBytes(readerPtr, NULL, itemHead.arg);
+                if (result != LE_OK)
+                {
+                    return result;
+                }
+            }
+            return result;
+        }
+
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP:
+        {
+            // A map holds two items (key and value) per entry.
+            int itemsPerEntry = (headPtr->major == CBOR_MAJOR_MAP) ? 2 : 1;
+
+            for (uint64_t i = 0; headPtr->indefinite || (i < headPtr->arg); i++)
+            {
+                for (int j = 0; j < itemsPerEntry; j++)
+                {
+                    result = ReadHead(readerPtr, &itemHead);
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+                    if (IsBreak(&itemHead))
+                    {
+                        if (headPtr->indefinite && (j == 0))
+                        {
+                            return LE_OK;
+                        }
+                        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR break");
+                    }
+                    result = SkipItem(readerPtr, &itemHead, depth + 1);
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+                }
+            }
+            return LE_OK;
+        }
+
+        case CBOR_MAJOR_SIMPLE:
+        {
+            if (headPtr->indefinite)
+            {
+                return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR break");
+            }
+            // Any argument was already consumed with the head.
+            return LE_OK;
+        }
+
+        default:
+        {
+            // Integers hold their value in the head.
+            return LE_OK;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the next key of a map whose head has been read, along with the head of its value.
+ *
+ *  Keys longer than the buffer are truncated, so must only be compared with shorter strings.
+ *
+ * @return
+ *      - LE_OK if a key was read.
+ *      - LE_OUT_OF_RANGE if there are no more entries in the map.
+ *      - LE_OVERFLOW if a key was read, but truncated.
+ *      - LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t NextMapEntry
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* mapHeadPtr,                     ///< [INOUT] head of the map, counts entries left.
+    char* keyPtr,                               ///< [OUT] null-terminated key
+    size_t keySize,                             ///< [IN] size of the key buffer
+    CborHead_t* valueHeadPtr                    ///< [OUT] head of the entry's value
+)
+{
+    CborHead_t keyHead;
+
+    if (!mapHeadPtr->indefinite)
+    {
+        if (mapHeadPtr->arg == 0)
+        {
+            return LE_OUT_OF_RANGE;
+        }
+        mapHeadPtr->arg--;
+    }
+
+    le_result_t result = ReadHead(readerPtr, &keyHead);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+    if (mapHeadPtr->indefinite && IsBreak(&keyHead))
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    le_result_t keyResult = ReadText(readerPtr, &keyHead, keyPtr, keySize);
+    if ((keyResult != LE_OK) && (keyResult != LE_OVERFLOW))
+    {
+        return keyResult;
+    }
+
+    result = ReadHead(readerPtr, valueHeadPtr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+    if (IsBreak(valueHeadPtr))
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR break");
+    }
+
+    return keyResult;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the value of an observation member that holds a number.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_FORMAT_ERROR if the value is not a number.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadObsNumber
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const CborHead_t* headPtr,                  ///< [IN] head of the value
+    uint32_t mask,                              ///< [IN] bit of the member in the obs bitmask
+    double* valuePtr                            ///< [OUT] value
+)
+{
+    le_result_t result = GetNumber(readerPtr, headPtr, valuePtr);
+    if (result == LE_OK)
+    {
+        readerPtr->parseEnvPtr->tempStorage.o.bitmask |= mask;
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse one member of an observation map.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if the value is invalid.
+ *      - LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObsMember
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const char* memberName,                     ///< [IN] obs member key
+    const CborHead_t* headPtr                   ///< [IN] head of the value
+)
+{
+    parser_ObsData_t* obsDataPtr = &(readerPtr->parseEnvPtr->tempStorage.o);
+    le_result_t result;
+    double number;
+
+    if (strcmp(memberName, "r") == 0)
+    {
+        result = ReadText(readerPtr, headPtr, obsDataPtr->resourcePath,
+                          sizeof(obsDataPtr->resourcePath));
+        if ((result == LE_OVERFLOW) ||
+            ((result == LE_OK) && hub_IsResourcePathMalformed(obsDataPtr->resourcePath)))
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "resource path is invalid");
+        }
+        obsDataPtr->bitmask |= PARSER_OBS_RESOURCE_MASK;
+        return result;
+    }
+    else if (strcmp(memberName, "d") == 0)
+    {
+        result = ReadText(readerPtr, headPtr, obsDataPtr->destination,
+                          sizeof(obsDataPtr->destination));
+        // if destination starts with '/', then it's going to be interpreted as a resource path.
+        if ((result == LE_OVERFLOW) ||
+            ((result == LE_OK) && (obsDataPtr->destination[0] == '/') &&
+             hub_IsResourcePathMalformed(obsDataPtr->destination)))
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "obs destination is invalid");
+        }
+        obsDataPtr->bitmask |= PARSER_OBS_DEST_MASK;
+        return result;
+    }
+    else if (strcmp(memberName, "p") == 0)
+    {
+        return ReadObsNumber(readerPtr, headPtr, PARSER_OBS_PERIOD_MASK, &obsDataPtr->minPeriod);
+    }
+    else if (strcmp(memberName, "st") == 0)
+    {
+        return ReadObsNumber(readerPtr, headPtr, PARSER_OBS_CHANGEBY_MASK, &obsDataPtr->changeBy);
+    }
+    else if (strcmp(memberName, "lt") == 0)
+    {
+        return ReadObsNumber(readerPtr, headPtr, PARSER_OBS_LOWERTHAN_MASK,
+                             &obsDataPtr->lowerThan);
+    }
+    else if (strcmp(memberName, "gt") == 0)
+    {
+        return ReadObsNumber(readerPtr, headPtr, PARSER_OBS_GREATERTHAN_MASK,
+                             &obsDataPtr->greaterThan);
+    }
+    else if (strcmp(memberName, "b") == 0)
+    {
+        result = ReadObsNumber(readerPtr, headPtr, PARSER_OBS_BUFFER_MASK, &number);
+        if (result == LE_OK)
+        {
+            obsDataPtr->bufferMaxCount = number;
+        }
+        return result;
+    }
+    else if (strcmp(memberName, "f") == 0)
+    {
+        char transform[PARSER_OBS_TRANSFORM_MAX_BYTES];
+
+        result = ReadText(readerPtr, headPtr, transform, sizeof(transform));
+        if (result == LE_OVERFLOW)
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "obs transform is invalid");
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+        obsDataPtr->bitmask |= PARSER_OBS_TRANSFORM_MASK;
+        obsDataPtr->transform = parser_FunctionToTransformType(transform);
+        return result;
+    }
+    else if (strcmp(memberName, "s") == 0)
+    {
+        result = ReadText(readerPtr, headPtr, obsDataPtr->jsonExtraction,
+                          sizeof(obsDataPtr->jsonExtraction));
+        if (result == LE_OVERFLOW)
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "jsonExtraction is too long");
+        }
+        obsDataPtr->bitmask |= PARSER_OBS_JSON_EXT_MASK;
+        return result;
+    }
+
+    // unexpected member, ignore this member:
+    return SkipItem(readerPtr, headPtr, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the map of one observation, whose name is already in temp storage.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObservation
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* headPtr                         ///< [IN] head of the observation map
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    char memberName[CBOR_MEMBER_KEY_MAX_BYTES];
+    CborHead_t valueHead;
+    le_result_t result;
+
+    if (headPtr->major != CBOR_MAJOR_MAP)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    while ((result = NextMapEntry(readerPtr, headPtr, memberName, sizeof(memberName),
+                                  &valueHead)) != LE_OUT_OF_RANGE)
+    {
+        if (result == LE_OVERFLOW)
+        {
+            result = SkipItem(readerPtr, &valueHead, 0);
+        }
+        else if (result == LE_OK)
+        {
+            result = ParseObsMember(readerPtr, memberName, &valueHead);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // did we get all we expect:
+    if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_RESOURCE_MASK) ||
+        !(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_DEST_MASK))
+    {
+        snprintf(readerPtr->errorMsg, sizeof(readerPtr->errorMsg),
+                 "observation %.10s did not have both r and d",
+                 parseEnvPtr->tempStorage.o.obsName);
+        return LE_FORMAT_ERROR;
+    }
+
+    parser_SetMissingObsFields(&(parseEnvPtr->tempStorage.o));
+
+    if (parseEnvPtr->callbacksPtr->observation)
+    {
+        parseEnvPtr->callbacksPtr->observation(&(parseEnvPtr->tempStorage.o),
+                                               parseEnvPtr->context);
+    }
+
+    return CheckStopped(readerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "o" map.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseObservations
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* headPtr                         ///< [IN] head of the "o" map
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    parser_ObsData_t* obsDataPtr = &(parseEnvPtr->tempStorage.o);
+    CborHead_t valueHead;
+    le_result_t result;
+
+    if (headPtr->major != CBOR_MAJOR_MAP)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    if (parseEnvPtr->callbacksPtr->oObject)
+    {
+        parseEnvPtr->callbacksPtr->oObject(parseEnvPtr->context);
+        if (CheckStopped(readerPtr) != LE_OK)
+        {
+            return LE_TERMINATED;
+        }
+    }
+
+    while (true)
+    {
+        // start each observation from a clean slate.
+        memset(obsDataPtr, 0, sizeof(*obsDataPtr));
+
+        result = NextMapEntry(readerPtr, headPtr, obsDataPtr->obsName,
+                              sizeof(obsDataPtr->obsName), &valueHead);
+        if (result == LE_OUT_OF_RANGE)
+        {
+            break;
+        }
+        if ((result == LE_OVERFLOW) ||
+            ((result == LE_OK) && hub_IsResourcePathMalformed(obsDataPtr->obsName)))
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "observation name is invalid");
+        }
+        if (result == LE_OK)
+        {
+            result = ParseObservation(readerPtr, &valueHead);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // finished with all observations:
+    if (parseEnvPtr->callbacksPtr->oObjectEnd)
+    {
+        parseEnvPtr->callbacksPtr->oObjectEnd(parseEnvPtr->context);
+    }
+
+    return CheckStopped(readerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "v" member of a state.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_BAD_PARAMETER if a string value is too long.
+ *      - LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseStateValue
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const CborHead_t* headPtr                   ///< [IN] head of the value
+)
+{
+    parser_StateData_t* stateDataPtr = &(readerPtr->parseEnvPtr->tempStorage.s);
+    le_result_t result;
+
+    if (headPtr->major == CBOR_MAJOR_TEXT)
+    {
+        if (stateDataPtr->dataType != IO_DATA_TYPE_JSON)
+        {
+            // if we haven't gotten the "dt" field yet, then we'll assume this string is just
+            // a string type. If there was a "dt" later, then dataType will be corrected.
+            stateDataPtr->dataType = IO_DATA_TYPE_STRING;
+        }
+        result = ReadText(readerPtr, headPtr, readerPtr->parseEnvPtr->valueBufferPtr,
+                          PARSER_STATE_MAX_STRING_BYTES);
+        stateDataPtr->value.string = readerPtr->parseEnvPtr->valueBufferPtr;
+        if (result == LE_OVERFLOW)
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "String value is too long.");
+        }
+    }
+    else if ((headPtr->major == CBOR_MAJOR_SIMPLE) &&
+             ((headPtr->info == CBOR_INFO_TRUE) || (headPtr->info == CBOR_INFO_FALSE)))
+    {
+        stateDataPtr->dataType = IO_DATA_TYPE_BOOLEAN;
+        stateDataPtr->value.boolean = (headPtr->info == CBOR_INFO_TRUE);
+        result = LE_OK;
+    }
+    else
+    {
+        stateDataPtr->dataType = IO_DATA_TYPE_NUMERIC;
+        result = GetNumber(readerPtr, headPtr, &stateDataPtr->value.number);
+    }
+
+    if (result == LE_OK)
+    {
+        stateDataPtr->bitmask |= PARSER_STATE_VALUE_MASK;
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the map of one state, whose resource path is already in temp storage.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseState
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* headPtr                         ///< [IN] head of the state map
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    parser_StateData_t* stateDataPtr = &(parseEnvPtr->tempStorage.s);
+    char memberName[CBOR_MEMBER_KEY_MAX_BYTES];
+    CborHead_t valueHead;
+    le_result_t result;
+
+    if (headPtr->major != CBOR_MAJOR_MAP)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    while ((result = NextMapEntry(readerPtr, headPtr, memberName, sizeof(memberName),
+                                  &valueHead)) != LE_OUT_OF_RANGE)
+    {
+        if (result == LE_OK && (strcmp(memberName, "v") == 0))
+        {
+            result = ParseStateValue(readerPtr, &valueHead);
+        }
+        else if (result == LE_OK && (strcmp(memberName, "dt") == 0) &&
+                 (valueHead.major == CBOR_MAJOR_TEXT))
+        {
+            char dataType[CBOR_MEMBER_KEY_MAX_BYTES];
+
+            result = ReadText(readerPtr, &valueHead, dataType, sizeof(dataType));
+            // anything other than "json" will be ignored, and so will "json" for a value that
+            // is not a string.
+            if ((result == LE_OK) && (strcmp(dataType, "json") == 0) &&
+                (!(stateDataPtr->bitmask & PARSER_STATE_VALUE_MASK) ||
+                 (stateDataPtr->dataType == IO_DATA_TYPE_STRING)))
+            {
+                stateDataPtr->dataType = IO_DATA_TYPE_JSON;
+                stateDataPtr->bitmask |= PARSER_STATE_DATATYPE_MASK;
+            }
+            else if (result == LE_OVERFLOW)
+            {
+                result = LE_OK;
+            }
+        }
+        else if ((result == LE_OK) || (result == LE_OVERFLOW))
+        {
+            result = SkipItem(readerPtr, &valueHead, 0);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // did we get all the required fields for a state:
+    if (!(stateDataPtr->bitmask & PARSER_STATE_VALUE_MASK))
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "state did not have v");
+    }
+
+    if (parseEnvPtr->callbacksPtr->state)
+    {
+        parseEnvPtr->callbacksPtr->state(stateDataPtr, parseEnvPtr->context);
+    }
+
+    return CheckStopped(readerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the "s" map.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseStates
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    CborHead_t* headPtr                         ///< [IN] head of the "s" map
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    parser_StateData_t* stateDataPtr = &(parseEnvPtr->tempStorage.s);
+    CborHead_t valueHead;
+    le_result_t result;
+
+    if (headPtr->major != CBOR_MAJOR_MAP)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    if (parseEnvPtr->callbacksPtr->sObject)
+    {
+        parseEnvPtr->callbacksPtr->sObject(parseEnvPtr->context);
+        if (CheckStopped(readerPtr) != LE_OK)
+        {
+            return LE_TERMINATED;
+        }
+    }
+
+    while (true)
+    {
+        memset(stateDataPtr, 0, sizeof(*stateDataPtr));
+
+        result = NextMapEntry(readerPtr, headPtr, stateDataPtr->resourcePath,
+                              sizeof(stateDataPtr->resourcePath), &valueHead);
+        if (result == LE_OUT_OF_RANGE)
+        {
+            break;
+        }
+        if ((result == LE_OVERFLOW) ||
+            ((result == LE_OK) && hub_IsResourcePathMalformed(stateDataPtr->resourcePath)))
+        {
+            return Fail(readerPtr, LE_BAD_PARAMETER, "state key is invalid");
+        }
+        if (result == LE_OK)
+        {
+            result = ParseState(readerPtr, &valueHead);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // finished with all states:
+    if (parseEnvPtr->callbacksPtr->sObjectEnd)
+    {
+        parseEnvPtr->callbacksPtr->sObjectEnd(parseEnvPtr->context);
+    }
+
+    return CheckStopped(readerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse one member of the root map.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseRootMember
+(
+    CborReader_t* readerPtr,                    ///< [IN] reader
+    const char* memberName,                     ///< [IN] root member key
+    CborHead_t* headPtr                         ///< [IN] head of the value
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    parser_Callbacks_t* callbacksPtr = parseEnvPtr->callbacksPtr;
+    le_result_t result;
+    double number;
+
+    if (strcmp(memberName, "o") == 0)
+    {
+        return ParseObservations(readerPtr, headPtr);
+    }
+    else if (strcmp(memberName, "s") == 0)
+    {
+        return ParseStates(readerPtr, headPtr);
+    }
+    else if ((strcmp(memberName, "t") == 0) && callbacksPtr->type)
+    {
+        result = GetNumber(readerPtr, headPtr, &number);
+        if (result == LE_OK)
+        {
+            callbacksPtr->type((int)number, parseEnvPtr->context);
+            result = CheckStopped(readerPtr);
+        }
+        return result;
+    }
+    else if ((strcmp(memberName, "v") == 0) && callbacksPtr->version)
+    {
+        char version[PARSER_OBSNAME_MAX_BYTES];
+
+        result = ReadText(readerPtr, headPtr, version, sizeof(version));
+        if ((result == LE_OK) || (result == LE_OVERFLOW))
+        {
+            callbacksPtr->version(version, parseEnvPtr->context);
+            result = CheckStopped(readerPtr);
+        }
+        return result;
+    }
+    else if ((strcmp(memberName, "ts") == 0) && callbacksPtr->timeStamp)
+    {
+        result = GetNumber(readerPtr, headPtr, &number);
+        if (result == LE_OK)
+        {
+            callbacksPtr->timeStamp(number, parseEnvPtr->context);
+            result = CheckStopped(readerPtr);
+        }
+        return result;
+    }
+
+    // actions are not supported yet, and unknown root members are ignored.
+    return SkipItem(readerPtr, headPtr, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse the root map.
+ *
+ * @return
+ *      - LE_OK if successful.
+ *      - LE_TERMINATED if the client stopped the parse.
+ *      - LE_BAD_PARAMETER, LE_FORMAT_ERROR or LE_IO_ERROR otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ParseRoot
+(
+    CborReader_t* readerPtr                     ///< [IN] reader
+)
+{
+    ParseEnv_t* parseEnvPtr = readerPtr->parseEnvPtr;
+    char memberName[CBOR_MEMBER_KEY_MAX_BYTES];
+    CborHead_t rootHead;
+    CborHead_t valueHead;
+
+    le_result_t result = ReadHead(readerPtr, &rootHead);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+    if (rootHead.major != CBOR_MAJOR_MAP)
+    {
+        return Fail(readerPtr, LE_FORMAT_ERROR, "Unexpected CBOR element found");
+    }
+
+    while ((result = NextMapEntry(readerPtr, &rootHead, memberName, sizeof(memberName),
+                                  &valueHead)) != LE_OUT_OF_RANGE)
+    {
+        if (result == LE_OVERFLOW)
+        {
+            result = SkipItem(readerPtr, &valueHead, 0);
+        }
+        else if (result == LE_OK)
+        {
+            result = ParseRootMember(readerPtr, memberName, &valueHead);
+        }
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    if (parseEnvPtr->callbacksPtr->endOfParse)
+    {
+        parseEnvPtr->callbacksPtr->endOfParse(parseEnvPtr->context);
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Public functions:
+ */
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a CBOR (RFC 7049) encoded file.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_ParseCbor
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+)
+{
+    ParseEnv_t parseEnv;
+    CborReader_t reader;
+
+    if (parser_StartSession(&parseEnv, PARSER_FORMAT_CBOR, fd, callbacksPtr, context) != LE_OK)
+    {
+        return;
+    }
+
+    reader.parseEnvPtr = &parseEnv;
+    reader.length = 0;
+    reader.pos = 0;
+    reader.errorMsg[0] = '\0';
+
+    le_result_t result = ParseRoot(&reader);
+
+    // a parse stopped by the client is not an error.
+    if ((result != LE_OK) && (result != LE_TERMINATED) && parseEnv.callbacksPtr->error)
+    {
+        parseEnv.callbacksPtr->error(result, reader.errorMsg, context);
+    }
+
+    parser_EndSession();
+}
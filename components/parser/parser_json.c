@@ -17,43 +17,25 @@
 #include "ioService.h"
 
 #include "parser.h"
+#include "parserEnv.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Temporary storage to use during parse.
- */
-//--------------------------------------------------------------------------------------------------
-typedef union TempStorage
-{
-    parser_ObsData_t o;
-    parser_StateData_t s;
-} tempStorage_t;
-
-//--------------------------------------------------------------------------------------------------
-/**
- *  Holds the parse environment parameters.
+ * Reference to current parse session.
+ *
+ * Only support one parse session now.
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct ParseEnv
-{
-    int fd;                                 ///< File descriptor.
-    parser_Callbacks_t* callbacksPtr;       ///< Callbacks structure
-    tempStorage_t tempStorage;              ///< Temp storage for observation or state data.
-    bool stopped;                           ///< Whether the parse has been stopped by the client.
-    le_json_EventHandler_t fallbackHandler; ///< Sometimes we have to ignore an entire json object,
-                                            /// this field holds a handler to use when we are
-                                            /// finished with that object.
-    void* context;                          ///< User context.
-} ParseEnv_t;
+static Parser_ParseSessionRef_t CurrParseSessionRef;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Reference to current parse session.
- *
- * Only support one parse session now.
+ * Pool of state value buffers.  One is held by each parse session, so that the largest string value
+ * is neither on the stack nor part of the temporary storage that is cleared for every record.
  */
 //--------------------------------------------------------------------------------------------------
-static Parser_ParseSessionRef_t CurrParseSessionRef;
+static le_mem_PoolRef_t ValueBufferPool = NULL;
+LE_MEM_DEFINE_STATIC_POOL(ValueBufferPool, 1, PARSER_STATE_MAX_STRING_BYTES);
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -424,7 +406,7 @@ static void ExpectObsMaxBuffer
  *      obs transform type.
  */
 //--------------------------------------------------------------------------------------------------
-static admin_TransformType_t FunctionToTransformType
+admin_TransformType_t parser_FunctionToTransformType
 (
     const char* function            ///< [IN] transform function name in the config file.
 )
@@ -448,6 +430,46 @@ static admin_TransformType_t FunctionToTransformType
     return ADMIN_OBS_TRANSFORM_TYPE_NONE;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the fields of an observation that were not present in the file to their default value.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_SetMissingObsFields
+(
+    parser_ObsData_t* obsDataPtr                    ///< [INOUT] observation data.
+)
+{
+    if (!(obsDataPtr->bitmask & PARSER_OBS_PERIOD_MASK))
+    {
+        obsDataPtr->minPeriod = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_CHANGEBY_MASK))
+    {
+        obsDataPtr->changeBy = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_LOWERTHAN_MASK))
+    {
+        obsDataPtr->lowerThan = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_GREATERTHAN_MASK))
+    {
+        obsDataPtr->greaterThan = NAN;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_BUFFER_MASK))
+    {
+        obsDataPtr->bufferMaxCount = 0;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_TRANSFORM_MASK))
+    {
+        obsDataPtr->transform = ADMIN_OBS_TRANSFORM_TYPE_NONE;
+    }
+    if (!(obsDataPtr->bitmask & PARSER_OBS_JSON_EXT_MASK))
+    {
+        obsDataPtr->jsonExtraction[0] = '\0';
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  le_json event handler that expects the "f" member of an observation.
@@ -474,7 +496,7 @@ static void ExpectObsTransformFunction
         // set the bitmask so we know we've received this field:
         parseEnvPtr->tempStorage.o.bitmask |= PARSER_OBS_TRANSFORM_MASK;
         // cache the value in temp storage:
-        parseEnvPtr->tempStorage.o.transform = FunctionToTransformType(transform);
+        parseEnvPtr->tempStorage.o.transform = parser_FunctionToTransformType(transform);
 
         GoToNextState(ExpectObsMember);
     }
@@ -598,34 +620,7 @@ static void ExpectObsMember
         {
             // have what we need:
             // set missing fields:
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_PERIOD_MASK))
-            {
-                parseEnvPtr->tempStorage.o.minPeriod = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_CHANGEBY_MASK))
-            {
-                parseEnvPtr->tempStorage.o.changeBy = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_LOWERTHAN_MASK))
-            {
-                parseEnvPtr->tempStorage.o.lowerThan = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_GREATERTHAN_MASK))
-            {
-                parseEnvPtr->tempStorage.o.greaterThan = NAN;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_BUFFER_MASK))
-            {
-                parseEnvPtr->tempStorage.o.bufferMaxCount = 0;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_TRANSFORM_MASK))
-            {
-                parseEnvPtr->tempStorage.o.transform = ADMIN_OBS_TRANSFORM_TYPE_NONE;
-            }
-            if (!(parseEnvPtr->tempStorage.o.bitmask & PARSER_OBS_JSON_EXT_MASK))
-            {
-                parseEnvPtr->tempStorage.o.jsonExtraction[0] = '\0';
-            }
+            parser_SetMissingObsFields(&(parseEnvPtr->tempStorage.o));
             // call the callback:
             if (parseEnvPtr->callbacksPtr->observation)
             {
@@ -937,9 +932,10 @@ static void ExpectStateValue
                 HandleError(LE_BAD_PARAMETER, "String value is too long.");
                 return;
             }
-            le_utf8_Copy(parseEnvPtr->tempStorage.s.value.string,
+            le_utf8_Copy(parseEnvPtr->valueBufferPtr,
                          le_json_GetString(),
                          PARSER_STATE_MAX_STRING_BYTES, NULL);
+            parseEnvPtr->tempStorage.s.value.string = parseEnvPtr->valueBufferPtr;
             break;
         }
         default:
@@ -966,13 +962,18 @@ static void ExpectStateDataType
     ParseEnv_t* parseEnvPtr = le_json_GetOpaquePtr();
     if (event == LE_JSON_STRING)
     {
-        // anything other than "json" will be ignored.
-        if (strcmp(le_json_GetString(), "json") == 0)
+        // anything other than "json" will be ignored, and so will "json" for a value that is not a
+        // string: the value would then be read through value.string, which now points to the
+        // session's value buffer only when the value is a string.  Either way, the state's
+        // remaining members are still expected.
+        if ((strcmp(le_json_GetString(), "json") == 0) &&
+            (!(parseEnvPtr->tempStorage.s.bitmask & PARSER_STATE_VALUE_MASK) ||
+             (parseEnvPtr->tempStorage.s.dataType == IO_DATA_TYPE_STRING)))
         {
             parseEnvPtr->tempStorage.s.dataType = IO_DATA_TYPE_JSON;
             parseEnvPtr->tempStorage.s.bitmask |= PARSER_STATE_DATATYPE_MASK;
-            GoToNextState(ExpectStateMember);
         }
+        GoToNextState(ExpectStateMember);
     }
     else
     {
@@ -1244,13 +1245,17 @@ LE_SHARED size_t parser_GetNumBytesRead
 (
 )
 {
-    if (CurrParseSessionRef)
+    if (CurrParseSessionRef == NULL)
+    {
+        return 0;
+    }
+    else if (CurrParseSessionRef->format == PARSER_FORMAT_JSON)
     {
         return le_json_GetBytesRead(le_json_GetSession());
     }
     else
     {
-        return 0;
+        return CurrParseSessionRef->bytesRead;
     }
 }
 
@@ -1279,36 +1284,89 @@ LE_SHARED parser_Callbacks_t* parser_GetCallbacks
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Parse a file.
+ *  Start a parse session, making it the current one.
+ *
+ *  The error callback is called if the session cannot be started.
+ *
+ * @return
+ *      - LE_OK if the session was started.
+ *      - LE_BUSY if another parse is ongoing.
+ *      - LE_IO_ERROR if the file descriptor is invalid.
+ *      - LE_NO_MEMORY if the state value buffer cannot be allocated.
  */
 //--------------------------------------------------------------------------------------------------
-LE_SHARED void parser_Parse
+le_result_t parser_StartSession
 (
+    ParseEnv_t* parseEnvPtr,                         ///< [OUT] Parse environment to initialize.
+    parser_Format_t format,                          ///< [IN] Format of the file.
     int fd,                                          ///< [IN] file descriptor to be parsed.
     parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
     void* context                                    ///< [IN] Context to provide to callbacks
 )
 {
+    static parser_Callbacks_t emptyCallbacks = {0};
+
     if (CurrParseSessionRef)
     {
         // there is another parse ongoing,
         // currently we only support one parse at the time.
         callbacksPtr->error(LE_BUSY, "Another parse is ongoing", context);
+        return LE_BUSY;
     }
     else if (fd < 0)
     {
         callbacksPtr->error(LE_IO_ERROR, "Invalid Fd", context);
+        return LE_IO_ERROR;
     }
-    else
+
+    memset(parseEnvPtr, 0, sizeof(*parseEnvPtr));
+    parseEnvPtr->valueBufferPtr = le_mem_TryAlloc(ValueBufferPool);
+    if (parseEnvPtr->valueBufferPtr == NULL)
+    {
+        callbacksPtr->error(LE_NO_MEMORY, "Out of memory for state values", context);
+        return LE_NO_MEMORY;
+    }
+    parseEnvPtr->fd = fd;
+    parseEnvPtr->callbacksPtr = (callbacksPtr)? callbacksPtr : (&emptyCallbacks);
+    parseEnvPtr->context = context;
+    parseEnvPtr->format = format;
+    CurrParseSessionRef = parseEnvPtr;
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End the current parse session.
+ */
+//--------------------------------------------------------------------------------------------------
+void parser_EndSession
+(
+    void
+)
+{
+    le_mem_Release(CurrParseSessionRef->valueBufferPtr);
+    CurrParseSessionRef = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Parse a file.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void parser_Parse
+(
+    int fd,                                          ///< [IN] file descriptor to be parsed.
+    parser_Callbacks_t* callbacksPtr,                ///< [IN] Pointer to callback structure
+    void* context                                    ///< [IN] Context to provide to callbacks
+)
+{
+    ParseEnv_t parseEnv;
+
+    if (parser_StartSession(&parseEnv, PARSER_FORMAT_JSON, fd, callbacksPtr, context) == LE_OK)
     {
-        parser_Callbacks_t emptyCallbacks = {0};
-        ParseEnv_t parseEnv = {0};
-        parseEnv.fd = fd;
-        parseEnv.callbacksPtr = (callbacksPtr)? callbacksPtr : (&emptyCallbacks);
-        parseEnv.context = context;
-        CurrParseSessionRef = &parseEnv;
         le_json_SyncParse(fd, ExpectConfigStart, ErrorEventHandler, &parseEnv);
-        CurrParseSessionRef = NULL;
+        parser_EndSession();
     }
 }
 
@@ -1317,7 +1375,13 @@ LE_SHARED void parser_Parse
  * Component initializer.
  */
 //--------------------------------------------------------------------------------------------------
+#ifndef UNIT_TEST
 COMPONENT_INIT
+#else
+void initParser(void)
+#endif
 {
+    ValueBufferPool = le_mem_InitStaticPool(ValueBufferPool, 1, PARSER_STATE_MAX_STRING_BYTES);
+
     LE_INFO("Default Parser Started.");
 }
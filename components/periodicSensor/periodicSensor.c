@@ -9,6 +9,20 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "periodicSensor.h"
+#include "pushBatch.h"
+#include "timerWheel.h"
+
+/// Adaptive sampling needs the io API's demand notifications, so is not available to sensors that
+/// use the admin API (MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE).
+#ifndef MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE
+#define PSENSOR_ADAPTIVE        1
+#else
+#define PSENSOR_ADAPTIVE        0
+#endif
+
+/// Time (s) added to a demanded period, so that jitter never brings two samples closer together
+/// than an Observation's minimum period (which would make it drop every other sample).
+#define DEMAND_MARGIN           0.01
 
 
 //--------------------------------------------------------------------------------------------------
@@ -19,8 +33,10 @@
 typedef struct psensor
 {
     bool isEnabled;
+    bool isAligned;  ///< Samples are taken at multiples of the period since the Epoch.
     double period;  ///< seconds (0.0 = not set yet)
-    le_timer_Ref_t timer;
+    double runPeriod;  ///< Period the timer is running at, in seconds (0.0 = stopped).
+    timerWheel_Entry_t wheelEntry;  ///< Entry in the shared timer wheel.
     void (*sampleFunc)(psensor_Ref_t, void *);
     void *sampleFuncContext;
     char name[PSENSOR_MAX_NAME_BYTES];
@@ -28,6 +44,18 @@ typedef struct psensor
     dhubIO_TriggerPushHandlerRef_t triggerHandlerRef;
     dhubIO_NumericPushHandlerRef_t periodHandlerRef;
     dhubIO_BooleanPushHandlerRef_t enableHandlerRef;
+
+#if PSENSOR_ADAPTIVE
+    dhubIO_DemandHandlerRef_t demandHandlerRef;  ///< NULL if not adaptive.
+    double demandedPeriod;      ///< Shortest period (s) at which samples are wanted (0 = all).
+    uint32_t consumerCount;     ///< Number of consumers of the samples (0 = none).
+    bool isDemandKnown;         ///< The demand has been reported since the handler was added.
+#endif
+
+#if PSENSOR_BATCH_PUSHES
+    bool isBatched;         ///< Samples are queued and sent in batches.
+    uint32_t valueHandle;   ///< Handle of the "value" Input, if isBatched.
+#endif
 }
 Sensor_t;
 
@@ -45,21 +73,115 @@ LE_MEM_DEFINE_STATIC_POOL(SensorPool, DEFAULT_POOL_SIZE, sizeof(Sensor_t));
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Timer expiry handler function.
+ * Timer wheel expiry handler function.
  */
 //--------------------------------------------------------------------------------------------------
 static void HandleTimerExpiry
 (
-    le_timer_Ref_t timer
+    timerWheel_Entry_t* entryPtr
 )
 //--------------------------------------------------------------------------------------------------
 {
-    Sensor_t* sensorPtr = le_timer_GetContextPtr(timer);
+    Sensor_t* sensorPtr = CONTAINER_OF(entryPtr, Sensor_t, wheelEntry);
 
     sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called once all the sensors due in a timer wheel tick have taken their sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleTickEnd
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+#if PSENSOR_BATCH_PUSHES
+    // Push this tick's samples as one batch.
+    pushBatch_Send();
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the period at which a sensor should be sampled: its configured period, stretched to match
+ * the demand for its samples if it is adaptive.
+ *
+ * @return The period in seconds, or 0 if the sensor should not be sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetRunPeriod
+(
+    Sensor_t* sensorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((!sensorPtr->isEnabled) || (sensorPtr->period <= 0.0))
+    {
+        return 0.0;
+    }
+
+#if PSENSOR_ADAPTIVE
+    // Until the demand is first reported, keep sampling at the configured period.
+    if ((sensorPtr->demandHandlerRef != NULL) && sensorPtr->isDemandKnown)
+    {
+        if (sensorPtr->consumerCount == 0)
+        {
+            // Nobody is using the samples.
+            return 0.0;
+        }
+        if (sensorPtr->demandedPeriod + DEMAND_MARGIN > sensorPtr->period)
+        {
+            return sensorPtr->demandedPeriod + DEMAND_MARGIN;
+        }
+    }
+#endif
+
+    return sensorPtr->period;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start, restart or stop a sensor's timer after its settings changed.  A sample is taken when the
+ * timer is started.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateTimer
+(
+    Sensor_t* sensorPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    double period = GetRunPeriod(sensorPtr);
+
+    if (period == sensorPtr->runPeriod)
+    {
+        return;
+    }
+
+    if (period == 0.0)
+    {
+        timerWheel_Stop(&sensorPtr->wheelEntry);
+    }
+    else
+    {
+        if (sensorPtr->runPeriod == 0.0)
+        {
+            sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
+        }
+
+        timerWheel_Start(&sensorPtr->wheelEntry, period, sensorPtr->isAligned);
+    }
+
+    sensorPtr->runPeriod = period;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle an "enable" update from the Data Hub.
@@ -81,19 +203,8 @@ static void HandleEnablePush
     {
         sensorPtr->isEnabled = enable;
 
-        if (enable)
-        {
-            // If the period has been set, take a sample and start the timer.
-            if (sensorPtr->period > 0.0)
-            {
-                sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
-                le_timer_Start(sensorPtr->timer);
-            }
-        }
-        else
-        {
-            le_timer_Stop(sensorPtr->timer);
-        }
+        // If the period has been set, take a sample and start the timer (or stop it).
+        UpdateTimer(sensorPtr);
     }
 }
 
@@ -123,38 +234,54 @@ static void HandlePeriodPush
         if (period <= 0.0)
         {
             LE_ERROR("Timer period %lf is out of range. Must be > 0.", period);
-            le_timer_Stop(sensorPtr->timer);
             sensorPtr->period = 0.0;
         }
         else if (period > (double)(0x7FFFFFFF)) // Don't know how big time_t is, assume 32-bits.
         {
             LE_ERROR("Timer period %lf is too high.", period);
-            le_timer_Stop(sensorPtr->timer);
             sensorPtr->period = 0.0;
         }
         else
         {
             // The new period is good.
-            // Set the timer's interval to the period.
-            le_clk_Time_t interval;
-            interval.sec = (time_t)period;
-            interval.usec = (period - interval.sec) * 1000000;
-            le_timer_SetInterval(sensorPtr->timer, interval);
-
-            // If the old value was zero and the sensor is enabled, take a sample and
-            // start the timer now.
-            if ((sensorPtr->period == 0) && sensorPtr->isEnabled)
-            {
-                sensorPtr->sampleFunc(sensorPtr, sensorPtr->sampleFuncContext);
-                le_timer_Start(sensorPtr->timer);
-            }
-
             sensorPtr->period = period;
         }
+
+        // If the sensor is enabled, (re)start its timer with the new period, taking a sample now
+        // if it was not running.
+        UpdateTimer(sensorPtr);
     }
 }
 
 
+#if PSENSOR_ADAPTIVE
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handle a change in the demand for the samples of an adaptive sensor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleDemand
+(
+    double period,          ///< Shortest period (s) at which samples are wanted (0 = all).
+    uint32_t consumerCount, ///< Number of consumers (0 = no demand).
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Sensor_t* sensorPtr = contextPtr;
+
+    sensorPtr->demandedPeriod = period;
+    sensorPtr->consumerCount = consumerCount;
+    sensorPtr->isDemandKnown = true;
+
+    // Inside the Data Hub, this is first called from within dhubIO_AddDemandHandler(), before the
+    // handler reference is known, and psensor_SetAdaptive() updates the timer once it is.  Through
+    // IPC, it is first called later, from the event loop.
+    UpdateTimer(sensorPtr);
+}
+#endif
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handle a "trigger" update from the Data Hub.
@@ -209,7 +336,7 @@ static void BuildResourcePath
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and gives it an entry in the shared timer.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc must
  * call one of the psensor_PushX() functions below.
  *
@@ -230,16 +357,22 @@ psensor_Ref_t psensor_Create
     Sensor_t* sensorPtr = le_mem_Alloc(SensorPool);
 
     sensorPtr->isEnabled = false;
+    sensorPtr->isAligned = false;
     sensorPtr->period = 0.0;
+    sensorPtr->runPeriod = 0.0;
 
-    sensorPtr->timer = le_timer_Create(name);
-    le_timer_SetRepeat(sensorPtr->timer, 0); // Repeat an infinite number of times.
-    le_timer_SetHandler(sensorPtr->timer, HandleTimerExpiry);
-    le_timer_SetContextPtr(sensorPtr->timer, sensorPtr);
+    timerWheel_InitEntry(&sensorPtr->wheelEntry, HandleTimerExpiry);
 
     sensorPtr->sampleFunc = sampleFunc;
     sensorPtr->sampleFuncContext = sampleFuncContext;
 
+#if PSENSOR_ADAPTIVE
+    sensorPtr->demandHandlerRef = NULL;
+    sensorPtr->demandedPeriod = 0.0;
+    sensorPtr->consumerCount = 0;
+    sensorPtr->isDemandKnown = false;
+#endif
+
     if (le_utf8_Copy(sensorPtr->name, name, sizeof(sensorPtr->name), NULL) != LE_OK)
     {
         LE_FATAL("Sensor name too long (%s)", name);
@@ -254,6 +387,14 @@ psensor_Ref_t psensor_Create
         LE_FATAL("Failed to create Data Hub Input '%s' (%s).", path, LE_RESULT_TXT(result));
     }
 
+#if PSENSOR_BATCH_PUSHES
+    // Only Boolean and numeric samples can be batched.  If no handle is available, the sensor's
+    // samples are pushed one at a time.
+    sensorPtr->isBatched = (   ((dataType == IO_DATA_TYPE_BOOLEAN)
+                                || (dataType == IO_DATA_TYPE_NUMERIC))
+                            && (pushBatch_GetHandle(path, &sensorPtr->valueHandle) == LE_OK));
+#endif
+
     BuildResourcePath(path, sizeof(path), sensorPtr, "enable");
     result = dhubIO_CreateOutput(path, IO_DATA_TYPE_BOOLEAN, "");
     if (result != LE_OK)
@@ -288,7 +429,7 @@ psensor_Ref_t psensor_Create
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name that produces JSON samples.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and gives it an entry in the shared timer.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc is supposed
  * to call psensor_PushJson() to push the JSON sample.
  *
@@ -342,9 +483,15 @@ void psensor_Destroy
     {
         sensorPtr->isEnabled = false;
 
-        // Stop and delete timer
-        (void)le_timer_Stop (sensorPtr->timer);
-        le_timer_Delete(sensorPtr->timer);
+        // Stop timer
+        timerWheel_Stop(&sensorPtr->wheelEntry);
+
+#if PSENSOR_ADAPTIVE
+        if (sensorPtr->demandHandlerRef != NULL)
+        {
+            dhubIO_RemoveDemandHandler(sensorPtr->demandHandlerRef);
+        }
+#endif
 
         // Deregister handlers and remove resources
         BuildResourcePath(path, sizeof(path), sensorPtr, "trigger");
@@ -359,6 +506,14 @@ void psensor_Destroy
         dhubIO_RemoveBooleanPushHandler(sensorPtr->enableHandlerRef);
         dhubIO_DeleteResource(path);
 
+#if PSENSOR_BATCH_PUSHES
+        // Send the samples still queued before their Input goes away.
+        if (sensorPtr->isBatched)
+        {
+            pushBatch_Flush();
+        }
+#endif
+
         BuildResourcePath(path, sizeof(path), sensorPtr, "value");
         dhubIO_DeleteResource(path);
 
@@ -367,6 +522,86 @@ void psensor_Destroy
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Choose whether a sensor takes its samples at multiples of its period since the Epoch, so that
+ * sensors with the same period take theirs together, or at multiples of its period since it was
+ * enabled (the default).
+ */
+//--------------------------------------------------------------------------------------------------
+void psensor_SetPhaseAlignment
+(
+    psensor_Ref_t ref,  ///< Reference returned by psensor_Create().
+    bool isAligned      ///< true = align samples to period boundaries.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Sensor_t* sensorPtr = ref;
+
+    if (sensorPtr->isAligned != isAligned)
+    {
+        sensorPtr->isAligned = isAligned;
+
+        if (sensorPtr->runPeriod > 0.0)
+        {
+            timerWheel_Start(&sensorPtr->wheelEntry, sensorPtr->runPeriod, isAligned);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Choose whether a sensor adapts its sampling to the demand for its samples.  An adaptive sensor
+ * is not sampled while nothing in the Data Hub uses its samples (no Observation or push handler
+ * on its value), and is sampled no faster than the shortest minimum period of the Observations
+ * fed by it.  Its configured period remains the fastest it is sampled at, and enabling it or
+ * triggering it still works as usual.  Until the Data Hub first reports the demand, it is sampled
+ * at its configured period.
+ *
+ * Not available with MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE, in which case sensors always sample at
+ * their configured period.
+ */
+//--------------------------------------------------------------------------------------------------
+void psensor_SetAdaptive
+(
+    psensor_Ref_t ref,  ///< Reference returned by psensor_Create().
+    bool isAdaptive     ///< true = adapt sampling to demand.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Sensor_t* sensorPtr = ref;
+
+#if PSENSOR_ADAPTIVE
+    if (isAdaptive && (sensorPtr->demandHandlerRef == NULL))
+    {
+        char path[IO_MAX_RESOURCE_PATH_LEN];
+        BuildResourcePath(path, sizeof(path), sensorPtr, "value");
+
+        // The sampling is left as it is until the handler is called back with the demand.
+        sensorPtr->isDemandKnown = false;
+        sensorPtr->demandHandlerRef = dhubIO_AddDemandHandler(path, HandleDemand, sensorPtr);
+        if (sensorPtr->demandHandlerRef == NULL)
+        {
+            LE_ERROR("Failed to follow the demand for '%s'.", path);
+        }
+    }
+    else if ((!isAdaptive) && (sensorPtr->demandHandlerRef != NULL))
+    {
+        dhubIO_RemoveDemandHandler(sensorPtr->demandHandlerRef);
+        sensorPtr->demandHandlerRef = NULL;
+    }
+
+    UpdateTimer(sensorPtr);
+#else
+    if (isAdaptive)
+    {
+        LE_WARN("Adaptive sampling is not available for sensor '%s'.", sensorPtr->name);
+    }
+#endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Push a boolean sample to the Data Hub.
@@ -382,6 +617,14 @@ void psensor_PushBoolean
 {
     Sensor_t* sensorPtr = ref;
 
+#if PSENSOR_BATCH_PUSHES
+    if (sensorPtr->isBatched)
+    {
+        pushBatch_Add(sensorPtr->valueHandle, IO_DATA_TYPE_BOOLEAN, timestamp, (value ? 1 : 0));
+        return;
+    }
+#endif
+
     char path[IO_MAX_RESOURCE_PATH_LEN];
     LE_ASSERT(snprintf(path, sizeof(path), "%s/value", sensorPtr->name) < (int) sizeof(path));
 
@@ -404,6 +647,14 @@ void psensor_PushNumeric
 {
     Sensor_t* sensorPtr = ref;
 
+#if PSENSOR_BATCH_PUSHES
+    if (sensorPtr->isBatched)
+    {
+        pushBatch_Add(sensorPtr->valueHandle, IO_DATA_TYPE_NUMERIC, timestamp, value);
+        return;
+    }
+#endif
+
     char path[IO_MAX_RESOURCE_PATH_LEN];
     LE_ASSERT(snprintf(path, sizeof(path), "%s/value", sensorPtr->name) < (int) sizeof(path));
 
@@ -458,4 +709,10 @@ void psensor_PushJson
 COMPONENT_INIT
 {
     SensorPool = le_mem_InitStaticPool(SensorPool, DEFAULT_POOL_SIZE, sizeof(Sensor_t));
+
+    timerWheel_Init(HandleTickEnd);
+
+#if PSENSOR_BATCH_PUSHES
+    pushBatch_Init();
+#endif
 }
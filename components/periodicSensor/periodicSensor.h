@@ -20,6 +20,18 @@
  *
  * psensor_Destroy() can be used to destroy a previously created sensor scaffold.
  *
+ * All the sensors of a process share one timer, which wakes up once for all the sensors due in
+ * the same 10 ms tick.  psensor_SetPhaseAlignment() lines a sensor's samples up with multiples of
+ * its period, so that sensors with the same period are sampled together.
+ *
+ * psensor_SetAdaptive() makes a sensor follow the demand for its samples: it is paused while
+ * nothing in the Data Hub uses them, and slowed down to the shortest minimum period of the
+ * Observations it feeds.
+ *
+ * On Linux, Boolean and numeric samples are queued and pushed to the Data Hub in batches, about
+ * every 100 ms, rather than one IPC message per sample.  Samples pushed with a timestamp of 0 are
+ * time stamped when they are queued.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -53,7 +65,7 @@ typedef struct psensor* psensor_Ref_t;
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and gives it an entry in the shared timer.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc should
  * call one of the psensor_PushX() functions defined in this API to push its sample to the
  * Data Hub.
@@ -76,7 +88,7 @@ LE_SHARED psensor_Ref_t psensor_Create
 /**
  * Creates a periodic sensor scaffold for a sensor with a given name that produces JSON samples.
  *
- * This makes the sensor appear in the Data Hub and creates a timer for that sensor.
+ * This makes the sensor appear in the Data Hub and gives it an entry in the shared timer.
  * The sampleFunc will be called whenever it's time to take a sample.  The sampleFunc is supposed
  * to call psensor_PushJson() to push the JSON sample.
  *
@@ -104,6 +116,38 @@ LE_SHARED void psensor_Destroy
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Choose whether a sensor takes its samples at multiples of its period since the Epoch, so that
+ * sensors with the same period take theirs together, or at multiples of its period since it was
+ * enabled (the default).
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void psensor_SetPhaseAlignment
+(
+    psensor_Ref_t ref,  ///< Reference returned by psensor_Create().
+    bool isAligned      ///< true = align samples to period boundaries.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Choose whether a sensor adapts its sampling to the demand for its samples.  An adaptive sensor
+ * is not sampled while nothing in the Data Hub uses its samples (no Observation or push handler
+ * on its value), and is sampled no faster than the shortest minimum period of the Observations
+ * fed by it.  Its configured period remains the fastest it is sampled at.
+ *
+ * Not available with MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE, in which case sensors always sample at
+ * their configured period.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void psensor_SetAdaptive
+(
+    psensor_Ref_t ref,  ///< Reference returned by psensor_Create().
+    bool isAdaptive     ///< true = adapt sampling to demand.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Push a boolean sample to the Data Hub.
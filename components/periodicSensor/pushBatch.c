@@ -0,0 +1,306 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client-side batching of the samples pushed by periodic sensors.  See pushBatch.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pushBatch.h"
+
+#if PSENSOR_BATCH_PUSHES
+
+/// Number of samples that can be queued.  A full batch is sent as soon as it is queued, even while
+/// flushes are backed off, so the queue never holds more than one batch.
+#define DEFAULT_QUEUE_SIZE          IO_MAX_BATCH_SAMPLES
+
+/// Default time between flushes, in ms.
+#define DEFAULT_FLUSH_INTERVAL_MS   100
+
+/// Longest time between flushes while the Data Hub is holding samples back, in ms.
+#define MAX_BACKOFF_INTERVAL_MS     3200
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A queued sample.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t handle;        ///< Handle of the Input.
+    uint8_t dataType;       ///< io_DataType_t.
+    double timestamp;       ///< Timestamp (never IO_NOW, as the sample is sent later).
+    double value;           ///< Value.
+}
+QueuedSample_t;
+
+/// Queued samples, oldest at QueueHead.
+static QueuedSample_t Queue[DEFAULT_QUEUE_SIZE];
+static size_t QueueHead = 0;
+static size_t QueueCount = 0;
+
+/// Time between flushes, in ms.  Doubled each time the Data Hub holds samples back.
+static uint32_t FlushIntervalMs = DEFAULT_FLUSH_INTERVAL_MS;
+
+/// Timer that flushes the queue.  Only runs while samples are queued.
+static le_timer_Ref_t FlushTimer = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change the time between flushes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetFlushInterval
+(
+    uint32_t intervalMs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (intervalMs != FlushIntervalMs)
+    {
+        FlushIntervalMs = intervalMs;
+
+        bool isRunning = le_timer_IsRunning(FlushTimer);
+        le_timer_Stop(FlushTimer);
+        le_timer_SetMsInterval(FlushTimer, intervalMs);
+        if (isRunning)
+        {
+            le_timer_Start(FlushTimer);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send up to one batch of queued samples.
+ *
+ * @return The result of io_PushBatch().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SendBatch
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t handles[IO_MAX_BATCH_SAMPLES];
+    uint8_t types[IO_MAX_BATCH_SAMPLES];
+    double timestamps[IO_MAX_BATCH_SAMPLES];
+    double values[IO_MAX_BATCH_SAMPLES];
+    size_t count = (QueueCount < IO_MAX_BATCH_SAMPLES ? QueueCount : IO_MAX_BATCH_SAMPLES);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const QueuedSample_t* samplePtr = &Queue[(QueueHead + i) % DEFAULT_QUEUE_SIZE];
+
+        handles[i] = samplePtr->handle;
+        types[i] = samplePtr->dataType;
+        timestamps[i] = samplePtr->timestamp;
+        values[i] = samplePtr->value;
+    }
+
+    le_result_t result = dhubIO_PushBatch(handles, count,
+                                          types, count,
+                                          timestamps, count,
+                                          values, count);
+
+    // Even with LE_IN_PROGRESS, the Data Hub has received the samples, so they are never resent.
+    QueueHead = (QueueHead + count) % DEFAULT_QUEUE_SIZE;
+    QueueCount -= count;
+
+    if (result == LE_OK)
+    {
+        // The Data Hub is taking samples again; stop backing off.
+        SetFlushInterval(DEFAULT_FLUSH_INTERVAL_MS);
+    }
+    else if (result != LE_IN_PROGRESS)
+    {
+        LE_WARN("Batch of %" PRIuS " samples was not fully pushed (%s)",
+                count,
+                LE_RESULT_TXT(result));
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send queued samples, stopping early if the Data Hub starts holding samples back.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Flush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (QueueCount > 0)
+    {
+        if (SendBatch() == LE_IN_PROGRESS)
+        {
+            // The Data Hub is being reconfigured; keep the rest here and try again later.
+            uint32_t intervalMs = FlushIntervalMs * 2;
+            SetFlushInterval(intervalMs < MAX_BACKOFF_INTERVAL_MS ? intervalMs
+                                                                  : MAX_BACKOFF_INTERVAL_MS);
+            if (!le_timer_IsRunning(FlushTimer))
+            {
+                le_timer_Start(FlushTimer);
+            }
+            return;
+        }
+    }
+
+    SetFlushInterval(DEFAULT_FLUSH_INTERVAL_MS);
+    le_timer_Stop(FlushTimer);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush timer expiry handler function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleFlushTimerExpiry
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(timer);
+
+    Flush();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the handle to queue samples for one of the client's Inputs.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - Any error returned by io_GetIngestHandle(), in which case samples for this Input must be
+ *    pushed directly.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushBatch_GetHandle
+(
+    const char* path,       ///< Resource path within the client app's namespace.
+    uint32_t* handlePtr     ///< [OUT] Handle of the resource.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return dhubIO_GetIngestHandle(path, handlePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a Boolean or numeric sample, to be sent with the next batch.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Add
+(
+    uint32_t handle,            ///< Handle from pushBatch_GetHandle().
+    io_DataType_t dataType,     ///< IO_DATA_TYPE_BOOLEAN or IO_DATA_TYPE_NUMERIC.
+    double timestamp,           ///< Timestamp (or 0 = now).
+    double value                ///< Value (non-zero = true for a Boolean).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (timestamp == IO_NOW)
+    {
+        // The sample is sent later, so the Data Hub cannot be left to time stamp it.
+        le_clk_Time_t now = le_clk_GetAbsoluteTime();
+        timestamp = (double)now.sec + ((double)now.usec / 1000000);
+    }
+
+    QueuedSample_t* samplePtr = &Queue[(QueueHead + QueueCount) % DEFAULT_QUEUE_SIZE];
+    samplePtr->handle = handle;
+    samplePtr->dataType = dataType;
+    samplePtr->timestamp = timestamp;
+    samplePtr->value = value;
+    QueueCount++;
+
+    if (QueueCount == DEFAULT_QUEUE_SIZE)
+    {
+        // A full batch is ready.  Send it even while flushes are backed off, as there is no room
+        // to keep it here; the Data Hub decides which held samples to keep.
+        if (FlushIntervalMs == DEFAULT_FLUSH_INTERVAL_MS)
+        {
+            Flush();
+        }
+        else
+        {
+            (void)SendBatch();
+        }
+    }
+
+    if ((QueueCount > 0) && !le_timer_IsRunning(FlushTimer))
+    {
+        le_timer_Start(FlushTimer);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the queued samples now, unless flushes are being backed off.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Send
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((QueueCount > 0) && (FlushIntervalMs == DEFAULT_FLUSH_INTERVAL_MS))
+    {
+        Flush();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send all queued samples now, even if flushes are being backed off.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Flush
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (QueueCount > 0)
+    {
+        (void)SendBatch();
+    }
+
+    SetFlushInterval(DEFAULT_FLUSH_INTERVAL_MS);
+    le_timer_Stop(FlushTimer);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Init
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    FlushTimer = le_timer_Create("psensorFlush");
+    le_timer_SetRepeat(FlushTimer, 0); // Repeat until the queue is empty.
+    le_timer_SetHandler(FlushTimer, HandleFlushTimerExpiry);
+    le_timer_SetMsInterval(FlushTimer, FlushIntervalMs);
+}
+
+#endif // PSENSOR_BATCH_PUSHES
@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client-side batching of the samples pushed by periodic sensors.
+ *
+ * Boolean and numeric samples are queued locally and sent to the Data Hub with io_PushBatch(),
+ * one IPC message per flush interval (or per IO_MAX_BATCH_SAMPLES samples) instead of one per
+ * sample.  While the Data Hub holds samples back for a configuration update, the flushes of
+ * partial batches are backed off (up to a few seconds), but full batches are still sent as soon as
+ * they are queued, so no samples are dropped here.  The backoff ends as soon as a batch is
+ * accepted.
+ *
+ * Batching needs the io API's handles, so it is only done on Linux and when the sensors use the
+ * io API (i.e., not with MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE).  Otherwise, PSENSOR_BATCH_PUSHES
+ * is 0 and every sample is pushed as it is taken.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef PUSH_BATCH_H_INCLUDE_GUARD
+#define PUSH_BATCH_H_INCLUDE_GUARD
+
+#if LE_CONFIG_LINUX && !defined(MK_CONFIG_PERIODIC_SENSOR_ABSOLUTE)
+#define PSENSOR_BATCH_PUSHES    1
+#else
+#define PSENSOR_BATCH_PUSHES    0
+#endif
+
+#if PSENSOR_BATCH_PUSHES
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the handle to queue samples for one of the client's Inputs.
+ *
+ * @return
+ *  - LE_OK if successful.
+ *  - Any error returned by io_GetIngestHandle(), in which case samples for this Input must be
+ *    pushed directly.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pushBatch_GetHandle
+(
+    const char* path,       ///< Resource path within the client app's namespace.
+    uint32_t* handlePtr     ///< [OUT] Handle of the resource.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a Boolean or numeric sample, to be sent with the next batch.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Add
+(
+    uint32_t handle,            ///< Handle from pushBatch_GetHandle().
+    io_DataType_t dataType,     ///< IO_DATA_TYPE_BOOLEAN or IO_DATA_TYPE_NUMERIC.
+    double timestamp,           ///< Timestamp (or 0 = now).
+    double value                ///< Value (non-zero = true for a Boolean).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the queued samples now, unless flushes are being backed off.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Send
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send all queued samples now, even if flushes are being backed off.
+ */
+//--------------------------------------------------------------------------------------------------
+void pushBatch_Flush
+(
+    void
+);
+
+#endif // PSENSOR_BATCH_PUSHES
+
+#endif // PUSH_BATCH_H_INCLUDE_GUARD
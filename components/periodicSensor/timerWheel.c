@@ -0,0 +1,366 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer wheel shared by all the periodic sensors of a process.  See timerWheel.h.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "timerWheel.h"
+
+/// Length of a tick, in ms.
+#define DEFAULT_TICK_MS     10
+
+/// Number of slots (one per tick) in the lower wheel.
+#define LEVEL0_SLOTS        256
+
+/// Number of slots (one per rotation of the lower wheel) in the upper wheel.
+#define LEVEL1_SLOTS        64
+
+/// Entries due within LEVEL0_SLOTS ticks, by due tick.
+static le_dls_List_t Level0[LEVEL0_SLOTS];
+
+/// Entries due within LEVEL0_SLOTS * LEVEL1_SLOTS ticks, by rotation of the lower wheel.
+static le_dls_List_t Level1[LEVEL1_SLOTS];
+
+/// Entries due later than that.
+static le_dls_List_t Overflow = LE_DLS_LIST_INIT;
+
+/// Last tick that was processed.
+static uint64_t CurrentTick = 0;
+
+/// Number of started entries.
+static size_t StartedCount = 0;
+
+/// Timer waking up the process for the next tick that has something due.
+static le_timer_Ref_t WheelTimer = NULL;
+
+/// Called after the entries due in a tick have expired.
+static void (*TickEndFunc)(void) = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the current tick, counted on the relative clock.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNowTick
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    return ((uint64_t)now.sec * 1000 + (uint64_t)now.usec / 1000) / DEFAULT_TICK_MS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put a started entry in the list for its due tick.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Insert
+(
+    timerWheel_Entry_t* entryPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t delta = entryPtr->dueTick - CurrentTick;
+
+    if (delta < LEVEL0_SLOTS)
+    {
+        entryPtr->listPtr = &Level0[entryPtr->dueTick % LEVEL0_SLOTS];
+    }
+    else if (delta < (uint64_t)LEVEL0_SLOTS * LEVEL1_SLOTS)
+    {
+        entryPtr->listPtr = &Level1[(entryPtr->dueTick / LEVEL0_SLOTS) % LEVEL1_SLOTS];
+    }
+    else
+    {
+        entryPtr->listPtr = &Overflow;
+    }
+
+    le_dls_Queue(entryPtr->listPtr, &entryPtr->link);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move the entries of an upper level list down to the list for their due tick.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Cascade
+(
+    le_dls_List_t* listPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_List_t list = *listPtr;
+    le_dls_Link_t* linkPtr;
+
+    *listPtr = LE_DLS_LIST_INIT;
+
+    while ((linkPtr = le_dls_Pop(&list)) != NULL)
+    {
+        Insert(CONTAINER_OF(linkPtr, timerWheel_Entry_t, link));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expire the entries of a lower wheel slot, which are all due in the current tick.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Expire
+(
+    le_dls_List_t* listPtr,
+    uint64_t nowTick        ///< Tick the wheel is catching up to.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_dls_Link_t* linkPtr;
+
+    // The expiry functions can stop and start any entry, so take one entry off at a time.
+    while ((linkPtr = le_dls_Pop(listPtr)) != NULL)
+    {
+        timerWheel_Entry_t* entryPtr = CONTAINER_OF(linkPtr, timerWheel_Entry_t, link);
+
+        // If the process was held up, skip the expiries it missed, but keep the phase.
+        entryPtr->dueTick += entryPtr->periodTicks;
+        if (entryPtr->dueTick <= nowTick)
+        {
+            entryPtr->dueTick += ((nowTick - entryPtr->dueTick) / entryPtr->periodTicks + 1)
+                                 * entryPtr->periodTicks;
+        }
+        Insert(entryPtr);
+
+        entryPtr->expiryFunc(entryPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next tick that has entries due, or at which an upper level has to be cascaded.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetNextTick
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t tick = CurrentTick + 1;
+
+    for (; (tick % LEVEL0_SLOTS) != 0; tick++)
+    {
+        if (!le_dls_IsEmpty(&Level0[tick % LEVEL0_SLOTS]))
+        {
+            break;
+        }
+    }
+
+    return tick;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the wheel timer for the next tick that has something to do, or stop it if no entries are
+ * started.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Reschedule
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_timer_Stop(WheelTimer);
+
+    if (StartedCount == 0)
+    {
+        return;
+    }
+
+    uint64_t nowTick = GetNowTick();
+    uint64_t nextTick = GetNextTick();
+
+    le_timer_SetMsInterval(WheelTimer,
+                           (nextTick > nowTick ? (nextTick - nowTick) * DEFAULT_TICK_MS : 1));
+    le_timer_Start(WheelTimer);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wheel timer expiry handler function.  Processes every tick up to now.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HandleWheelTimerExpiry
+(
+    le_timer_Ref_t timer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_UNUSED(timer);
+
+    uint64_t nowTick = GetNowTick();
+
+    while ((CurrentTick < nowTick) && (StartedCount > 0))
+    {
+        CurrentTick++;
+
+        if ((CurrentTick % LEVEL0_SLOTS) == 0)
+        {
+            uint64_t rotation = CurrentTick / LEVEL0_SLOTS;
+
+            if ((rotation % LEVEL1_SLOTS) == 0)
+            {
+                Cascade(&Overflow);
+            }
+            Cascade(&Level1[rotation % LEVEL1_SLOTS]);
+        }
+
+        Expire(&Level0[CurrentTick % LEVEL0_SLOTS], nowTick);
+    }
+
+    if (TickEndFunc != NULL)
+    {
+        TickEndFunc();
+    }
+
+    Reschedule();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an entry, stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_InitEntry
+(
+    timerWheel_Entry_t* entryPtr,
+    void (*expiryFunc)(timerWheel_Entry_t* entryPtr)    ///< Called when the entry expires.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    entryPtr->link = LE_DLS_LINK_INIT;
+    entryPtr->listPtr = NULL;
+    entryPtr->dueTick = 0;
+    entryPtr->periodTicks = 0;
+    entryPtr->expiryFunc = expiryFunc;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start (or restart) an entry, so it expires every period from now.  If isAligned is true, the
+ * first expiry is instead at the next multiple of the period since the Epoch.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Start
+(
+    timerWheel_Entry_t* entryPtr,
+    double period,      ///< Seconds (> 0).
+    bool isAligned      ///< Align expiries to period boundaries.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    timerWheel_Stop(entryPtr);
+
+    uint64_t nowTick = GetNowTick();
+    uint64_t periodMs = (uint64_t)(period * 1000 + 0.5);
+
+    if (StartedCount == 0)
+    {
+        // Nothing to catch up on.
+        CurrentTick = nowTick;
+    }
+
+    entryPtr->periodTicks = (periodMs + DEFAULT_TICK_MS / 2) / DEFAULT_TICK_MS;
+    if (entryPtr->periodTicks == 0)
+    {
+        entryPtr->periodTicks = 1;
+    }
+
+    if (isAligned && (periodMs > 0))
+    {
+        le_clk_Time_t now = le_clk_GetAbsoluteTime();
+        uint64_t nowMs = (uint64_t)now.sec * 1000 + (uint64_t)now.usec / 1000;
+        uint64_t delayMs = periodMs - (nowMs % periodMs);
+
+        entryPtr->dueTick = nowTick + (delayMs + DEFAULT_TICK_MS - 1) / DEFAULT_TICK_MS;
+    }
+    else
+    {
+        entryPtr->dueTick = nowTick + entryPtr->periodTicks;
+    }
+
+    if (entryPtr->dueTick <= CurrentTick)
+    {
+        entryPtr->dueTick = CurrentTick + 1;
+    }
+
+    Insert(entryPtr);
+    StartedCount++;
+
+    Reschedule();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop an entry.  Does nothing if it is not started.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Stop
+(
+    timerWheel_Entry_t* entryPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (entryPtr->listPtr != NULL)
+    {
+        le_dls_Remove(entryPtr->listPtr, &entryPtr->link);
+        entryPtr->listPtr = NULL;
+        StartedCount--;
+
+        if (StartedCount == 0)
+        {
+            le_timer_Stop(WheelTimer);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Init
+(
+    void (*tickEndFunc)(void)   ///< Called after the entries due in a tick have expired.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < LEVEL0_SLOTS; i++)
+    {
+        Level0[i] = LE_DLS_LIST_INIT;
+    }
+    for (size_t i = 0; i < LEVEL1_SLOTS; i++)
+    {
+        Level1[i] = LE_DLS_LIST_INIT;
+    }
+
+    TickEndFunc = tickEndFunc;
+
+    WheelTimer = le_timer_Create("psensorWheel");
+    le_timer_SetHandler(WheelTimer, HandleWheelTimerExpiry);
+}
@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer wheel shared by all the periodic sensors of a process.
+ *
+ * Time is divided into ticks, and every entry due in the same tick is expired together, from a
+ * single le_timer that only wakes the process for ticks that have something due.  Entries due
+ * within 256 ticks are kept in a wheel of one slot per tick, those due within 64 rotations of it
+ * in a second wheel of one slot per rotation, and the rest in an overflow list.  Entries move down
+ * a level each time the lower wheel completes a rotation.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef TIMER_WHEEL_H_INCLUDE_GUARD
+#define TIMER_WHEEL_H_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * An entry in the timer wheel.  To be embedded in the object that is expired periodically.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct timerWheel_Entry
+{
+    le_dls_Link_t link;             ///< Link in listPtr.
+    le_dls_List_t* listPtr;         ///< List the entry is in, or NULL if it is stopped.
+    uint64_t dueTick;               ///< Tick at which the entry expires next.
+    uint64_t periodTicks;           ///< Ticks between expiries.
+    void (*expiryFunc)(struct timerWheel_Entry* entryPtr); ///< Called when the entry expires.
+}
+timerWheel_Entry_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the module.  Must be called before any other functions in the module are called.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Init
+(
+    void (*tickEndFunc)(void)   ///< Called after the entries due in a tick have expired.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize an entry, stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_InitEntry
+(
+    timerWheel_Entry_t* entryPtr,
+    void (*expiryFunc)(timerWheel_Entry_t* entryPtr)    ///< Called when the entry expires.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start (or restart) an entry, so it expires every period from now.  If isAligned is true, the
+ * first expiry is instead at the next multiple of the period since the Epoch, so that entries with
+ * the same period expire together however they were started.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Start
+(
+    timerWheel_Entry_t* entryPtr,
+    double period,      ///< Seconds (> 0).
+    bool isAligned      ///< Align expiries to period boundaries.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop an entry.  Does nothing if it is not started.
+ */
+//--------------------------------------------------------------------------------------------------
+void timerWheel_Stop
+(
+    timerWheel_Entry_t* entryPtr
+);
+
+#endif // TIMER_WHEEL_H_INCLUDE_GUARD
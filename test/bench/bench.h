@@ -0,0 +1,17 @@
+/**
+ * @file bench.h
+ *
+ * Shared between the benchmark harness and the mocks.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/// Number of blocks allocated with hub_MemAlloc() so far.
+extern size_t bench_PoolAllocCount;
+
+/// Number of calls to malloc(), calloc() and realloc() so far.
+extern size_t bench_HeapAllocCount;
+
+#endif
@@ -0,0 +1,591 @@
+/**
+ * @file main.c
+ *
+ * Host benchmarks of the Data Hub core: path lookups, pushes through Input, Observation and Output
+ * chains, Observation buffer queries, snapshots, buffer backups and configuration loads.
+ *
+ * Each benchmark is run for a growing number of operations until the run takes at least
+ * MIN_RUN_NS, and its result is printed as one JSON object per line:
+ *
+ * @code
+ * {"benchmark":"push/input","ops":4194304,"ns_per_op":61.2,"pool_allocs_per_op":1.000,
+ *  "heap_allocs_per_op":0.000}
+ * @endcode
+ *
+ * (on a single line).  pool_allocs_per_op counts the blocks allocated with hub_MemAlloc(), and
+ * heap_allocs_per_op the calls to malloc(), calloc() and realloc() (e.g., by pools expanding).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#include "legato.h"
+#include "interfaces.h"
+#include "dataHub.h"
+#include "dataSample.h"
+#include "resTree.h"
+#include "bench.h"
+
+#include <poll.h>
+
+extern void initDataHub(void);
+extern void initParser(void);
+
+/// Minimum time for a run of a benchmark to count (ns).
+#define MIN_RUN_NS          200000000
+
+/// Maximum number of operations in a run of a benchmark.
+#define MAX_OPS             (1 << 24)
+
+/// Number of siblings next to the resources looked up by path.
+#define FIND_SIBLING_COUNT  100
+
+/// Number of Observations and state values in the benchmark configuration file.
+#define CONFIG_OBS_COUNT    50
+
+/// Observation buffer size of the backup benchmark.
+#define BACKUP_BUFFER_COUNT 1000
+
+/// Observation buffer sizes of the query benchmarks.
+static const uint32_t QueryBufferCounts[] = { 10, 100, 1000, 10000 };
+
+/// A benchmark: performs n operations.
+typedef void (*BenchFunc_t)(size_t n, void* contextPtr);
+
+/// Set by completion callbacks of asynchronous operations.
+static bool IsDone = false;
+
+/// Absolute path of the benchmark configuration file.
+static char ConfigFilePath[PATH_MAX];
+
+/// Observation resource used by the restore benchmark.
+static res_Resource_t* BackupObsPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the monotonic clock.
+ *
+ * @return The time in ns.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t Now
+(
+    void
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run everything that is ready to run on the event loop.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ServiceEvents
+(
+    void
+)
+{
+    while (le_event_ServiceLoop() == LE_OK)
+    {
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the event loop until IsDone is set, reading and discarding what arrives on a file
+ * descriptor meanwhile (if fd >= 0).  The file descriptor is closed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaitUntilDone
+(
+    int fd
+)
+{
+    char buffer[4096];
+
+    if (fd >= 0)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    for (;;)
+    {
+        while ((fd >= 0) && (read(fd, buffer, sizeof(buffer)) > 0))
+        {
+        }
+
+        ServiceEvents();
+
+        if (IsDone)
+        {
+            break;
+        }
+
+        struct pollfd fds[2] =
+        {
+            { .fd = le_event_GetFd(), .events = POLLIN },
+            { .fd = fd, .events = POLLIN },
+        };
+        poll(fds, (fd >= 0) ? 2 : 1, 100);
+    }
+
+    if (fd >= 0)
+    {
+        // The last of the data may have been written just before completion.
+        while (read(fd, buffer, sizeof(buffer)) > 0)
+        {
+        }
+        close(fd);
+    }
+
+    IsDone = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a benchmark for a growing number of operations until a run takes at least MIN_RUN_NS, then
+ * print the result of that run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Run
+(
+    const char* name,
+    BenchFunc_t func,
+    void* contextPtr
+)
+{
+    size_t n = 1;
+
+    for (;;)
+    {
+        ServiceEvents();
+
+        size_t poolAllocs = bench_PoolAllocCount;
+        size_t heapAllocs = bench_HeapAllocCount;
+        uint64_t start = Now();
+
+        func(n, contextPtr);
+
+        uint64_t elapsed = Now() - start;
+        poolAllocs = bench_PoolAllocCount - poolAllocs;
+        heapAllocs = bench_HeapAllocCount - heapAllocs;
+
+        if ((elapsed >= MIN_RUN_NS) || (n >= MAX_OPS))
+        {
+            printf("{\"benchmark\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.1f,"
+                   "\"pool_allocs_per_op\":%.3f,\"heap_allocs_per_op\":%.3f}\n",
+                   name,
+                   n,
+                   (double)elapsed / n,
+                   (double)poolAllocs / n,
+                   (double)heapAllocs / n);
+            fflush(stdout);
+            return;
+        }
+
+        // Aim a little past the minimum run time, growing by at most 100 times per run.
+        uint64_t next = (elapsed > 0) ? (n * (MIN_RUN_NS * 6 / 5) / elapsed) : (n * 100);
+        n = (next > n * 100) ? n * 100 : ((next <= n) ? n + 1 : next);
+        if (n > MAX_OPS)
+        {
+            n = MAX_OPS;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up a resource by path.  contextPtr is the path, relative to the root.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchFindEntry
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    const char* path = contextPtr;
+    resTree_EntryRef_t rootRef = resTree_GetRoot();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(resTree_FindEntry(rootRef, path) != NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push numeric samples to a resource.  contextPtr is the resource's tree entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchPush
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    resTree_EntryRef_t entryRef = contextPtr;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        resTree_Push(entryRef, IO_DATA_TYPE_NUMERIC, dataSample_CreateNumeric(i + 1, i));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Query an Observation's whole buffer.  contextPtr is the Observation's tree entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchQueryMin(size_t n, void* contextPtr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(!isnan(resTree_QueryMin(contextPtr, NAN)));
+    }
+}
+
+static void BenchQueryMax(size_t n, void* contextPtr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(!isnan(resTree_QueryMax(contextPtr, NAN)));
+    }
+}
+
+static void BenchQueryMean(size_t n, void* contextPtr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(!isnan(resTree_QueryMean(contextPtr, NAN)));
+    }
+}
+
+static void BenchQueryStdDev(size_t n, void* contextPtr)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(!isnan(resTree_QueryStdDev(contextPtr, NAN)));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback of a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotDone
+(
+    le_result_t result,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    LE_ASSERT(result == LE_OK);
+    IsDone = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take JSON snapshots of the whole resource tree, reading them from the pipe they are written to.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchSnapshot
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int fd = -1;
+
+        query_TakeSnapshot(QUERY_SNAPSHOT_FORMAT_JSON, 0, "/", QUERY_BEGINNING_OF_TIME,
+                           SnapshotDone, NULL, &fd);
+        LE_ASSERT(fd >= 0);
+        WaitUntilDone(fd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Back up an Observation's buffer.  Re-enabling backups after disabling them backs the buffer up
+ * straight away, so each operation also deletes the previous backup file.  contextPtr is the
+ * Observation's path.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchBackup
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        admin_SetBufferBackupPeriod(contextPtr, 0);
+        admin_SetBufferBackupPeriod(contextPtr, 1);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Restore an Observation's buffer from its backup file.  The buffer is full, so each restored
+ * sample replaces the oldest one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchRestore
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        res_RestoreBackup(BackupObsPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback of a configuration load.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadDone
+(
+    le_result_t result,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    LE_FATAL_IF(result != LE_OK, "Config load failed at %" PRIu32 ": %s", fileLoc, errorMsg);
+    IsDone = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the benchmark configuration file.  After the first load, the Observations already exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchConfigLoad
+(
+    size_t n,
+    void* contextPtr
+)
+{
+    (void)contextPtr;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        LE_ASSERT(config_Load(ConfigFilePath, "json", LoadDone, NULL) == LE_OK);
+        WaitUntilDone(-1);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Push handler on the end of the push chain.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NumericPushHandler
+(
+    double timestamp,
+    double value,
+    void* contextPtr
+)
+{
+    (void)timestamp;
+    (void)value;
+    (void)contextPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the Observation resource used by the restore benchmark.  Called for each resource.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FindBackupObs
+(
+    res_Resource_t* resPtr,
+    admin_EntryType_t entryType
+)
+{
+    if (   (entryType == ADMIN_ENTRY_TYPE_OBSERVATION)
+        && (res_GetResTreeEntry(resPtr) == resTree_FindEntryAtAbsolutePath("/obs/benchBackup")))
+    {
+        BackupObsPtr = resPtr;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create an Observation with a buffer, and fill the buffer with numeric samples.
+ *
+ * @return The Observation's tree entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static resTree_EntryRef_t CreateFullObs
+(
+    const char* name,
+    uint32_t count
+)
+{
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];
+
+    LE_ASSERT(admin_CreateObs(name) == LE_OK);
+    admin_SetBufferMaxCount(name, count);
+
+    snprintf(path, sizeof(path), "/obs/%s", name);
+    resTree_EntryRef_t entryRef = resTree_FindEntryAtAbsolutePath(path);
+    LE_ASSERT(entryRef != NULL);
+
+    BenchPush(count, entryRef);
+
+    return entryRef;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the benchmark configuration file: CONFIG_OBS_COUNT Observations of Inputs, and as many
+ * state values.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteConfigFile
+(
+    void
+)
+{
+    LE_ASSERT(getcwd(ConfigFilePath, sizeof(ConfigFilePath) - sizeof("/benchConfig.json")) != NULL);
+    strcat(ConfigFilePath, "/benchConfig.json");
+
+    FILE* filePtr = fopen(ConfigFilePath, "w");
+    LE_ASSERT(filePtr != NULL);
+
+    fprintf(filePtr, "{\"o\":{");
+    for (int i = 0; i < CONFIG_OBS_COUNT; i++)
+    {
+        fprintf(filePtr,
+                "%s\"config%d\":{\"r\":\"/app/bench/config/input%d\",\"d\":\"cloud\","
+                "\"p\":1,\"st\":0.5,\"b\":10,\"f\":\"mean\"}",
+                (i > 0) ? "," : "", i, i);
+    }
+    fprintf(filePtr, "},\"s\":{");
+    for (int i = 0; i < CONFIG_OBS_COUNT; i++)
+    {
+        fprintf(filePtr, "%s\"/app/bench/config/state%d\":{\"v\":%d}", (i > 0) ? "," : "", i, i);
+    }
+    fprintf(filePtr, "}}\n");
+
+    LE_ASSERT(fclose(filePtr) == 0);
+}
+
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    char path[HUB_MAX_RESOURCE_PATH_BYTES];
+    char name[64];
+
+    le_log_SetFilterLevel(LE_LOG_WARN);
+
+    initDataHub();
+    initParser();
+
+    // Path lookups, next to FIND_SIBLING_COUNT siblings.
+    for (int i = 0; i < FIND_SIBLING_COUNT; i++)
+    {
+        snprintf(path, sizeof(path), "/app/bench/find/sibling%d", i);
+        LE_ASSERT(admin_CreateInput(path, IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    }
+    LE_ASSERT(admin_CreateInput("/app/bench/find/value", IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(admin_CreateInput("/app/bench/find/a/b/c/d/e/f/value", IO_DATA_TYPE_NUMERIC, "")
+              == LE_OK);
+    Run("resTree_FindEntry/depth4", BenchFindEntry, "app/bench/find/value");
+    Run("resTree_FindEntry/depth10", BenchFindEntry, "app/bench/find/a/b/c/d/e/f/value");
+
+    // Pushes to an Input, an Input observed by an Observation, and an Input observed by a buffered
+    // Observation feeding an Output that has a push handler.
+    LE_ASSERT(admin_CreateInput("/app/bench/push/input", IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(admin_CreateInput("/app/bench/push/obsInput", IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(admin_CreateObs("benchPush") == LE_OK);
+    LE_ASSERT(admin_SetSource("/obs/benchPush", "/app/bench/push/obsInput") == LE_OK);
+    LE_ASSERT(admin_CreateInput("/app/bench/push/chainInput", IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(admin_CreateObs("benchChain") == LE_OK);
+    admin_SetBufferMaxCount("benchChain", 100);
+    admin_SetTransform("benchChain", ADMIN_OBS_TRANSFORM_TYPE_MEAN, NULL, 0);
+    LE_ASSERT(admin_SetSource("/obs/benchChain", "/app/bench/push/chainInput") == LE_OK);
+    LE_ASSERT(admin_CreateOutput("/app/bench/push/output", IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(admin_SetSource("/app/bench/push/output", "/obs/benchChain") == LE_OK);
+    LE_ASSERT(admin_AddNumericPushHandler("/app/bench/push/output", NumericPushHandler, NULL)
+              != NULL);
+    Run("res_Push/input", BenchPush,
+        resTree_FindEntryAtAbsolutePath("/app/bench/push/input"));
+    Run("res_Push/input-obs", BenchPush,
+        resTree_FindEntryAtAbsolutePath("/app/bench/push/obsInput"));
+    Run("res_Push/input-obs(buffer,mean)-output", BenchPush,
+        resTree_FindEntryAtAbsolutePath("/app/bench/push/chainInput"));
+
+    // Observation buffer queries.
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(QueryBufferCounts); i++)
+    {
+        snprintf(name, sizeof(name), "benchQuery%" PRIu32, QueryBufferCounts[i]);
+        resTree_EntryRef_t obsRef = CreateFullObs(name, QueryBufferCounts[i]);
+
+        snprintf(name, sizeof(name), "obs_QueryMin/%" PRIu32, QueryBufferCounts[i]);
+        Run(name, BenchQueryMin, obsRef);
+        snprintf(name, sizeof(name), "obs_QueryMax/%" PRIu32, QueryBufferCounts[i]);
+        Run(name, BenchQueryMax, obsRef);
+        snprintf(name, sizeof(name), "obs_QueryMean/%" PRIu32, QueryBufferCounts[i]);
+        Run(name, BenchQueryMean, obsRef);
+        snprintf(name, sizeof(name), "obs_QueryStdDev/%" PRIu32, QueryBufferCounts[i]);
+        Run(name, BenchQueryStdDev, obsRef);
+    }
+
+    // Buffer backup and restore.
+    CreateFullObs("benchBackup", BACKUP_BUFFER_COUNT);
+    resTree_ForEachResource(FindBackupObs);
+    LE_ASSERT(BackupObsPtr != NULL);
+    snprintf(name, sizeof(name), "obs_Backup/%d", BACKUP_BUFFER_COUNT);
+    Run(name, BenchBackup, "benchBackup");
+    snprintf(name, sizeof(name), "obs_RestoreBackup/%d", BACKUP_BUFFER_COUNT);
+    Run(name, BenchRestore, NULL);
+
+    // Configuration loads (which add their Observations and states to the tree).
+    WriteConfigFile();
+    snprintf(name, sizeof(name), "config_Load/json/%d", CONFIG_OBS_COUNT);
+    Run(name, BenchConfigLoad, NULL);
+
+    // Snapshots of everything above.
+    Run("snapshot/json", BenchSnapshot, NULL);
+
+    return EXIT_SUCCESS;
+}
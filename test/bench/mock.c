@@ -0,0 +1,109 @@
+/**
+ * @file mock.c
+ *
+ * Stand-ins for the Legato services the Data Hub uses, so the benchmarks run without them, and
+ * the allocation counters.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#include "legato.h"
+#include "interfaces.h"
+#include "bench.h"
+
+/// Allocation counters (see bench.h).
+size_t bench_PoolAllocCount = 0;
+size_t bench_HeapAllocCount = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Services and client sessions.  The benchmarks only use the Admin API and internal functions,
+ * which don't look at the client session.
+ */
+//--------------------------------------------------------------------------------------------------
+static int ServiceIo;
+static int ServiceQuery;
+static int SessionIo;
+static int SessionQuery;
+
+le_msg_ServiceRef_t io_GetServiceRef(void)
+{
+    return (le_msg_ServiceRef_t)&ServiceIo;
+}
+
+le_msg_ServiceRef_t query_GetServiceRef(void)
+{
+    return (le_msg_ServiceRef_t)&ServiceQuery;
+}
+
+le_msg_SessionRef_t io_GetClientSessionRef(void)
+{
+    return (le_msg_SessionRef_t)&SessionIo;
+}
+
+le_msg_SessionRef_t query_GetClientSessionRef(void)
+{
+    return (le_msg_SessionRef_t)&SessionQuery;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sessions never close, so there's nothing to register.
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t __wrap_le_msg_AddServiceCloseHandler
+(
+    le_msg_ServiceRef_t serviceRef,
+    le_msg_SessionEventHandler_t handlerFunc,
+    void* contextPtr
+)
+{
+    (void)serviceRef;
+    (void)handlerFunc;
+    (void)contextPtr;
+    return (le_msg_SessionEventHandlerRef_t)&ServiceIo;
+}
+
+le_result_t le_appInfo_GetName
+(
+    int32_t  pid,           ///< [IN]  PID of the process.
+    char    *appNameStr,    ///< [OUT] Application name buffer.
+    size_t   appNameSize    ///< [IN]  Buffer size.
+)
+{
+    (void)pid;
+    return le_utf8_Copy(appNameStr, "bench", appNameSize, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Allocation counting wrappers (see -Wl,--wrap in the Makefile).
+ */
+//--------------------------------------------------------------------------------------------------
+void* __real_hub_MemAlloc(le_mem_PoolRef_t pool);
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_hub_MemAlloc(le_mem_PoolRef_t pool)
+{
+    bench_PoolAllocCount++;
+    return __real_hub_MemAlloc(pool);
+}
+
+void* __wrap_malloc(size_t size)
+{
+    bench_HeapAllocCount++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    bench_HeapAllocCount++;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    bench_HeapAllocCount++;
+    return __real_realloc(ptr, size);
+}
@@ -0,0 +1,342 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_benchmark.c
+ *
+ * Measures how long the Data Hub takes to load configs of increasing size through the config.api.
+ *
+ * A config with the given number of observations (and one state per observation) is generated for
+ * each step, loaded, and the time from config_Load() to the result callback is logged along with
+ * the size of the file.  The same config is loaded as both JSON and CBOR to compare the encodings.
+ * The last step is a config of about 10 MB.
+ *
+ * The growth of the Data Hub's peak resident memory (VmHWM) is reported for each step, for
+ * information only: it includes the Resources and Observations the config creates as well as the
+ * memory used to stage it, and staging memory grows with the size of the file, so no ceiling is
+ * checked here.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define BENCHMARK_TIMEOUT   300000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of observations and encoding of the config loaded at each step.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    int obsCount;
+    const char* encoding;
+}
+Steps[] =
+{
+    {100, "json"},
+    {1000, "json"},
+    {10000, "json"},
+    {2000, "json"},
+    {2000, "cbor"},
+    {75000, "json"},    // about 10 MB
+};
+
+static size_t StepIndex = 0;
+static le_clk_Time_t StartTime;
+static char ConfigPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+static long ConfigSize;
+static pid_t HubPid;
+static long HubPeakKb;
+
+/*
+ * Timer to trigger timeout if a load does not complete.
+ */
+static le_timer_Ref_t TestTimeoutTimerRef;
+
+static void RunStep(void);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a JSON config holding obsCount observations and as many states.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteJsonConfig
+(
+    FILE* file,
+    int obsCount
+)
+{
+    fprintf(file, "{\"o\":{");
+    for (int i = 0; i < obsCount; i++)
+    {
+        fprintf(file,
+                "%s\"bench%d\":{\"r\":\"/app/configTest/bench/%d/value\",\"d\":\"bench\","
+                "\"p\":1,\"st\":0.5,\"b\":10}",
+                (i == 0) ? "" : ",",
+                i,
+                i);
+    }
+    fprintf(file, "},\"s\":{");
+    for (int i = 0; i < obsCount; i++)
+    {
+        fprintf(file,
+                "%s\"/app/configTest/bench/%d/value\":{\"v\":%d}",
+                (i == 0) ? "" : ",",
+                i,
+                i);
+    }
+    fprintf(file, "}}");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write the head of a CBOR data item.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteCborHead
+(
+    FILE* file,
+    uint8_t majorType,
+    uint32_t value
+)
+{
+    if (value < 24)
+    {
+        fputc((majorType << 5) | value, file);
+    }
+    else if (value <= UINT8_MAX)
+    {
+        fputc((majorType << 5) | 24, file);
+        fputc(value, file);
+    }
+    else if (value <= UINT16_MAX)
+    {
+        fputc((majorType << 5) | 25, file);
+        fputc(value >> 8, file);
+        fputc(value & 0xff, file);
+    }
+    else
+    {
+        fputc((majorType << 5) | 26, file);
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            fputc((value >> shift) & 0xff, file);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a CBOR text string.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteCborText
+(
+    FILE* file,
+    const char* text
+)
+{
+    size_t length = strlen(text);
+    WriteCborHead(file, 3, length);
+    fwrite(text, 1, length, file);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a CBOR config holding the same content as WriteJsonConfig().
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteCborConfig
+(
+    FILE* file,
+    int obsCount
+)
+{
+    char buffer[IO_MAX_RESOURCE_PATH_LEN + 1];
+
+    WriteCborHead(file, 5, 2);
+
+    WriteCborText(file, "o");
+    WriteCborHead(file, 5, obsCount);
+    for (int i = 0; i < obsCount; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "bench%d", i);
+        WriteCborText(file, buffer);
+        WriteCborHead(file, 5, 5);
+        WriteCborText(file, "r");
+        snprintf(buffer, sizeof(buffer), "/app/configTest/bench/%d/value", i);
+        WriteCborText(file, buffer);
+        WriteCborText(file, "d");
+        WriteCborText(file, "bench");
+        WriteCborText(file, "p");
+        WriteCborHead(file, 0, 1);
+        WriteCborText(file, "st");
+        fputc(0xf9, file);      // half precision 0.5
+        fputc(0x38, file);
+        fputc(0x00, file);
+        WriteCborText(file, "b");
+        WriteCborHead(file, 0, 10);
+    }
+
+    WriteCborText(file, "s");
+    WriteCborHead(file, 5, obsCount);
+    for (int i = 0; i < obsCount; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "/app/configTest/bench/%d/value", i);
+        WriteCborText(file, buffer);
+        WriteCborHead(file, 5, 1);
+        WriteCborText(file, "v");
+        WriteCborHead(file, 0, i);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a config file holding obsCount observations and as many states, in the given encoding.
+ *
+ *  @return true if the file was written.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteConfig
+(
+    const char* path,
+    const char* encoding,
+    int obsCount
+)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", path);
+        return false;
+    }
+
+    if (strcmp(encoding, "cbor") == 0)
+    {
+        WriteCborConfig(file, obsCount);
+    }
+    else
+    {
+        WriteJsonConfig(file, obsCount);
+    }
+    ConfigSize = ftell(file);
+
+    return (fclose(file) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Result callback for each load.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+    le_timer_Stop(TestTimeoutTimerRef);
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    LE_TEST_OK(res == LE_OK, "load of %d observations (%s), got %s (%s at %" PRIu32 ")",
+               Steps[StepIndex].obsCount, Steps[StepIndex].encoding, LE_RESULT_TXT(res),
+               errorMsg, fileLoc);
+    long peakKb = configTest_GetPeakKb(HubPid);
+    LE_TEST_INFO("BENCHMARK: %d observations (%s, %ld bytes) loaded in %ld.%06ld s,"
+                 " hubd peak memory %ld kB (+%ld kB)",
+                 Steps[StepIndex].obsCount, Steps[StepIndex].encoding, ConfigSize,
+                 (long)elapsed.sec, (long)elapsed.usec,
+                 peakKb, (peakKb >= 0 && HubPeakKb >= 0) ? peakKb - HubPeakKb : 0);
+
+    unlink(ConfigPath);
+
+    StepIndex++;
+    RunStep();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Time out callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_OK(false, "Did not get result callback in time.");
+    LE_TEST_INFO("======== END Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Generate and load the config for the current step.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunStep
+(
+    void
+)
+{
+    if (StepIndex >= NUM_ARRAY_MEMBERS(Steps))
+    {
+        LE_TEST_INFO("======== END Benchmark TEST ========");
+        LE_TEST_EXIT;
+    }
+
+    snprintf(ConfigPath, sizeof(ConfigPath), "/tmp/configBench%d.%s",
+             Steps[StepIndex].obsCount, Steps[StepIndex].encoding);
+    LE_ASSERT(WriteConfig(ConfigPath, Steps[StepIndex].encoding, Steps[StepIndex].obsCount));
+
+    HubPeakKb = configTest_GetPeakKb(HubPid);
+    le_timer_Start(TestTimeoutTimerRef);
+    StartTime = le_clk_GetRelativeTime();
+
+    le_result_t res = config_Load(ConfigPath, Steps[StepIndex].encoding, ResCallback, NULL);
+    if (res != LE_OK)
+    {
+        LE_TEST_OK(false, "config_Load of %d observations (%s) returned %s",
+                   Steps[StepIndex].obsCount, Steps[StepIndex].encoding, LE_RESULT_TXT(res));
+        LE_TEST_EXIT;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Run the config load benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+void config_benchmark_test
+(
+)
+{
+    LE_TEST_INFO("======== BEGIN Benchmark TEST ========");
+    LE_TEST_PLAN(NUM_ARRAY_MEMBERS(Steps));
+
+    HubPid = configTest_FindHubPid();
+
+    TestTimeoutTimerRef = le_timer_Create("BenchmarkTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, BENCHMARK_TIMEOUT);
+
+    RunStep();
+}
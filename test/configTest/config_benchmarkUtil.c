@@ -0,0 +1,155 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_benchmarkUtil.c
+ *
+ * Helpers shared by the benchmarks: logging the time taken, and finding the Data Hub's process to
+ * read its figures from /proc.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include <dirent.h>
+#include <ctype.h>
+
+#include "config_test.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Log the time taken by count operations since startTime, the time per operation and the number
+ *  of operations per second.
+ */
+//--------------------------------------------------------------------------------------------------
+void configTest_LogTime
+(
+    const char* what,           ///< What was done, following the count in the log.
+    le_clk_Time_t startTime,    ///< When it started.
+    int count,                  ///< Number of operations.
+    const char* unit            ///< Name of one operation.
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    double us = elapsed.sec * 1000000.0 + elapsed.usec;
+
+    LE_TEST_INFO("BENCHMARK: %d %s in %ld.%06ld s (%.3f us/%s, %.0f/s)",
+                 count,
+                 what,
+                 (long)elapsed.sec,
+                 (long)elapsed.usec,
+                 us / count,
+                 unit,
+                 (us > 0) ? (count * 1000000.0 / us) : 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Find the Data Hub's process.
+ *
+ * @return The PID, or 0 if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+pid_t configTest_FindHubPid
+(
+    void
+)
+{
+    pid_t pid = 0;
+    DIR* dirPtr = opendir("/proc");
+    struct dirent* entryPtr;
+
+    while ((dirPtr != NULL) && (pid == 0) && ((entryPtr = readdir(dirPtr)) != NULL))
+    {
+        char path[64];
+        char comm[32] = "";
+
+        if (!isdigit((unsigned char)entryPtr->d_name[0]))
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "/proc/%s/comm", entryPtr->d_name);
+        FILE* filePtr = fopen(path, "r");
+        if (filePtr != NULL)
+        {
+            if ((fgets(comm, sizeof(comm), filePtr) != NULL) && (strcmp(comm, "hubd\n") == 0))
+            {
+                pid = atoi(entryPtr->d_name);
+            }
+            fclose(filePtr);
+        }
+    }
+
+    if (dirPtr != NULL)
+    {
+        closedir(dirPtr);
+    }
+
+    return pid;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get a "key: value" field of a process's /proc file (e.g., "status" or "io").
+ *
+ * @return The value, or -1 if it cannot be read.
+ */
+//--------------------------------------------------------------------------------------------------
+long configTest_GetProcField
+(
+    pid_t pid,
+    const char* file,
+    const char* key
+)
+{
+    char path[64];
+    char line[128];
+    size_t keyLen = strlen(key);
+    long value = -1;
+
+    if (pid == 0)
+    {
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "/proc/%d/%s", (int)pid, file);
+    FILE* filePtr = fopen(path, "r");
+    if (filePtr == NULL)
+    {
+        return -1;
+    }
+
+    while ((value < 0) && (fgets(line, sizeof(line), filePtr) != NULL))
+    {
+        if (   (strncmp(line, key, keyLen) != 0)
+            || (line[keyLen] != ':')
+            || (sscanf(line + keyLen + 1, "%ld", &value) != 1))
+        {
+            value = -1;
+        }
+    }
+    fclose(filePtr);
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get the peak resident memory (VmHWM) of a process.
+ *
+ * @return Peak resident memory in kB, or -1 if it cannot be read.
+ */
+//--------------------------------------------------------------------------------------------------
+long configTest_GetPeakKb
+(
+    pid_t pid
+)
+{
+    return configTest_GetProcField(pid, "status", "VmHWM");
+}
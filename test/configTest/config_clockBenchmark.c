@@ -0,0 +1,227 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_clockBenchmark.c
+ *
+ * Measures the cost of the clock reads on the push path: samples stamped IO_NOW are pushed in
+ * batches to an Input feeding a buffered Observation that has a minimum period and a backup
+ * period, so that each sample is time stamped, rate checked and considered for backup.
+ *
+ * The Data Hub reads the clock at most once per batch for all of these, so the CPU time it uses
+ * per sample is logged, as measured from /proc, along with the rate seen by this client.  The
+ * same is then done with one sample per message (io_PushNumeric()).  For both, the read and write
+ * system calls and the context switches of the Data Hub per message are logged too, to make sure
+ * that caching the clock does not add kernel work to the push path.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define SAMPLE_COUNT        200000
+#define SINGLE_COUNT        20000
+#define RESOURCE_NAME       "clock/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME            "clockObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Get the CPU time used by a process, in clock ticks.
+ *
+ * @return The time, or 0 if it could not be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static unsigned long GetCpuTicks
+(
+    pid_t pid
+)
+{
+    char path[64];
+    char buffer[512];
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE* filePtr = fopen(path, "r");
+    if (filePtr == NULL)
+    {
+        return 0;
+    }
+
+    // utime and stime are the 14th and 15th fields, counted after the command name, which may
+    // contain spaces.
+    if (fgets(buffer, sizeof(buffer), filePtr) != NULL)
+    {
+        const char* fieldsPtr = strrchr(buffer, ')');
+        if ((fieldsPtr == NULL)
+            || (sscanf(fieldsPtr + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                       &utime, &stime) != 2))
+        {
+            utime = 0;
+            stime = 0;
+        }
+    }
+    fclose(filePtr);
+
+    return utime + stime;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Counters of the Data Hub's process.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    unsigned long cpuTicks;     ///< CPU time, in clock ticks.
+    long syscalls;              ///< Read and write system calls, or -1 if unknown.
+    long ctxSwitches;           ///< Context switches, or -1 if unknown.
+}
+HubCounters_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read the counters of the Data Hub's process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadCounters
+(
+    pid_t pid,
+    HubCounters_t* countersPtr      ///< [OUT]
+)
+{
+    long reads = configTest_GetProcField(pid, "io", "syscr");
+    long writes = configTest_GetProcField(pid, "io", "syscw");
+    long voluntary = configTest_GetProcField(pid, "status", "voluntary_ctxt_switches");
+    long involuntary = configTest_GetProcField(pid, "status", "nonvoluntary_ctxt_switches");
+
+    countersPtr->cpuTicks = GetCpuTicks(pid);
+    countersPtr->syscalls = ((reads >= 0) && (writes >= 0)) ? reads + writes : -1;
+    countersPtr->ctxSwitches = ((voluntary >= 0) && (involuntary >= 0)) ?
+                                    voluntary + involuntary : -1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Log the rate of a run, and the Data Hub's CPU time per sample and system calls and context
+ *  switches per message since startPtr was read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogRun
+(
+    const char* what,
+    pid_t pid,
+    const HubCounters_t* startPtr,
+    le_clk_Time_t startTime,
+    int sampleCount,
+    int messageCount
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    double seconds = elapsed.sec + (elapsed.usec / 1000000.0);
+    HubCounters_t end;
+
+    ReadCounters(pid, &end);
+
+    LE_TEST_INFO("BENCHMARK: %d IO_NOW samples %s: %.0f samples/s, Data Hub CPU %.0f ns/sample,"
+                 " %.2f read/write syscalls and %.2f context switches per message",
+                 sampleCount,
+                 what,
+                 sampleCount / seconds,
+                 (pid != 0) ? (end.cpuTicks - startPtr->cpuTicks) *
+                                 (1000000000.0 / sysconf(_SC_CLK_TCK)) / sampleCount
+                            : NAN,
+                 ((end.syscalls >= 0) && (startPtr->syscalls >= 0)) ?
+                        (double)(end.syscalls - startPtr->syscalls) / messageCount : NAN,
+                 ((end.ctxSwitches >= 0) && (startPtr->ctxSwitches >= 0)) ?
+                        (double)(end.ctxSwitches - startPtr->ctxSwitches) / messageCount : NAN);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_clockBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Clock Benchmark TEST ========");
+    LE_TEST_PLAN(4);
+
+    uint32_t handle = 0;
+    LE_TEST_OK(   (io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (io_GetIngestHandle(RESOURCE_NAME, &handle) == LE_OK),
+               "Created Input");
+
+    LE_TEST_OK(   (admin_CreateObs(OBS_NAME) == LE_OK)
+               && (admin_SetMinPeriod(OBS_NAME, 0.000001) == LE_OK)
+               && (admin_SetBufferMaxCount(OBS_NAME, 100) == LE_OK)
+               && (admin_SetBufferBackupPeriod(OBS_NAME, 1) == LE_OK)
+               && (admin_SetSource(ADMIN_OBS_NAME, ADMIN_RESOURCE_NAME) == LE_OK),
+               "Created buffered Observation");
+
+    uint32_t handles[IO_MAX_BATCH_SAMPLES];
+    uint8_t types[IO_MAX_BATCH_SAMPLES];
+    double timestamps[IO_MAX_BATCH_SAMPLES];
+    double values[IO_MAX_BATCH_SAMPLES];
+
+    for (int i = 0; i < IO_MAX_BATCH_SAMPLES; i++)
+    {
+        handles[i] = handle;
+        types[i] = IO_DATA_TYPE_NUMERIC;
+        timestamps[i] = IO_NOW;
+        values[i] = i;
+    }
+
+    pid_t hubPid = configTest_FindHubPid();
+    HubCounters_t start;
+    ReadCounters(hubPid, &start);
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_result_t result = LE_OK;
+
+    for (int pushed = 0;
+         (pushed < SAMPLE_COUNT) && (result == LE_OK);
+         pushed += IO_MAX_BATCH_SAMPLES)
+    {
+        result = io_PushBatch(handles, IO_MAX_BATCH_SAMPLES,
+                              types, IO_MAX_BATCH_SAMPLES,
+                              timestamps, IO_MAX_BATCH_SAMPLES,
+                              values, IO_MAX_BATCH_SAMPLES);
+    }
+
+    LogRun("in batches through a buffered Observation", hubPid, &start, startTime,
+           SAMPLE_COUNT, (SAMPLE_COUNT + IO_MAX_BATCH_SAMPLES - 1) / IO_MAX_BATCH_SAMPLES);
+    LE_TEST_OK(result == LE_OK, "Pushed %d samples in batches (%s)",
+               SAMPLE_COUNT, LE_RESULT_TXT(result));
+
+    ReadCounters(hubPid, &start);
+    startTime = le_clk_GetRelativeTime();
+
+    for (int i = 0; (i < SINGLE_COUNT) && (result == LE_OK); i++)
+    {
+        result = io_PushNumeric(RESOURCE_NAME, IO_NOW, i);
+    }
+
+    LogRun("one per message through a buffered Observation", hubPid, &start, startTime,
+           SINGLE_COUNT, SINGLE_COUNT);
+    LE_TEST_OK(result == LE_OK, "Pushed %d samples one at a time (%s)",
+               SINGLE_COUNT, LE_RESULT_TXT(result));
+
+    admin_DeleteObs(OBS_NAME);
+
+    LE_TEST_INFO("======== END Clock Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
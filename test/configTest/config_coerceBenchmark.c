@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_coerceBenchmark.c
+ *
+ * Measures the cost of type coercion in the Data Hub, by pushing the same samples to an Input of
+ * their own type and to an Input of another type, and logging the time per sample for both:
+ *  - numeric samples pushed to a Boolean Input with io_PushBatch(), which coerces each batch in
+ *    bulk; and
+ *  - string samples pushed to a numeric Input with io_PushString(), which coerces each sample as
+ *    it is pushed (strings cannot be batched).
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define SAMPLE_COUNT        1000000
+#define BOOLEAN_NAME        "coerce/boolean"
+#define NUMERIC_NAME        "coerce/numeric"
+#define STRING_NAME         "coerce/string"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push SAMPLE_COUNT numeric samples to an Input in batches.
+ *
+ * @return LE_OK if all the batches were pushed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushNumericBatches
+(
+    const char* path,
+    const char* what
+)
+{
+    uint32_t handle;
+    le_result_t result = io_GetIngestHandle(path, &handle);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    uint32_t handles[IO_MAX_BATCH_SAMPLES];
+    uint8_t types[IO_MAX_BATCH_SAMPLES];
+    double timestamps[IO_MAX_BATCH_SAMPLES];
+    double values[IO_MAX_BATCH_SAMPLES];
+
+    for (int i = 0; i < IO_MAX_BATCH_SAMPLES; i++)
+    {
+        handles[i] = handle;
+        types[i] = IO_DATA_TYPE_NUMERIC;
+        timestamps[i] = IO_NOW;
+        values[i] = i % 3;
+    }
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (int pushed = 0; (pushed < SAMPLE_COUNT) && (result == LE_OK); )
+    {
+        int count = SAMPLE_COUNT - pushed;
+        if (count > IO_MAX_BATCH_SAMPLES)
+        {
+            count = IO_MAX_BATCH_SAMPLES;
+        }
+
+        result = io_PushBatch(handles, count, types, count, timestamps, count, values, count);
+        pushed += count;
+    }
+
+    configTest_LogTime(what, startTime, SAMPLE_COUNT, "sample");
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push SAMPLE_COUNT string samples to an Input, one at a time.
+ *
+ * @return LE_OK if all the samples were pushed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PushStrings
+(
+    const char* path,
+    const char* what
+)
+{
+    static const char* const Values[] = { "", "0", "12.5" };
+    le_result_t result = LE_OK;
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (int i = 0; (i < SAMPLE_COUNT) && (result == LE_OK); i++)
+    {
+        result = io_PushString(path, IO_NOW, Values[i % NUM_ARRAY_MEMBERS(Values)]);
+    }
+
+    configTest_LogTime(what, startTime, SAMPLE_COUNT, "sample");
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_coerceBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Coercion Benchmark TEST ========");
+    LE_TEST_PLAN(7);
+
+    LE_TEST_OK((io_CreateInput(BOOLEAN_NAME, IO_DATA_TYPE_BOOLEAN, "") == LE_OK)
+               && (io_CreateInput(NUMERIC_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (io_CreateInput(STRING_NAME, IO_DATA_TYPE_STRING, "") == LE_OK),
+               "Created Inputs");
+
+    LE_TEST_OK(PushNumericBatches(NUMERIC_NAME, "numeric samples batched to a numeric Input")
+               == LE_OK, "Pushed numeric batches to a numeric Input");
+    LE_TEST_OK(PushNumericBatches(BOOLEAN_NAME, "numeric samples batched to a Boolean Input")
+               == LE_OK, "Pushed numeric batches to a Boolean Input");
+
+    // Every batch ends with a 0 (63 % 3).
+    bool boolValue = true;
+    double timestamp;
+    LE_TEST_OK((io_GetBoolean(BOOLEAN_NAME, &timestamp, &boolValue) == LE_OK) && !boolValue,
+               "Numeric samples were coerced to Boolean");
+
+    LE_TEST_OK(PushStrings(STRING_NAME, "string samples to a string Input") == LE_OK,
+               "Pushed strings to a string Input");
+    LE_TEST_OK(PushStrings(NUMERIC_NAME, "string samples to a numeric Input") == LE_OK,
+               "Pushed strings to a numeric Input");
+
+    // The last string was "" (999999 % 3 = 0), which is coerced to 0.
+    double numValue = NAN;
+    LE_TEST_OK((io_GetNumeric(NUMERIC_NAME, &timestamp, &numValue) == LE_OK) && (numValue == 0),
+               "String samples were coerced to numeric");
+
+    LE_TEST_INFO("======== END Coercion Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
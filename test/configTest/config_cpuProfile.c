@@ -0,0 +1,125 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_cpuProfile.c
+ *
+ * Tests CPU profiling through the Admin API: pushes to an Input and to the Observation it feeds
+ * are accounted for by each resource, and turning profiling back on clears them.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "cpu/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME            "cpuObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+
+/// Number of samples pushed.
+#define PUSH_COUNT          100
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look for a resource among the heaviest resources, and check its CPU times.
+ *
+ * @return true if it was found with a non-zero push time.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FindCpuTopEntry
+(
+    uint32_t count,
+    const char* expectedPath
+)
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    double cpuTime[ADMIN_CPU_SITE_COUNT];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        size_t cpuTimeSize = ADMIN_CPU_SITE_COUNT;
+
+        if (   (admin_GetCpuTopEntry(i, path, sizeof(path), cpuTime, &cpuTimeSize) == LE_OK)
+            && (strcmp(path, expectedPath) == 0))
+        {
+            LE_TEST_INFO("'%s' took %.1f us (handlers %.1f us)",
+                         path,
+                         cpuTime[ADMIN_CPU_SITE_PUSH] * 1e6,
+                         cpuTime[ADMIN_CPU_SITE_HANDLERS] * 1e6);
+
+            return (cpuTimeSize == ADMIN_CPU_SITE_COUNT) && (cpuTime[ADMIN_CPU_SITE_PUSH] > 0);
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_cpuProfile_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN CPU Profile TEST ========");
+    LE_TEST_PLAN(5);
+
+    le_result_t result = admin_SetCpuProfiling(true);
+
+    LE_TEST_BEGIN_SKIP(result == LE_NOT_IMPLEMENTED, 5);
+
+    LE_TEST_OK(result == LE_OK, "Turned CPU profiling on (%s)", LE_RESULT_TXT(result));
+
+    LE_TEST_OK(   (io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (admin_CreateObs(OBS_NAME) == LE_OK)
+               && (admin_SetSource(ADMIN_OBS_NAME, ADMIN_RESOURCE_NAME) == LE_OK)
+               && (admin_SetBufferMaxCount(OBS_NAME, PUSH_COUNT) == LE_OK),
+               "Created resources");
+
+    for (int i = 0; i < PUSH_COUNT; i++)
+    {
+        io_PushNumeric(RESOURCE_NAME, 0, i);
+    }
+
+    uint32_t count;
+    double window;
+    LE_TEST_OK(   (admin_UpdateCpuTop(&count, &window) == LE_OK)
+               && (window >= 0)
+               && FindCpuTopEntry(count, ADMIN_RESOURCE_NAME)
+               && FindCpuTopEntry(count, ADMIN_OBS_NAME),
+               "Input and Observation accounted for");
+
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    double cpuTime[ADMIN_CPU_SITE_COUNT];
+    size_t cpuTimeSize = ADMIN_CPU_SITE_COUNT;
+    LE_TEST_OK(admin_GetCpuTopEntry(count, path, sizeof(path), cpuTime, &cpuTimeSize)
+               == LE_OUT_OF_RANGE,
+               "Index past the end rejected");
+
+    // Turning profiling back on clears the times.
+    LE_TEST_OK(   (admin_SetCpuProfiling(false) == LE_OK)
+               && (admin_SetCpuProfiling(true) == LE_OK)
+               && (admin_UpdateCpuTop(&count, &window) == LE_OK)
+               && (count == 0),
+               "Cleared CPU times");
+
+    admin_SetCpuProfiling(false);
+
+    LE_TEST_END_SKIP();
+
+    admin_DeleteObs(OBS_NAME);
+    io_DeleteResource(RESOURCE_NAME);
+
+    LE_TEST_INFO("======== END CPU Profile TEST ========");
+    LE_TEST_EXIT;
+}
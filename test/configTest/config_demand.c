@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_demand.c
+ *
+ * Tests the demand notifications of the io API: an Input's demand handler is told how many
+ * consumers its samples have and the shortest period at which they want them, as Observations
+ * are connected to and removed from it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define TEST_CALLBACK_TIMEOUT   5000
+#define INPUT_NAME              "demand/value"
+#define ADMIN_INPUT_NAME        "/app/configTest/" INPUT_NAME
+#define OBS_NAME                "demandObs"
+#define ADMIN_OBS_NAME          "/obs/" OBS_NAME
+#define OBS_MIN_PERIOD          2.5
+
+/// Timer to fail the test if an expected notification is not received.
+static le_timer_Ref_t TestTimeoutTimerRef;
+
+/// Number of notifications received.
+static int NotificationCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Fail the test if an expected notification is not received.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    LE_TEST_FATAL("Did not get demand notification %d", NotificationCount + 1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check each demand notification, and make the change that leads to the next one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DemandHandler
+(
+    double period,
+    uint32_t consumerCount,
+    void* contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    le_timer_Restart(TestTimeoutTimerRef);
+
+    switch (NotificationCount++)
+    {
+        case 0:
+            LE_TEST_OK((consumerCount == 0) && (period == 0),
+                       "No demand before anything uses the Input (%" PRIu32 ", %f)",
+                       consumerCount, period);
+
+            // Throttle the Observation before connecting it, so its demand arrives in one change.
+            LE_TEST_OK(admin_CreateObs(OBS_NAME) == LE_OK, "Created Observation");
+            LE_TEST_OK(admin_SetMinPeriod(OBS_NAME, OBS_MIN_PERIOD) == LE_OK, "Set min period");
+            LE_TEST_OK(admin_SetSource(ADMIN_OBS_NAME, ADMIN_INPUT_NAME) == LE_OK,
+                       "Connected Observation");
+            break;
+
+        case 1:
+            LE_TEST_OK((consumerCount == 1) && (period == OBS_MIN_PERIOD),
+                       "Demand follows the Observation (%" PRIu32 ", %f)", consumerCount, period);
+
+            admin_DeleteObs(OBS_NAME);
+            break;
+
+        case 2:
+            LE_TEST_OK((consumerCount == 0) && (period == 0),
+                       "No demand once the Observation is deleted (%" PRIu32 ", %f)",
+                       consumerCount, period);
+
+            le_timer_Stop(TestTimeoutTimerRef);
+            LE_TEST_INFO("======== END Demand TEST ========");
+            LE_TEST_EXIT;
+            break;
+
+        default:
+            LE_TEST_FATAL("Unexpected demand notification (%" PRIu32 ", %f)",
+                          consumerCount, period);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_demand_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Demand TEST ========");
+    LE_TEST_PLAN(7);
+
+    TestTimeoutTimerRef = le_timer_Create("TestTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_CALLBACK_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+
+    LE_ASSERT(io_CreateInput(INPUT_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK);
+    LE_ASSERT(io_AddDemandHandler(INPUT_NAME, DemandHandler, NULL) != NULL);
+}
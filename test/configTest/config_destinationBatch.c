@@ -0,0 +1,211 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_destinationBatch.c
+ *
+ * Testing batched destination delivery for the config.api
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define TEST_CALLBACK_TIMEOUT 5000
+
+/// Size of the fixed part of a batch record (see config_StartDestinationBatch()).
+#define RECORD_HEADER_BYTES   20
+
+#define RESOURCE_NAME "resource2/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME "obs2"
+#define TEST_DESTINATION "destination2"
+
+/*
+ * Timer to trigger timeout if expected records are not received.
+ */
+static le_timer_Ref_t TestTimeoutTimerRef;
+
+static const double TestValues[] = { 1.5, -2.25, 1000.0 };
+#define TEST_VALUE_COUNT  NUM_ARRAY_MEMBERS(TestValues)
+
+static size_t RecordCount = 0;
+
+/// Records received so far, possibly ending with a partial record.
+static uint8_t ReadBuffer[512];
+static size_t ReadLen = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  timeout handler
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_FATAL("Received %" PRIuS " of %" PRIuS " records", RecordCount, TEST_VALUE_COUNT);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the complete records at the start of ReadBuffer and drop them from it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckRecords
+(
+    void
+)
+{
+    size_t offset = 0;
+
+    while (ReadLen - offset >= RECORD_HEADER_BYTES)
+    {
+        const uint8_t* recordPtr = &ReadBuffer[offset];
+        uint32_t recordLen;
+        uint32_t valueLen;
+        double value;
+
+        memcpy(&recordLen, recordPtr, sizeof(recordLen));
+        if (ReadLen - offset < recordLen)
+        {
+            break;
+        }
+        memcpy(&valueLen, recordPtr + 16, sizeof(valueLen));
+
+        uint8_t obsNameLen = recordPtr[13];
+        uint8_t srcPathLen = recordPtr[14];
+        const char* obsName = (const char*)recordPtr + RECORD_HEADER_BYTES;
+        const char* srcPath = obsName + obsNameLen;
+        memcpy(&value, srcPath + srcPathLen, sizeof(value));
+
+        LE_TEST_OK((recordPtr[12] == IO_DATA_TYPE_NUMERIC) &&
+                   (obsNameLen == strlen(OBS_NAME)) &&
+                   (strncmp(obsName, OBS_NAME, obsNameLen) == 0) &&
+                   (srcPathLen == strlen(ADMIN_RESOURCE_NAME)) &&
+                   (strncmp(srcPath, ADMIN_RESOURCE_NAME, srcPathLen) == 0) &&
+                   (valueLen == sizeof(double)) &&
+                   (recordLen == RECORD_HEADER_BYTES + obsNameLen + srcPathLen + valueLen) &&
+                   (value == TestValues[RecordCount]),
+                   "Record %" PRIuS ": %.*s, value %f",
+                   RecordCount,
+                   (int)obsNameLen,
+                   obsName,
+                   value);
+
+        RecordCount++;
+        offset += recordLen;
+    }
+
+    memmove(ReadBuffer, &ReadBuffer[offset], ReadLen - offset);
+    ReadLen -= offset;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batch stream handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchStreamHandler
+(
+    int fd,
+    short events
+)
+{
+    if (events & POLLIN)
+    {
+        ssize_t count = read(fd, &ReadBuffer[ReadLen], sizeof(ReadBuffer) - ReadLen);
+        if (count > 0)
+        {
+            ReadLen += count;
+            CheckRecords();
+        }
+    }
+
+    if (RecordCount == TEST_VALUE_COUNT)
+    {
+        le_timer_Stop(TestTimeoutTimerRef);
+
+        LE_TEST_OK(config_StopDestinationBatch(TEST_DESTINATION) == LE_OK, "Stopped batch");
+        LE_TEST_OK(config_StopDestinationBatch(TEST_DESTINATION) == LE_NOT_FOUND,
+                   "Batch cannot be stopped twice");
+
+        LE_TEST_INFO("======== END DestinationBatch TEST ========");
+        LE_TEST_EXIT;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  config load result callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConfigLoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+    LE_UNUSED(errorMsg);
+    LE_UNUSED(fileLoc);
+    LE_TEST_OK(res == LE_OK, "Config file final load result: %d", res);
+
+    int batchStream = -1;
+    res = config_StartDestinationBatch(TEST_DESTINATION, 0, 100, &batchStream);
+    LE_TEST_OK((res == LE_OK) && (batchStream >= 0), "Started batch: %s", LE_RESULT_TXT(res));
+
+    int otherStream = -1;
+    res = config_StartDestinationBatch(TEST_DESTINATION, 0, 100, &otherStream);
+    LE_TEST_OK(res == LE_DUPLICATE, "Batch cannot be started twice: %s", LE_RESULT_TXT(res));
+
+    le_fdMonitor_Create("BatchStream", batchStream, BatchStreamHandler, POLLIN);
+
+    // All of these should arrive in a single batch, after 100 ms.
+    for (size_t i = 0; i < TEST_VALUE_COUNT; i++)
+    {
+        res = io_PushNumeric(RESOURCE_NAME, IO_NOW, TestValues[i]);
+        LE_TEST_OK(res == LE_OK, "Pushed %f: %s", TestValues[i], LE_RESULT_TXT(res));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function: batch a destination and check the records pushed through the batch stream.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_destinationBatch_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN DestinationBatch TEST ========");
+    LE_TEST_PLAN(13);
+
+    le_result_t res = io_CreateOutput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Resource: %s", LE_RESULT_TXT(res));
+
+    res = config_Load("test/configTest/configFiles/config_destinationPushHandler.json",
+                      "json",
+                      ConfigLoadResCallback,
+                      NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load return value is %d", res);
+
+    TestTimeoutTimerRef = le_timer_Create("TestTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_CALLBACK_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+}
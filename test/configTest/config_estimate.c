@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_estimate.c
+ *
+ * Testing the config load cost estimate of the config.api
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME "resource1/value"
+#define CONFIG_FILE "test/configTest/configFiles/rollbackConfig1.json"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function: estimate a config and check that nothing has been applied.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_estimate_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Estimate TEST ========");
+    LE_TEST_PLAN(7);
+
+    uint32_t obsCount, newObsCount, stateCount, bufferEntryCount;
+    uint32_t nonStringSampleCount, stringSampleCount;
+    uint32_t smallStringCount, medStringCount, largeStringCount;
+    double backupBytesPerSec;
+
+    le_result_t res = io_CreateOutput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Resource: %s", LE_RESULT_TXT(res));
+
+    res = config_Estimate(CONFIG_FILE, "json", &obsCount, &newObsCount, &stateCount,
+                          &bufferEntryCount, &nonStringSampleCount, &stringSampleCount,
+                          &smallStringCount, &medStringCount, &largeStringCount,
+                          &backupBytesPerSec);
+    LE_TEST_OK(res == LE_OK, "config_Estimate return value is %s", LE_RESULT_TXT(res));
+
+    // rbobs1 buffers 10 numeric samples and has no backup.
+    LE_TEST_OK((obsCount == 1) && (newObsCount == 1) && (stateCount == 0),
+               "Counted %" PRIu32 " obs (%" PRIu32 " new), %" PRIu32 " states",
+               obsCount, newObsCount, stateCount);
+    LE_TEST_OK((bufferEntryCount == 10) && (nonStringSampleCount == 10) &&
+               (stringSampleCount == 0) && (backupBytesPerSec == 0),
+               "Counted %" PRIu32 " buffer entries, %" PRIu32 " samples",
+               bufferEntryCount, nonStringSampleCount);
+
+    LE_TEST_OK(admin_GetEntryType("/obs/rbobs1") == ADMIN_ENTRY_TYPE_NONE,
+               "Config not applied");
+
+    res = config_Estimate(CONFIG_FILE, "xml", &obsCount, &newObsCount, &stateCount,
+                          &bufferEntryCount, &nonStringSampleCount, &stringSampleCount,
+                          &smallStringCount, &medStringCount, &largeStringCount,
+                          &backupBytesPerSec);
+    LE_TEST_OK(res == LE_UNSUPPORTED, "Unknown encoding: %s", LE_RESULT_TXT(res));
+
+    res = config_Estimate("test/configTest/configFiles/noSuchConfig.json", "json", &obsCount,
+                          &newObsCount, &stateCount, &bufferEntryCount, &nonStringSampleCount,
+                          &stringSampleCount, &smallStringCount, &medStringCount,
+                          &largeStringCount, &backupBytesPerSec);
+    LE_TEST_OK(res == LE_NOT_FOUND, "Missing file: %s", LE_RESULT_TXT(res));
+
+    LE_TEST_INFO("======== END Estimate TEST ========");
+    LE_TEST_EXIT;
+}
@@ -0,0 +1,174 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_ingestBenchmark.c
+ *
+ * Compares the rate at which numeric samples can be pushed to the Data Hub through the io API's
+ * Push functions (one IPC message per sample) and through the shared-memory ingest ring.
+ *
+ * The same number of samples is pushed to an Input each way, and the number of samples per second
+ * is logged for both.  The ring is considered done when the Data Hub has consumed every record.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include <sys/mman.h>
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "ingest/value"
+#define SAMPLE_COUNT        100000
+#define RING_RECORDS        4096
+#define DRAIN_TIMEOUT_MS    10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A record in the ingest ring, as described in io.api.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t handle;
+    uint8_t type;
+    uint8_t reserved[3];
+    double timestamp;
+    double value;
+}
+Record_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push the samples one IPC message at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushOverIpc
+(
+    void
+)
+{
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_result_t res = LE_OK;
+    int i;
+
+    for (i = 0; (i < SAMPLE_COUNT) && (res == LE_OK); i++)
+    {
+        res = io_PushNumeric(RESOURCE_NAME, IO_NOW, i);
+    }
+    LE_TEST_OK(res == LE_OK, "Pushed over IPC: %s", LE_RESULT_TXT(res));
+
+    configTest_LogTime("samples through io_PushNumeric()", startTime, i, "sample");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push the samples through the ingest ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushOverRing
+(
+    void
+)
+{
+    int ringFd = -1;
+    int doorbellFd = -1;
+    uint32_t handle = 0;
+
+    le_result_t res = io_OpenIngestRing(RING_RECORDS, &ringFd, &doorbellFd);
+    LE_TEST_OK(res == LE_OK, "Opened ingest ring: %s", LE_RESULT_TXT(res));
+    if (res != LE_OK)
+    {
+        LE_TEST_FATAL("No ingest ring");
+    }
+
+    res = io_GetIngestHandle(RESOURCE_NAME, &handle);
+    LE_TEST_OK(res == LE_OK, "Got ingest handle: %s", LE_RESULT_TXT(res));
+
+    size_t ringBytes = IO_INGEST_RECORDS_OFFSET + (RING_RECORDS * IO_INGEST_RECORD_BYTES);
+    uint8_t* ringPtr = mmap(NULL, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED, ringFd, 0);
+    LE_FATAL_IF(ringPtr == MAP_FAILED, "Cannot map ingest ring: %m");
+
+    uint32_t* headPtr = (uint32_t*)(ringPtr + IO_INGEST_HEAD_OFFSET);
+    uint32_t* tailPtr = (uint32_t*)(ringPtr + IO_INGEST_TAIL_OFFSET);
+    uint32_t* waitingPtr = (uint32_t*)(ringPtr + IO_INGEST_WAITING_OFFSET);
+    Record_t* recordsPtr = (Record_t*)(ringPtr + IO_INGEST_RECORDS_OFFSET);
+    const uint64_t ring = 1;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    uint32_t head = *headPtr;
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        // Wait for a free slot.
+        while ((head - __atomic_load_n(tailPtr, __ATOMIC_ACQUIRE)) >= RING_RECORDS)
+        {
+            sched_yield();
+        }
+
+        Record_t* recordPtr = &recordsPtr[head % RING_RECORDS];
+        recordPtr->handle = handle;
+        recordPtr->type = IO_DATA_TYPE_NUMERIC;
+        recordPtr->timestamp = IO_NOW;
+        recordPtr->value = SAMPLE_COUNT + i;
+        head++;
+        __atomic_store_n(headPtr, head, __ATOMIC_SEQ_CST);
+
+        if (__atomic_exchange_n(waitingPtr, 0, __ATOMIC_SEQ_CST) != 0)
+        {
+            LE_FATAL_IF(write(doorbellFd, &ring, sizeof(ring)) != sizeof(ring),
+                        "Cannot ring doorbell: %m");
+        }
+    }
+
+    // Wait for the Data Hub to consume the last record.
+    int waitedMs = 0;
+    while ((__atomic_load_n(tailPtr, __ATOMIC_ACQUIRE) != head) && (waitedMs < DRAIN_TIMEOUT_MS))
+    {
+        usleep(1000);
+        waitedMs++;
+    }
+    LE_TEST_OK(*tailPtr == head, "Ring drained");
+
+    configTest_LogTime("samples through the ingest ring", startTime, SAMPLE_COUNT, "sample");
+
+    double timestamp;
+    double value;
+    res = io_GetNumeric(RESOURCE_NAME, &timestamp, &value);
+    LE_TEST_OK((res == LE_OK) && (value == (2 * SAMPLE_COUNT) - 1),
+               "Last value pushed through the ring is current (%f)", value);
+
+    munmap(ringPtr, ringBytes);
+    close(ringFd);
+    close(doorbellFd);
+    io_CloseIngestRing();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_ingestBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Ingest Benchmark TEST ========");
+    LE_TEST_PLAN(6);
+
+    le_result_t res = io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Input: %s", LE_RESULT_TXT(res));
+
+    PushOverIpc();
+    PushOverRing();
+
+    LE_TEST_INFO("======== END Ingest Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_listBenchmark.c
+ *
+ * Compares the cost of listing a large branch of the resource tree by walking it with
+ * admin_GetFirstChild() and admin_GetNextSibling(), as "dhub list" used to, with listing it in one
+ * pass with admin_ListSubtree().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define GROUP_COUNT         100
+#define INPUT_COUNT         200     // Per group.
+#define ENTRY_COUNT         (1 + GROUP_COUNT * (1 + INPUT_COUNT))   // Including the branch root.
+#define BRANCH_NAME         "list"
+#define ADMIN_BRANCH_NAME   "/app/configTest/" BRANCH_NAME
+
+/// Number of records received from admin_ListSubtree().
+static int RecordCount = 0;
+
+/// Time the listing started.
+static le_clk_Time_t StartTime;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Walk a branch of the resource tree as "dhub list" used to, getting the type of each entry.
+ *
+ * @return Number of entries in the branch.
+ */
+//--------------------------------------------------------------------------------------------------
+static int WalkBranch
+(
+    const char* path
+)
+{
+    char childPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+    int count = (admin_GetEntryType(path) != ADMIN_ENTRY_TYPE_NONE) ? 1 : 0;
+
+    le_result_t result = admin_GetFirstChild(path, childPath, sizeof(childPath));
+
+    while (result == LE_OK)
+    {
+        count += WalkBranch(childPath);
+
+        result = admin_GetNextSibling(childPath, childPath, sizeof(childPath));
+    }
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check the listing once it is complete.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ListComplete
+(
+    le_result_t result,
+    void* contextPtr
+)
+{
+    LE_UNUSED(contextPtr);
+
+    configTest_LogTime("entries listed with admin_ListSubtree()", StartTime, ENTRY_COUNT, "entry");
+
+    LE_TEST_OK(result == LE_OK, "Listing completed (%s)", LE_RESULT_TXT(result));
+    LE_TEST_OK(RecordCount == ENTRY_COUNT, "Listed %d entries", RecordCount);
+
+    LE_TEST_INFO("======== END List Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_listBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN List Benchmark TEST ========");
+    LE_TEST_PLAN(4);
+
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    le_result_t result = LE_OK;
+
+    for (int i = 0; (i < GROUP_COUNT) && (result == LE_OK); i++)
+    {
+        for (int j = 0; (j < INPUT_COUNT) && (result == LE_OK); j++)
+        {
+            snprintf(path, sizeof(path), BRANCH_NAME "/group%d/input%d", i, j);
+            result = io_CreateInput(path, IO_DATA_TYPE_NUMERIC, "");
+        }
+    }
+    LE_TEST_OK(result == LE_OK, "Created %d Inputs (%s)",
+               GROUP_COUNT * INPUT_COUNT, LE_RESULT_TXT(result));
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    int walkCount = WalkBranch(ADMIN_BRANCH_NAME);
+    configTest_LogTime("entries listed with admin_GetFirstChild() and admin_GetNextSibling()",
+                       startTime, ENTRY_COUNT, "entry");
+    LE_TEST_OK(walkCount == ENTRY_COUNT, "Walked %d entries", walkCount);
+
+    int fds[2];
+    LE_ASSERT(pipe(fds) == 0);
+
+    StartTime = le_clk_GetRelativeTime();
+    LE_ASSERT(admin_ListSubtree(ADMIN_BRANCH_NAME, fds[1], ListComplete, NULL) == LE_OK);
+
+    // None of the Inputs has a value, so no field contains a newline and each one ends a record.
+    char buffer[4096];
+    ssize_t len;
+    while ((len = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t i = 0; i < len; i++)
+        {
+            if (buffer[i] == '\n')
+            {
+                RecordCount++;
+            }
+        }
+    }
+    close(fds[0]);
+
+    // Wait for ListComplete().
+}
@@ -71,7 +71,7 @@ static config_testcase_t config_testcases[][8] =
         {"nonExistingConfig.json", "json", LE_NOT_FOUND, LE_FAULT}, {{0}}
     },
     {
-        {"validConfig1.cbor", "cbor", LE_UNSUPPORTED, LE_FAULT} ,{{0}}
+        {"validConfig1.cbor", "cbor", LE_OK, LE_FORMAT_ERROR} ,{{0}}
     },
     {
         {"validConfig1.json", "json", LE_OK, LE_OK}, {{0}}
@@ -119,6 +119,16 @@ static config_testcase_t config_testcases[][8] =
     {
         {"validConfig1.json" , "json", LE_OK, LE_OK},
         {"tooLargeConfig1.json", "json", LE_OK, LE_FAULT}, {{0}} // will only pass on RTOS
+    },
+    {
+        {"validConfig2.cbor", "cbor", LE_OK, LE_OK} ,{{0}}
+    },
+    {
+        {"validConfig1.json", "xml", LE_UNSUPPORTED, LE_FAULT} ,{{0}}
+    },
+    {
+        {"validConfig2.cbor" , "cbor", LE_OK, LE_OK},
+        {"wrongFromatConfig1.json", "json", LE_OK, LE_FORMAT_ERROR}, {{0}}
     }
 };
 
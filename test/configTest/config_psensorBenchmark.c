@@ -0,0 +1,312 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_psensorBenchmark.c
+ *
+ * Compares the cost of 200 sensors sampled at 10 Hz when each one has its own timer and pushes
+ * each sample with its own io_PushNumeric() call, and when they are run by the periodicSensor
+ * component, which wakes up once per tick for all the sensors due in it and sends their samples
+ * in one io_PushBatch() call.
+ *
+ * Each way runs for the same time, after the sensors have settled.  The direct timers are started
+ * a few ms apart, as the timers of independently enabled sensors would be, while the periodic
+ * sensors are phase aligned.  The CPU time used by this process and the number of times it
+ * blocked (each wakeup of the event loop and each IPC call to the Data Hub blocks once) are
+ * logged per second for both.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include <sys/resource.h>
+
+#include "periodicSensor.h"
+#include "config_test.h"
+
+#define SENSOR_COUNT        200
+#define PERIOD_MS           100
+#define SETTLE_MS           1000
+#define MEASURE_MS          10000
+#define DIRECT_NAME         "direct/%d/value"
+#define BATCHED_NAME        "batched/%d"
+#define BATCHED_ABS_PATH    "/app/configTest/batched/%d/%s"
+
+/// Per-sensor timers pushing directly.
+static le_timer_Ref_t DirectTimers[SENSOR_COUNT];
+
+/// Sensors pushing through the periodicSensor component.
+static psensor_Ref_t Sensors[SENSOR_COUNT];
+
+/// Timer starting the direct timers one after the other.
+static le_timer_Ref_t StarterTimerRef;
+static int StartedCount = 0;
+
+/// Timer ending the settle and measurement phases.
+static le_timer_Ref_t PhaseTimerRef;
+
+/// Usage of this process at the start of the measurement.
+static struct rusage StartUsage;
+
+/// Number of direct pushes that failed.
+static int DirectFailures = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Log the CPU time used and the number of times this process blocked since StartUsage.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogUsage
+(
+    const char* method
+)
+{
+    struct rusage usage;
+    LE_ASSERT(getrusage(RUSAGE_SELF, &usage) == 0);
+
+    double cpuUs = (usage.ru_utime.tv_sec - StartUsage.ru_utime.tv_sec) * 1000000.0
+                 + (usage.ru_utime.tv_usec - StartUsage.ru_utime.tv_usec)
+                 + (usage.ru_stime.tv_sec - StartUsage.ru_stime.tv_sec) * 1000000.0
+                 + (usage.ru_stime.tv_usec - StartUsage.ru_stime.tv_usec);
+    long blocks = usage.ru_nvcsw - StartUsage.ru_nvcsw;
+    double seconds = MEASURE_MS / 1000.0;
+
+    LE_TEST_INFO("BENCHMARK: %d sensors at %d ms through %s: %.0f wakeups and IPC waits/s,"
+                 " CPU %.1f%%",
+                 SENSOR_COUNT,
+                 PERIOD_MS,
+                 method,
+                 blocks / seconds,
+                 cpuUs / (seconds * 10000.0));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push a sample directly.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DirectTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    char path[IO_MAX_RESOURCE_PATH_LEN];
+    int index = (int)(intptr_t)le_timer_GetContextPtr(timerRef);
+
+    snprintf(path, sizeof(path), DIRECT_NAME, index);
+    if (io_PushNumeric(path, IO_NOW, index) != LE_OK)
+    {
+        DirectFailures++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start the next direct timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartNextDirectTimer
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    le_timer_Start(DirectTimers[StartedCount++]);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Take a sample of a batched sensor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleSensor
+(
+    psensor_Ref_t ref,
+    void* context
+)
+{
+    psensor_PushNumeric(ref, 0, (double)(intptr_t)context);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start a phase timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartPhaseTimer
+(
+    uint32_t ms,
+    le_timer_ExpiryHandler_t handler
+)
+{
+    le_timer_Stop(PhaseTimerRef);
+    le_timer_SetHandler(PhaseTimerRef, handler);
+    le_timer_SetMsInterval(PhaseTimerRef, ms);
+    le_timer_Start(PhaseTimerRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End of the batched measurement: check the samples got through, and end the test.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndBatched
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    LogUsage("periodicSensor batches");
+
+    double timestamp;
+    double value;
+    le_result_t res = io_GetNumeric("batched/7/value", &timestamp, &value);
+    LE_TEST_OK((res == LE_OK) && (value == 7), "Batched samples reached the Data Hub (%s, %f)",
+               LE_RESULT_TXT(res), value);
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        psensor_Destroy(&Sensors[i]);
+    }
+
+    LE_TEST_INFO("======== END psensor Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Batched sensors have settled: start measuring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartBatched
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    LE_ASSERT(getrusage(RUSAGE_SELF, &StartUsage) == 0);
+    StartPhaseTimer(MEASURE_MS, EndBatched);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End of the direct measurement: stop the direct timers, and start the batched sensors.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndDirect
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    LogUsage("io_PushNumeric()");
+    LE_TEST_OK(DirectFailures == 0, "Direct pushes succeeded (%d failures)", DirectFailures);
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        le_timer_Delete(DirectTimers[i]);
+    }
+
+    le_result_t res = LE_OK;
+    char path[IO_MAX_RESOURCE_PATH_LEN];
+    char name[PSENSOR_MAX_NAME_BYTES];
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        snprintf(name, sizeof(name), BATCHED_NAME, i);
+        Sensors[i] = psensor_Create(name, IO_DATA_TYPE_NUMERIC, "", SampleSensor,
+                                    (void*)(intptr_t)i);
+        psensor_SetPhaseAlignment(Sensors[i], true);
+
+        snprintf(path, sizeof(path), BATCHED_ABS_PATH, i, "period");
+        if (admin_PushNumeric(path, IO_NOW, PERIOD_MS / 1000.0) != LE_OK)
+        {
+            res = LE_FAULT;
+        }
+        snprintf(path, sizeof(path), BATCHED_ABS_PATH, i, "enable");
+        if (admin_PushBoolean(path, IO_NOW, true) != LE_OK)
+        {
+            res = LE_FAULT;
+        }
+    }
+    LE_TEST_OK(res == LE_OK, "Enabled %d periodic sensors", SENSOR_COUNT);
+
+    StartPhaseTimer(SETTLE_MS, StartBatched);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Direct timers have settled: start measuring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartDirect
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    LE_ASSERT(getrusage(RUSAGE_SELF, &StartUsage) == 0);
+    StartPhaseTimer(MEASURE_MS, EndDirect);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_psensorBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN psensor Benchmark TEST ========");
+    LE_TEST_PLAN(4);
+
+    le_result_t res = LE_OK;
+    char path[IO_MAX_RESOURCE_PATH_LEN];
+
+    for (int i = 0; i < SENSOR_COUNT; i++)
+    {
+        snprintf(path, sizeof(path), DIRECT_NAME, i);
+        if (io_CreateInput(path, IO_DATA_TYPE_NUMERIC, "") != LE_OK)
+        {
+            res = LE_FAULT;
+        }
+
+        DirectTimers[i] = le_timer_Create("DirectSensor");
+        le_timer_SetHandler(DirectTimers[i], DirectTimerHandler);
+        le_timer_SetContextPtr(DirectTimers[i], (void*)(intptr_t)i);
+        le_timer_SetMsInterval(DirectTimers[i], PERIOD_MS);
+        le_timer_SetRepeat(DirectTimers[i], 0);
+    }
+    LE_TEST_OK(res == LE_OK, "Created %d direct Inputs", SENSOR_COUNT);
+
+    // Start one direct timer every 0.5 ms, spreading them over the period.
+    le_clk_Time_t interval = { .sec = 0, .usec = 500 };
+    StarterTimerRef = le_timer_Create("DirectSensorStarter");
+    le_timer_SetHandler(StarterTimerRef, StartNextDirectTimer);
+    le_timer_SetInterval(StarterTimerRef, interval);
+    le_timer_SetRepeat(StarterTimerRef, SENSOR_COUNT);
+    le_timer_Start(StarterTimerRef);
+
+    PhaseTimerRef = le_timer_Create("psensorBenchmarkPhase");
+    StartPhaseTimer(SETTLE_MS, StartDirect);
+}
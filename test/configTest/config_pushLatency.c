@@ -0,0 +1,356 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_pushLatency.c
+ *
+ * Measures how long io_PushNumeric() takes while the Data Hub is busy with a large config load,
+ * then with a full snapshot of the resource tree, compared to when it is idle.
+ *
+ * A sample is pushed every millisecond.  The round trip of each push is recorded, first while the
+ * Data Hub is idle, then from the moment the config load is started until it has completed, then
+ * likewise for the snapshot.  The median, 99th percentile and worst push latency of each phase
+ * are logged.  Only the parse of the config is done off the Data Hub's main thread, so the load
+ * phase shows the effect of that, while the snapshot phase is a baseline for work that still
+ * shares the main thread with pushes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "latency/value"
+#define CONFIG_PATH         "/tmp/configLatency.json"
+#define OBS_COUNT           20000
+#define IDLE_PUSHES         500
+#define MAX_PHASE_PUSHES    60000
+#define PUSH_INTERVAL_MS    1
+#define TEST_TIMEOUT        300000
+
+/// What the Data Hub is busy with while pushes are timed.
+typedef enum
+{
+    PHASE_IDLE,
+    PHASE_LOAD,
+    PHASE_SNAPSHOT,
+    PHASE_COUNT
+}
+Phase_t;
+
+static const char* const PhaseNames[PHASE_COUNT] =
+{
+    "idle",
+    "loading a config",
+    "taking a snapshot"
+};
+
+/// Push round trips (us) in each phase.
+static uint32_t Latency[PHASE_COUNT][MAX_PHASE_PUSHES];
+static size_t LatencyCount[PHASE_COUNT];
+
+static Phase_t Phase = PHASE_IDLE;
+
+static le_timer_Ref_t PushTimerRef;
+static le_timer_Ref_t TestTimeoutTimerRef;
+static le_fdMonitor_Ref_t SnapshotMonitorRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Compare two latencies, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLatency
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    uint32_t a = *(const uint32_t*)aPtr;
+    uint32_t b = *(const uint32_t*)bPtr;
+
+    return (a > b) - (a < b);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Log the median, 99th percentile and worst of a set of latencies.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LogPercentiles
+(
+    const char* phase,
+    uint32_t* latencyPtr,
+    size_t count
+)
+{
+    if (count == 0)
+    {
+        LE_TEST_INFO("BENCHMARK: no pushes while %s", phase);
+        return;
+    }
+
+    qsort(latencyPtr, count, sizeof(latencyPtr[0]), CompareLatency);
+
+    LE_TEST_INFO("BENCHMARK: %" PRIuS " pushes while %s: p50 %" PRIu32 " us, p99 %" PRIu32
+                 " us, max %" PRIu32 " us",
+                 count,
+                 phase,
+                 latencyPtr[count / 2],
+                 latencyPtr[(count * 99) / 100],
+                 latencyPtr[count - 1]);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a JSON config holding OBS_COUNT observations and as many states.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteConfig
+(
+    void
+)
+{
+    FILE* file = fopen(CONFIG_PATH, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"o\":{");
+    for (int i = 0; i < OBS_COUNT; i++)
+    {
+        fprintf(file,
+                "%s\"lat%d\":{\"r\":\"/app/configTest/lat/%d/value\",\"d\":\"latency\","
+                "\"st\":0.5,\"b\":10}",
+                (i == 0) ? "" : ",",
+                i,
+                i);
+    }
+    fprintf(file, "},\"s\":{");
+    for (int i = 0; i < OBS_COUNT; i++)
+    {
+        fprintf(file,
+                "%s\"/app/configTest/lat/%d/value\":{\"v\":%d}",
+                (i == 0) ? "" : ",",
+                i,
+                i);
+    }
+    fprintf(file, "}}");
+
+    return (fclose(file) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  End the test once the snapshot has completed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EndTest
+(
+    void
+)
+{
+    le_timer_Stop(PushTimerRef);
+    le_timer_Stop(TestTimeoutTimerRef);
+    unlink(CONFIG_PATH);
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        LogPercentiles(PhaseNames[phase], Latency[phase], LatencyCount[phase]);
+    }
+
+    LE_TEST_INFO("======== END Push Latency TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Snapshot result callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotResCallback
+(
+    le_result_t res,
+    void* context
+)
+{
+    LE_UNUSED(context);
+
+    LE_TEST_OK(res == LE_OK, "Snapshot result: %s", LE_RESULT_TXT(res));
+    EndTest();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read and discard the snapshot as it is streamed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotReadHandler
+(
+    int fd,
+    short events
+)
+{
+    char buffer[1024];
+
+    if ((events & POLLIN) && (read(fd, buffer, sizeof(buffer)) > 0))
+    {
+        return;
+    }
+
+    le_fdMonitor_Delete(SnapshotMonitorRef);
+    SnapshotMonitorRef = NULL;
+    close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start the snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartSnapshot
+(
+    void
+)
+{
+    int snapshotFd = -1;
+
+    Phase = PHASE_SNAPSHOT;
+
+    query_TakeSnapshot(QUERY_SNAPSHOT_FORMAT_JSON,
+                       0,
+                       "/",
+                       QUERY_BEGINNING_OF_TIME,
+                       SnapshotResCallback,
+                       NULL,
+                       &snapshotFd);
+    LE_TEST_OK(snapshotFd >= 0, "Snapshot started");
+    if (snapshotFd >= 0)
+    {
+        SnapshotMonitorRef = le_fdMonitor_Create("Snapshot", snapshotFd, SnapshotReadHandler,
+                                                 POLLIN);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Config load result callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+
+    LE_TEST_OK(res == LE_OK, "Config load result: %s (%s at %" PRIu32 ")",
+               LE_RESULT_TXT(res), errorMsg, fileLoc);
+    StartSnapshot();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Start the config load.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartLoad
+(
+    void
+)
+{
+    Phase = PHASE_LOAD;
+
+    le_result_t res = config_Load(CONFIG_PATH, "json", LoadResCallback, NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load returned %s", LE_RESULT_TXT(res));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push a sample and record how long the push took.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    io_PushNumeric(RESOURCE_NAME, IO_NOW, startTime.usec);
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    uint32_t latencyUs = (uint32_t)(elapsed.sec * 1000000 + elapsed.usec);
+
+    if (LatencyCount[Phase] < MAX_PHASE_PUSHES)
+    {
+        Latency[Phase][LatencyCount[Phase]++] = latencyUs;
+    }
+
+    if ((Phase == PHASE_IDLE) && (LatencyCount[PHASE_IDLE] == IDLE_PUSHES))
+    {
+        StartLoad();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Time out callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_FATAL("Config load and snapshot did not complete in time.");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_pushLatency_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Push Latency TEST ========");
+    LE_TEST_PLAN(6);
+
+    le_result_t res = io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Input: %s", LE_RESULT_TXT(res));
+    LE_TEST_OK(WriteConfig(), "Wrote config of %d observations", OBS_COUNT);
+
+    TestTimeoutTimerRef = le_timer_Create("LatencyTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+
+    PushTimerRef = le_timer_Create("LatencyPush");
+    le_timer_SetHandler(PushTimerRef, PushTimerHandler);
+    le_timer_SetMsInterval(PushTimerRef, PUSH_INTERVAL_MS);
+    le_timer_SetRepeat(PushTimerRef, 0);
+    le_timer_Start(PushTimerRef);
+}
@@ -0,0 +1,178 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_pushStats.c
+ *
+ * Tests the push statistics of the Admin API: samples pushed to an Input feeding an Observation
+ * with a high limit and a changeBy filter are counted by both resources, and the push path stages
+ * they go through are timed.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "stats/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME            "statsObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check that the push statistics counters of a resource have the expected values.
+ *
+ * @return true if they do.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckCounts
+(
+    const char* path,
+    const uint32_t* expectedPtr     ///< ADMIN_PUSH_COUNTER_COUNT expected counts.
+)
+{
+    uint32_t counts[ADMIN_PUSH_COUNTER_COUNT];
+    size_t countsSize = ADMIN_PUSH_COUNTER_COUNT;
+
+    if (   (admin_GetPushCounts(path, counts, &countsSize) != LE_OK)
+        || (countsSize != ADMIN_PUSH_COUNTER_COUNT))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < ADMIN_PUSH_COUNTER_COUNT; i++)
+    {
+        if (counts[i] != expectedPtr[i])
+        {
+            LE_TEST_INFO("%s: counter %d is %" PRIu32 ", expected %" PRIu32,
+                         path, i, counts[i], expectedPtr[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Check the latency summary of a push path stage, which should have run at least minCount times.
+ *
+ * @return true if it is consistent.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckLatency
+(
+    admin_PushStage_t stage,
+    uint64_t minCount
+)
+{
+    uint64_t count;
+    double mean, p50, p90, p99, max;
+
+    if (admin_GetPushLatency(stage, &count, &mean, &p50, &p90, &p99, &max) != LE_OK)
+    {
+        return false;
+    }
+
+    LE_TEST_INFO("stage %d: %" PRIu64 " runs, mean %.1f us, p50 %.1f us, p99 %.1f us,"
+                 " max %.1f us",
+                 stage, count, mean * 1e6, p50 * 1e6, p99 * 1e6, max * 1e6);
+
+    return    (count >= minCount)
+           && (p50 <= p90) && (p90 <= p99) && (p99 <= max)
+           && (mean <= max);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_pushStats_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Push Stats TEST ========");
+    LE_TEST_PLAN(8);
+
+    le_result_t result = admin_SetPushStageTiming(true);
+
+    if (result == LE_OK)
+    {
+        result = admin_ResetPushStats();
+    }
+
+    LE_TEST_BEGIN_SKIP(result == LE_NOT_IMPLEMENTED, 8);
+
+    LE_TEST_OK(result == LE_OK, "Reset push statistics (%s)", LE_RESULT_TXT(result));
+
+    LE_TEST_OK(   (io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (admin_CreateObs(OBS_NAME) == LE_OK)
+               && (admin_SetHighLimit(OBS_NAME, 100) == LE_OK)
+               && (admin_SetChangeBy(OBS_NAME, 5) == LE_OK)
+               && (admin_SetSource(ADMIN_OBS_NAME, ADMIN_RESOURCE_NAME) == LE_OK),
+               "Created Input and Observation");
+
+    // The Observation accepts 1, then filters out 2 (changeBy) and 200 (high limit), then
+    // accepts 10.
+    io_PushNumeric(RESOURCE_NAME, 1, 1);
+    io_PushNumeric(RESOURCE_NAME, 2, 2);
+    io_PushNumeric(RESOURCE_NAME, 3, 200);
+    io_PushNumeric(RESOURCE_NAME, 4, 10);
+
+    const uint32_t inputCounts[ADMIN_PUSH_COUNTER_COUNT] =
+    {
+        [ADMIN_PUSH_COUNTER_PUSHED] = 4,
+        [ADMIN_PUSH_COUNTER_ACCEPTED] = 4,
+    };
+    const uint32_t obsCounts[ADMIN_PUSH_COUNTER_COUNT] =
+    {
+        [ADMIN_PUSH_COUNTER_PUSHED] = 4,
+        [ADMIN_PUSH_COUNTER_ACCEPTED] = 2,
+        [ADMIN_PUSH_COUNTER_FILTERED_LIMIT] = 1,
+        [ADMIN_PUSH_COUNTER_FILTERED_CHANGE_BY] = 1,
+    };
+    LE_TEST_OK(CheckCounts(ADMIN_RESOURCE_NAME, inputCounts), "Input counts");
+    LE_TEST_OK(CheckCounts(ADMIN_OBS_NAME, obsCounts), "Observation counts");
+
+    uint32_t counts[ADMIN_PUSH_COUNTER_COUNT];
+    size_t countsSize = ADMIN_PUSH_COUNTER_COUNT;
+    LE_TEST_OK(admin_GetPushCounts("/app/configTest/stats", counts, &countsSize) == LE_NOT_FOUND,
+               "No counts for a namespace");
+
+    LE_TEST_OK(   CheckLatency(ADMIN_PUSH_STAGE_COERCION, 4)
+               && CheckLatency(ADMIN_PUSH_STAGE_FILTER, 4)
+               && CheckLatency(ADMIN_PUSH_STAGE_HANDLERS, 6),
+               "Latency summaries");
+
+    uint64_t count;
+    double mean, p50, p90, p99, max;
+    LE_TEST_OK(admin_GetPushLatency(ADMIN_PUSH_STAGE_COUNT, &count, &mean, &p50, &p90, &p99, &max)
+               == LE_BAD_PARAMETER,
+               "Unknown stage");
+
+    const uint32_t zeroCounts[ADMIN_PUSH_COUNTER_COUNT] = { 0 };
+    LE_TEST_OK(   (admin_ResetPushStats() == LE_OK)
+               && CheckCounts(ADMIN_OBS_NAME, zeroCounts)
+               && (admin_GetPushLatency(ADMIN_PUSH_STAGE_FILTER,
+                                        &count, &mean, &p50, &p90, &p99, &max) == LE_OK)
+               && (count == 0),
+               "Reset counts and histograms");
+
+    admin_SetPushStageTiming(false);
+
+    LE_TEST_END_SKIP();
+
+    admin_DeleteObs(OBS_NAME);
+
+    LE_TEST_INFO("======== END Push Stats TEST ========");
+    LE_TEST_EXIT;
+}
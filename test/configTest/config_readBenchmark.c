@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_readBenchmark.c
+ *
+ * Tests the read handles of the query API, and compares the cost of refreshing the current values
+ * of many resources by path (query_GetDataType(), then query_GetNumeric() or query_GetBoolean())
+ * with reading them all through handles with query_ReadValues().
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_COUNT      QUERY_MAX_READ_VALUES
+#define REFRESH_COUNT       200
+#define RESOURCE_NAME_FMT   "read/value%d"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_readBenchmark_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Read Benchmark TEST ========");
+    LE_TEST_PLAN(8);
+
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    uint32_t handles[RESOURCE_COUNT];
+    le_result_t result = LE_OK;
+
+    // Even resources are numeric, odd ones Boolean; the last one never gets a value.  Resource i
+    // is given the value i at timestamp i + 1 (0 being IO_NOW).
+    for (int i = 0; (i < RESOURCE_COUNT) && (result == LE_OK); i++)
+    {
+        snprintf(path, sizeof(path), RESOURCE_NAME_FMT, i);
+        result = io_CreateInput(path,
+                                (i % 2) ? IO_DATA_TYPE_BOOLEAN : IO_DATA_TYPE_NUMERIC,
+                                "");
+        if ((result == LE_OK) && (i < RESOURCE_COUNT - 1))
+        {
+            result = (i % 2) ? io_PushBoolean(path, i + 1, true)
+                             : io_PushNumeric(path, i + 1, i);
+        }
+        if (result == LE_OK)
+        {
+            result = query_GetReadHandle(path, &handles[i]);
+        }
+    }
+    LE_TEST_OK(result == LE_OK, "Created Inputs and got read handles (%s)", LE_RESULT_TXT(result));
+
+    uint32_t handle = UINT32_MAX;
+    LE_TEST_OK(   (query_GetReadHandle("/app/configTest/read/value0", &handle) == LE_OK)
+               && (handle == handles[0]),
+               "Absolute and relative paths give the same handle");
+    LE_TEST_OK(query_GetReadHandle("read", &handle) == LE_NOT_FOUND,
+               "No handle for a namespace");
+
+    uint8_t types[RESOURCE_COUNT];
+    double timestamps[RESOURCE_COUNT];
+    double values[RESOURCE_COUNT];
+    size_t typesSize = RESOURCE_COUNT;
+    size_t timestampsSize = RESOURCE_COUNT;
+    size_t valuesSize = RESOURCE_COUNT;
+
+    result = query_ReadValues(handles, RESOURCE_COUNT,
+                              types, &typesSize,
+                              timestamps, &timestampsSize,
+                              values, &valuesSize);
+    bool isCorrect = (result == LE_OK) && (typesSize == RESOURCE_COUNT);
+    for (int i = 0; isCorrect && (i < RESOURCE_COUNT - 1); i++)
+    {
+        isCorrect = (types[i] == ((i % 2) ? IO_DATA_TYPE_BOOLEAN : IO_DATA_TYPE_NUMERIC))
+                    && (timestamps[i] == i + 1)
+                    && (values[i] == ((i % 2) ? 1 : i));
+    }
+    LE_TEST_OK(isCorrect, "Read the current values");
+    LE_TEST_OK(types[RESOURCE_COUNT - 1] == QUERY_READ_NO_VALUE, "Resource without a value");
+
+    // A deleted resource reads as having no value, and an unknown handle is an error.
+    uint32_t deletedHandles[2] = { handles[0], UINT32_MAX };
+    typesSize = timestampsSize = valuesSize = 2;
+    io_DeleteResource("read/value0");
+    result = query_ReadValues(deletedHandles, 2,
+                              types, &typesSize,
+                              timestamps, &timestampsSize,
+                              values, &valuesSize);
+    LE_TEST_OK(   (result == LE_BAD_PARAMETER)
+               && (types[0] == QUERY_READ_NO_VALUE)
+               && (types[1] == QUERY_READ_NO_VALUE),
+               "Deleted resource and unknown handle (%s)", LE_RESULT_TXT(result));
+    io_CreateInput("read/value0", IO_DATA_TYPE_NUMERIC, "");
+    io_PushNumeric("read/value0", 1, 0);
+
+    // Refresh by path, as a client without handles would.
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    result = LE_OK;
+    for (int n = 0; (n < REFRESH_COUNT) && (result == LE_OK); n++)
+    {
+        for (int i = 0; (i < RESOURCE_COUNT - 1) && (result == LE_OK); i++)
+        {
+            io_DataType_t dataType;
+            double timestamp;
+            double numValue;
+            bool boolValue;
+
+            snprintf(path, sizeof(path), RESOURCE_NAME_FMT, i);
+            result = query_GetDataType(path, &dataType);
+            if (result == LE_OK)
+            {
+                result = (dataType == IO_DATA_TYPE_BOOLEAN) ?
+                                query_GetBoolean(path, &timestamp, &boolValue) :
+                                query_GetNumeric(path, &timestamp, &numValue);
+            }
+        }
+    }
+    configTest_LogTime("values refreshed by path", startTime, REFRESH_COUNT * RESOURCE_COUNT,
+                       "value");
+    LE_TEST_OK(result == LE_OK, "Refreshed by path (%s)", LE_RESULT_TXT(result));
+
+    startTime = le_clk_GetRelativeTime();
+    result = LE_OK;
+    for (int n = 0; (n < REFRESH_COUNT) && (result == LE_OK); n++)
+    {
+        typesSize = timestampsSize = valuesSize = RESOURCE_COUNT;
+        result = query_ReadValues(handles, RESOURCE_COUNT,
+                                  types, &typesSize,
+                                  timestamps, &timestampsSize,
+                                  values, &valuesSize);
+    }
+    configTest_LogTime("values refreshed by handle", startTime, REFRESH_COUNT * RESOURCE_COUNT,
+                       "value");
+    LE_TEST_OK(result == LE_OK, "Refreshed by handle (%s)", LE_RESULT_TXT(result));
+
+    LE_TEST_INFO("======== END Read Benchmark TEST ========");
+    LE_TEST_EXIT;
+}
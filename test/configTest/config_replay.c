@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_replay.c
+ *
+ * Tests that samples held back during an administrative update are filtered, when they are
+ * replayed at the end of it, as of the time they were pushed: two samples pushed further apart
+ * than the Observation's minPeriod must both get through, although they are replayed together.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "replay/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME            "replayObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+
+/// Observation minPeriod (s), and time between the two samples pushed (ms).
+#define MIN_PERIOD          0.2
+#define PUSH_GAP_MS         500
+
+/// How far back to look for samples in the Observation (s).
+#define HISTORY_SECS        3600
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push the second sample, end the update, and check that both samples got through.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SecondPush
+(
+    le_timer_Ref_t timerRef
+)
+{
+    le_timer_Delete(timerRef);
+
+    LE_TEST_OK(io_PushNumeric(RESOURCE_NAME, IO_NOW, 3) == LE_OK, "Pushed second sample");
+    LE_TEST_OK(isnan(query_GetMax(OBS_NAME, HISTORY_SECS)), "Samples held back");
+
+    admin_EndUpdate();
+
+    LE_TEST_OK(   (query_GetMin(OBS_NAME, HISTORY_SECS) == 1)
+               && (query_GetMax(OBS_NAME, HISTORY_SECS) == 3),
+               "Both samples delivered");
+
+    admin_DeleteObs(OBS_NAME);
+    io_DeleteResource(RESOURCE_NAME);
+
+    LE_TEST_INFO("======== END Replay TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_replay_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Replay TEST ========");
+    LE_TEST_PLAN(4);
+
+    LE_TEST_OK(   (io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (admin_CreateObs(OBS_NAME) == LE_OK)
+               && (admin_SetBufferMaxCount(OBS_NAME, 10) == LE_OK)
+               && (admin_SetSource(ADMIN_OBS_NAME, ADMIN_RESOURCE_NAME) == LE_OK),
+               "Created Input and Observation");
+
+    // Changing the minPeriod during an update holds back the samples pushed to the Observation.
+    admin_StartUpdate();
+    admin_SetMinPeriod(OBS_NAME, MIN_PERIOD);
+    io_PushNumeric(RESOURCE_NAME, IO_NOW, 1);
+
+    le_timer_Ref_t timerRef = le_timer_Create("ReplayPush");
+    le_timer_SetHandler(timerRef, SecondPush);
+    le_timer_SetMsInterval(timerRef, PUSH_GAP_MS);
+    le_timer_Start(timerRef);
+}
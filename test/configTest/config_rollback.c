@@ -0,0 +1,137 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_rollback.c
+ *
+ * Testing that a config which fails to apply leaves the previous config in place.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define TEST_CALLBACK_TIMEOUT 5000
+
+#define RESOURCE_NAME "resource1/value"
+#define OBS_NAME "rbobs1"
+
+/*
+ * Timer to trigger timeout if expected event is not received.
+ */
+static le_timer_Ref_t TestTimeoutTimerRef;
+
+static const double TestValues[] = { 1.0, 2.0, 3.0 };
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  timeout handler
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_FATAL("Did not get result callback in time.");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Result callback of the config that cannot be applied.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FailedLoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+    le_timer_Stop(TestTimeoutTimerRef);
+
+    LE_TEST_OK(res == LE_FAULT, "Config apply failed: %s (%s at %" PRIu32 ")",
+               LE_RESULT_TXT(res), errorMsg, fileLoc);
+
+    // The first config must still be in place, with the samples buffered before the failed load.
+    LE_TEST_OK(admin_GetBufferMaxCount(OBS_NAME) == 10, "Buffer size restored");
+    LE_TEST_OK(admin_GetChangeBy(OBS_NAME) == 0.5, "Change by restored");
+    LE_TEST_OK(query_GetMean(OBS_NAME, 60) == 2.0, "Buffered samples kept");
+    LE_TEST_OK(admin_GetEntryType("/obs/rbnew") == ADMIN_ENTRY_TYPE_NONE,
+               "New observation removed");
+
+    LE_TEST_INFO("======== END Rollback TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Result callback of the first config.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConfigLoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+    LE_UNUSED(errorMsg);
+    LE_UNUSED(fileLoc);
+    LE_TEST_OK(res == LE_OK, "Config file final load result: %d", res);
+
+    for (size_t i = 0; i < NUM_ARRAY_MEMBERS(TestValues); i++)
+    {
+        res = io_PushNumeric(RESOURCE_NAME, IO_NOW, TestValues[i]);
+        LE_TEST_OK(res == LE_OK, "Pushed %f: %s", TestValues[i], LE_RESULT_TXT(res));
+    }
+
+    // This config changes the observation, then fails on a data flow loop.
+    res = config_Load("test/configTest/configFiles/rollbackConfig2.json",
+                      "json",
+                      FailedLoadResCallback,
+                      NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load return value is %d", res);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function: load a config, buffer some samples, then load a config that cannot be
+ * applied and check that the first config and its buffer are untouched.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_rollback_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Rollback TEST ========");
+    LE_TEST_PLAN(12);
+
+    le_result_t res = io_CreateOutput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Resource: %s", LE_RESULT_TXT(res));
+
+    res = config_Load("test/configTest/configFiles/rollbackConfig1.json",
+                      "json",
+                      ConfigLoadResCallback,
+                      NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load return value is %d", res);
+
+    TestTimeoutTimerRef = le_timer_Create("TestTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_CALLBACK_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+}
@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_slowOps.c
+ *
+ * Tests the slow operation trace of the Admin API: with a zero threshold, pushes and buffer
+ * backups are recorded with the path they were on, and the trace can be cleared.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "slow/value"
+#define ADMIN_RESOURCE_NAME "/app/configTest/" RESOURCE_NAME
+#define OBS_NAME            "slowObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+
+/// Default slow operation threshold (s).
+#define DEFAULT_THRESHOLD   0.1
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Look for an operation among the slow operations kept.
+ *
+ * @return true if it was found.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool FindSlowOp
+(
+    const char* expectedName,
+    const char* expectedPath
+)
+{
+    char name[ADMIN_MAX_SLOW_OP_NAME_LEN + 1];
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    double timestamp, duration;
+
+    for (uint32_t i = 0;
+         admin_GetSlowOp(i, name, sizeof(name), path, sizeof(path), &timestamp, &duration) == LE_OK;
+         i++)
+    {
+        LE_TEST_INFO("slow op %" PRIu32 ": %s '%s' took %.1f us", i, name, path, duration * 1e6);
+
+        if ((strcmp(name, expectedName) == 0) && (strcmp(path, expectedPath) == 0))
+        {
+            return (duration >= 0) && (timestamp > 0);
+        }
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_slowOps_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Slow Ops TEST ========");
+    LE_TEST_PLAN(6);
+
+    double threshold;
+    le_result_t result = admin_GetSlowOpThreshold(&threshold);
+
+    LE_TEST_BEGIN_SKIP(result == LE_NOT_IMPLEMENTED, 6);
+
+    LE_TEST_OK(result == LE_OK, "Got threshold %lf s (%s)", threshold, LE_RESULT_TXT(result));
+
+    LE_TEST_OK(   (admin_SetSlowOpThreshold(-1) == LE_BAD_PARAMETER)
+               && (admin_SetSlowOpThreshold(NAN) == LE_BAD_PARAMETER),
+               "Rejected bad thresholds");
+
+    // Record everything from here on.
+    LE_TEST_OK(   (admin_SetSlowOpThreshold(0) == LE_OK)
+               && (admin_ClearSlowOps() == LE_OK)
+               && (io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "") == LE_OK)
+               && (io_PushNumeric(RESOURCE_NAME, 0, 1) == LE_OK)
+               && FindSlowOp("io_PushNumeric", ADMIN_RESOURCE_NAME),
+               "Push recorded");
+
+    // Re-enabling backups backs the buffer up straight away.
+    LE_TEST_OK(   (admin_CreateObs(OBS_NAME) == LE_OK)
+               && (admin_SetSource(ADMIN_OBS_NAME, ADMIN_RESOURCE_NAME) == LE_OK)
+               && (admin_SetBufferMaxCount(OBS_NAME, 10) == LE_OK)
+               && (io_PushNumeric(RESOURCE_NAME, 0, 2) == LE_OK)
+               && (admin_SetBufferBackupPeriod(OBS_NAME, 0) == LE_OK)
+               && (admin_SetBufferBackupPeriod(OBS_NAME, 1) == LE_OK)
+               && FindSlowOp("backup", ADMIN_OBS_NAME),
+               "Backup recorded");
+
+    char name[4];
+    char path[IO_MAX_RESOURCE_PATH_LEN + 1];
+    double timestamp, duration;
+    LE_TEST_OK(admin_GetSlowOp(0, name, sizeof(name), path, sizeof(path), &timestamp, &duration)
+               == LE_OVERFLOW,
+               "Name truncated");
+
+    LE_TEST_OK(   (admin_SetSlowOpThreshold(DEFAULT_THRESHOLD) == LE_OK)
+               && (admin_ClearSlowOps() == LE_OK)
+               && (admin_GetSlowOp(0, name, sizeof(name), path, sizeof(path),
+                                   &timestamp, &duration) == LE_OUT_OF_RANGE),
+               "Cleared slow operations");
+
+    LE_TEST_END_SKIP();
+
+    admin_DeleteObs(OBS_NAME);
+    io_DeleteResource(RESOURCE_NAME);
+
+    LE_TEST_INFO("======== END Slow Ops TEST ========");
+    LE_TEST_EXIT;
+}
@@ -33,6 +33,78 @@ COMPONENT_INIT
    {
         config_destinationPush_test();
    }
+   else if (strcmp(action, "batch") == 0)
+   {
+        config_destinationBatch_test();
+   }
+   else if (strcmp(action, "rollback") == 0)
+   {
+        config_rollback_test();
+   }
+   else if (strcmp(action, "estimate") == 0)
+   {
+        config_estimate_test();
+   }
+   else if (strcmp(action, "wildcard") == 0)
+   {
+        config_wildcard_test();
+   }
+   else if (strcmp(action, "benchmark") == 0)
+   {
+        config_benchmark_test();
+   }
+   else if (strcmp(action, "ingest") == 0)
+   {
+        config_ingestBenchmark_test();
+   }
+   else if (strcmp(action, "latency") == 0)
+   {
+        config_pushLatency_test();
+   }
+   else if (strcmp(action, "psensor") == 0)
+   {
+        config_psensorBenchmark_test();
+   }
+   else if (strcmp(action, "demand") == 0)
+   {
+        config_demand_test();
+   }
+   else if (strcmp(action, "coerce") == 0)
+   {
+        config_coerceBenchmark_test();
+   }
+   else if (strcmp(action, "clock") == 0)
+   {
+        config_clockBenchmark_test();
+   }
+   else if (strcmp(action, "read") == 0)
+   {
+        config_readBenchmark_test();
+   }
+   else if (strcmp(action, "list") == 0)
+   {
+        config_listBenchmark_test();
+   }
+   else if (strcmp(action, "stats") == 0)
+   {
+        config_pushStats_test();
+   }
+   else if (strcmp(action, "slowOps") == 0)
+   {
+        config_slowOps_test();
+   }
+   else if (strcmp(action, "cpuProfile") == 0)
+   {
+        config_cpuProfile_test();
+   }
+   else if (strcmp(action, "nesting") == 0)
+   {
+        config_updateNesting_test();
+   }
+   else if (strcmp(action, "replay") == 0)
+   {
+        config_replay_test();
+   }
    else
    {
        LE_ERROR("unknown action");
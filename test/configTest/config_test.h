@@ -14,5 +14,29 @@
 
 void config_parser_test();
 void config_destinationPush_test();
+void config_destinationBatch_test();
+void config_rollback_test();
+void config_estimate_test();
+void config_wildcard_test();
+void config_benchmark_test();
+void config_ingestBenchmark_test();
+void config_pushLatency_test();
+void config_psensorBenchmark_test();
+void config_demand_test();
+void config_coerceBenchmark_test();
+void config_clockBenchmark_test();
+void config_readBenchmark_test();
+void config_listBenchmark_test();
+void config_pushStats_test();
+void config_slowOps_test();
+void config_cpuProfile_test();
+void config_updateNesting_test();
+void config_replay_test();
+
+// Benchmark helpers (config_benchmarkUtil.c).
+void configTest_LogTime(const char* what, le_clk_Time_t startTime, int count, const char* unit);
+pid_t configTest_FindHubPid(void);
+long configTest_GetProcField(pid_t pid, const char* file, const char* key);
+long configTest_GetPeakKb(pid_t pid);
 
 #endif
@@ -0,0 +1,254 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_updateNesting.c
+ *
+ * Tests that snapshots taken while a large config is applied, a chunk at a time, don't end the
+ * config's administrative update early.
+ *
+ * The first Observation of the config is fed by an Input that is pushed to every millisecond, and
+ * snapshots are taken back to back until the load completes.  Until then, the samples pushed must
+ * be held back rather than reach the Observation through a half-applied config, even after this
+ * client calls admin_EndUpdate() without having started an update.  When the load completes, the
+ * held back samples must be delivered.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define RESOURCE_NAME       "nest/value"
+#define OBS_NAME            "nestObs"
+#define ADMIN_OBS_NAME      "/obs/" OBS_NAME
+#define CONFIG_PATH         "/tmp/configNesting.json"
+#define FILLER_OBS_COUNT    20000
+#define PUSH_INTERVAL_MS    1
+#define TEST_TIMEOUT        300000
+
+/// How far back to look for samples in the Observation (s).
+#define HISTORY_SECS        3600
+
+static bool LoadDone = false;
+static bool IsSnapshotRunning = false;
+static unsigned int SnapshotsDuringApply = 0;
+static bool SampleLeaked = false;
+static bool StrayEndDone = false;
+
+static le_timer_Ref_t PushTimerRef;
+static le_timer_Ref_t TestTimeoutTimerRef;
+static le_fdMonitor_Ref_t SnapshotMonitorRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Write a JSON config holding the Observation fed by the Input, then FILLER_OBS_COUNT more so the
+ *  apply takes many chunks.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteConfig
+(
+    void
+)
+{
+    FILE* file = fopen(CONFIG_PATH, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file,
+            "{\"o\":{\"" OBS_NAME "\":{\"r\":\"/app/configTest/" RESOURCE_NAME "\",\"b\":100}");
+    for (int i = 0; i < FILLER_OBS_COUNT; i++)
+    {
+        fprintf(file, ",\"nest%d\":{\"r\":\"/app/configTest/nest/%d/value\",\"b\":10}", i, i);
+    }
+    fprintf(file, "}}");
+
+    return (fclose(file) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Config load result callback.  The samples held back during the apply have been delivered by
+ *  now.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+
+    LoadDone = true;
+    le_timer_Stop(PushTimerRef);
+    le_timer_Stop(TestTimeoutTimerRef);
+    unlink(CONFIG_PATH);
+
+    LE_TEST_OK(res == LE_OK, "Config load result: %s (%s at %" PRIu32 ")",
+               LE_RESULT_TXT(res), errorMsg, fileLoc);
+    LE_TEST_OK(SnapshotsDuringApply > 0,
+               "%u snapshots completed during the apply", SnapshotsDuringApply);
+    LE_TEST_OK(!SampleLeaked, "Samples held back until the end of the load");
+    LE_TEST_OK(!isnan(query_GetMax(OBS_NAME, HISTORY_SECS)), "Held back samples delivered");
+
+    admin_DeleteObs(OBS_NAME);
+    io_DeleteResource(RESOURCE_NAME);
+
+    LE_TEST_INFO("======== END Update Nesting TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Snapshot result callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotResCallback
+(
+    le_result_t res,
+    void* context
+)
+{
+    LE_UNUSED(context);
+
+    IsSnapshotRunning = false;
+
+    // Only count the snapshots that ended after the Observation was applied.
+    if (   (res == LE_OK)
+        && !LoadDone
+        && (admin_GetEntryType(ADMIN_OBS_NAME) == ADMIN_ENTRY_TYPE_OBSERVATION))
+    {
+        SnapshotsDuringApply++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Read and discard the snapshot as it is streamed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotReadHandler
+(
+    int fd,
+    short events
+)
+{
+    char buffer[1024];
+
+    if ((events & POLLIN) && (read(fd, buffer, sizeof(buffer)) > 0))
+    {
+        return;
+    }
+
+    le_fdMonitor_Delete(SnapshotMonitorRef);
+    SnapshotMonitorRef = NULL;
+    close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Push a sample, check that none has reached the Observation, and start a snapshot if none is
+ *  running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    LE_UNUSED(timerRef);
+
+    // Once the apply has started, end an update this client never started: it must be ignored.
+    if (!StrayEndDone && (admin_GetEntryType(ADMIN_OBS_NAME) == ADMIN_ENTRY_TYPE_OBSERVATION))
+    {
+        StrayEndDone = true;
+        admin_EndUpdate();
+    }
+
+    io_PushNumeric(RESOURCE_NAME, IO_NOW, 1);
+
+    if (!isnan(query_GetMax(OBS_NAME, HISTORY_SECS)))
+    {
+        SampleLeaked = true;
+    }
+
+    if (!IsSnapshotRunning && (SnapshotMonitorRef == NULL))
+    {
+        int snapshotFd = -1;
+
+        IsSnapshotRunning = true;
+        query_TakeSnapshot(QUERY_SNAPSHOT_FORMAT_JSON,
+                           0,
+                           "/",
+                           QUERY_BEGINNING_OF_TIME,
+                           SnapshotResCallback,
+                           NULL,
+                           &snapshotFd);
+        if (snapshotFd >= 0)
+        {
+            SnapshotMonitorRef = le_fdMonitor_Create("Snapshot", snapshotFd, SnapshotReadHandler,
+                                                     POLLIN);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Time out callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_FATAL("Config load did not complete in time.");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_updateNesting_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Update Nesting TEST ========");
+    LE_TEST_PLAN(7);
+
+    le_result_t res = io_CreateInput(RESOURCE_NAME, IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created Numeric Input: %s", LE_RESULT_TXT(res));
+    LE_TEST_OK(WriteConfig(), "Wrote config of %d observations", FILLER_OBS_COUNT + 1);
+
+    res = config_Load(CONFIG_PATH, "json", LoadResCallback, NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load returned %s", LE_RESULT_TXT(res));
+
+    TestTimeoutTimerRef = le_timer_Create("NestingTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+
+    PushTimerRef = le_timer_Create("NestingPush");
+    le_timer_SetHandler(PushTimerRef, PushTimerHandler);
+    le_timer_SetMsInterval(PushTimerRef, PUSH_INTERVAL_MS);
+    le_timer_SetRepeat(PushTimerRef, 0);
+    le_timer_Start(PushTimerRef);
+}
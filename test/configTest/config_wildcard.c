@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file config_wildcard.c
+ *
+ * Testing wildcard observations (observation templates) in config files.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+
+#include "config_test.h"
+
+#define TEST_CALLBACK_TIMEOUT 5000
+
+#define TEMPLATE_NAME "adc/*"
+#define SOURCE_PATTERN "/app/configTest/adc/*/value"
+
+/*
+ * Timer to trigger timeout if expected event is not received.
+ */
+static le_timer_Ref_t TestTimeoutTimerRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  timeout handler
+ */
+//--------------------------------------------------------------------------------------------------
+static void CallbackTimeout
+(
+    le_timer_Ref_t timerRef                   ///< [IN] Timer pointer
+)
+{
+    LE_UNUSED(timerRef);
+    LE_TEST_FATAL("Did not get result callback in time.");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  config load result callback.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConfigLoadResCallback
+(
+    le_result_t res,
+    const char* errorMsg,
+    uint32_t fileLoc,
+    void* context
+)
+{
+    LE_UNUSED(context);
+    le_timer_Stop(TestTimeoutTimerRef);
+
+    LE_TEST_OK(res == LE_OK, "Config file final load result: %s (%s at %" PRIu32 ")",
+               LE_RESULT_TXT(res), errorMsg, fileLoc);
+
+    char srcPath[IO_MAX_RESOURCE_PATH_LEN + 1];
+    res = admin_GetSource("/obs/" TEMPLATE_NAME, srcPath, sizeof(srcPath));
+    LE_TEST_OK((res == LE_OK) && (strcmp(srcPath, SOURCE_PATTERN) == 0),
+               "Template source: %s", srcPath);
+
+    // The resource that existed before the config was loaded.
+    LE_TEST_OK(admin_GetEntryType("/obs/adc/ch0") == ADMIN_ENTRY_TYPE_OBSERVATION,
+               "Instance created for existing resource");
+    LE_TEST_OK(admin_GetBufferMaxCount("adc/ch0") == 5, "Instance buffer size");
+    LE_TEST_OK(admin_GetChangeBy("adc/ch0") == 0.5, "Instance change by");
+
+    // A resource created after the config was loaded.
+    res = io_CreateOutput("adc/ch1/value", IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created adc/ch1/value: %s", LE_RESULT_TXT(res));
+    LE_TEST_OK(admin_GetEntryType("/obs/adc/ch1") == ADMIN_ENTRY_TYPE_OBSERVATION,
+               "Instance created for new resource");
+
+    // Settings changed on the template apply to its instances...
+    LE_TEST_OK(admin_SetChangeBy(TEMPLATE_NAME, 1.0) == LE_OK, "Set template change by");
+    LE_TEST_OK(admin_GetChangeBy("adc/ch1") == 1.0, "Instance follows template change by");
+
+    // ...until the instance gets a setting of its own.
+    LE_TEST_OK(admin_SetChangeBy("adc/ch0", 2.0) == LE_OK, "Set instance change by");
+    LE_TEST_OK((admin_GetChangeBy("adc/ch0") == 2.0) &&
+               (admin_GetChangeBy(TEMPLATE_NAME) == 1.0) &&
+               (admin_GetChangeBy("adc/ch1") == 1.0),
+               "Instance setting does not affect template");
+
+    admin_DeleteObs(TEMPLATE_NAME);
+    LE_TEST_OK((admin_GetEntryType("/obs/adc/ch0") != ADMIN_ENTRY_TYPE_OBSERVATION) &&
+               (admin_GetEntryType("/obs/adc/ch1") != ADMIN_ENTRY_TYPE_OBSERVATION),
+               "Instances deleted with template");
+
+    LE_TEST_INFO("======== END Wildcard TEST ========");
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main test function: load a config with a wildcard observation and check that it is
+ * instantiated for existing and new matching resources.
+ *
+ * @return none
+ */
+//--------------------------------------------------------------------------------------------------
+void config_wildcard_test
+(
+    void
+)
+{
+    LE_TEST_INFO("======== BEGIN Wildcard TEST ========");
+    LE_TEST_PLAN(14);
+
+    le_result_t res = io_CreateOutput("adc/ch0/value", IO_DATA_TYPE_NUMERIC, "");
+    LE_TEST_OK(res == LE_OK, "Created adc/ch0/value: %s", LE_RESULT_TXT(res));
+
+    res = config_Load("test/configTest/configFiles/wildcardConfig.json",
+                      "json",
+                      ConfigLoadResCallback,
+                      NULL);
+    LE_TEST_OK(res == LE_OK, "config_Load return value is %d", res);
+
+    TestTimeoutTimerRef = le_timer_Create("TestTimeout");
+    le_timer_SetHandler(TestTimeoutTimerRef, CallbackTimeout);
+    le_timer_SetMsInterval(TestTimeoutTimerRef, TEST_CALLBACK_TIMEOUT);
+    le_timer_Start(TestTimeoutTimerRef);
+}